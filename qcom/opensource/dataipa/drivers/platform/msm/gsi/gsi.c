@@ -2283,6 +2283,8 @@ int gsi_alloc_evt_ring(struct gsi_evt_ring_props *props, unsigned long dev_hdl,
 	}
 
 	gsi_program_evt_ring_ctx(props, evt_id, gsi_ctx->per.ee);
+	ctx->cur_int_modt = props->int_modt;
+	ctx->cur_int_modc = props->int_modc;
 
 	spin_lock_init(&ctx->ring.slock);
 	gsi_init_evt_ring(props, &ctx->ring);
@@ -2602,7 +2604,10 @@ int gsi_reset_evt_ring(unsigned long evt_ring_hdl)
 		GSI_ASSERT();
 	}
 
+	/* drops any moderation set by gsi_update_evt_ring_int_mod() */
 	gsi_program_evt_ring_ctx(&ctx->props, evt_ring_hdl, gsi_ctx->per.ee);
+	ctx->cur_int_modt = ctx->props.int_modt;
+	ctx->cur_int_modc = ctx->props.int_modc;
 	gsi_init_evt_ring(&ctx->props, &ctx->ring);
 
 	/* restore scratch */
@@ -5755,6 +5760,42 @@ void gsi_update_almst_empty_thrshold(unsigned long chan_hdl, unsigned short thre
 }
 EXPORT_SYMBOL(gsi_update_almst_empty_thrshold);
 
+int gsi_update_evt_ring_int_mod(unsigned long evt_ring_hdl,
+	uint16_t int_modt, uint8_t int_modc)
+{
+	struct gsihal_reg_ev_ch_k_cntxt_8 ev_ch_k_cntxt_8;
+	struct gsi_evt_ctx *ctx;
+
+	if (!gsi_ctx) {
+		pr_err("%s:%d gsi context not allocated\n", __func__, __LINE__);
+		return -GSI_STATUS_NODEV;
+	}
+
+	if (evt_ring_hdl >= gsi_ctx->max_ev) {
+		GSIERR("bad params evt_ring_hdl=%lu\n", evt_ring_hdl);
+		return -GSI_STATUS_INVALID_PARAMS;
+	}
+
+	ctx = &gsi_ctx->evtr[evt_ring_hdl];
+
+	if (ctx->state != GSI_EVT_RING_STATE_ALLOCATED) {
+		GSIERR("bad state %d\n", ctx->state);
+		return -GSI_STATUS_UNSUPPORTED_OP;
+	}
+
+	ctx->cur_int_modt = int_modt;
+	ctx->cur_int_modc = int_modc;
+
+	ev_ch_k_cntxt_8.int_mod_cnt = 0;
+	ev_ch_k_cntxt_8.int_modt = int_modt;
+	ev_ch_k_cntxt_8.int_modc = int_modc;
+	gsihal_write_reg_nk_fields(GSI_EE_n_EV_CH_k_CNTXT_8,
+		gsi_ctx->per.ee, evt_ring_hdl, &ev_ch_k_cntxt_8);
+
+	return GSI_STATUS_SUCCESS;
+}
+EXPORT_SYMBOL(gsi_update_evt_ring_int_mod);
+
 static union __packed gsi_channel_scratch __gsi_update_mhi_channel_scratch(
 	unsigned long chan_hdl, struct __packed gsi_mhi_channel_scratch mscr)
 {
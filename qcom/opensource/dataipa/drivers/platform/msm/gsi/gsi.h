@@ -1471,6 +1471,9 @@ struct gsi_evt_ctx {
 	atomic_t chan_ref_cnt;
 	union __packed gsi_evt_scratch scratch;
 	struct gsi_evt_stats stats;
+	/* moderation in HW, props keeps the one the ring was allocated with */
+	uint16_t cur_int_modt;
+	uint8_t cur_int_modc;
 };
 
 struct gsi_ee_scratch {
@@ -2496,6 +2499,20 @@ int gsi_query_device_msi_addr(u64 *addr);
 */
 void gsi_update_almst_empty_thrshold(unsigned long chan_hdl, unsigned short threshold);
 
+/**
+* gsi_update_evt_ring_int_mod - update the interrupt moderation of an
+* allocated event ring without resetting it. A reset of the ring goes back
+* to the moderation in its allocation properties.
+*
+* @evt_ring_hdl: Client handle previously obtained from gsi_alloc_evt_ring
+* @int_modt: cycles base interrupt moderation (32KHz clock)
+* @int_modc: interrupt moderation packet counter
+*
+* @Return gsi_status
+*/
+int gsi_update_evt_ring_int_mod(unsigned long evt_ring_hdl,
+	uint16_t int_modt, uint8_t int_modc);
+
 /**
 * gsi_dump_ch_info - channel information.
 *
@@ -124,9 +124,12 @@ static ssize_t gsi_dump_evt(struct file *file,
 
 	gsi_ctx->per.unvote_clk_cb();
 
-	if (arg2) {
-		ctx = &gsi_ctx->evtr[arg1];
+	ctx = &gsi_ctx->evtr[arg1];
+	TERR("EV%2d MOD   %u/%u configured %u/%u\n", arg1,
+		ctx->cur_int_modt, ctx->cur_int_modc,
+		ctx->props.int_modt, ctx->props.int_modc);
 
+	if (arg2) {
 		if (ctx->props.ring_base_vaddr) {
 			for (i = 0; i < ctx->props.ring_len / 16; i++)
 				TERR("EV%2d (0x%08llx) %08x %08x %08x %08x\n",
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-2.0-only WITH Linux-syscall-note
+/*
+ * Copyright (c) 2022 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+/* This file should be removed once msm_ipa.h carries IPA_IOC_COMMIT_TABLES */
+#ifndef _IPA_TEST_MODULE_COMMIT_TABLES_H_
+#define _IPA_TEST_MODULE_COMMIT_TABLES_H_
+
+#include <linux/msm_ipa.h>
+
+#ifndef IPA_IOC_COMMIT_TABLES
+
+#define IPA_IOCTL_COMMIT_TABLES                 120
+
+/*
+ * Tables committed by IPA_IOC_COMMIT_TABLES, the ioctl argument is an OR of
+ * these bits. Mirrors the IPA3_COMMIT_* mask of ipa3_commit_tables().
+ */
+#define IPA_COMMIT_TABLES_HDR                   (1 << 0)
+#define IPA_COMMIT_TABLES_RT_V4                 (1 << 1)
+#define IPA_COMMIT_TABLES_RT_V6                 (1 << 2)
+#define IPA_COMMIT_TABLES_FLT_V4                (1 << 3)
+#define IPA_COMMIT_TABLES_FLT_V6                (1 << 4)
+
+#define IPA_IOC_COMMIT_TABLES _IO(IPA_IOC_MAGIC, IPA_IOCTL_COMMIT_TABLES)
+
+#endif /* IPA_IOC_COMMIT_TABLES */
+
+#endif /* _IPA_TEST_MODULE_COMMIT_TABLES_H_ */
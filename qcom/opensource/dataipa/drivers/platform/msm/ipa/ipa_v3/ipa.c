@@ -66,6 +66,7 @@
 #if defined(CONFIG_IPA_TSP)
 #include "ipa_tsp.h"
 #endif
+#include "ipa_test_module_commit_tables.h"
 #include "ipahal.h"
 #include "ipahal_fltrt.h"
 
@@ -3468,6 +3469,9 @@ static long ipa3_ioctl(struct file *filp, unsigned int cmd, unsigned long arg)
 	case IPA_IOC_RESET_FLT:
 		retval = ipa3_reset_flt(arg, false);
 		break;
+	case IPA_IOC_COMMIT_TABLES:
+		retval = ipa3_commit_tables((u32)arg);
+		break;
 	case IPA_IOC_GET_RT_TBL:
 		if (copy_from_user(header, (const void __user *)arg,
 			sizeof(struct ipa_ioc_get_rt_tbl))) {
@@ -5892,6 +5896,9 @@ int _ipa_init_rt4_v3(void)
 		ipa3_ctx->rt_idx_bitmap[IPA_IP_v4] |= (1 << i);
 	IPADBG("v4 rt bitmap 0x%lx\n", ipa3_ctx->rt_idx_bitmap[IPA_IP_v4]);
 
+	/* sram is reset to an empty image, next commit must rewrite it all */
+	ipa3_ctx->rt_tbl_full_commit[IPA_IP_v4] = true;
+
 	rc = ipahal_rt_generate_empty_img(IPA_MEM_PART(v4_rt_num_index),
 		IPA_MEM_PART(v4_rt_hash_size), IPA_MEM_PART(v4_rt_nhash_size),
 		&mem, false);
@@ -5966,6 +5973,9 @@ int _ipa_init_rt6_v3(void)
 		ipa3_ctx->rt_idx_bitmap[IPA_IP_v6] |= (1 << i);
 	IPADBG("v6 rt bitmap 0x%lx\n", ipa3_ctx->rt_idx_bitmap[IPA_IP_v6]);
 
+	/* sram is reset to an empty image, next commit must rewrite it all */
+	ipa3_ctx->rt_tbl_full_commit[IPA_IP_v6] = true;
+
 	rc = ipahal_rt_generate_empty_img(IPA_MEM_PART(v6_rt_num_index),
 		IPA_MEM_PART(v6_rt_hash_size), IPA_MEM_PART(v6_rt_nhash_size),
 		&mem, false);
@@ -6033,6 +6043,9 @@ int _ipa_init_flt4_v3(void)
 	struct ipahal_imm_cmd_pyld *cmd_pyld;
 	int rc;
 
+	/* sram is reset to an empty image, next commit must rewrite it all */
+	ipa3_ctx->flt_tbl_full_commit[IPA_IP_v4] = true;
+
 	rc = ipahal_flt_generate_empty_img(ipa3_ctx->ep_flt_num,
 		IPA_MEM_PART(v4_flt_hash_size),
 		IPA_MEM_PART(v4_flt_nhash_size), ipa3_ctx->ep_flt_bitmap,
@@ -6101,6 +6114,9 @@ int _ipa_init_flt6_v3(void)
 	struct ipahal_imm_cmd_pyld *cmd_pyld;
 	int rc;
 
+	/* sram is reset to an empty image, next commit must rewrite it all */
+	ipa3_ctx->flt_tbl_full_commit[IPA_IP_v6] = true;
+
 	rc = ipahal_flt_generate_empty_img(ipa3_ctx->ep_flt_num,
 		IPA_MEM_PART(v6_flt_hash_size),
 		IPA_MEM_PART(v6_flt_nhash_size), ipa3_ctx->ep_flt_bitmap,
@@ -6604,6 +6620,7 @@ long compat_ipa3_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 	case IPA_IOC_RESET_RT:
 	case IPA_IOC_COMMIT_FLT:
 	case IPA_IOC_RESET_FLT:
+	case IPA_IOC_COMMIT_TABLES:
 	case IPA_IOC_DUMP:
 	case IPA_IOC_PUT_RT_TBL:
 	case IPA_IOC_PUT_HDR:
@@ -9484,6 +9501,9 @@ static int ipa3_pre_init(const struct ipa3_plat_drv_res *resource_p,
 	/* Enable ipa3_ctx->enable_napi_chain */
 	ipa3_ctx->enable_napi_chain = 1;
 
+	/* Enable adaptive interrupt moderation of rx pipes */
+	ipa3_ctx->rx_dim_enable = 1;
+
 	/* Initialize Page poll threshold. */
 	ipa3_ctx->page_poll_threshold = IPA_PAGE_POLL_DEFAULT_THRESHOLD;
 
@@ -9648,14 +9668,6 @@ static int ipa3_pre_init(const struct ipa3_plat_drv_res *resource_p,
 		result = -ENOMEM;
 		goto fail_rt_tbl_cache;
 	}
-	ipa3_ctx->tx_pkt_wrapper_cache =
-	   kmem_cache_create("IPA_TX_PKT_WRAPPER",
-			   sizeof(struct ipa3_tx_pkt_wrapper), 0, 0, NULL);
-	if (!ipa3_ctx->tx_pkt_wrapper_cache) {
-		IPAERR(":ipa tx pkt wrapper cache create failed\n");
-		result = -ENOMEM;
-		goto fail_tx_pkt_wrapper_cache;
-	}
 	ipa3_ctx->rx_pkt_wrapper_cache =
 	   kmem_cache_create("IPA_RX_PKT_WRAPPER",
 			   sizeof(struct ipa3_rx_pkt_wrapper), 0, 0, NULL);
@@ -9673,6 +9685,7 @@ static int ipa3_pre_init(const struct ipa3_plat_drv_res *resource_p,
 			INIT_LIST_HEAD(&ipa3_ctx->hdr_tbl[hdr_tbl].head_free_offset_list[i]);
 		}
 	}
+	hash_init(ipa3_ctx->hdr_name_htable);
 	INIT_LIST_HEAD(&ipa3_ctx->hdr_proc_ctx_tbl.head_proc_ctx_entry_list);
 	for (i = 0; i < IPA_HDR_PROC_CTX_BIN_MAX; i++) {
 		INIT_LIST_HEAD(
@@ -9682,8 +9695,10 @@ static int ipa3_pre_init(const struct ipa3_plat_drv_res *resource_p,
 	}
 	INIT_LIST_HEAD(&ipa3_ctx->rt_tbl_set[IPA_IP_v4].head_rt_tbl_list);
 	idr_init(&ipa3_ctx->rt_tbl_set[IPA_IP_v4].rule_ids);
+	hash_init(ipa3_ctx->rt_tbl_set[IPA_IP_v4].name_htable);
 	INIT_LIST_HEAD(&ipa3_ctx->rt_tbl_set[IPA_IP_v6].head_rt_tbl_list);
 	idr_init(&ipa3_ctx->rt_tbl_set[IPA_IP_v6].rule_ids);
+	hash_init(ipa3_ctx->rt_tbl_set[IPA_IP_v6].name_htable);
 
 	rset = &ipa3_ctx->reap_rt_tbl_set[IPA_IP_v4];
 	INIT_LIST_HEAD(&rset->head_rt_tbl_list);
@@ -9904,8 +9919,6 @@ fail_alloc_chrdev_region:
 	idr_destroy(&ipa3_ctx->rt_tbl_set[IPA_IP_v4].rule_ids);
 	kmem_cache_destroy(ipa3_ctx->rx_pkt_wrapper_cache);
 fail_rx_pkt_wrapper_cache:
-	kmem_cache_destroy(ipa3_ctx->tx_pkt_wrapper_cache);
-fail_tx_pkt_wrapper_cache:
 	kmem_cache_destroy(ipa3_ctx->rt_tbl_cache);
 fail_rt_tbl_cache:
 	kmem_cache_destroy(ipa3_ctx->hdr_proc_ctx_offset_cache);
@@ -10135,7 +10148,6 @@ static int get_ipa_dts_pm_info(struct platform_device *pdev,
 
 	return 0;
 }
-
 static void get_dts_tx_wrapper_cache_size(struct platform_device *pdev,
 		struct ipa3_plat_drv_res *ipa_drv_res)
 {
@@ -11984,6 +11996,8 @@ static void ipa3_deepsleep_suspend(void)
 	/*Destroying ipa hal module*/
 	ipahal_destroy();
 	ipa3_ctx->ipa_initialization_complete = false;
+	/*Stats device and HW stats shared region are set up again in post init*/
+	ipa_tlpd_stats_deinit();
 	ipa3_debugfs_remove();
 	/*Unloading IPA FW to allow FW load in resume*/
 	ipa3_pil_unload_ipa_fws();
@@ -12470,6 +12484,7 @@ static void __exit ipa_module_exit(void)
 	if (running_emulation)
 		pci_unregister_driver(&ipa_pci_driver);
 	platform_driver_unregister(&ipa_plat_drv);
+	ipa_tlpd_stats_deinit();
 	if(ipa3_ctx->hw_stats) {
 		kfree(ipa3_ctx->hw_stats);
 		ipa3_ctx->hw_stats = NULL;
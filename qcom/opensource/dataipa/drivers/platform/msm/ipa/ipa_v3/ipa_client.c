@@ -273,6 +273,9 @@ int ipa3_reset_gsi_event_ring(u32 clnt_hdl)
 		result = -EFAULT;
 		goto reset_evt_fail;
 	}
+	/* the ring is back on its static moderation */
+	if (ep->sys)
+		ipa3_rx_dim_reset(ep->sys);
 
 	if (!ep->keep_ipa_awake)
 		IPA_ACTIVE_CLIENTS_DEC_EP(ipa3_get_client_mapping(clnt_hdl));
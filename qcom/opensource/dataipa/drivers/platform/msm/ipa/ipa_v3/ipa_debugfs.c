@@ -1561,7 +1561,9 @@ static ssize_t ipa3_read_stats(struct file *file, char __user *ubuf,
 		"num_buff_below_thresh_for_ll_pipe_notified=%u\n"
 		"num_free_page_task_scheduled=%u\n"
 		"pipe_setup_fail_cnt=%u\n"
-		"ttl_count=%u\n",
+		"ttl_count=%u\n"
+		"name_lookup_cnt=%u\n"
+		"name_lookup_cmp_cnt=%u\n",
 		ipa3_ctx->stats.tx_sw_pkts,
 		ipa3_ctx->stats.tx_hw_pkts,
 		ipa3_ctx->stats.tx_non_linear,
@@ -1592,7 +1594,9 @@ static ssize_t ipa3_read_stats(struct file *file, char __user *ubuf,
 		atomic_read(&ipa3_ctx->stats.num_buff_below_thresh_for_ll_pipe_notified),
 		atomic_read(&ipa3_ctx->stats.num_free_page_task_scheduled),
 		ipa3_ctx->stats.pipe_setup_fail_cnt,
-		ipa3_ctx->stats.ttl_cnt
+		ipa3_ctx->stats.ttl_cnt,
+		ipa3_ctx->stats.name_lookup_cnt,
+		ipa3_ctx->stats.name_lookup_cmp_cnt
 		);
 	cnt += nbytes;
 
@@ -1605,6 +1609,35 @@ static ssize_t ipa3_read_stats(struct file *file, char __user *ubuf,
 		cnt += nbytes;
 	}
 
+	for (i = 0; i < ipa3_ctx->ipa_num_pipes; i++) {
+		if (!ipa3_ctx->ep[i].valid || !ipa3_ctx->ep[i].sys ||
+			!ipa3_ctx->ep[i].sys->dim.enabled)
+			continue;
+		nbytes = scnprintf(dbg_buff + cnt,
+			IPA_MAX_MSG_LEN - cnt,
+			"rx_dim[%u:%s] profile=%u ppi=%u gap_us=%u up=%llu down=%llu\n",
+			i, ipa_clients_strings[ipa3_ctx->ep[i].client],
+			ipa3_ctx->stats.rx_dim[i].profile,
+			ipa3_ctx->stats.rx_dim[i].ppi,
+			ipa3_ctx->stats.rx_dim[i].gap_us,
+			ipa3_ctx->stats.rx_dim[i].step_up,
+			ipa3_ctx->stats.rx_dim[i].step_down);
+		cnt += nbytes;
+	}
+
+	for (i = 0; i < ipa3_ctx->ipa_num_pipes; i++) {
+		if (!ipa3_ctx->stats.tx_db[i].pkts)
+			continue;
+		nbytes = scnprintf(dbg_buff + cnt,
+			IPA_MAX_MSG_LEN - cnt,
+			"tx_db[%u:%s] pkts=%llu doorbells=%llu timer_flush=%llu\n",
+			i, ipa_clients_strings[ipa3_ctx->ep[i].client],
+			ipa3_ctx->stats.tx_db[i].pkts,
+			ipa3_ctx->stats.tx_db[i].doorbells,
+			ipa3_ctx->stats.tx_db[i].timer_flush);
+		cnt += nbytes;
+	}
+
 	return simple_read_from_buffer(ubuf, count, ppos, dbg_buff, cnt);
 }
 
@@ -1646,28 +1679,38 @@ static ssize_t ipa3_read_page_recycle_stats(struct file *file,
 		"COAL   : Total number of packets replenished =%llu\n"
 		"COAL   : Number of page recycled packets  =%llu\n"
 		"COAL   : Number of tmp alloc packets  =%llu\n"
+		"COAL   : Number of page pool hits  =%llu\n"
+		"COAL   : Number of page pool misses  =%llu\n"
 		"COAL   : Number of times tasklet scheduled  =%llu\n"
 
 		"DEF    : Total number of packets replenished =%llu\n"
 		"DEF    : Number of page recycled packets =%llu\n"
 		"DEF    : Number of tmp alloc packets  =%llu\n"
+		"DEF    : Number of page pool hits  =%llu\n"
+		"DEF    : Number of page pool misses  =%llu\n"
 		"DEF    : Number of times tasklet scheduled  =%llu\n"
 
 		"COMMON : Number of page recycled in tasklet  =%llu\n"
-		"COMMON : Number of times free pages not found in tasklet =%llu\n",
+		"COMMON : Number of times free pages not found in tasklet =%llu\n"
+		"COMMON : Number of pool pages released by shrinker =%llu\n",
 
 		ipa3_ctx->stats.page_recycle_stats[0].total_replenished,
 		ipa3_ctx->stats.page_recycle_stats[0].page_recycled,
 		ipa3_ctx->stats.page_recycle_stats[0].tmp_alloc,
+		ipa3_ctx->stats.page_recycle_stats[0].pool_hit,
+		ipa3_ctx->stats.page_recycle_stats[0].pool_miss,
 		ipa3_ctx->stats.num_sort_tasklet_sched[0],
 
 		ipa3_ctx->stats.page_recycle_stats[1].total_replenished,
 		ipa3_ctx->stats.page_recycle_stats[1].page_recycled,
 		ipa3_ctx->stats.page_recycle_stats[1].tmp_alloc,
+		ipa3_ctx->stats.page_recycle_stats[1].pool_hit,
+		ipa3_ctx->stats.page_recycle_stats[1].pool_miss,
 		ipa3_ctx->stats.num_sort_tasklet_sched[1],
 
 		ipa3_ctx->stats.page_recycle_cnt_in_tasklet,
-		ipa3_ctx->stats.num_of_times_wq_reschd);
+		ipa3_ctx->stats.num_of_times_wq_reschd,
+		ipa3_ctx->stats.page_pool_shrunk);
 
 	cnt += nbytes;
 
@@ -2728,6 +2771,22 @@ ret:
 	return simple_read_from_buffer(ubuf, count, ppos, dbg_buff, cnt);
 }
 
+static ssize_t ipa3_pm_scaling_log_read(struct file *file,
+		char __user *ubuf, size_t count, loff_t *ppos)
+{
+	int result, cnt = 0;
+
+	result = ipa_pm_scaling_log_stat(dbg_buff, IPA_MAX_MSG_LEN);
+	if (result < 0) {
+		cnt += scnprintf(dbg_buff + cnt, IPA_MAX_MSG_LEN - cnt,
+				"Error in printing PM scaling log %d\n", result);
+		goto ret;
+	}
+	cnt += result;
+ret:
+	return simple_read_from_buffer(ubuf, count, ppos, dbg_buff, cnt);
+}
+
 static ssize_t ipa3_read_ipahal_regs(struct file *file, char __user *ubuf,
 		size_t count, loff_t *ppos)
 {
@@ -3852,6 +3911,10 @@ static const struct ipa3_debugfs_file debugfs_files[] = {
 		"pm_ex_stats", IPA_READ_ONLY_MODE, NULL, {
 			.read = ipa3_pm_ex_read_stats,
 		}
+	}, {
+		"pm_scaling_log", IPA_READ_ONLY_MODE, NULL, {
+			.read = ipa3_pm_scaling_log_read,
+		}
 	}, {
 		"status_stats", IPA_READ_ONLY_MODE, NULL, {
 			.read = ipa_status_stats_read,
@@ -3965,6 +4028,9 @@ void ipa3_debugfs_init(void)
 	debugfs_create_u32("enable_napi_chain", IPA_READ_WRITE_MODE,
 		dent, &ipa3_ctx->enable_napi_chain);
 
+	debugfs_create_u32("rx_dim_enable", IPA_READ_WRITE_MODE,
+		dent, &ipa3_ctx->rx_dim_enable);
+
 	debugfs_create_u32("clock_scaling_bw_threshold_nominal_mbps",
 		IPA_READ_WRITE_MODE, dent,
 		&ipa3_ctx->ctrl->clock_scaling_bw_threshold_nominal);
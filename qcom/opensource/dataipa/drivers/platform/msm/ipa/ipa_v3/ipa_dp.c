@@ -82,6 +82,14 @@
 #define IPA_GSI_EVT_RING_INT_MODT (16) /* 0.5ms under 32KHz clock */
 #define IPA_GSI_EVT_RING_INT_MODC (20)
 
+/* interrupts sampled before the rx moderation profile is reconsidered */
+#define IPA_RX_DIM_WINDOW_EVENTS 16
+/* completions per interrupt below/above which moderation steps down/up */
+#define IPA_RX_DIM_PPI_LOW 8
+#define IPA_RX_DIM_PPI_HIGH 64
+/* mean interrupt gap of sparse traffic, moderation only adds latency */
+#define IPA_RX_DIM_IDLE_GAP_US 2000
+
 #define IPA_GSI_CH_20_WA_NUM_CH_TO_ALLOC 10
 /* The below virtual channel cannot be used by any entity */
 #define IPA_GSI_CH_20_WA_VIRT_CHAN 29
@@ -94,6 +102,10 @@
 
 #define IPA_TX_SEND_COMPL_NOP_DELAY_NS (2 * 1000 * 1000)
 
+/* xmit_more bursts ring the doorbell at least every N descriptors / delay */
+#define IPA_TX_DB_BATCH_MAX_DESC 32
+#define IPA_TX_DB_FLUSH_DELAY_NS (100 * 1000)
+
 #define IPA_APPS_BW_FOR_PM 700
 
 #define IPA_SEND_MAX_DESC (20)
@@ -106,6 +118,9 @@
 
 #define IPA_MEM_ALLOC_RETRY 5
 
+/* pages kept per CPU by the rx page pool, idle or held by the stack */
+#define IPA_PAGE_POOL_CPU_CAPACITY 32
+
 static int ipa3_tx_switch_to_intr_mode(struct ipa3_sys_context *sys);
 static int ipa3_rx_switch_to_intr_mode(struct ipa3_sys_context *sys);
 static struct sk_buff *ipa3_get_skb_ipa_rx(unsigned int len, gfp_t flags);
@@ -117,6 +132,8 @@ static void ipa3_fast_replenish_rx_cache(struct ipa3_sys_context *sys);
 static void ipa3_replenish_rx_page_cache(struct ipa3_sys_context *sys);
 static void ipa3_wq_page_repl(struct work_struct *work);
 static void ipa3_replenish_rx_page_recycle(struct ipa3_sys_context *sys);
+static struct ipa3_page_pool *ipa3_page_pool_create(u32 page_order);
+static void ipa3_page_pool_destroy(struct ipa3_page_pool *pool);
 static struct ipa3_rx_pkt_wrapper *ipa3_alloc_rx_pkt_page(gfp_t flag,
 	bool is_tmp_alloc, struct ipa3_sys_context *sys);
 static void ipa3_wq_handle_rx(struct work_struct *work);
@@ -310,18 +327,47 @@ static void ipa3_collect_low_lat_data_recycle_stats_wq(struct work_struct *work)
 	return;
 }
 
+/**
+ * ipa3_tx_ring_peek() - get the oldest in flight tx_pkt_wrapper of a pipe
+ * @sys: tx pipe context
+ *
+ * Called from the completion side only. Returns NULL if nothing is in
+ * flight. The acquire on head makes the slot contents visible, but other
+ * completion contexts may advance tail concurrently, so without
+ * compl_lock held the result is only a hint that ipa3_write_done_common()
+ * checks again under the lock.
+ */
+static struct ipa3_tx_pkt_wrapper *ipa3_tx_ring_peek(
+	struct ipa3_sys_context *sys)
+{
+	struct ipa3_tx_ring *ring = &sys->tx_ring;
+	u32 tail = READ_ONCE(ring->tail);
+
+	/* pairs with the release in __ipa3_send() / ipa3_send_nop_desc() */
+	if (tail == smp_load_acquire(&ring->head))
+		return NULL;
+
+	return &ring->pkt[tail & ring->mask];
+}
+
 /**
  * ipa3_write_done_common() - this function is responsible on freeing
  * all tx_pkt_wrappers related to a skb
  * @tx_pkt: the first tx_pkt_warpper related to a certain skb
  * @sys:points to the ipa3_sys_context the EOT was received on
  * returns the number of tx_pkt_wrappers that were freed
+ *
+ * Completions arrive in the order the TREs were queued so @tx_pkt is
+ * normally the slot at the tail of the pipe tx ring. If a completion was
+ * missed, the older slots were completed by the HW before @tx_pkt and are
+ * freed together with it, so the ring can't stall behind them.
  */
 static int ipa3_write_done_common(struct ipa3_sys_context *sys,
 				struct ipa3_tx_pkt_wrapper *tx_pkt)
 {
-	struct ipa3_tx_pkt_wrapper *next_pkt;
+	struct ipa3_tx_ring *ring = &sys->tx_ring;
 	int i, cnt;
+	u32 tail, pos;
 	void *user1;
 	int user2;
 	void (*callback)(void *user1, int user2);
@@ -331,17 +377,34 @@ static int ipa3_write_done_common(struct ipa3_sys_context *sys,
 		return 0;
 	}
 
-	cnt = tx_pkt->cnt;
+	/* tail only stands still under compl_lock, which is kept until the
+	 * first slot is consumed
+	 */
+	spin_lock_bh(&ring->compl_lock);
+	tail = ring->tail;
+	pos = (u32)(tx_pkt - ring->pkt) - tail;
+	if (unlikely(tx_pkt < ring->pkt || tx_pkt > &ring->pkt[ring->mask] ||
+		(pos & ring->mask) >= smp_load_acquire(&ring->head) - tail)) {
+		/* already freed, e.g. with a later completion */
+		spin_unlock_bh(&ring->compl_lock);
+		IPAERR_RL("tx_pkt %pK is not in flight\n", tx_pkt);
+		return 0;
+	}
+
+	pos &= ring->mask;
+	WARN_ONCE(pos, "ch:%lu %u tx completions missed\n",
+		sys->ep->gsi_chan_hdl, pos);
+	cnt = pos + tx_pkt->cnt;
 	for (i = 0; i < cnt; i++) {
-		spin_lock_bh(&sys->spinlock);
-		if (unlikely(list_empty(&sys->head_desc_list))) {
-			spin_unlock_bh(&sys->spinlock);
-			IPAERR_RL("list is empty missing descriptors");
+		if (i)
+			spin_lock_bh(&ring->compl_lock);
+		tail = ring->tail;
+		if (unlikely(tail == smp_load_acquire(&ring->head))) {
+			spin_unlock_bh(&ring->compl_lock);
+			IPAERR_RL("ring is empty missing descriptors");
 			return i;
 		}
-		next_pkt = list_next_entry(tx_pkt, link);
-		list_del(&tx_pkt->link);
-		sys->len--;
+		tx_pkt = &ring->pkt[tail & ring->mask];
 		if (!tx_pkt->no_unmap_dma) {
 			if (tx_pkt->type != IPA_DATA_DESC_SKB_PAGED) {
 				dma_unmap_single(ipa3_ctx->pdev,
@@ -358,20 +421,11 @@ static int ipa3_write_done_common(struct ipa3_sys_context *sys,
 		callback = tx_pkt->callback;
 		user1 = tx_pkt->user1;
 		user2 = tx_pkt->user2;
-		if (sys->avail_tx_wrapper >=
-			ipa3_ctx->tx_wrapper_cache_max_size ||
-			sys->ep->client == IPA_CLIENT_APPS_CMD_PROD) {
-			kmem_cache_free(ipa3_ctx->tx_pkt_wrapper_cache,
-				tx_pkt);
-		} else {
-			list_add_tail(&tx_pkt->link,
-				&sys->avail_tx_wrapper_list);
-			sys->avail_tx_wrapper++;
-		}
-		spin_unlock_bh(&sys->spinlock);
+		/* hand the slot back to the submit side */
+		smp_store_release(&ring->tail, tail + 1);
+		spin_unlock_bh(&ring->compl_lock);
 		if (callback)
 			(*callback)(user1, user2);
-		tx_pkt = next_pkt;
 	}
 	return i;
 }
@@ -422,15 +476,10 @@ static void ipa3_tasklet_write_done(unsigned long data)
 	unsigned int max_tx_pkt = 0;
 
 	sys = (struct ipa3_sys_context *)data;
-	spin_lock_bh(&sys->spinlock);
 	while (atomic_add_unless(&sys->xmit_eot_cnt, -1, 0)) {
-		while (!list_empty(&sys->head_desc_list)) {
-			this_pkt = list_first_entry(&sys->head_desc_list,
-				struct ipa3_tx_pkt_wrapper, link);
+		while ((this_pkt = ipa3_tx_ring_peek(sys))) {
 			xmit_done = this_pkt->xmit_done;
-			spin_unlock_bh(&sys->spinlock);
 			ipa3_write_done_common(sys, this_pkt);
-			spin_lock_bh(&sys->spinlock);
 			max_tx_pkt++;
 			if (xmit_done)
 				break;
@@ -443,7 +492,6 @@ static void ipa3_tasklet_write_done(unsigned long data)
 		 if (max_tx_pkt >= IPA_TX_MAX_DESC)
 			 break;
 	}
-	spin_unlock_bh(&sys->spinlock);
 
 	if (max_tx_pkt >= IPA_TX_MAX_DESC)
 		queue_work(sys->tasklet_wq, &sys->tasklet_work);
@@ -510,22 +558,17 @@ static int ipa3_napi_tx_complete(struct ipa3_sys_context *sys, int budget)
 	bool xmit_done = false;
 	int entry_budget = budget;
 
-	spin_lock_bh(&sys->spinlock);
 	while (budget > 0 && atomic_read(&sys->xmit_eot_cnt) > 0) {
-		if (unlikely(list_empty(&sys->head_desc_list))) {
-			IPADBG_LOW("list is empty");
+		this_pkt = ipa3_tx_ring_peek(sys);
+		if (unlikely(!this_pkt)) {
+			IPADBG_LOW("ring is empty");
 			break;
 		}
-		this_pkt = list_first_entry(&sys->head_desc_list,
-			struct ipa3_tx_pkt_wrapper, link);
 		xmit_done = this_pkt->xmit_done;
-		spin_unlock_bh(&sys->spinlock);
 		budget -= ipa3_write_done_common(sys, this_pkt);
-		spin_lock_bh(&sys->spinlock);
 		if (xmit_done)
 			atomic_add_unless(&sys->xmit_eot_cnt, -1, 0);
 	}
-	spin_unlock_bh(&sys->spinlock);
 	return entry_budget - budget;
 }
 
@@ -556,6 +599,7 @@ static void ipa3_send_nop_desc(struct work_struct *work)
 {
 	struct ipa3_sys_context *sys = container_of(work,
 		struct ipa3_sys_context, work);
+	struct ipa3_tx_ring *ring = &sys->tx_ring;
 	struct gsi_xfer_elem nop_xfer;
 	struct ipa3_tx_pkt_wrapper *tx_pkt;
 
@@ -564,50 +608,38 @@ static void ipa3_send_nop_desc(struct work_struct *work)
 		return;
 
 	spin_lock_bh(&sys->spinlock);
-	if (!list_empty(&sys->avail_tx_wrapper_list)) {
-		tx_pkt = list_first_entry(&sys->avail_tx_wrapper_list,
-				struct ipa3_tx_pkt_wrapper, link);
-		list_del(&tx_pkt->link);
-		sys->avail_tx_wrapper--;
-		memset(tx_pkt, 0, sizeof(struct ipa3_tx_pkt_wrapper));
-	} else {
+	if (unlikely(!sys->nop_pending)) {
 		spin_unlock_bh(&sys->spinlock);
-		tx_pkt = kmem_cache_zalloc(ipa3_ctx->tx_pkt_wrapper_cache,
-			GFP_KERNEL);
-		spin_lock_bh(&sys->spinlock);
+		return;
 	}
-	if (!tx_pkt) {
+	if (unlikely(ring->head - smp_load_acquire(&ring->tail) > ring->mask)) {
 		spin_unlock_bh(&sys->spinlock);
 		queue_work(sys->wq, &sys->work);
 		return;
 	}
 
-	INIT_LIST_HEAD(&tx_pkt->link);
+	tx_pkt = &ring->pkt[ring->head & ring->mask];
+	memset(tx_pkt, 0, sizeof(struct ipa3_tx_pkt_wrapper));
 	tx_pkt->cnt = 1;
 	tx_pkt->no_unmap_dma = true;
 	tx_pkt->sys = sys;
-	if (unlikely(!sys->nop_pending)) {
-		spin_unlock_bh(&sys->spinlock);
-		kmem_cache_free(ipa3_ctx->tx_pkt_wrapper_cache, tx_pkt);
-		return;
-	}
-	list_add_tail(&tx_pkt->link, &sys->head_desc_list);
 
 	memset(&nop_xfer, 0, sizeof(nop_xfer));
 	nop_xfer.type = GSI_XFER_ELEM_NOP;
 	nop_xfer.flags = GSI_XFER_FLAG_EOT;
 	nop_xfer.xfer_user_data = tx_pkt;
+	/* publish the slot before the doorbell can complete it */
+	smp_store_release(&ring->head, ring->head + 1);
 	if (gsi_queue_xfer(sys->ep->gsi_chan_hdl, 1, &nop_xfer, true)) {
-		list_del(&tx_pkt->link);
-		kmem_cache_free(ipa3_ctx->tx_pkt_wrapper_cache, tx_pkt);
+		WRITE_ONCE(ring->head, ring->head - 1);
 		spin_unlock_bh(&sys->spinlock);
 		IPAERR("gsi_queue_xfer for ch:%lu failed\n",
 			sys->ep->gsi_chan_hdl);
 		queue_work(sys->wq, &sys->work);
 		return;
 	}
-	sys->len++;
 	sys->nop_pending = false;
+	sys->db_pending = 0;
 	spin_unlock_bh(&sys->spinlock);
 
 	/* make sure TAG process is sent before clocks are gated */
@@ -616,37 +648,41 @@ static void ipa3_send_nop_desc(struct work_struct *work)
 
 
 /**
- * ipa3_send() - Send multiple descriptors in one HW transaction
+ * __ipa3_send() - Send multiple descriptors in one HW transaction
  * @sys: system pipe context
  * @num_desc: number of packets
  * @desc: packets to send (may be immediate command or data)
  * @in_atomic:  whether caller is in atomic context
+ * @xmit_more: more packets follow, the doorbell may be deferred
  *
  * This function is used for GPI connection.
  * - ipa3_tx_pkt_wrapper will be used for each ipa
- *   descriptor (allocated from wrappers cache)
+ *   descriptor (taken from the pipe tx ring)
  * - The wrapper struct will be configured for each ipa-desc payload and will
  *   contain information which will be later used by the user callbacks
- * - Each packet (command or data) that will be sent will also be saved in
- *   ipa3_sys_context for later check that all data was sent
+ * - The wrappers are published to the completion side before their TREs
+ *   are queued, and the doorbell is rung by the same gsi_queue_xfer() call
  *
  * Return codes: 0: success, -EFAULT: failure
  */
-int ipa3_send(struct ipa3_sys_context *sys,
+static int __ipa3_send(struct ipa3_sys_context *sys,
 		u32 num_desc,
 		struct ipa3_desc *desc,
-		bool in_atomic)
+		bool in_atomic,
+		bool xmit_more)
 {
+	struct ipa3_tx_ring *ring = &sys->tx_ring;
 	struct ipa3_tx_pkt_wrapper *tx_pkt, *tx_pkt_first = NULL;
 	struct ipahal_imm_cmd_pyld *tag_pyld_ret = NULL;
-	struct ipa3_tx_pkt_wrapper *next_pkt;
 	struct gsi_xfer_elem gsi_xfer[IPA_SEND_MAX_DESC];
 	int i = 0;
 	int j;
 	int result;
 	u32 mem_flag = GFP_ATOMIC;
 	const struct ipa_gsi_ep_config *gsi_ep_cfg;
+	struct ipa3_tx_db_stats *db_stats;
 	bool send_nop = false;
+	bool ring_db;
 	unsigned int max_desc;
 
 	if (unlikely(!in_atomic))
@@ -688,25 +724,17 @@ int ipa3_send(struct ipa3_sys_context *sys,
 		return -EFAULT;
 	}
 
-	for (i = 0; i < num_desc; i++) {
-		if (!list_empty(&sys->avail_tx_wrapper_list)) {
-			tx_pkt = list_first_entry(&sys->avail_tx_wrapper_list,
-				struct ipa3_tx_pkt_wrapper, link);
-			list_del(&tx_pkt->link);
-			sys->avail_tx_wrapper--;
+	/* pairs with the release in ipa3_write_done_common() */
+	if (unlikely(ring->head - smp_load_acquire(&ring->tail) + num_desc >
+		ring->mask + 1)) {
+		IPAERR_RL("no free tx wrapper\n");
+		spin_unlock_bh(&sys->spinlock);
+		return -ENOMEM;
+	}
 
-			memset(tx_pkt, 0, sizeof(struct ipa3_tx_pkt_wrapper));
-		} else {
-			tx_pkt = kmem_cache_zalloc(
-				ipa3_ctx->tx_pkt_wrapper_cache,
-				GFP_ATOMIC);
-		}
-		if (!tx_pkt) {
-			IPAERR("failed to alloc tx wrapper\n");
-			result = -ENOMEM;
-			goto failure;
-		}
-		INIT_LIST_HEAD(&tx_pkt->link);
+	for (i = 0; i < num_desc; i++) {
+		tx_pkt = &ring->pkt[(ring->head + i) & ring->mask];
+		memset(tx_pkt, 0, sizeof(struct ipa3_tx_pkt_wrapper));
 
 		if (i == 0) {
 			tx_pkt_first = tx_pkt;
@@ -719,7 +747,7 @@ int ipa3_send(struct ipa3_sys_context *sys,
 				&tag_pyld_ret)) {
 				IPAERR("Failed to populate tag field\n");
 				result = -EFAULT;
-				goto failure_dma_map;
+				goto failure;
 			}
 		}
 
@@ -759,7 +787,7 @@ int ipa3_send(struct ipa3_sys_context *sys,
 		if (dma_mapping_error(ipa3_ctx->pdev, tx_pkt->mem.phys_base)) {
 			IPAERR("failed to do dma map.\n");
 			result = -EFAULT;
-			goto failure_dma_map;
+			goto failure;
 		}
 
 		tx_pkt->sys = sys;
@@ -768,8 +796,6 @@ int ipa3_send(struct ipa3_sys_context *sys,
 		tx_pkt->user2 = desc[i].user2;
 		tx_pkt->xmit_done = false;
 
-		list_add_tail(&tx_pkt->link, &sys->head_desc_list);
-		sys->len++;
 		gsi_xfer[i].addr = tx_pkt->mem.phys_base;
 
 		/*
@@ -807,15 +833,36 @@ int ipa3_send(struct ipa3_sys_context *sys,
 		}
 	}
 
+	ring_db = !xmit_more ||
+		sys->db_pending + num_desc >= IPA_TX_DB_BATCH_MAX_DESC;
+	/* publish the wrappers before the doorbell can complete them */
+	smp_store_release(&ring->head, ring->head + num_desc);
 	IPADBG_LOW("ch:%lu queue xfer\n", sys->ep->gsi_chan_hdl);
 	result = gsi_queue_xfer(sys->ep->gsi_chan_hdl, num_desc,
-			gsi_xfer, true);
+			gsi_xfer, ring_db);
 	if (result != GSI_STATUS_SUCCESS) {
 		IPAERR_RL("GSI xfer failed.\n");
+		/* nothing was queued, so nothing can complete these slots */
+		WRITE_ONCE(ring->head, ring->head - num_desc);
 		result = -EFAULT;
 		goto failure;
 	}
 
+	db_stats = &ipa3_ctx->stats.tx_db[
+		ipa3_get_ep_mapping(sys->ep->client)];
+	db_stats->pkts++;
+	if (ring_db) {
+		db_stats->doorbells++;
+		sys->db_pending = 0;
+		hrtimer_try_to_cancel(&sys->db_flush_timer);
+	} else {
+		if (!sys->db_pending)
+			hrtimer_start(&sys->db_flush_timer,
+				ktime_set(0, IPA_TX_DB_FLUSH_DELAY_NS),
+				HRTIMER_MODE_REL_SOFT);
+		sys->db_pending += num_desc;
+	}
+
 	if (send_nop && !sys->nop_pending)
 		sys->nop_pending = true;
 	else
@@ -838,16 +885,11 @@ int ipa3_send(struct ipa3_sys_context *sys,
 
 	return 0;
 
-failure_dma_map:
-	kmem_cache_free(ipa3_ctx->tx_pkt_wrapper_cache, tx_pkt);
-
 failure:
 	ipahal_destroy_imm_cmd(tag_pyld_ret);
-	tx_pkt = tx_pkt_first;
+	/* the slots are not published, head is where it was */
 	for (j = 0; j < i; j++) {
-		next_pkt = list_next_entry(tx_pkt, link);
-		list_del(&tx_pkt->link);
-		sys->len--;
+		tx_pkt = &ring->pkt[(ring->head + j) & ring->mask];
 
 		if (!tx_pkt->no_unmap_dma) {
 			if (desc[j].type != IPA_DATA_DESC_SKB_PAGED) {
@@ -861,14 +903,30 @@ failure:
 					DMA_TO_DEVICE);
 			}
 		}
-		kmem_cache_free(ipa3_ctx->tx_pkt_wrapper_cache, tx_pkt);
-		tx_pkt = next_pkt;
 	}
 
 	spin_unlock_bh(&sys->spinlock);
 	return result;
 }
 
+/**
+ * ipa3_send() - Send multiple descriptors in one HW transaction and ring the
+ * doorbell
+ * @sys: system pipe context
+ * @num_desc: number of packets
+ * @desc: packets to send (may be immediate command or data)
+ * @in_atomic:  whether caller is in atomic context
+ *
+ * Return codes: 0: success, -EFAULT: failure
+ */
+int ipa3_send(struct ipa3_sys_context *sys,
+		u32 num_desc,
+		struct ipa3_desc *desc,
+		bool in_atomic)
+{
+	return __ipa3_send(sys, num_desc, desc, in_atomic, false);
+}
+
 /**
  * ipa3_send_one() - Send a single descriptor
  * @sys:	system pipe context
@@ -1082,6 +1140,349 @@ bail:
 	return result;
 }
 
+/**
+ * struct ipa3_cmd_batch_mem - DMA buffer freed at the end of a batch
+ * @link: entry's link in the batch free list
+ * @mem: the buffer
+ * @hal: buffer was allocated by ipahal rather than on ipa3_ctx->pdev
+ */
+struct ipa3_cmd_batch_mem {
+	struct list_head link;
+	struct ipa_mem_buffer mem;
+	bool hal;
+};
+
+static void ipa3_cmd_batch_release_mem(struct ipa3_cmd_batch *batch,
+	bool free_mem)
+{
+	struct ipa3_cmd_batch_mem *entry, *next;
+
+	list_for_each_entry_safe(entry, next, &batch->free_list, link) {
+		if (!free_mem)
+			IPAERR("leaking %u bytes of DMA memory\n",
+				entry->mem.size);
+		else if (entry->hal)
+			ipahal_free_dma_mem(&entry->mem);
+		else
+			dma_free_coherent(ipa3_ctx->pdev, entry->mem.size,
+				entry->mem.base, entry->mem.phys_base);
+		list_del(&entry->link);
+		kfree(entry);
+	}
+}
+
+static void ipa3_cmd_batch_ack(void *user1, int user2)
+{
+	struct ipa3_tag_completion *comp = user1;
+
+	if (atomic_dec_and_test(&comp->cnt))
+		complete(&comp->comp);
+}
+
+/**
+ * ipa3_cmd_batch_send() - send the queued command chains of a batch
+ * @batch: the batch
+ *
+ * Each chain is posted on its own, within the IPA_SEND_MAX_DESC and TLV
+ * limits, but all of them are posted before waiting, so the whole batch
+ * costs one completion wait. If a chain fails to post, the chains after it
+ * are not posted and the chains before it are still waited for.
+ *
+ * The callback of the last descriptor of each chain is overwritten, the
+ * payloads are not freed.
+ *
+ * Return: 0 on success, negative on failure
+ */
+int ipa3_cmd_batch_send(struct ipa3_cmd_batch *batch)
+{
+	struct ipa3_tag_completion comp;
+	struct ipa3_sys_context *sys;
+	struct ipa3_desc *desc = batch->desc;
+	int ep_idx, i, result = 0;
+
+	ep_idx = ipa3_get_ep_mapping(IPA_CLIENT_APPS_CMD_PROD);
+	if (-1 == ep_idx) {
+		IPAERR("Client %u is not mapped\n",
+			IPA_CLIENT_APPS_CMD_PROD);
+		return -EFAULT;
+	}
+
+	sys = ipa3_ctx->ep[ep_idx].sys;
+	init_completion(&comp.comp);
+	/* released by each posted chain and by the wait below */
+	atomic_set(&comp.cnt, 1);
+	IPA_ACTIVE_CLIENTS_INC_SIMPLE();
+
+	for (i = 0; i < batch->num_chain; i++) {
+		desc[batch->chain_len[i] - 1].callback = ipa3_cmd_batch_ack;
+		desc[batch->chain_len[i] - 1].user1 = &comp;
+		atomic_inc(&comp.cnt);
+		if (ipa3_send(sys, batch->chain_len[i], desc, true)) {
+			IPAERR("fail to send chain %d of %u\n", i,
+				batch->num_chain);
+			atomic_dec(&comp.cnt);
+			result = -EFAULT;
+			break;
+		}
+		desc += batch->chain_len[i];
+	}
+
+	if (!atomic_dec_and_test(&comp.cnt))
+		wait_for_completion(&comp.comp);
+	batch->send_cnt++;
+
+	IPA_ACTIVE_CLIENTS_DEC_SIMPLE();
+	return result;
+}
+
+/**
+ * ipa3_cmd_batch_flush() - send the queued commands of a batch
+ * @batch: the batch
+ *
+ * Once the commands were processed, the buffers queued for release are
+ * freed as nothing refers to them anymore.
+ *
+ * Return: 0 on success, negative on failure
+ */
+static int ipa3_cmd_batch_flush(struct ipa3_cmd_batch *batch)
+{
+	int i, result;
+
+	if (batch->failed)
+		return -EFAULT;
+
+	if (batch->num_desc) {
+		result = ipa3_cmd_batch_send(batch);
+		for (i = 0; i < batch->num_desc; i++)
+			kfree(batch->desc[i].pyld);
+		memset(batch->desc, 0, sizeof(batch->desc));
+		batch->num_desc = 0;
+		batch->num_chain = 0;
+		if (result) {
+			IPAERR("fail to send batched immediate commands\n");
+			batch->failed = true;
+			return result;
+		}
+	}
+
+	ipa3_cmd_batch_release_mem(batch, true);
+	return 0;
+}
+
+/**
+ * ipa3_batch_send_cmd() - send the immediate commands of a table commit
+ * @num_desc:	number of descriptors within the desc struct
+ * @descr:	descriptor structure
+ *
+ * Same as ipa3_send_cmd(), unless a ipa3_commit_tables() transaction is
+ * open. The commands are then queued and sent later on, chained to the
+ * commands of the other tables. The payloads are copied, so the caller may
+ * release its own right away as it does after ipa3_send_cmd().
+ *
+ * Caller needs to hold ipa3_ctx->lock
+ *
+ * Return: 0 on success, negative on failure
+ */
+int ipa3_batch_send_cmd(u16 num_desc, struct ipa3_desc *descr)
+{
+	struct ipa3_cmd_batch *batch = ipa3_ctx->cmd_batch;
+	struct ipa3_desc *desc;
+	int i, n;
+
+	if (!batch)
+		return ipa3_send_cmd(num_desc, descr);
+
+	if (batch->failed)
+		return -EFAULT;
+
+	/* callers chain at most IPA3_CMD_BATCH_CHAIN_LEN commands */
+	if (num_desc > IPA3_CMD_BATCH_CHAIN_LEN) {
+		if (ipa3_cmd_batch_flush(batch))
+			return -EFAULT;
+		return ipa3_send_cmd(num_desc, descr);
+	}
+
+	if (batch->num_desc + num_desc > IPA3_CMD_BATCH_MAX_DESC &&
+		ipa3_cmd_batch_flush(batch))
+		return -EFAULT;
+
+	for (i = 0; i < num_desc; i++) {
+		desc = &batch->desc[batch->num_desc + i];
+		desc->type = descr[i].type;
+		desc->opcode = descr[i].opcode;
+		desc->len = descr[i].len;
+		desc->pyld = kmemdup(descr[i].pyld, descr[i].len, GFP_KERNEL);
+		if (!desc->pyld) {
+			IPAERR("fail to copy imm cmd %d\n", descr[i].opcode);
+			goto fail_copy;
+		}
+	}
+
+	/* extend the last chain if it fits, never split the caller's one */
+	n = batch->num_chain;
+	if (n && batch->chain_len[n - 1] + num_desc <= IPA3_CMD_BATCH_CHAIN_LEN)
+		batch->chain_len[n - 1] += num_desc;
+	else
+		batch->chain_len[batch->num_chain++] = num_desc;
+	batch->num_desc += num_desc;
+
+	return 0;
+
+fail_copy:
+	while (i--) {
+		desc = &batch->desc[batch->num_desc + i];
+		kfree(desc->pyld);
+		memset(desc, 0, sizeof(*desc));
+	}
+	return -ENOMEM;
+}
+
+static void ipa3_batch_free_mem(struct ipa_mem_buffer *mem, bool hal)
+{
+	struct ipa3_cmd_batch *batch = ipa3_ctx->cmd_batch;
+	struct ipa3_cmd_batch_mem *entry;
+
+	if (batch && mem->base) {
+		entry = kzalloc(sizeof(*entry), GFP_KERNEL);
+		if (entry) {
+			entry->mem = *mem;
+			entry->hal = hal;
+			list_add_tail(&entry->link, &batch->free_list);
+			memset(mem, 0, sizeof(*mem));
+			return;
+		}
+
+		/* cannot defer, have the hw done with the queued commands */
+		if (ipa3_cmd_batch_flush(batch)) {
+			IPAERR("leaking %u bytes of DMA memory\n", mem->size);
+			memset(mem, 0, sizeof(*mem));
+			return;
+		}
+	}
+
+	if (hal)
+		ipahal_free_dma_mem(mem);
+	else
+		dma_free_coherent(ipa3_ctx->pdev, mem->size, mem->base,
+			mem->phys_base);
+}
+
+/**
+ * ipa3_batch_free_dma_mem() - free a DMA buffer allocated by ipahal, which
+ *  may be referenced by commands queued to a table commit transaction
+ * @mem: the buffer
+ *
+ * Same as ipahal_free_dma_mem() if no transaction is open, otherwise the
+ * buffer is freed once the queued commands were processed.
+ */
+void ipa3_batch_free_dma_mem(struct ipa_mem_buffer *mem)
+{
+	ipa3_batch_free_mem(mem, true);
+}
+
+/**
+ * ipa3_batch_free_coherent() - free a DMA buffer allocated on
+ *  ipa3_ctx->pdev, which may be referenced by commands queued to a table
+ *  commit transaction
+ * @mem: the buffer
+ *
+ * Same as dma_free_coherent() if no transaction is open, otherwise the
+ * buffer is freed once the queued commands were processed.
+ */
+void ipa3_batch_free_coherent(struct ipa_mem_buffer *mem)
+{
+	ipa3_batch_free_mem(mem, false);
+}
+
+static int ipa3_commit_tables_locked(u32 tables)
+{
+	if ((tables & IPA3_COMMIT_FLT_V4) &&
+		ipa3_ctx->ctrl->ipa3_commit_flt(IPA_IP_v4))
+		return -EPERM;
+	if ((tables & IPA3_COMMIT_RT_V4) &&
+		ipa3_ctx->ctrl->ipa3_commit_rt(IPA_IP_v4))
+		return -EPERM;
+	if ((tables & IPA3_COMMIT_FLT_V6) &&
+		ipa3_ctx->ctrl->ipa3_commit_flt(IPA_IP_v6))
+		return -EPERM;
+	if ((tables & IPA3_COMMIT_RT_V6) &&
+		ipa3_ctx->ctrl->ipa3_commit_rt(IPA_IP_v6))
+		return -EPERM;
+	if ((tables & IPA3_COMMIT_HDR) &&
+		ipa3_ctx->ctrl->ipa3_commit_hdr())
+		return -EPERM;
+
+	return 0;
+}
+
+/**
+ * ipa3_commit_tables() - commit the header, routing and filtering tables
+ *  to IPA HW in a single transaction
+ * @tables:	[in] IPA3_COMMIT_* mask of the tables to commit
+ *
+ * The immediate commands generated for all the tables are chained and sent
+ * with one completion wait, rather than one wait per table. Tables are
+ * committed in the order ipa3_commit_hdr() uses: the filtering and routing
+ * tables pointing to a header or routing table are committed first.
+ *
+ * If the chain fails to send, all the tables are recommitted one by one as
+ * the SW state of the tables may already refer to the new images.
+ *
+ * Returns:	0 on success, negative on failure
+ *
+ * Note:	Should not be called from atomic context
+ */
+int ipa3_commit_tables(u32 tables)
+{
+	struct ipa3_cmd_batch *batch;
+	int result;
+
+	if (!tables || (tables & ~IPA3_COMMIT_ALL)) {
+		IPAERR_RL("bad tables mask 0x%x\n", tables);
+		return -EINVAL;
+	}
+
+	/* same dependencies as the single table commits */
+	if (tables & IPA3_COMMIT_HDR)
+		tables |= IPA3_COMMIT_RT_V4 | IPA3_COMMIT_RT_V6;
+	if (tables & IPA3_COMMIT_RT_V4)
+		tables |= IPA3_COMMIT_FLT_V4;
+	if (tables & IPA3_COMMIT_RT_V6)
+		tables |= IPA3_COMMIT_FLT_V6;
+
+	batch = kzalloc(sizeof(*batch), GFP_KERNEL);
+	if (!batch)
+		return -ENOMEM;
+	INIT_LIST_HEAD(&batch->free_list);
+
+	mutex_lock(&ipa3_ctx->lock);
+	ipa3_ctx->cmd_batch = batch;
+	result = ipa3_commit_tables_locked(tables);
+	/* whatever was committed must reach the hw, even on a later failure */
+	ipa3_cmd_batch_flush(batch);
+	ipa3_ctx->cmd_batch = NULL;
+
+	if (batch->failed) {
+		IPAERR("recommitting tables 0x%x one by one\n", tables);
+		ipa3_ctx->rt_tbl_full_commit[IPA_IP_v4] = true;
+		ipa3_ctx->rt_tbl_full_commit[IPA_IP_v6] = true;
+		ipa3_ctx->flt_tbl_full_commit[IPA_IP_v4] = true;
+		ipa3_ctx->flt_tbl_full_commit[IPA_IP_v6] = true;
+		result = ipa3_commit_tables_locked(tables);
+	}
+
+	/* on failure the hw may still be reading the released buffers */
+	ipa3_cmd_batch_release_mem(batch, !batch->failed || !result);
+	ipa3_ctx->stats.commit_tables++;
+	ipa3_ctx->stats.commit_tables_waits += batch->send_cnt;
+	IPADBG("committed tables 0x%x with %u waits, result %d\n", tables,
+		batch->send_cnt, result);
+	mutex_unlock(&ipa3_ctx->lock);
+
+	kfree(batch);
+	return result;
+}
+
 /**
  * ipa3_handle_rx_core() - The core functionality of packet reception. This
  * function is read from multiple code paths.
@@ -1176,6 +1577,192 @@ static int ipa3_tx_switch_to_intr_mode(struct ipa3_sys_context *sys) {
 	return ret;
 }
 
+struct ipa3_rx_dim_profile {
+	u16 int_modt;
+	u8 int_modc;
+	u32 poll_inactivity;
+};
+
+/* from lowest latency to highest throughput */
+static const struct ipa3_rx_dim_profile ipa3_rx_dim_profiles[] = {
+	{ IPA_GSI_EVT_RING_INT_MODT, 1, POLLING_INACTIVITY_RX / 4 },
+	{ 8, 8, POLLING_INACTIVITY_RX / 2 },
+	{ IPA_GSI_EVT_RING_INT_MODT, IPA_GSI_EVT_RING_INT_MODC,
+		POLLING_INACTIVITY_RX },
+	{ 32, 48, POLLING_INACTIVITY_RX * 2 },
+};
+
+/* profiles matching the static moderation of napi and non napi pipes */
+#define IPA_RX_DIM_PROFILE_NAPI 2
+#define IPA_RX_DIM_PROFILE_INTR 0
+
+/**
+ * ipa3_rx_dim_init() - start adaptive moderation of a rx pipe
+ * @sys: sys pipe context, its event ring just allocated
+ * @int_modt: static moderation timer the event ring was allocated with
+ * @int_modc: static moderation counter the event ring was allocated with
+ *
+ * Pipes with moderation set by the client, sharing their event ring or
+ * reserved for low latency traffic keep the static moderation.
+ */
+static void ipa3_rx_dim_init(struct ipa3_sys_context *sys, u16 int_modt,
+	u8 int_modc)
+{
+	struct ipa3_rx_dim *dim = &sys->dim;
+	int ipa_ep_idx;
+
+	memset(dim, 0, sizeof(*dim));
+	dim->int_modt = int_modt;
+	dim->int_modc = int_modc;
+	if (!IPA_CLIENT_IS_CONS(sys->ep->client) || sys->ext_ioctl_v2 ||
+		sys->use_comm_evt_ring ||
+		IPA_CLIENT_IS_LOW_LAT_CONS(sys->ep->client))
+		return;
+
+	ipa_ep_idx = ipa3_get_ep_mapping(sys->ep->client);
+	if (ipa_ep_idx == IPA_EP_NOT_ALLOCATED)
+		return;
+
+	dim->init_profile = sys->napi_obj ?
+		IPA_RX_DIM_PROFILE_NAPI : IPA_RX_DIM_PROFILE_INTR;
+	dim->profile = dim->init_profile;
+	dim->window_start = ktime_get();
+	dim->enabled = true;
+
+	memset(&ipa3_ctx->stats.rx_dim[ipa_ep_idx], 0,
+		sizeof(ipa3_ctx->stats.rx_dim[ipa_ep_idx]));
+	ipa3_ctx->stats.rx_dim[ipa_ep_idx].profile = dim->profile;
+}
+
+/**
+ * ipa3_rx_dim_reset() - forget the tuned moderation of a rx pipe
+ * @sys: sys pipe context
+ *
+ * Called once the event ring is back on its static moderation, either
+ * put back by ipa3_rx_dim_restore() or by a reset of the ring.
+ */
+void ipa3_rx_dim_reset(struct ipa3_sys_context *sys)
+{
+	struct ipa3_rx_dim *dim = &sys->dim;
+
+	if (dim->tuned) {
+		dim->tuned = false;
+		dim->profile = dim->init_profile;
+		ipa3_ctx->stats.rx_dim[
+			ipa3_get_ep_mapping(sys->ep->client)].profile =
+			dim->profile;
+	}
+
+	/* start a fresh window in case moderation is turned back on */
+	dim->events = 0;
+	dim->pkts = 0;
+	dim->window_start = ktime_get();
+}
+
+/**
+ * ipa3_rx_dim_restore() - put back the static moderation of a rx pipe
+ * @sys: sys pipe context
+ *
+ * Called once adaptive moderation is turned off through debugfs, so the
+ * event ring does not stay on whatever profile was tuned last.
+ */
+static void ipa3_rx_dim_restore(struct ipa3_sys_context *sys)
+{
+	struct ipa3_rx_dim *dim = &sys->dim;
+
+	if (dim->tuned) {
+		if (gsi_update_evt_ring_int_mod(sys->ep->gsi_evt_ring_hdl,
+			dim->int_modt, dim->int_modc) != GSI_STATUS_SUCCESS) {
+			IPAERR_RL("client %d failed to restore moderation\n",
+				sys->ep->client);
+			return;
+		}
+		IPADBG_LOW("client %d moderation back to static %u/%u\n",
+			sys->ep->client, dim->int_modt, dim->int_modc);
+	}
+
+	ipa3_rx_dim_reset(sys);
+}
+
+/**
+ * ipa3_rx_dim_update() - retune the moderation of a rx pipe
+ * @sys: sys pipe context, about to leave polling mode
+ *
+ * Once a window of interrupts is sampled, moderation steps up when each
+ * interrupt brings many completions (bulk transfer) and steps down when it
+ * brings few of them. Sparse traffic, with interrupts far apart, goes
+ * straight to the lowest latency profile since moderating it only delays
+ * each burst.
+ */
+static void ipa3_rx_dim_update(struct ipa3_sys_context *sys)
+{
+	struct ipa3_rx_dim *dim = &sys->dim;
+	const struct ipa3_rx_dim_profile *prof;
+	struct ipa3_rx_dim_stats *stats;
+	u32 profile = dim->profile;
+	u32 ppi;
+	u32 gap_us;
+	ktime_t now;
+
+	if (!dim->enabled)
+		return;
+
+	if (!ipa3_ctx->rx_dim_enable) {
+		ipa3_rx_dim_restore(sys);
+		return;
+	}
+
+	if (dim->events < IPA_RX_DIM_WINDOW_EVENTS)
+		return;
+
+	now = ktime_get();
+	ppi = dim->pkts / dim->events;
+	gap_us = (u32)(ktime_us_delta(now, dim->window_start) / dim->events);
+
+	if (gap_us >= IPA_RX_DIM_IDLE_GAP_US && ppi < IPA_RX_DIM_PPI_HIGH)
+		profile = 0;
+	else if (ppi >= IPA_RX_DIM_PPI_HIGH &&
+		profile < ARRAY_SIZE(ipa3_rx_dim_profiles) - 1)
+		profile++;
+	else if (ppi <= IPA_RX_DIM_PPI_LOW && profile > 0)
+		profile--;
+
+	stats = &ipa3_ctx->stats.rx_dim[ipa3_get_ep_mapping(sys->ep->client)];
+	if (profile != dim->profile) {
+		prof = &ipa3_rx_dim_profiles[profile];
+		if (gsi_update_evt_ring_int_mod(sys->ep->gsi_evt_ring_hdl,
+			prof->int_modt, prof->int_modc) != GSI_STATUS_SUCCESS) {
+			IPAERR_RL("client %d failed to set moderation\n",
+				sys->ep->client);
+			goto new_window;
+		}
+		dim->tuned = true;
+		IPADBG_LOW("client %d moderation profile %u->%u ppi %u gap %u\n",
+			sys->ep->client, dim->profile, profile, ppi, gap_us);
+		if (profile > dim->profile)
+			stats->step_up++;
+		else
+			stats->step_down++;
+		dim->profile = profile;
+	}
+	stats->profile = profile;
+	stats->ppi = ppi;
+	stats->gap_us = gap_us;
+
+new_window:
+	dim->events = 0;
+	dim->pkts = 0;
+	dim->window_start = now;
+}
+
+static u32 ipa3_rx_dim_poll_inactivity(struct ipa3_sys_context *sys)
+{
+	if (!sys->dim.enabled || !ipa3_ctx->rx_dim_enable)
+		return POLLING_INACTIVITY_RX;
+
+	return ipa3_rx_dim_profiles[sys->dim.profile].poll_inactivity;
+}
+
 /**
  * ipa3_rx_switch_to_intr_mode() - Operate the Rx data path in interrupt mode
  */
@@ -1183,6 +1770,7 @@ static int ipa3_rx_switch_to_intr_mode(struct ipa3_sys_context *sys)
 {
 	int ret;
 
+	ipa3_rx_dim_update(sys);
 	atomic_set(&sys->curr_polling_state, 0);
 	__ipa3_update_curr_poll_state(sys->ep->client, 0);
 	ipa_pm_deferred_deactivate(sys->pm_hdl);
@@ -1228,6 +1816,7 @@ start_poll:
 			inactive_cycles++;
 		else
 			inactive_cycles = 0;
+		sys->dim.pkts += cnt;
 
 		trace_idle_sleep_enter3(sys->ep->client);
 		usleep_range(POLLING_MIN_SLEEP_RX, POLLING_MAX_SLEEP_RX);
@@ -1241,7 +1830,7 @@ start_poll:
 		if (sys->len == 0)
 			break;
 
-	} while (inactive_cycles <= POLLING_INACTIVITY_RX);
+	} while (inactive_cycles <= ipa3_rx_dim_poll_inactivity(sys));
 
 	trace_poll_to_intr3(sys->ep->client);
 	ret = ipa3_rx_switch_to_intr_mode(sys);
@@ -1282,6 +1871,29 @@ enum hrtimer_restart ipa3_ring_doorbell_timer_fn(struct hrtimer *param)
 	return HRTIMER_NORESTART;
 }
 
+static enum hrtimer_restart ipa3_tx_db_flush_timer_fn(struct hrtimer *param)
+{
+	struct ipa3_sys_context *sys = container_of(param,
+		struct ipa3_sys_context, db_flush_timer);
+	struct ipa3_tx_db_stats *db_stats;
+
+	spin_lock_bh(&sys->spinlock);
+	if (sys->db_pending) {
+		/* no more packets came after the burst, ring it now */
+		if (gsi_queue_xfer(sys->ep->gsi_chan_hdl, 0, NULL, true))
+			IPAERR_RL("failed to ring ch:%lu doorbell\n",
+				sys->ep->gsi_chan_hdl);
+		sys->db_pending = 0;
+		db_stats = &ipa3_ctx->stats.tx_db[
+			ipa3_get_ep_mapping(sys->ep->client)];
+		db_stats->doorbells++;
+		db_stats->timer_flush++;
+	}
+	spin_unlock_bh(&sys->spinlock);
+
+	return HRTIMER_NORESTART;
+}
+
 static void ipa_pm_sys_pipe_cb(void *p, enum ipa_pm_cb_event event)
 {
 	struct ipa3_sys_context *sys = (struct ipa3_sys_context *)p;
@@ -1473,6 +2085,7 @@ int ipa3_setup_sys_pipe(struct ipa_sys_connect_params *sys_in, u32 *clnt_hdl)
 	char buff[IPA_RESOURCE_NAME_MAX];
 	struct ipa_ep_cfg ep_cfg_copy;
 	int (*tx_completion_func)(struct napi_struct *, int);
+	u32 ring_sz;
 
 	if (sys_in == NULL || clnt_hdl == NULL) {
 		IPAERR(
@@ -1567,12 +2180,13 @@ int ipa3_setup_sys_pipe(struct ipa_sys_connect_params *sys_in, u32 *clnt_hdl)
 
 		INIT_LIST_HEAD(&ep->sys->head_desc_list);
 		INIT_LIST_HEAD(&ep->sys->rcycl_list);
-		INIT_LIST_HEAD(&ep->sys->avail_tx_wrapper_list);
-		ep->sys->avail_tx_wrapper = 0;
 		spin_lock_init(&ep->sys->spinlock);
 		hrtimer_init(&ep->sys->db_timer, CLOCK_MONOTONIC,
 			HRTIMER_MODE_REL);
 		ep->sys->db_timer.function = ipa3_ring_doorbell_timer_fn;
+		hrtimer_init(&ep->sys->db_flush_timer, CLOCK_MONOTONIC,
+			HRTIMER_MODE_REL_SOFT);
+		ep->sys->db_flush_timer.function = ipa3_tx_db_flush_timer_fn;
 
 		/* create IPA PM resources for handling polling mode */
 		if (sys_in->client == IPA_CLIENT_APPS_WAN_CONS &&
@@ -1638,6 +2252,28 @@ int ipa3_setup_sys_pipe(struct ipa_sys_connect_params *sys_in, u32 *clnt_hdl)
 				(unsigned long) ep->sys);
 		INIT_WORK(&ep->sys->tasklet_work,
 			ipa3_tasklet_schd_work);
+
+		/*
+		 * one wrapper slot for each TRE of the channel, unless the
+		 * wrapper cache size limits the memory kept per pipe
+		 */
+		ring_sz = roundup_pow_of_two(
+			sys_in->desc_fifo_sz / IPA_FIFO_ELEMENT_SIZE);
+		if (ipa3_ctx->tx_wrapper_cache_max_size)
+			ring_sz = min_t(u32, ring_sz, max_t(u32,
+				rounddown_pow_of_two(
+				ipa3_ctx->tx_wrapper_cache_max_size),
+				roundup_pow_of_two(IPA_SEND_MAX_DESC)));
+		ep->sys->tx_ring.mask = ring_sz - 1;
+		ep->sys->tx_ring.pkt = kvcalloc(ep->sys->tx_ring.mask + 1,
+			sizeof(struct ipa3_tx_pkt_wrapper), GFP_KERNEL);
+		if (!ep->sys->tx_ring.pkt) {
+			IPAERR("failed to alloc tx ring for client %d\n",
+				sys_in->client);
+			result = -ENOMEM;
+			goto fail_gen2;
+		}
+		spin_lock_init(&ep->sys->tx_ring.compl_lock);
 	}
 	if (sys_in->client == IPA_CLIENT_APPS_WAN_LOW_LAT_CONS)
 		tasklet_init(&ep->sys->tasklet, ipa3_tasklet_rx_notify,
@@ -1783,12 +2419,19 @@ int ipa3_setup_sys_pipe(struct ipa_sys_connect_params *sys_in, u32 *clnt_hdl)
 				IPADBG("Page repl capacity for client:%d, value:%d\n",
 						   sys_in->client, ep->sys->page_recycle_repl->capacity);
 				INIT_LIST_HEAD(&ep->sys->page_recycle_repl->page_repl_head);
+				ep->sys->page_recycle_repl->pool =
+					ipa3_page_pool_create(ep->sys->page_order);
 				INIT_DELAYED_WORK(&ep->sys->freepage_work, ipa3_schd_freepage_work);
 				tasklet_init(&ep->sys->tasklet_find_freepage,
 					ipa3_tasklet_find_freepage, (unsigned long) ep->sys);
 				ipa3_replenish_rx_page_cache(ep->sys);
 			} else {
  				ep->sys->napi_sort_page_thrshld_cnt = 0;
+				/* the pool goes away with each teardown */
+				if (!ep->sys->page_recycle_repl->pool)
+					ep->sys->page_recycle_repl->pool =
+						ipa3_page_pool_create(
+						ep->sys->page_order);
 				/* Sort the pages once. */
 				ipa3_tasklet_find_freepage((unsigned long) ep->sys);
 			}
@@ -1932,6 +2575,8 @@ fail_repl:
 	}
 fail_page_recycle_repl:
 	if (ep->sys->page_recycle_repl && !ep->sys->common_buff_pool) {
+		if (ep->sys->page_recycle_repl->pool)
+			ipa3_page_pool_destroy(ep->sys->page_recycle_repl->pool);
 		kfree(ep->sys->page_recycle_repl);
 		ep->sys->page_recycle_repl = NULL;
 	}
@@ -1944,6 +2589,8 @@ fail_napi:
 	if (ipa3_ctx->tx_napi_enable &&
 		(IPA_CLIENT_IS_PROD(sys_in->client)))
 		netif_napi_del(&ep->sys->napi_tx);
+	kvfree(ep->sys->tx_ring.pkt);
+	ep->sys->tx_ring.pkt = NULL;
 fail_gen2:
 	ipa_pm_deregister(ep->sys->pm_hdl);
 fail_pm:
@@ -1965,22 +2612,6 @@ fail_gen:
 	return result;
 }
 
-static void delete_avail_tx_wrapper_list(struct ipa3_ep_context *ep)
-{
-	struct ipa3_tx_pkt_wrapper *tx_pkt_iterator = NULL;
-	struct ipa3_tx_pkt_wrapper *tx_pkt_temp = NULL;
-
-	spin_lock_bh(&ep->sys->spinlock);
-	list_for_each_entry_safe(tx_pkt_iterator, tx_pkt_temp,
-	    &ep->sys->avail_tx_wrapper_list, link) {
-		list_del(&tx_pkt_iterator->link);
-		kmem_cache_free(ipa3_ctx->tx_pkt_wrapper_cache, tx_pkt_iterator);
-		ep->sys->avail_tx_wrapper--;
-	}
-	ep->sys->avail_tx_wrapper = 0;
-	spin_unlock_bh(&ep->sys->spinlock);
-}
-
 /**
  * ipa3_teardown_sys_pipe() - Teardown the GPI pipe and cleanup IPA EP
  * @clnt_hdl:	[in] the handle obtained from ipa3_setup_sys_pipe
@@ -2011,15 +2642,15 @@ int ipa3_teardown_sys_pipe(u32 clnt_hdl)
 		do {
 			spin_lock_bh(&ep->sys->spinlock);
 			atomic_set(&ep->disconnect_in_progress, 1);
-			empty = list_empty(&ep->sys->head_desc_list);
+			empty = !ipa3_tx_ring_peek(ep->sys);
 			spin_unlock_bh(&ep->sys->spinlock);
 			if (!empty)
 				usleep_range(95, 105);
 			else
 				break;
 		} while (1);
+		hrtimer_cancel(&ep->sys->db_flush_timer);
 
-		delete_avail_tx_wrapper_list(ep);
 		/* Delete NAPI TX object. For WAN_PROD, it is deleted
 		 * in rmnet_ipa driver.
 		 */
@@ -2170,6 +2801,19 @@ int ipa3_teardown_sys_pipe(u32 clnt_hdl)
 	if (IPA_CLIENT_IS_CONS(ep->client) && !ep->sys->common_buff_pool)
 		ipa3_cleanup_rx(ep->sys);
 
+	/* the channel is flushed, pooled pages are all back in the pool */
+	if (ep->sys->repl_hdlr == ipa3_replenish_rx_page_recycle &&
+		!ep->sys->common_buff_pool && ep->sys->page_recycle_repl &&
+		ep->sys->page_recycle_repl->pool) {
+		ipa3_page_pool_destroy(ep->sys->page_recycle_repl->pool);
+		ep->sys->page_recycle_repl->pool = NULL;
+	}
+
+	if (IPA_CLIENT_IS_PROD(ep->client)) {
+		kvfree(ep->sys->tx_ring.pkt);
+		ep->sys->tx_ring.pkt = NULL;
+	}
+
 	if (!ep->skip_ep_cfg && IPA_CLIENT_IS_PROD(ep->client)) {
 		if (ipa3_ctx->modem_cfg_emb_pipe_flt &&
 			(ep->client == IPA_CLIENT_APPS_WAN_PROD ||
@@ -2324,6 +2968,26 @@ void ipa3_tx_cmd_comp(void *user1, int user2)
  */
 int ipa3_tx_dp(enum ipa_client_type dst, struct sk_buff *skb,
 		struct ipa_tx_meta *meta)
+{
+	return ipa3_tx_dp_xmit_more(dst, skb, meta, false);
+}
+
+/**
+ * ipa3_tx_dp_xmit_more() - Data-path tx handler for bursts of packets
+ * @dst:	[in] which IPA destination to route tx packets to
+ * @skb:	[in] the packet to send
+ * @metadata:	[in] TX packet meta-data
+ * @xmit_more:	[in] more packets follow, as reported by netdev_xmit_more()
+ *
+ * Same as ipa3_tx_dp(), except that the doorbell of the pipe is not rung for
+ * a packet followed by others. It is rung by the last packet of the burst,
+ * or once IPA_TX_DB_BATCH_MAX_DESC descriptors or IPA_TX_DB_FLUSH_DELAY_NS
+ * are pending.
+ *
+ * Returns:	0 on success, negative on failure
+ */
+int ipa3_tx_dp_xmit_more(enum ipa_client_type dst, struct sk_buff *skb,
+		struct ipa_tx_meta *meta, bool xmit_more)
 {
 	struct ipa3_desc *desc;
 	struct ipa3_desc _desc[3];
@@ -2497,7 +3161,8 @@ int ipa3_tx_dp(enum ipa_client_type dst, struct sk_buff *skb,
 			desc[skb_idx].callback = NULL;
 		}
 
-		if (ipa3_send(sys, num_frags + data_idx, desc, true)) {
+		if (__ipa3_send(sys, num_frags + data_idx, desc, true,
+			xmit_more)) {
 			IPAERR_RL("fail to send skb %pK num_frags %u SWP\n",
 				skb, num_frags);
 			goto fail_send;
@@ -2528,7 +3193,8 @@ int ipa3_tx_dp(enum ipa_client_type dst, struct sk_buff *skb,
 			desc[data_idx].dma_address = meta->dma_address;
 		}
 		if (num_frags == 0) {
-			if (ipa3_send(sys, data_idx + 1, desc, true)) {
+			if (__ipa3_send(sys, data_idx + 1, desc, true,
+				xmit_more)) {
 				IPAERR_RL("fail to send skb %pK HWP\n", skb);
 				goto fail_mem;
 			}
@@ -2547,8 +3213,8 @@ int ipa3_tx_dp(enum ipa_client_type dst, struct sk_buff *skb,
 			desc[data_idx+f].user2 = desc[data_idx].user2;
 			desc[data_idx].callback = NULL;
 
-			if (ipa3_send(sys, num_frags + data_idx + 1,
-				desc, true)) {
+			if (__ipa3_send(sys, num_frags + data_idx + 1,
+				desc, true, xmit_more)) {
 				IPAERR_RL("fail to send skb %pK num_frags %u\n",
 					skb, num_frags);
 				goto fail_mem;
@@ -2744,6 +3410,262 @@ fail_page_alloc:
 	return NULL;
 }
 
+static void ipa3_page_pool_free_page(struct ipa3_rx_pkt_wrapper *rx_pkt)
+{
+	dma_unmap_page(ipa3_ctx->pdev, rx_pkt->page_data.dma_addr,
+		rx_pkt->len, DMA_FROM_DEVICE);
+	__free_pages(rx_pkt->page_data.page, rx_pkt->page_data.page_order);
+	kmem_cache_free(ipa3_ctx->rx_pkt_wrapper_cache, rx_pkt);
+}
+
+static unsigned long ipa3_page_pool_shrink_count(struct shrinker *shrinker,
+	struct shrink_control *sc)
+{
+	struct ipa3_page_pool *pool =
+		container_of(shrinker, struct ipa3_page_pool, shrinker);
+
+	return atomic_read(&pool->cnt);
+}
+
+static unsigned long ipa3_page_pool_shrink_scan(struct shrinker *shrinker,
+	struct shrink_control *sc)
+{
+	struct ipa3_page_pool *pool =
+		container_of(shrinker, struct ipa3_page_pool, shrinker);
+	struct ipa3_page_pool_cpu *pcpu;
+	struct ipa3_rx_pkt_wrapper *rx_pkt, *tmp;
+	struct list_head free_head;
+	unsigned long freed = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		if (freed == sc->nr_to_scan)
+			break;
+
+		INIT_LIST_HEAD(&free_head);
+		pcpu = per_cpu_ptr(pool->cpu, cpu);
+		spin_lock_bh(&pcpu->lock);
+		list_for_each_entry_safe(rx_pkt, tmp, &pcpu->page_head, link) {
+			if (freed == sc->nr_to_scan)
+				break;
+			/* pages still held by the stack are left alone */
+			if (page_ref_count(rx_pkt->page_data.page) != 1)
+				continue;
+			list_move(&rx_pkt->link, &free_head);
+			pcpu->cnt--;
+			freed++;
+		}
+		spin_unlock_bh(&pcpu->lock);
+
+		list_for_each_entry_safe(rx_pkt, tmp, &free_head, link) {
+			list_del(&rx_pkt->link);
+			atomic_dec(&pool->cnt);
+			ipa3_page_pool_free_page(rx_pkt);
+		}
+	}
+	ipa3_ctx->stats.page_pool_shrunk += freed;
+
+	return freed ? freed : SHRINK_STOP;
+}
+
+/**
+ * ipa3_page_pool_create() - create the pool keeping tmp_alloc pages
+ * @page_order: order of the pages the pool keeps
+ *
+ * Pages allocated on the fly when the recycle list has no idle page are
+ * normally unmapped and handed over to the stack for good. The pool keeps
+ * them mapped instead, on a list of the CPU completing them, and gives them
+ * back to the replenish of that CPU once the stack released them.
+ *
+ * Return: the pool, NULL if it could not be created
+ */
+static struct ipa3_page_pool *ipa3_page_pool_create(u32 page_order)
+{
+	struct ipa3_page_pool *pool;
+	struct ipa3_page_pool_cpu *pcpu;
+	int cpu;
+
+	pool = kzalloc(sizeof(*pool), GFP_KERNEL);
+	if (!pool)
+		return NULL;
+
+	pool->cpu = alloc_percpu(struct ipa3_page_pool_cpu);
+	if (!pool->cpu)
+		goto fail_alloc_percpu;
+
+	for_each_possible_cpu(cpu) {
+		pcpu = per_cpu_ptr(pool->cpu, cpu);
+		spin_lock_init(&pcpu->lock);
+		INIT_LIST_HEAD(&pcpu->page_head);
+	}
+	pool->page_order = page_order;
+	atomic_set(&pool->cnt, 0);
+
+	pool->shrinker.count_objects = ipa3_page_pool_shrink_count;
+	pool->shrinker.scan_objects = ipa3_page_pool_shrink_scan;
+	pool->shrinker.seeks = DEFAULT_SEEKS;
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(6, 0, 0))
+	if (register_shrinker(&pool->shrinker, "ipa-page-pool"))
+#else
+	if (register_shrinker(&pool->shrinker))
+#endif
+		goto fail_register_shrinker;
+
+	return pool;
+
+fail_register_shrinker:
+	free_percpu(pool->cpu);
+fail_alloc_percpu:
+	kfree(pool);
+	IPAERR("failed to create rx page pool\n");
+	return NULL;
+}
+
+/**
+ * ipa3_page_pool_destroy() - release a pool and the pages it keeps
+ * @pool: the pool
+ *
+ * Every page is unmapped and the pool reference dropped, pages still held
+ * by the stack are freed once the stack releases them. Pages posted to the
+ * channel must have been returned to the pool before.
+ */
+static void ipa3_page_pool_destroy(struct ipa3_page_pool *pool)
+{
+	struct ipa3_page_pool_cpu *pcpu;
+	struct ipa3_rx_pkt_wrapper *rx_pkt, *tmp;
+	struct list_head free_head;
+	int cpu;
+
+	unregister_shrinker(&pool->shrinker);
+
+	for_each_possible_cpu(cpu) {
+		INIT_LIST_HEAD(&free_head);
+		pcpu = per_cpu_ptr(pool->cpu, cpu);
+		spin_lock_bh(&pcpu->lock);
+		list_splice_init(&pcpu->page_head, &free_head);
+		pcpu->cnt = 0;
+		spin_unlock_bh(&pcpu->lock);
+
+		list_for_each_entry_safe(rx_pkt, tmp, &free_head, link) {
+			list_del(&rx_pkt->link);
+			atomic_dec(&pool->cnt);
+			ipa3_page_pool_free_page(rx_pkt);
+		}
+	}
+
+	free_percpu(pool->cpu);
+	kfree(pool);
+}
+
+static bool ipa3_page_pool_add(struct ipa3_page_pool *pool,
+	struct ipa3_rx_pkt_wrapper *rx_pkt)
+{
+	struct ipa3_page_pool_cpu *pcpu = raw_cpu_ptr(pool->cpu);
+
+	spin_lock_bh(&pcpu->lock);
+	if (pcpu->cnt >= IPA_PAGE_POOL_CPU_CAPACITY) {
+		spin_unlock_bh(&pcpu->lock);
+		return false;
+	}
+	list_add_tail(&rx_pkt->link, &pcpu->page_head);
+	pcpu->cnt++;
+	spin_unlock_bh(&pcpu->lock);
+	atomic_inc(&pool->cnt);
+
+	return true;
+}
+
+/**
+ * ipa3_page_pool_get() - get an idle page from the pool of this CPU
+ * @pool: the pool
+ *
+ * Return: the rx_pkt wrapper of the page, NULL if no idle page was found
+ */
+static struct ipa3_rx_pkt_wrapper *ipa3_page_pool_get(
+	struct ipa3_page_pool *pool)
+{
+	struct ipa3_page_pool_cpu *pcpu = raw_cpu_ptr(pool->cpu);
+	struct ipa3_rx_pkt_wrapper *rx_pkt;
+	int i = 0;
+
+	spin_lock_bh(&pcpu->lock);
+	list_for_each_entry(rx_pkt, &pcpu->page_head, link) {
+		if (i++ == ipa3_ctx->page_poll_threshold)
+			break;
+		if (page_ref_count(rx_pkt->page_data.page) == 1) {
+			page_ref_inc(rx_pkt->page_data.page);
+			list_del_init(&rx_pkt->link);
+			pcpu->cnt--;
+			spin_unlock_bh(&pcpu->lock);
+			atomic_dec(&pool->cnt);
+			return rx_pkt;
+		}
+	}
+	spin_unlock_bh(&pcpu->lock);
+
+	return NULL;
+}
+
+/**
+ * ipa3_page_pool_recycle() - keep a page handed to the stack in the pool
+ * @rx_pkt: tmp_alloc or pooled page completed by the hw
+ *
+ * The pool takes its own reference on the page, the one the page came with
+ * goes to the stack. A page the pool does not take is turned into a plain
+ * tmp_alloc page, to be unmapped by the caller.
+ *
+ * Return: true if the page was kept in the pool
+ */
+static bool ipa3_page_pool_recycle(struct ipa3_rx_pkt_wrapper *rx_pkt)
+{
+	struct ipa3_page_repl_ctx *page_repl = rx_pkt->sys->page_recycle_repl;
+	struct ipa_rx_page_data *page_data = &rx_pkt->page_data;
+
+	if (!page_data->is_tmp_alloc && !page_data->is_pooled)
+		return false;
+
+	if (page_repl && page_repl->pool &&
+		page_data->page_order == page_repl->pool->page_order) {
+		if (!page_data->is_pooled)
+			page_ref_inc(page_data->page);
+		if (ipa3_page_pool_add(page_repl->pool, rx_pkt)) {
+			page_data->is_pooled = true;
+			page_data->is_tmp_alloc = false;
+			dma_sync_single_for_cpu(ipa3_ctx->pdev,
+				page_data->dma_addr, rx_pkt->len,
+				DMA_FROM_DEVICE);
+			return true;
+		}
+		page_ref_dec(page_data->page);
+	}
+
+	page_data->is_pooled = false;
+	page_data->is_tmp_alloc = true;
+	return false;
+}
+
+/**
+ * ipa3_page_pool_return() - put back a pooled page the stack never got
+ * @rx_pkt: pooled page completed by the hw or flushed from the channel
+ *
+ * If the pool is gone or has no room left the page is freed and the wrapper
+ * turned into a tmp_alloc one, for the caller to release.
+ */
+static void ipa3_page_pool_return(struct ipa3_rx_pkt_wrapper *rx_pkt)
+{
+	struct ipa3_page_pool *pool = rx_pkt->sys->page_recycle_repl->pool;
+
+	init_page_count(rx_pkt->page_data.page);
+	if (pool && ipa3_page_pool_add(pool, rx_pkt))
+		return;
+
+	dma_unmap_page(ipa3_ctx->pdev, rx_pkt->page_data.dma_addr,
+		rx_pkt->len, DMA_FROM_DEVICE);
+	__free_pages(rx_pkt->page_data.page, rx_pkt->page_data.page_order);
+	rx_pkt->page_data.is_pooled = false;
+	rx_pkt->page_data.is_tmp_alloc = true;
+}
+
 static void ipa3_replenish_rx_page_cache(struct ipa3_sys_context *sys)
 {
 	struct ipa3_rx_pkt_wrapper *rx_pkt;
@@ -2961,7 +3883,13 @@ int ipa3_unregister_notifier(void *fn_ptr)
 			((rx_pkt = ipa3_get_free_page(sys,stats_i)) != NULL)) {
 			ipa3_ctx->stats.page_recycle_stats[stats_i].page_recycled++;
 
+		} else if (sys->page_recycle_repl && sys->page_recycle_repl->pool &&
+			((rx_pkt = ipa3_page_pool_get(
+				sys->page_recycle_repl->pool)) != NULL)) {
+			ipa3_ctx->stats.page_recycle_stats[stats_i].pool_hit++;
 		} else {
+			if (sys->page_recycle_repl && sys->page_recycle_repl->pool)
+				ipa3_ctx->stats.page_recycle_stats[stats_i].pool_miss++;
 			/*
 			 * Could not find idle page at curr index.
 			 * Allocate a new one.
@@ -3713,7 +4641,12 @@ static void free_rx_page(void *chan_user_data, void *xfer_user_data)
 	struct ipa3_rx_pkt_wrapper *rx_pkt = (struct ipa3_rx_pkt_wrapper *)
 		xfer_user_data;
 
-	if (!rx_pkt->page_data.is_tmp_alloc) {
+	if (rx_pkt->page_data.is_pooled) {
+		list_del_init(&rx_pkt->link);
+		ipa3_page_pool_return(rx_pkt);
+		if (!rx_pkt->page_data.is_pooled)
+			kmem_cache_free(ipa3_ctx->rx_pkt_wrapper_cache, rx_pkt);
+	} else if (!rx_pkt->page_data.is_tmp_alloc) {
 		list_del_init(&rx_pkt->link);
 		page_ref_dec(rx_pkt->page_data.page);
 		spin_lock_bh(&rx_pkt->sys->common_sys->spinlock);
@@ -5360,7 +6293,9 @@ static struct sk_buff *handle_page_completion(struct gsi_chan_xfer_notify
 
 	if (notify->veid >= GSI_VEID_MAX) {
 		IPAERR("notify->veid > GSI_VEID_MAX\n");
-		if (!rx_page.is_tmp_alloc) {
+		if (rx_page.is_pooled) {
+			ipa3_page_pool_return(rx_pkt);
+		} else if (!rx_page.is_tmp_alloc) {
 			init_page_count(rx_page.page);
 			spin_lock_bh(&rx_pkt->sys->common_sys->spinlock);
 			/* Add the element to head. */
@@ -5392,7 +6327,9 @@ static struct sk_buff *handle_page_completion(struct gsi_chan_xfer_notify
 				rx_page = rx_pkt->page_data;
 				size = rx_pkt->data_len;
 				list_del_init(&rx_pkt->link);
-				if (!rx_page.is_tmp_alloc) {
+				if (rx_page.is_pooled) {
+					ipa3_page_pool_return(rx_pkt);
+				} else if (!rx_page.is_tmp_alloc) {
 					init_page_count(rx_page.page);
 					spin_lock_bh(&rx_pkt->sys->common_sys->spinlock);
 					/* Add the element to head. */
@@ -5414,9 +6351,12 @@ static struct sk_buff *handle_page_completion(struct gsi_chan_xfer_notify
 			size = rx_pkt->data_len;
 
 			list_del_init(&rx_pkt->link);
-			if (rx_page.is_tmp_alloc) {
-				dma_unmap_page(ipa3_ctx->pdev, rx_page.dma_addr,
-					rx_pkt->len, DMA_FROM_DEVICE);
+			if (rx_page.is_tmp_alloc || rx_page.is_pooled) {
+				/* keep the page mapped for this CPU if possible */
+				if (!ipa3_page_pool_recycle(rx_pkt))
+					dma_unmap_page(ipa3_ctx->pdev,
+						rx_page.dma_addr,
+						rx_pkt->len, DMA_FROM_DEVICE);
 			} else {
 				spin_lock_bh(&rx_pkt->sys->common_sys->spinlock);
 				/* Add the element back to tail. */
@@ -5471,92 +6411,121 @@ static void ipa3_rx_napi_chain(struct ipa3_sys_context *sys,
 	struct ipa3_sys_context *wan_def_sys;
 	int i, ipa_ep_idx;
 	struct sk_buff *rx_skb, *first_skb = NULL, *prev_skb = NULL;
+	bool coal_skb = sys->ep->client == IPA_CLIENT_APPS_WAN_COAL_CONS &&
+		!ipa3_ctx->ipa_wan_skb_page;
+	bool to_list = sys->ep->client_notify_list != NULL;
+	bool delivered = false;
+	LIST_HEAD(rx_list);
 
-	/* non-coalescing case (SKB chaining enabled) */
-	if (sys->ep->client != IPA_CLIENT_APPS_WAN_COAL_CONS) {
-		for (i = 0; i < num; i++) {
-			if (!ipa3_ctx->ipa_wan_skb_page)
-				rx_skb = handle_skb_completion(
-					&notify[i], false, NULL);
-			else
-				rx_skb = handle_page_completion(
-					&notify[i], false);
-
-			/* this is always true for EOTs */
-			if (rx_skb) {
-				if (!first_skb)
-					first_skb = rx_skb;
-
-				if (prev_skb)
-					skb_shinfo(prev_skb)->frag_list =
-						rx_skb;
+	/*
+	 * batch the skbs completed in this poll, the client gets all of them
+	 * through a single notification: as an sk_buff list if it takes one,
+	 * otherwise chained through frag_list
+	 */
+	for (i = 0; i < num; i++) {
+		if (!ipa3_ctx->ipa_wan_skb_page)
+			rx_skb = handle_skb_completion(
+				&notify[i], false, NULL);
+		else
+			rx_skb = handle_page_completion(
+				&notify[i], false);
 
-				trace_ipa3_rx_napi_chain(first_skb,
-							 prev_skb,
-							 rx_skb);
+		/* this is always set for EOTs */
+		if (!rx_skb)
+			continue;
 
-				prev_skb = rx_skb;
+		if (to_list) {
+			if (!rx_skb->len) {
+				IPAERR("ZLT\n");
+				sys->free_skb(rx_skb);
+				continue;
 			}
+			IPA_DUMP_BUFF(rx_skb->data, 0, rx_skb->len);
+			list_add_tail(&rx_skb->list, &rx_list);
+			delivered = coal_skb;
+			continue;
 		}
-		if (prev_skb) {
-			skb_shinfo(prev_skb)->frag_list = NULL;
-			sys->pyld_hdlr(first_skb, sys);
+
+		/*
+		 * coalescing skbs already link their continuation buffers
+		 * through frag_list, deliver them one at a time
+		 */
+		if (coal_skb) {
+			sys->pyld_hdlr(rx_skb, sys);
+			delivered = true;
+			continue;
 		}
-	} else {
-		if (!ipa3_ctx->ipa_wan_skb_page) {
-			/* TODO: add chaining for coal case */
-			for (i = 0; i < num; i++) {
-				rx_skb = handle_skb_completion(
-					&notify[i], false, NULL);
-				if (rx_skb) {
-					sys->pyld_hdlr(rx_skb, sys);
-					/*
-					 * For coalescing, we have 2 transfer
-					 * rings to replenish
-					 */
-					ipa_ep_idx = ipa3_get_ep_mapping(
-						IPA_CLIENT_APPS_WAN_CONS);
-					if (ipa_ep_idx ==
-						IPA_EP_NOT_ALLOCATED) {
-						IPAERR("Invalid client.\n");
-						return;
-					}
-					wan_def_sys =
-						ipa3_ctx->ep[ipa_ep_idx].sys;
-					wan_def_sys->repl_hdlr(wan_def_sys);
-					sys->repl_hdlr(sys);
-				}
-			}
-		} else {
-			for (i = 0; i < num; i++) {
-				rx_skb = handle_page_completion(
-					&notify[i], false);
 
-				/* this is always true for EOTs */
-				if (rx_skb) {
-					if (!first_skb)
-						first_skb = rx_skb;
+		if (!first_skb)
+			first_skb = rx_skb;
 
-					if (prev_skb)
-						skb_shinfo(prev_skb)->frag_list
-							= rx_skb;
+		if (prev_skb)
+			skb_shinfo(prev_skb)->frag_list = rx_skb;
 
-					prev_skb = rx_skb;
+		trace_ipa3_rx_napi_chain(first_skb, prev_skb, rx_skb);
 
-					trace_ipa3_rx_napi_chain(first_skb,
-								 prev_skb,
-								 rx_skb);
+		prev_skb = rx_skb;
+	}
+	if (prev_skb) {
+		skb_shinfo(prev_skb)->frag_list = NULL;
+		sys->pyld_hdlr(first_skb, sys);
+	}
 
-				}
-			}
-			if (prev_skb) {
-				skb_shinfo(prev_skb)->frag_list = NULL;
-				sys->pyld_hdlr(first_skb, sys);
-			}
+	if (!list_empty(&rx_list))
+		sys->ep->client_notify_list(sys->ep->priv, &rx_list);
+
+	if (delivered) {
+		/*
+		 * For coalescing, we have 2 transfer rings to replenish,
+		 * once per poll
+		 */
+		ipa_ep_idx = ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_CONS);
+		if (ipa_ep_idx == IPA_EP_NOT_ALLOCATED) {
+			IPAERR("Invalid client.\n");
+			return;
 		}
+		wan_def_sys = ipa3_ctx->ep[ipa_ep_idx].sys;
+		wan_def_sys->repl_hdlr(wan_def_sys);
+		sys->repl_hdlr(sys);
 	}
 }
 
+/**
+ * ipa3_set_rx_list_notify() - have the rx skbs of a NAPI poll delivered
+ * as an sk_buff list
+ * @clnt_hdl:	[in] handle of a WAN consumer pipe
+ * @notify:	[in] callback taking the skbs, linked through skb->list
+ *
+ * Only pipes whose payload handler passes the skb on to the client as is
+ * can do this, that is the WAN pipes in GRO aggregation mode. The setting
+ * is dropped with the pipe on teardown.
+ *
+ * Returns:	0 on success, negative on failure
+ */
+int ipa3_set_rx_list_notify(u32 clnt_hdl,
+	void (*notify)(void *priv, struct list_head *skbs))
+{
+	struct ipa3_ep_context *ep;
+
+	if (clnt_hdl >= ipa3_ctx->ipa_num_pipes ||
+		ipa3_ctx->ep[clnt_hdl].valid == 0) {
+		IPAERR("bad parm.\n");
+		return -EINVAL;
+	}
+
+	ep = &ipa3_ctx->ep[clnt_hdl];
+	if (!ep->sys || ep->sys->pyld_hdlr != ipa3_wan_rx_pyld_hdlr ||
+		!ipa3_ctx->ipa_client_apps_wan_cons_agg_gro) {
+		IPAERR("client %d can't take skb lists\n", ep->client);
+		return -EPERM;
+	}
+
+	ep->client_notify_list = notify;
+	IPADBG("client %d rx delivered as skb lists\n", ep->client);
+
+	return 0;
+}
+
 static void ipa3_wlan_wq_rx_common(struct ipa3_sys_context *sys,
 	struct gsi_chan_xfer_notify *notify)
 {
@@ -6458,6 +7427,7 @@ static void ipa_gsi_irq_rx_notify_cb(struct gsi_chan_xfer_notify *notify)
 	case GSI_CHAN_EVT_EOB:
 		atomic_set(&ipa3_ctx->transport_pm.eot_activity, 1);
 		if (!atomic_read(&sys->curr_polling_state)) {
+			sys->dim.events++;
 			/* put the gsi channel into polling mode */
 			gsi_config_channel_mode(sys->ep->gsi_chan_hdl,
 				GSI_CHAN_MODE_POLL);
@@ -6789,6 +7759,10 @@ static int ipa_gsi_setup_event_ring(struct ipa3_ep_context *ep,
 	if (result != GSI_STATUS_SUCCESS)
 		goto fail_alloc_evt_ring;
 
+	if (ep->sys)
+		ipa3_rx_dim_init(ep->sys, gsi_evt_ring_props.int_modt,
+			gsi_evt_ring_props.int_modc);
+
 	return 0;
 
 fail_alloc_evt_ring:
@@ -7113,6 +8087,7 @@ start_poll:
 				ipa3_wq_rx_common(ep->sys, g_lan_rx_notify + i);
 		}
 
+		ep->sys->dim.pkts += num;
 		remain_aggr_weight -= num;
 		if (ep->sys->len == 0) {
 			if (remain_aggr_weight == 0)
@@ -7205,6 +8180,7 @@ start_poll:
 
 		trace_ipa3_napi_rx_poll_num(ep->client, num);
 		ipa3_rx_napi_chain(ep->sys, notify, num);
+		ep->sys->dim.pkts += num;
 		remain_aggr_weight -= num;
 
 		trace_ipa3_napi_rx_poll_cnt(ep->client, ep->sys->len);
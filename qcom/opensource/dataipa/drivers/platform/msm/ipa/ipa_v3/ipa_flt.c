@@ -11,6 +11,9 @@
 #define IPA_FLT_STATUS_OF_DEL_FAILED		(-1)
 #define IPA_FLT_STATUS_OF_MDFY_FAILED		(-1)
 #define IPA_FLT_MAX_IMM_CMD_CHAIN_LENGTH	(10)
+/* coal close and cache flush leave room for this many table updates */
+#define IPA_FLT_MAX_NUM_OF_DELTA_BDYS		\
+	(IPA_FLT_MAX_IMM_CMD_CHAIN_LENGTH - 2)
 
 #define IPA_FLT_GET_RULE_TYPE(__entry) \
 	( \
@@ -18,6 +21,20 @@
 	(IPA_RULE_HASHABLE):(IPA_RULE_NON_HASHABLE) \
 	)
 
+/**
+ * struct ipa_flt_delta_bdy - flt table body rebuilt by a delta commit
+ * @tbl: the flt table
+ * @rlt: the rule type of the body (hashable or non-hashable)
+ * @hdr_idx: index of the table entry in the flt header
+ * @mem: the generated body
+ */
+struct ipa_flt_delta_bdy {
+	struct ipa3_flt_tbl *tbl;
+	enum ipa_rule_type rlt;
+	int hdr_idx;
+	struct ipa_mem_buffer mem;
+};
+
 /**
  * ipa3_generate_flt_hw_rule() - generates the filtering hardware rule
  * @ip: the ip address family type
@@ -98,14 +115,14 @@ static void __ipa_reap_sys_flt_tbls(enum ipa_ip_type ip, enum ipa_rule_type rlt)
 		tbl = &ipa3_ctx->flt_tbl[i][ip];
 		if (tbl->prev_mem[rlt].phys_base) {
 			IPADBG_LOW("reaping flt tbl (prev) pipe=%d\n", i);
-			ipahal_free_dma_mem(&tbl->prev_mem[rlt]);
+			ipa3_batch_free_dma_mem(&tbl->prev_mem[rlt]);
 		}
 
 		if (list_empty(&tbl->head_flt_rule_list)) {
 			if (tbl->curr_mem[rlt].phys_base) {
 				IPADBG_LOW("reaping flt tbl (curr) pipe=%d\n",
 					i);
-				ipahal_free_dma_mem(&tbl->curr_mem[rlt]);
+				ipa3_batch_free_dma_mem(&tbl->curr_mem[rlt]);
 			}
 		}
 	}
@@ -261,6 +278,7 @@ static int ipa_translate_flt_tbl_to_hw_fmt(enum ipa_ip_type ip,
 			tbl->curr_mem[rlt] = tbl_mem;
 		} else {
 			offset = body_i - base + body_ofst;
+			tbl->lcl_ofst[rlt] = body_i - base;
 
 			/* update the hdr at the right index */
 			if (ipahal_fltrt_write_addr_to_hdr(offset, hdr,
@@ -470,6 +488,358 @@ static bool ipa_flt_skip_pipe_config(int pipe)
 	return false;
 }
 
+/**
+ * ipa_flt_add_flush_cmds() - add the imm commands that should precede a flt
+ *  tables update: closing the coalescing frame and flushing the flt rules
+ *  cache
+ * @ip: the ip address family type
+ * @desc: descriptors array to fill
+ * @cmd_pyld: imm commands payload pointers array to fill
+ * @num_cmd: [IN/OUT] number of commands already in the arrays
+ *
+ * Return: 0 on success, negative on failure
+ */
+static int ipa_flt_add_flush_cmds(enum ipa_ip_type ip, struct ipa3_desc *desc,
+	struct ipahal_imm_cmd_pyld **cmd_pyld, int *num_cmd)
+{
+	struct ipahal_imm_cmd_register_write reg_write_cmd = {0};
+	struct ipahal_imm_cmd_register_write reg_write_coal_close;
+	struct ipahal_reg_valmask valmask;
+	int i;
+
+	/* IC to close the coal frame before HPS Clear if coal is enabled */
+	if (ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS) != -1
+		&& !ipa3_ctx->ulso_wa) {
+		u32 offset = 0;
+
+		i = ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS);
+		reg_write_coal_close.skip_pipeline_clear = false;
+		reg_write_coal_close.pipeline_clear_options = IPAHAL_HPS_CLEAR;
+		if (ipa3_ctx->ipa_hw_type < IPA_HW_v5_0)
+			offset = ipahal_get_reg_ofst(
+				IPA_AGGR_FORCE_CLOSE);
+		else
+			offset = ipahal_get_ep_reg_offset(
+				IPA_AGGR_FORCE_CLOSE_n, i);
+		reg_write_coal_close.offset = offset;
+		ipahal_get_aggr_force_close_valmask(i, &valmask);
+		reg_write_coal_close.value = valmask.val;
+		reg_write_coal_close.value_mask = valmask.mask;
+		cmd_pyld[*num_cmd] = ipahal_construct_imm_cmd(
+			IPA_IMM_CMD_REGISTER_WRITE,
+			&reg_write_coal_close, false);
+		if (!cmd_pyld[*num_cmd]) {
+			IPAERR("failed to construct coal close IC\n");
+			return -ENOMEM;
+		}
+		ipa3_init_imm_cmd_desc(&desc[*num_cmd], cmd_pyld[*num_cmd]);
+		++(*num_cmd);
+	}
+
+	/*
+	 * SRAM memory not allocated to hash tables. Sending
+	 * command to hash tables(filer/routing) operation not supported.
+	 */
+	if (!ipa3_ctx->ipa_fltrt_not_hashable) {
+		/* flushing ipa internal hashable flt rules cache */
+		if (ipa3_ctx->ipa_hw_type >= IPA_HW_v5_0) {
+			struct ipahal_reg_fltrt_cache_flush flush_cache;
+
+			memset(&flush_cache, 0, sizeof(flush_cache));
+			flush_cache.flt = true;
+			ipahal_get_fltrt_cache_flush_valmask(
+				&flush_cache, &valmask);
+			reg_write_cmd.offset = ipahal_get_reg_ofst(
+				IPA_FILT_ROUT_CACHE_FLUSH);
+		} else {
+			struct ipahal_reg_fltrt_hash_flush flush_hash;
+
+			memset(&flush_hash, 0, sizeof(flush_hash));
+			if (ip == IPA_IP_v4)
+				flush_hash.v4_flt = true;
+			else
+				flush_hash.v6_flt = true;
+			ipahal_get_fltrt_hash_flush_valmask(
+				&flush_hash, &valmask);
+			reg_write_cmd.offset = ipahal_get_reg_ofst(
+				IPA_FILT_ROUT_HASH_FLUSH);
+		}
+		reg_write_cmd.skip_pipeline_clear = false;
+		reg_write_cmd.pipeline_clear_options = IPAHAL_HPS_CLEAR;
+		reg_write_cmd.value = valmask.val;
+		reg_write_cmd.value_mask = valmask.mask;
+		cmd_pyld[*num_cmd] = ipahal_construct_imm_cmd(
+				IPA_IMM_CMD_REGISTER_WRITE, &reg_write_cmd,
+							false);
+		if (!cmd_pyld[*num_cmd]) {
+			IPAERR(
+			"fail construct register_write imm cmd: IP %d\n", ip);
+			return -EFAULT;
+		}
+		ipa3_init_imm_cmd_desc(&desc[*num_cmd], cmd_pyld[*num_cmd]);
+		++(*num_cmd);
+	}
+
+	return 0;
+}
+
+/**
+ * ipa_flt_gen_tbl_bdy() - generate the body of a single flt table into a
+ *  newly allocated DMA buffer
+ * @ip: the ip address family type
+ * @tbl: the flt tbl, already prepared for commit
+ * @rlt: the type of the rules to generate (hashable or non-hashable)
+ * @mem: [OUT] the generated body
+ *
+ * Return: 0 on success, negative on failure
+ */
+static int ipa_flt_gen_tbl_bdy(enum ipa_ip_type ip, struct ipa3_flt_tbl *tbl,
+	enum ipa_rule_type rlt, struct ipa_mem_buffer *mem)
+{
+	struct ipa3_flt_entry *entry;
+	u8 *bdy_i;
+
+	/* only body (no header) */
+	mem->size = tbl->sz[rlt] - ipahal_get_hw_tbl_hdr_width();
+	if (tbl->in_sys[rlt] || tbl->force_sys[rlt])
+		mem->size += ipahal_get_hw_prefetch_buf_size();
+	if (ipahal_fltrt_allocate_hw_sys_tbl(mem)) {
+		IPAERR("fail to alloc tbl bdy of size %d\n", mem->size);
+		return -ENOMEM;
+	}
+
+	bdy_i = mem->base;
+	list_for_each_entry(entry, &tbl->head_flt_rule_list, link) {
+		if (IPA_FLT_GET_RULE_TYPE(entry) != rlt)
+			continue;
+		if (ipa3_generate_flt_hw_rule(ip, entry, bdy_i)) {
+			IPAERR("failed to gen HW FLT rule\n");
+			ipahal_free_dma_mem(mem);
+			return -EPERM;
+		}
+		bdy_i += entry->hw_len;
+	}
+
+	return 0;
+}
+
+/**
+ * ipa_flt_commit_delta() - commit only the flt tables that changed since the
+ *  last commit
+ * @ip: the ip address family type
+ *
+ * Same scheme as the rt delta commit: only the bodies of the changed pipe
+ *  tables are rebuilt, system bodies are referenced via their own header
+ *  entry and local bodies are rewritten in place if their size is unchanged.
+ *  The placement of the tables (force_sys) is kept as decided by the last
+ *  full commit.
+ *
+ * Return: 0 on success, -EAGAIN if a full commit is needed instead,
+ *  other negative value on failure
+ */
+static int ipa_flt_commit_delta(enum ipa_ip_type ip)
+{
+	struct ipa3_desc desc[IPA_FLT_MAX_IMM_CMD_CHAIN_LENGTH];
+	struct ipahal_imm_cmd_pyld
+		*cmd_pyld[IPA_FLT_MAX_IMM_CMD_CHAIN_LENGTH];
+	struct ipahal_imm_cmd_dma_shared_mem mem_cmd = {0};
+	struct ipa_flt_delta_bdy bdy[IPA_FLT_MAX_NUM_OF_DELTA_BDYS];
+	struct ipa_mem_buffer hdr_mem = {0};
+	struct ipa3_flt_tbl *tbl;
+	u32 lcl_hdr[IPA_RULE_TYPE_MAX], lcl_bdy[IPA_RULE_TYPE_MAX];
+	u32 prev_sz[IPA_RULE_TYPE_MAX];
+	u32 tbl_hdr_width;
+	bool lcl;
+	int num_bdy = 0, num_cmd = 0;
+	int hdr_idx = 0;
+	int rlt, i;
+	int rc = -EAGAIN;
+
+	tbl_hdr_width = ipahal_get_hw_tbl_hdr_width();
+	memset(desc, 0, sizeof(desc));
+	memset(cmd_pyld, 0, sizeof(cmd_pyld));
+
+	if (ip == IPA_IP_v4) {
+		lcl_hdr[IPA_RULE_HASHABLE] = ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(v4_flt_hash_ofst) +
+			tbl_hdr_width; /* to skip the bitmap */
+		lcl_hdr[IPA_RULE_NON_HASHABLE] =
+			ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(v4_flt_nhash_ofst) +
+			tbl_hdr_width; /* to skip the bitmap */
+		lcl_bdy[IPA_RULE_HASHABLE] = ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(apps_v4_flt_hash_ofst);
+		lcl_bdy[IPA_RULE_NON_HASHABLE] =
+			ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(apps_v4_flt_nhash_ofst);
+	} else {
+		lcl_hdr[IPA_RULE_HASHABLE] = ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(v6_flt_hash_ofst) +
+			tbl_hdr_width; /* to skip the bitmap */
+		lcl_hdr[IPA_RULE_NON_HASHABLE] =
+			ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(v6_flt_nhash_ofst) +
+			tbl_hdr_width; /* to skip the bitmap */
+		lcl_bdy[IPA_RULE_HASHABLE] = ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(apps_v6_flt_hash_ofst);
+		lcl_bdy[IPA_RULE_NON_HASHABLE] =
+			ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(apps_v6_flt_nhash_ofst);
+	}
+
+	for (i = 0; i < ipa3_ctx->ipa_num_pipes; i++) {
+		if (!ipa_is_ep_support_flt(i))
+			continue;
+
+		tbl = &ipa3_ctx->flt_tbl[i][ip];
+		if (!tbl->dirty) {
+			hdr_idx++;
+			continue;
+		}
+
+		/* the full commit does not update the hdr of these pipes */
+		if (ipa_flt_skip_pipe_config(i))
+			goto free_bdys;
+
+		prev_sz[IPA_RULE_HASHABLE] = tbl->sz[IPA_RULE_HASHABLE];
+		prev_sz[IPA_RULE_NON_HASHABLE] = tbl->sz[IPA_RULE_NON_HASHABLE];
+		if (ipa_prep_flt_tbl_for_cmt(ip, tbl, i))
+			goto free_bdys;
+
+		for (rlt = 0; rlt < IPA_RULE_TYPE_MAX; rlt++) {
+			if (!prev_sz[rlt] && !tbl->sz[rlt])
+				continue;
+
+			/*
+			 * header entries of empty tables point to the shared
+			 * empty table and local bodies cannot be moved
+			 */
+			lcl = !tbl->in_sys[rlt] && !tbl->force_sys[rlt];
+			if (!prev_sz[rlt] || !tbl->sz[rlt] ||
+				(lcl && tbl->sz[rlt] != prev_sz[rlt])) {
+				IPADBG_LOW("flt tbl pipe %d rlt %d resized %u->%u\n",
+					i, rlt, prev_sz[rlt], tbl->sz[rlt]);
+				goto free_bdys;
+			}
+
+			if (num_bdy == IPA_FLT_MAX_NUM_OF_DELTA_BDYS) {
+				IPADBG_LOW("too many flt tbls changed\n");
+				goto free_bdys;
+			}
+
+			if (lcl && (tbl->lcl_ofst[rlt] % tbl_hdr_width)) {
+				IPADBG_LOW("flt tbl pipe %d lcl ofst %u unaligned\n",
+					i, tbl->lcl_ofst[rlt]);
+				goto free_bdys;
+			}
+
+			if (ipa_flt_gen_tbl_bdy(ip, tbl, rlt,
+				&bdy[num_bdy].mem))
+				goto free_bdys;
+			bdy[num_bdy].tbl = tbl;
+			bdy[num_bdy].rlt = rlt;
+			bdy[num_bdy].hdr_idx = hdr_idx;
+			num_bdy++;
+		}
+		hdr_idx++;
+	}
+
+	if (!num_bdy) {
+		IPADBG_LOW("no flt tbl changes to commit. IP %d\n", ip);
+		rc = 0;
+		goto clear_dirty;
+	}
+
+	hdr_mem.size = num_bdy * tbl_hdr_width;
+	hdr_mem.base = dma_alloc_coherent(ipa3_ctx->pdev, hdr_mem.size,
+		&hdr_mem.phys_base, GFP_KERNEL);
+	if (!hdr_mem.base) {
+		IPAERR("fail to alloc DMA buff of size %d\n", hdr_mem.size);
+		goto free_bdys;
+	}
+
+	if (ipa_flt_add_flush_cmds(ip, desc, cmd_pyld, &num_cmd))
+		goto fail_imm_cmd_construct;
+
+	for (i = 0; i < num_bdy; i++) {
+		tbl = bdy[i].tbl;
+		rlt = bdy[i].rlt;
+		lcl = !tbl->in_sys[rlt] && !tbl->force_sys[rlt];
+
+		mem_cmd.is_read = false;
+		mem_cmd.skip_pipeline_clear = false;
+		mem_cmd.pipeline_clear_options = IPAHAL_HPS_CLEAR;
+		if (!lcl) {
+			if (ipahal_fltrt_write_addr_to_hdr(
+				bdy[i].mem.phys_base,
+				hdr_mem.base + i * tbl_hdr_width, 0, true)) {
+				IPAERR("fail to wrt sys tbl addr to hdr\n");
+				goto fail_imm_cmd_construct;
+			}
+			mem_cmd.size = tbl_hdr_width;
+			mem_cmd.system_addr = hdr_mem.phys_base +
+				i * tbl_hdr_width;
+			mem_cmd.local_addr = lcl_hdr[rlt] +
+				bdy[i].hdr_idx * tbl_hdr_width;
+		} else {
+			mem_cmd.size = tbl->sz[rlt] - tbl_hdr_width;
+			mem_cmd.system_addr = bdy[i].mem.phys_base;
+			mem_cmd.local_addr = lcl_bdy[rlt] + tbl->lcl_ofst[rlt];
+		}
+		IPADBG_LOW("flt tbl hdr idx %d rlt %d %s update size %u\n",
+			bdy[i].hdr_idx, rlt, lcl ? "bdy" : "hdr",
+			mem_cmd.size);
+		cmd_pyld[num_cmd] = ipahal_construct_imm_cmd(
+			IPA_IMM_CMD_DMA_SHARED_MEM, &mem_cmd, false);
+		if (!cmd_pyld[num_cmd]) {
+			IPAERR("fail construct dma_shared_mem cmd: IP = %d\n",
+				ip);
+			goto fail_imm_cmd_construct;
+		}
+		ipa3_init_imm_cmd_desc(&desc[num_cmd], cmd_pyld[num_cmd]);
+		++num_cmd;
+	}
+
+	if (ipa3_batch_send_cmd(num_cmd, desc)) {
+		IPAERR("fail to send immediate command\n");
+		rc = -EFAULT;
+		goto fail_imm_cmd_construct;
+	}
+
+	/* the new sys bodies are now referenced by the hw */
+	for (i = 0; i < num_bdy; i++) {
+		tbl = bdy[i].tbl;
+		rlt = bdy[i].rlt;
+		if (!tbl->in_sys[rlt] && !tbl->force_sys[rlt])
+			continue;
+		if (tbl->curr_mem[rlt].phys_base) {
+			WARN_ON(tbl->prev_mem[rlt].phys_base);
+			tbl->prev_mem[rlt] = tbl->curr_mem[rlt];
+		}
+		tbl->curr_mem[rlt] = bdy[i].mem;
+		memset(&bdy[i].mem, 0, sizeof(bdy[i].mem));
+	}
+	__ipa_reap_sys_flt_tbls(ip, IPA_RULE_HASHABLE);
+	__ipa_reap_sys_flt_tbls(ip, IPA_RULE_NON_HASHABLE);
+	rc = 0;
+
+fail_imm_cmd_construct:
+	for (i = 0; i < num_cmd; i++)
+		ipahal_destroy_imm_cmd(cmd_pyld[i]);
+	ipa3_batch_free_coherent(&hdr_mem);
+free_bdys:
+	for (i = 0; i < num_bdy; i++)
+		if (bdy[i].mem.phys_base)
+			ipa3_batch_free_dma_mem(&bdy[i].mem);
+	if (rc)
+		return rc;
+clear_dirty:
+	for (i = 0; i < ipa3_ctx->ipa_num_pipes; i++)
+		if (ipa_is_ep_support_flt(i))
+			ipa3_ctx->flt_tbl[i][ip].dirty = false;
+	return 0;
+}
+
 /**
  * __ipa_commit_flt_v3() - commit flt tables to the hw
  *  commit the headers and the bodies if are local with internal cache flushing.
@@ -484,7 +854,6 @@ int __ipa_commit_flt_v3(enum ipa_ip_type ip)
 	struct ipahal_fltrt_alloc_imgs_params alloc_params;
 	int rc = 0;
 	struct ipa3_desc *desc, *desc_to_send;
-	struct ipahal_imm_cmd_register_write reg_write_cmd = {0};
 	struct ipahal_imm_cmd_dma_shared_mem mem_cmd = {0};
 	struct ipahal_imm_cmd_pyld **cmd_pyld;
 	int num_cmd = 0, remaining_num_cmd = 0, num_cmd_to_send = 0;
@@ -493,12 +862,22 @@ int __ipa_commit_flt_v3(enum ipa_ip_type ip)
 	u32 lcl_hash_hdr, lcl_nhash_hdr;
 	u32 lcl_hash_bdy, lcl_nhash_bdy;
 	bool lcl_hash, lcl_nhash;
-	struct ipahal_reg_valmask valmask;
 	u32 tbl_hdr_width;
 	struct ipa3_flt_tbl *tbl;
 	struct ipa3_flt_tbl_nhash_lcl *lcl_tbl;
 	u16 entries;
-	struct ipahal_imm_cmd_register_write reg_write_coal_close;
+
+	if (!ipa3_ctx->flt_tbl_full_commit[ip]) {
+		rc = ipa_flt_commit_delta(ip);
+		if (rc != -EAGAIN) {
+			if (rc)
+				ipa3_ctx->flt_tbl_full_commit[ip] = true;
+			return rc;
+		}
+		IPADBG_LOW("flt delta commit not possible. IP %d\n", ip);
+		rc = 0;
+	}
+	ipa3_ctx->flt_tbl_full_commit[ip] = true;
 
 	tbl_hdr_width = ipahal_get_hw_tbl_hdr_width();
 	memset(&alloc_params, 0, sizeof(alloc_params));
@@ -607,79 +986,9 @@ int __ipa_commit_flt_v3(enum ipa_ip_type ip)
 		goto fail_size_valid;
 	}
 
-	/* IC to close the coal frame before HPS Clear if coal is enabled */
-	if (ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS) != -1
-		&& !ipa3_ctx->ulso_wa) {
-		u32 offset = 0;
-
-		i = ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS);
-		reg_write_coal_close.skip_pipeline_clear = false;
-		reg_write_coal_close.pipeline_clear_options = IPAHAL_HPS_CLEAR;
-		if (ipa3_ctx->ipa_hw_type < IPA_HW_v5_0)
-			offset = ipahal_get_reg_ofst(
-				IPA_AGGR_FORCE_CLOSE);
-		else
-			offset = ipahal_get_ep_reg_offset(
-				IPA_AGGR_FORCE_CLOSE_n, i);
-		reg_write_coal_close.offset = offset;
-		ipahal_get_aggr_force_close_valmask(i, &valmask);
-		reg_write_coal_close.value = valmask.val;
-		reg_write_coal_close.value_mask = valmask.mask;
-		cmd_pyld[num_cmd] = ipahal_construct_imm_cmd(
-			IPA_IMM_CMD_REGISTER_WRITE,
-			&reg_write_coal_close, false);
-		if (!cmd_pyld[num_cmd]) {
-			IPAERR("failed to construct coal close IC\n");
-			rc = -ENOMEM;
-			goto fail_reg_write_construct;
-		}
-		ipa3_init_imm_cmd_desc(&desc[num_cmd], cmd_pyld[num_cmd]);
-		++num_cmd;
-	}
-
-	/*
-	 * SRAM memory not allocated to hash tables. Sending
-	 * command to hash tables(filer/routing) operation not supported.
-	 */
-	if (!ipa3_ctx->ipa_fltrt_not_hashable) {
-		/* flushing ipa internal hashable flt rules cache */
-		if (ipa3_ctx->ipa_hw_type >= IPA_HW_v5_0) {
-			struct ipahal_reg_fltrt_cache_flush flush_cache;
-
-			memset(&flush_cache, 0, sizeof(flush_cache));
-			flush_cache.flt = true;
-			ipahal_get_fltrt_cache_flush_valmask(
-				&flush_cache, &valmask);
-			reg_write_cmd.offset = ipahal_get_reg_ofst(
-				IPA_FILT_ROUT_CACHE_FLUSH);
-		} else {
-			struct ipahal_reg_fltrt_hash_flush flush_hash;
-
-			memset(&flush_hash, 0, sizeof(flush_hash));
-			if (ip == IPA_IP_v4)
-				flush_hash.v4_flt = true;
-			else
-				flush_hash.v6_flt = true;
-			ipahal_get_fltrt_hash_flush_valmask(
-				&flush_hash, &valmask);
-			reg_write_cmd.offset = ipahal_get_reg_ofst(
-				IPA_FILT_ROUT_HASH_FLUSH);
-		}
-		reg_write_cmd.skip_pipeline_clear = false;
-		reg_write_cmd.pipeline_clear_options = IPAHAL_HPS_CLEAR;
-		reg_write_cmd.value = valmask.val;
-		reg_write_cmd.value_mask = valmask.mask;
-		cmd_pyld[num_cmd] = ipahal_construct_imm_cmd(
-				IPA_IMM_CMD_REGISTER_WRITE, &reg_write_cmd,
-							false);
-		if (!cmd_pyld[num_cmd]) {
-			IPAERR(
-			"fail construct register_write imm cmd: IP %d\n", ip);
-			rc = -EFAULT;
-			goto fail_imm_cmd_construct;
-		}
-		ipa3_init_imm_cmd_desc(&desc[num_cmd], cmd_pyld[num_cmd]);
-		++num_cmd;
+	if (ipa_flt_add_flush_cmds(ip, desc, cmd_pyld, &num_cmd)) {
+		rc = -ENOMEM;
+		goto fail_imm_cmd_construct;
 	}
 
 	hdr_idx = 0;
@@ -817,7 +1126,7 @@ int __ipa_commit_flt_v3(enum ipa_ip_type ip)
 			IPA_FLT_MAX_IMM_CMD_CHAIN_LENGTH : remaining_num_cmd;
 		remaining_num_cmd -= num_cmd_to_send;
 
-		if (ipa3_send_cmd(num_cmd_to_send, desc_to_send)) {
+		if (ipa3_batch_send_cmd(num_cmd_to_send, desc_to_send)) {
 			IPAERR("fail to send immediate command batch\n");
 			rc = -EFAULT;
 			goto fail_imm_cmd_construct;
@@ -850,20 +1159,24 @@ int __ipa_commit_flt_v3(enum ipa_ip_type ip)
 	__ipa_reap_sys_flt_tbls(ip, IPA_RULE_HASHABLE);
 	__ipa_reap_sys_flt_tbls(ip, IPA_RULE_NON_HASHABLE);
 
+	for (i = 0; i < ipa3_ctx->ipa_num_pipes; i++)
+		if (ipa_is_ep_support_flt(i))
+			ipa3_ctx->flt_tbl[i][ip].dirty = false;
+	ipa3_ctx->flt_tbl_full_commit[ip] = false;
+
 fail_imm_cmd_construct:
 	for (i = 0 ; i < num_cmd ; i++)
 		ipahal_destroy_imm_cmd(cmd_pyld[i]);
-fail_reg_write_construct:
 	kfree(desc);
 	kfree(cmd_pyld);
 fail_size_valid:
 	if (alloc_params.hash_hdr.size)
-		ipahal_free_dma_mem(&alloc_params.hash_hdr);
-	ipahal_free_dma_mem(&alloc_params.nhash_hdr);
+		ipa3_batch_free_dma_mem(&alloc_params.hash_hdr);
+	ipa3_batch_free_dma_mem(&alloc_params.nhash_hdr);
 	if (alloc_params.hash_bdy.size)
-		ipahal_free_dma_mem(&alloc_params.hash_bdy);
+		ipa3_batch_free_dma_mem(&alloc_params.hash_bdy);
 	if (alloc_params.nhash_bdy.size)
-		ipahal_free_dma_mem(&alloc_params.nhash_bdy);
+		ipa3_batch_free_dma_mem(&alloc_params.nhash_bdy);
 prep_failed:
 	return rc;
 }
@@ -1019,6 +1332,7 @@ static int __ipa_finish_flt_rule_add(struct ipa3_flt_tbl *tbl,
 	}
 	*rule_hdl = id;
 	entry->id = id;
+	tbl->dirty = true;
 	IPADBG_LOW("add flt rule rule_cnt=%d\n", tbl->rule_cnt);
 
 	return 0;
@@ -1136,6 +1450,7 @@ static int __ipa_del_flt_rule(u32 rule_hdl)
 
 	list_del(&entry->link);
 	entry->tbl->rule_cnt--;
+	entry->tbl->dirty = true;
 	if (entry->rt_tbl && !ipa3_check_idr_if_freed(entry->rt_tbl))
 		entry->rt_tbl->ref_cnt--;
 	IPADBG("del flt rule rule_cnt=%d rule_id=%d\n",
@@ -1183,6 +1498,7 @@ static int __ipa_mdfy_flt_rule(struct ipa_flt_rule_mdfy_i *frule,
 		entry->rt_tbl->ref_cnt++;
 	entry->hw_len = 0;
 	entry->prio = 0;
+	entry->tbl->dirty = true;
 	if (frule->rule.enable_stats)
 		entry->cnt_idx = frule->rule.cnt_idx;
 	else
@@ -1898,6 +2214,7 @@ int ipa3_reset_flt(enum ipa_ip_type ip, bool user_only)
 	}
 
 	mutex_lock(&ipa3_ctx->lock);
+	ipa3_ctx->flt_tbl_full_commit[ip] = true;
 	for (i = 0; i < ipa3_ctx->ipa_num_pipes; i++) {
 		if (!ipa_is_ep_support_flt(i))
 			continue;
@@ -2243,6 +2560,9 @@ int ipa_flt_sram_set_client_prio_high(enum ipa_client_type client)
 	for (ip = IPA_IP_v4; ip < IPA_IP_MAX; ip++) {
 		struct ipa3_flt_tbl_nhash_lcl *lcl_tbl, *tmp;
 		struct ipa3_flt_tbl *flt_tbl = &ipa3_ctx->flt_tbl[ipa_ep_idx][ip];
+
+		/* SRAM placement is decided again on the next full commit */
+		ipa3_ctx->flt_tbl_full_commit[ip] = true;
 		/* Position filtering table last in the list so, it will have first SRAM priority */
 		list_for_each_entry_safe(
 			lcl_tbl, tmp, &ipa3_ctx->flt_tbl_nhash_lcl_list[ip], link) {
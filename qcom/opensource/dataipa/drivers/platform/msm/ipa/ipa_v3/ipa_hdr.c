@@ -4,6 +4,7 @@
  * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
  */
 
+#include <linux/hashtable.h>
 #include "ipa_i.h"
 #include "ipahal.h"
 
@@ -355,18 +356,14 @@ int __ipa_commit_hdr_v3_0(void)
 	++num_cmd;
 	IPA_DUMP_BUFF(ctx_mem.base, ctx_mem.phys_base, ctx_mem.size);
 
-	if (ipa3_send_cmd(num_cmd, desc))
+	if (ipa3_batch_send_cmd(num_cmd, desc))
 		IPAERR("fail to send immediate command\n");
 	else
 		rc = 0;
 
 	if (!rc && hdr_mem[HDR_TBL_SYS].base) {
-		if (ipa3_ctx->hdr_sys_mem.phys_base) {
-			dma_free_coherent(ipa3_ctx->pdev,
-					  ipa3_ctx->hdr_sys_mem.size,
-					  ipa3_ctx->hdr_sys_mem.base,
-					  ipa3_ctx->hdr_sys_mem.phys_base);
-		}
+		if (ipa3_ctx->hdr_sys_mem.phys_base)
+			ipa3_batch_free_coherent(&ipa3_ctx->hdr_sys_mem);
 		ipa3_ctx->hdr_sys_mem = hdr_mem[HDR_TBL_SYS];
 	}
 
@@ -376,15 +373,12 @@ int __ipa_commit_hdr_v3_0(void)
         }
 
 	if (ipa3_ctx->hdr_proc_ctx_tbl_lcl) {
-		dma_free_coherent(ipa3_ctx->pdev, ctx_mem.size, ctx_mem.base,
-			ctx_mem.phys_base);
+		ipa3_batch_free_coherent(&ctx_mem);
 	} else {
 		if (!rc) {
 			if (ipa3_ctx->hdr_proc_ctx_mem.phys_base)
-				dma_free_coherent(ipa3_ctx->pdev,
-					ipa3_ctx->hdr_proc_ctx_mem.size,
-					ipa3_ctx->hdr_proc_ctx_mem.base,
-					ipa3_ctx->hdr_proc_ctx_mem.phys_base);
+				ipa3_batch_free_coherent(
+					&ipa3_ctx->hdr_proc_ctx_mem);
 			ipa3_ctx->hdr_proc_ctx_mem = ctx_mem;
 		}
 		else {
@@ -403,12 +397,8 @@ free_dma:
 	}
 
 end:
-	if (hdr_mem[HDR_TBL_LCL].base) {
-		dma_free_coherent(ipa3_ctx->pdev,
-				  hdr_mem[HDR_TBL_LCL].size,
-				  hdr_mem[HDR_TBL_LCL].base,
-				  hdr_mem[HDR_TBL_LCL].phys_base);
-	}
+	if (hdr_mem[HDR_TBL_LCL].base)
+		ipa3_batch_free_coherent(&hdr_mem[HDR_TBL_LCL]);
 
 	if (coal_cmd_pyld)
 		ipahal_destroy_imm_cmd(coal_cmd_pyld);
@@ -559,16 +549,60 @@ bad_len:
 	return -EPERM;
 }
 
+static struct ipa3_hdr_entry *__ipa_find_hdr_in_list(const char *name)
+{
+	struct ipa3_hdr_entry *entry;
+	enum hdr_tbl_storage hdr_tbl_loc;
+
+	for (hdr_tbl_loc = HDR_TBL_LCL; hdr_tbl_loc < HDR_TBLS_TOTAL; hdr_tbl_loc++) {
+		list_for_each_entry(entry,
+				    &ipa3_ctx->hdr_tbl[hdr_tbl_loc].head_hdr_entry_list,
+				    link) {
+			if (!strcmp(name, entry->name))
+				return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Kernel clients may add headers with the same name. The hash does not
+ * keep the list order, so on a duplicate the lists are walked to return
+ * the same entry as before the hash was added.
+ */
+static struct ipa3_hdr_entry *__ipa_find_hdr(const char *name)
+{
+	struct ipa3_hdr_entry *entry, *found = NULL;
+
+	if (strnlen(name, IPA_RESOURCE_NAME_MAX) == IPA_RESOURCE_NAME_MAX) {
+		IPAERR_RL("Header name too long: %s\n", name);
+		return NULL;
+	}
+
+	ipa3_ctx->stats.name_lookup_cnt++;
+	hash_for_each_possible(ipa3_ctx->hdr_name_htable, entry, name_node,
+		ipa3_name_hkey(name)) {
+		ipa3_ctx->stats.name_lookup_cmp_cnt++;
+		if (strcmp(name, entry->name))
+			continue;
+		if (found)
+			return __ipa_find_hdr_in_list(name);
+		found = entry;
+	}
+
+	return found;
+}
+
 static int __ipa_add_hdr(struct ipa_hdr_add *hdr, bool user,
 	struct ipa3_hdr_entry **entry_out)
 {
-	struct ipa3_hdr_entry *entry, *entry_t, *next;
+	struct ipa3_hdr_entry *entry, *entry_t;
 	struct ipa_hdr_offset_entry *offset = NULL;
 	u32 bin;
 	struct ipa3_hdr_tbl *htbl;
 	int id;
 	int mem_size;
-	enum hdr_tbl_storage hdr_tbl_loc;
 
 	if (hdr->hdr_len > IPA_HDR_MAX_SIZE) {
 		IPAERR_RL("bad param\n");
@@ -600,23 +634,17 @@ static int __ipa_add_hdr(struct ipa_hdr_add *hdr, bool user,
 			 !IPA_MEM_PART(apps_hdr_size)) ? false : true;
 
 	/* check to see if adding header entry with duplicate name */
-	for (hdr_tbl_loc = HDR_TBL_LCL; hdr_tbl_loc < HDR_TBLS_TOTAL; hdr_tbl_loc++) {
-		list_for_each_entry_safe(entry_t, next,
-			&ipa3_ctx->hdr_tbl[hdr_tbl_loc].head_hdr_entry_list, link) {
+	entry_t = user ? __ipa_find_hdr(entry->name) : NULL;
+	if (entry_t) {
+		IPAERR("IPACM Trying to add hdr %s len=%d, duplicate entry, return old one\n",
+			entry->name, entry->hdr_len);
 
-			/* return if adding the same name */
-			if (!strcmp(entry_t->name, entry->name) && (user == true)) {
-				IPAERR("IPACM Trying to add hdr %s len=%d, duplicate entry, return old one\n",
-					entry->name, entry->hdr_len);
+		/* return the original entry */
+		if (entry_out)
+			*entry_out = entry_t;
 
-				/* return the original entry */
-				if (entry_out)
-					*entry_out = entry_t;
-
-				kmem_cache_free(ipa3_ctx->hdr_cache, entry);
-				return 0;
-			}
-		}
+		kmem_cache_free(ipa3_ctx->hdr_cache, entry);
+		return 0;
 	}
 
 	if (hdr->hdr_len <= ipa_hdr_bin_sz[IPA_HDR_BIN0])
@@ -711,6 +739,8 @@ create_entry:
 free_list:
 
 	list_add(&entry->link, &htbl->head_hdr_entry_list);
+	hash_add(ipa3_ctx->hdr_name_htable, &entry->name_node,
+		ipa3_name_hkey(entry->name));
 	htbl->hdr_cnt++;
 	IPADBG("add hdr of sz=%d hdr_cnt=%d ofst=%d to %s table\n",
 			hdr->hdr_len,
@@ -739,6 +769,7 @@ ipa_insert_failed:
 	entry->offset_entry = NULL;
 	htbl->hdr_cnt--;
 	list_del(&entry->link);
+	hash_del(&entry->name_node);
 
 bad_hdr_len:
 	entry->cookie = 0;
@@ -873,6 +904,7 @@ int __ipa3_del_hdr(u32 hdr_hdl, bool by_user)
 		list_move(&entry->offset_entry->link,
 			&htbl->head_free_offset_list[entry->offset_entry->bin]);
 	list_del(&entry->link);
+	hash_del(&entry->name_node);
 	htbl->hdr_cnt--;
 	entry->cookie = 0;
 	kmem_cache_free(ipa3_ctx->hdr_cache, entry);
@@ -1334,6 +1366,7 @@ int ipa3_reset_hdr(bool user_only)
 
 				/* delete the hdr entry from headers list */
 				list_del(&entry->link);
+				hash_del(&entry->name_node);
 				ipa3_ctx->hdr_tbl[hdr_tbl_loc].hdr_cnt--;
 				entry->ref_cnt = 0;
 				entry->cookie = 0;
@@ -1439,27 +1472,6 @@ int ipa3_reset_hdr(bool user_only)
 	return 0;
 }
 
-static struct ipa3_hdr_entry *__ipa_find_hdr(const char *name)
-{
-	struct ipa3_hdr_entry *entry;
-	enum hdr_tbl_storage hdr_tbl_loc;
-
-	if (strnlen(name, IPA_RESOURCE_NAME_MAX) == IPA_RESOURCE_NAME_MAX) {
-		IPAERR_RL("Header name too long: %s\n", name);
-		return NULL;
-	}
-	for (hdr_tbl_loc = HDR_TBL_LCL; hdr_tbl_loc < HDR_TBLS_TOTAL; hdr_tbl_loc++) {
-		list_for_each_entry(entry,
-				    &ipa3_ctx->hdr_tbl[hdr_tbl_loc].head_hdr_entry_list,
-				    link) {
-			if (!strcmp(name, entry->name))
-				return entry;
-		}
-	}
-
-	return NULL;
-}
-
 static struct ipa3_hdr_proc_ctx_entry* __ipa_find_hdr_proc_ctx(const char *name)
 {
 	struct ipa3_hdr_entry *entry;
@@ -10,6 +10,7 @@
 #include "ipa_i.h"
 #include "ipahal.h"
 #include "ipahal_hw_stats.h"
+#include "ipa_stats.h"
 
 #define IPA_INIT_DROP_STATS_MAX_CMD_NUM 5
 #define IPA_INIT_TETH_STATS_MAX_CMD_NUM 5
@@ -790,6 +791,8 @@ int ipa_get_quota_stats(struct ipa_quota_stats_all *out)
 			stats->stats[ep_idx].num_ipv6_pkts;
 	}
 
+	ipa_hw_stats_shm_publish();
+
 	/* copy results to out parameter */
 	if (out)
 		*out = ipa3_ctx->hw_stats->quota.stats;
@@ -1246,6 +1249,8 @@ int ipa_get_teth_stats(void)
 		}
 	}
 
+	ipa_hw_stats_shm_publish();
+
 	ret = 0;
 free_stats:
 	vfree(stats_all);
@@ -2212,6 +2217,7 @@ int ipa_get_drop_stats(struct ipa_drop_stats_all *out)
 			stats->stats[ep_idx].drop_packet_cnt;
 	}
 
+	ipa_hw_stats_shm_publish();
 
 	if (!out) {
 		ret = 0;
@@ -15,6 +15,7 @@
 #include <linux/list.h>
 #include <linux/mutex.h>
 #include <linux/skbuff.h>
+#include <linux/shrinker.h>
 #include <linux/slab.h>
 #include <linux/notifier.h>
 #include <linux/interrupt.h>
@@ -291,6 +292,7 @@ enum hdr_tbl_storage {
 #define IPA3_ACTIVE_CLIENTS_LOG_LINE_LEN 96
 #define IPA3_ACTIVE_CLIENTS_LOG_HASHTABLE_SIZE 50
 #define IPA3_ACTIVE_CLIENTS_LOG_NAME_LEN 40
+#define IPA3_NAME_HASHTABLE_SIZE 64
 #define SMEM_IPA_FILTER_TABLE 497
 #define IPA_TX_WRAPPER_CACHE_MAX_THRESHOLD 2000
 
@@ -615,12 +617,14 @@ enum ipa_icc_type {
  * @dma_addr: DMA address of this Rx packet
  * @is_tmp_alloc: skb page from tmp_alloc or recycle_list
  * @page_order: page order associated with the page.
+ * @is_pooled: former tmp_alloc page kept mapped in the page pool
  */
 struct ipa_rx_page_data {
 	struct page *page;
 	dma_addr_t dma_addr;
 	bool is_tmp_alloc;
 	u32 page_order;
+	bool is_pooled;
 };
 
 struct ipa3_active_client_htable_entry {
@@ -793,6 +797,10 @@ struct ipa3_flt_entry {
  * @prev_mem: previous routing table block in sys memory
  * @id: routing table id
  * @rule_ids: common idr structure that holds the rule_id for each rule
+ * @dirty: rules were added, deleted or modified since the last commit
+ * @lcl_ofst: offset of the table body in the local (sram) bodies block,
+ *  valid as of the last full commit
+ * @name_node: entry's node in the routing tables set name hashtable
  */
 struct ipa3_rt_tbl {
 	struct list_head link;
@@ -809,6 +817,9 @@ struct ipa3_rt_tbl {
 	struct ipa_mem_buffer prev_mem[IPA_RULE_TYPE_MAX];
 	int id;
 	struct idr *rule_ids;
+	bool dirty;
+	u32 lcl_ofst[IPA_RULE_TYPE_MAX];
+	struct hlist_node name_node;
 };
 
 /**
@@ -829,6 +840,7 @@ struct ipa3_rt_tbl {
  * @user_deleted: is the header deleted by the user?
  * @ipacm_installed: indicate if installed by ipacm
  * @is_lcl: is the entry in the SRAM?
+ * @name_node: entry's node in the global header name hashtable
  */
 struct ipa3_hdr_entry {
 	struct list_head link;
@@ -847,6 +859,7 @@ struct ipa3_hdr_entry {
 	bool user_deleted;
 	bool ipacm_installed;
 	bool is_lcl;
+	struct hlist_node name_node;
 };
 
 /**
@@ -937,6 +950,9 @@ struct ipa3_hdr_proc_ctx_tbl {
  * @rule_ids: common idr structure that holds the rule_id for each rule
  * @force_sys: flag indicating if filter table is forced to be
 			located in system memory
+ * @dirty: rules were added, deleted or modified since the last commit
+ * @lcl_ofst: offset of the table body in the local (sram) bodies block,
+ *  valid as of the last full commit
  */
 struct ipa3_flt_tbl {
 	struct list_head head_flt_rule_list;
@@ -948,6 +964,8 @@ struct ipa3_flt_tbl {
 	bool sticky_rear;
 	struct idr *rule_ids;
 	bool force_sys[IPA_RULE_TYPE_MAX];
+	bool dirty;
+	u32 lcl_ofst[IPA_RULE_TYPE_MAX];
 };
 
 struct ipa3_flt_tbl_nhash_lcl {
@@ -993,11 +1011,13 @@ struct ipa3_rt_entry {
  * @head_rt_tbl_list: collection of routing tables
  * @tbl_cnt: number of routing tables
  * @rule_ids: idr structure that holds the rule_id for each rule
+ * @name_htable: routing tables hashed by name
  */
 struct ipa3_rt_tbl_set {
 	struct list_head head_rt_tbl_list;
 	u32 tbl_cnt;
 	struct idr rule_ids;
+	struct hlist_head name_htable[IPA3_NAME_HASHTABLE_SIZE];
 };
 
 /**
@@ -1076,6 +1096,8 @@ struct ipa3_status_stats {
  *        notified for new data avail
  * @client_notify: user provided CB for EP events notification, the event is
  *                 data revived.
+ * @client_notify_list: optional CB taking the data of a whole NAPI poll as
+ *                 an sk_buff list, see ipa3_set_rx_list_notify()
  * @skip_ep_cfg: boolean field that determines if EP should be configured
  *  by IPA driver
  * @keep_ipa_awake: when true, IPA will not be clock gated
@@ -1102,6 +1124,7 @@ struct ipa3_ep_context {
 	void *priv;
 	void (*client_notify)(void *priv, enum ipa_dp_evt_type evt,
 		       unsigned long data);
+	void (*client_notify_list)(void *priv, struct list_head *skbs);
 	atomic_t avail_fifo_desc;
 	u32 dflt_flt4_rule_hdl;
 	u32 dflt_flt6_rule_hdl;
@@ -1165,17 +1188,88 @@ struct ipa3_repl_ctx {
 	atomic_t pending;
 };
 
+/**
+ * struct ipa3_page_pool_cpu - per-CPU list of a page pool
+ * @lock: protects the list and its count
+ * @page_head: pooled rx_pkt wrappers, either idle or still held by the stack
+ * @cnt: number of wrappers on the list
+ */
+struct ipa3_page_pool_cpu {
+	spinlock_t lock;
+	struct list_head page_head;
+	u32 cnt;
+};
+
+/**
+ * struct ipa3_page_pool - DMA mapped tmp_alloc pages kept for reuse
+ * @cpu: per-CPU lists, each filled by the CPU completing the pages
+ * @page_order: order of the pages kept in the pool
+ * @cnt: number of pages on all the lists
+ * @shrinker: releases idle pages under memory pressure
+ */
+struct ipa3_page_pool {
+	struct ipa3_page_pool_cpu __percpu *cpu;
+	u32 page_order;
+	atomic_t cnt;
+	struct shrinker shrinker;
+};
+
 struct ipa3_page_repl_ctx {
 	struct list_head page_repl_head;
 	u32 capacity;
 	atomic_t pending;
+	struct ipa3_page_pool *pool;
+};
+
+/**
+ * struct ipa3_rx_dim - adaptive interrupt moderation of a rx pipe
+ * @enabled: moderation of the pipe event ring is tuned at run time
+ * @tuned: the event ring moderation was changed from the static one
+ * @profile: index of the moderation profile applied to the event ring
+ * @init_profile: profile matching the static moderation of the pipe
+ * @int_modt: static moderation timer of the event ring
+ * @int_modc: static moderation counter of the event ring
+ * @events: interrupts taken in the current sample window
+ * @pkts: completions polled in the current sample window
+ * @window_start: start time of the current sample window
+ */
+struct ipa3_rx_dim {
+	bool enabled;
+	bool tuned;
+	u32 profile;
+	u32 init_profile;
+	u16 int_modt;
+	u8 int_modc;
+	u32 events;
+	u32 pkts;
+	ktime_t window_start;
+};
+
+/**
+ * struct ipa3_tx_ring - single producer / single consumer ring of tx wrappers
+ * @pkt: wrapper slots, one per GSI TRE in submission order
+ * @mask: number of slots minus one, the number of slots is a power of 2
+ * @head: next slot to fill, advanced by the submit side only
+ * @tail: next slot to complete, advanced by the completion side only
+ * @compl_lock: serializes completion contexts sharing an event ring
+ *
+ * Submitters still serialize among themselves under the pipe spinlock and
+ * completion contexts under @compl_lock, but the two sides only meet
+ * through the acquire/release ordering of @head and @tail.
+ */
+struct ipa3_tx_ring {
+	struct ipa3_tx_pkt_wrapper *pkt;
+	u32 mask;
+	u32 head;
+	u32 tail ____cacheline_aligned_in_smp;
+	spinlock_t compl_lock;
 };
 
 /**
  * struct ipa3_sys_context - IPA GPI pipes context
- * @head_desc_list: header descriptors list
- * @len: the size of the above list
- * @spinlock: protects the list and its size
+ * @head_desc_list: header descriptors list (IPA DMA consumer pipes)
+ * @len: the size of the above list, or the number of posted rx buffers
+ * @spinlock: protects the list, its size and the tx submit side
  * @ep: IPA EP context
  * @xmit_eot_cnt: count of pending eot for tasklet to process
  * @tasklet: tasklet for eot write_done handle (tx_complete)
@@ -1188,6 +1282,10 @@ struct ipa3_page_repl_ctx {
  * @buff_size: rx packet length
  * @page_order: page order of the rx pipe based on the ioctl version
  * @ext_ioctl_v2: specifies if it's new version of ingress/egress ioctl
+ * @dim: adaptive interrupt moderation state of rx pipes
+ * @db_pending: descriptors queued on a tx pipe since its last doorbell
+ * @db_flush_timer: rings the doorbell of descriptors left pending by a burst
+ * @tx_ring: wrappers of the descriptors in flight on a tx pipe
  *
  * IPA context specific to the GPI pipes a.k.a LAN IN/OUT and WAN
  */
@@ -1237,15 +1335,17 @@ struct ipa3_sys_context {
 	struct ipa3_sys_context *common_sys;
 	atomic_t page_avilable;
 	u32 napi_sort_page_thrshld_cnt;
+	struct ipa3_rx_dim dim;
+	u32 db_pending;
+	struct ipa3_tx_ring tx_ring;
 
 	/* ordering is important - mutable fields go above */
 	struct ipa3_ep_context *ep;
 	struct list_head head_desc_list;
 	struct list_head rcycl_list;
-	struct list_head avail_tx_wrapper_list;
-	u32 avail_tx_wrapper;
 	spinlock_t spinlock;
 	struct hrtimer db_timer;
+	struct hrtimer db_flush_timer;
 	struct workqueue_struct *wq;
 	struct workqueue_struct *repl_wq;
 	struct ipa3_status_stats *status_stat;
@@ -1274,7 +1374,6 @@ enum ipa3_desc_type {
  * struct ipa3_tx_pkt_wrapper - IPA Tx packet wrapper
  * @type: specify if this packet is for the skb or immediate command
  * @mem: memory buffer used by this Tx packet
- * @link: linked to the wrappers on that pipe
  * @callback: IPA client provided callback
  * @user1: cookie1 for above callback
  * @user2: cookie2 for above callback
@@ -1291,7 +1390,6 @@ enum ipa3_desc_type {
 struct ipa3_tx_pkt_wrapper {
 	enum ipa3_desc_type type;
 	struct ipa_mem_buffer mem;
-	struct list_head link;
 	void (*callback)(void *user1, int user2);
 	void *user1;
 	int user2;
@@ -1569,6 +1667,22 @@ struct ipa3_page_recycle_stats {
 	u64 total_replenished;
 	u64 page_recycled;
 	u64 tmp_alloc;
+	u64 pool_hit;
+	u64 pool_miss;
+};
+
+struct ipa3_rx_dim_stats {
+	u32 profile;
+	u32 ppi;
+	u32 gap_us;
+	u64 step_up;
+	u64 step_down;
+};
+
+struct ipa3_tx_db_stats {
+	u64 pkts;
+	u64 doorbells;
+	u64 timer_flush;
 };
 
 struct ipa3_cache_recycle_stats {
@@ -1624,6 +1738,8 @@ struct ipa3_stats {
 	u32 rx_page_drop_cnt;
 	u64 lower_order;
 	u32 pipe_setup_fail_cnt;
+	u32 commit_tables;
+	u32 commit_tables_waits;
 	struct ipa3_page_recycle_stats page_recycle_stats[3];
 	struct ipa3_cache_recycle_stats cache_recycle_stats[3];
 	u64 page_recycle_cnt[3][IPA_PAGE_POLL_THRESHOLD_MAX];
@@ -1638,7 +1754,12 @@ struct ipa3_stats {
 	u64 num_sort_tasklet_sched[3];
 	u64 num_of_times_wq_reschd;
 	u64 page_recycle_cnt_in_tasklet;
+	u64 page_pool_shrunk;
+	struct ipa3_rx_dim_stats rx_dim[IPA5_MAX_NUM_PIPES];
+	struct ipa3_tx_db_stats tx_db[IPA5_MAX_NUM_PIPES];
 	u32 ttl_cnt;
+	u32 name_lookup_cnt;
+	u32 name_lookup_cmp_cnt;
 };
 
 /* offset for each stats */
@@ -1684,6 +1805,39 @@ struct ipa3_tag_completion {
 	atomic_t cnt;
 };
 
+/* commands of a whole transaction, half the APPS_CMD_PROD ring */
+#define IPA3_CMD_BATCH_MAX_DESC 64
+/* keep below IPA_SEND_MAX_DESC, same as the flt commit chains */
+#define IPA3_CMD_BATCH_CHAIN_LEN 10
+
+/* tables selection for ipa3_commit_tables() */
+#define IPA3_COMMIT_HDR BIT(0)
+#define IPA3_COMMIT_RT_V4 BIT(1)
+#define IPA3_COMMIT_RT_V6 BIT(2)
+#define IPA3_COMMIT_FLT_V4 BIT(3)
+#define IPA3_COMMIT_FLT_V6 BIT(4)
+#define IPA3_COMMIT_ALL (BIT(5) - 1)
+
+/**
+ * struct ipa3_cmd_batch - immediate commands of a table commit transaction
+ * @desc: queued descriptors, each with its own copy of the command payload
+ * @num_desc: number of queued descriptors
+ * @chain_len: number of descriptors of each chain, in @desc order
+ * @num_chain: number of queued chains
+ * @free_list: DMA buffers to free once the queued commands were processed
+ * @send_cnt: number of completion waits for this transaction
+ * @failed: a command chain failed to send, nothing more is queued
+ */
+struct ipa3_cmd_batch {
+	struct ipa3_desc desc[IPA3_CMD_BATCH_MAX_DESC];
+	u16 num_desc;
+	u16 chain_len[IPA3_CMD_BATCH_MAX_DESC];
+	u16 num_chain;
+	struct list_head free_list;
+	u32 send_cnt;
+	bool failed;
+};
+
 struct ipa3_controller;
 
 enum ipa_ees {
@@ -2221,6 +2375,7 @@ enum ipa_per_usb_enum_type_e {
  * @ipa_wrapper_size: size of the memory pointed to by ipa_wrapper_base
  * @ipa_cfg_offset: offset from IPA_WRAPPER_BASE to IPA registers
  * @hdr_tbl: IPA header table
+ * @hdr_name_htable: IPA header entries hashed by name
  * @hdr_proc_ctx_tbl: IPA processing context table
  * @rt_tbl_set: list of routing tables each of which is a list of rules
  * @reap_rt_tbl_set: list of sys mem routing tables waiting to be reaped
@@ -2232,10 +2387,10 @@ enum ipa_per_usb_enum_type_e {
  * @hdr_proc_ctx_cache: processing context cache
  * @hdr_proc_ctx_offset_cache: processing context offset cache
  * @rt_tbl_cache: routing table cache
- * @tx_pkt_wrapper_cache: Tx packets cache
  * @rx_pkt_wrapper_cache: Rx packets cache
  * @rt_idx_bitmap: routing table index bitmap
  * @lock: this does NOT protect the linked lists within ipa3_sys_context
+ * @cmd_batch: table commit transaction in progress, protected by @lock
  * @smem_sz: shared memory size available for SW use starting
  *  from non-restricted bytes
  * @smem_restricted_bytes: the bytes that SW should not use in the shared mem
@@ -2346,6 +2501,7 @@ struct ipa3_context {
 	u32 ipa_cfg_offset;
 	bool set_evict_reg;
 	struct ipa3_hdr_tbl hdr_tbl[HDR_TBLS_TOTAL];
+	struct hlist_head hdr_name_htable[IPA3_NAME_HASHTABLE_SIZE];
 	struct ipa3_hdr_proc_ctx_tbl hdr_proc_ctx_tbl;
 	struct ipa3_rt_tbl_set rt_tbl_set[IPA_IP_MAX];
 	struct ipa3_rt_tbl_set reap_rt_tbl_set[IPA_IP_MAX];
@@ -2357,7 +2513,6 @@ struct ipa3_context {
 	struct kmem_cache *hdr_proc_ctx_cache;
 	struct kmem_cache *hdr_proc_ctx_offset_cache;
 	struct kmem_cache *rt_tbl_cache;
-	struct kmem_cache *tx_pkt_wrapper_cache;
 	struct kmem_cache *rx_pkt_wrapper_cache;
 	unsigned long rt_idx_bitmap[IPA_IP_MAX];
 	struct mutex lock;
@@ -2380,6 +2535,9 @@ struct ipa3_context {
 	bool flt_tbl_hash_lcl[IPA_IP_MAX];
 	bool flt_tbl_nhash_lcl[IPA_IP_MAX];
 	struct list_head flt_tbl_nhash_lcl_list[IPA_IP_MAX];
+	bool rt_tbl_full_commit[IPA_IP_MAX];
+	bool flt_tbl_full_commit[IPA_IP_MAX];
+	struct ipa3_cmd_batch *cmd_batch;
 	struct ipa3_active_clients ipa3_active_clients;
 	struct ipa3_active_clients_log_ctx ipa3_active_clients_logging;
 	struct workqueue_struct *power_mgmt_wq;
@@ -2433,6 +2591,7 @@ struct ipa3_context {
 	spinlock_t idr_lock;
 	u32 enable_clock_scaling;
 	u32 enable_napi_chain;
+	u32 rx_dim_enable;
 	u32 curr_ipa_clk_rate;
 	bool q6_proxy_clk_vote_valid;
 	struct mutex q6_proxy_clk_vote_mutex;
@@ -3066,6 +3225,9 @@ int ipa3_del_hdr_by_user(struct ipa_ioc_del_hdr *hdls, bool by_user);
 
 int ipa3_commit_hdr(void);
 
+int ipa3_commit_tables(u32 tables);
+int ipa3_cmd_batch_send(struct ipa3_cmd_batch *batch);
+
 int ipa3_get_hdr_offset(char* name, u32* offset);
 
 int ipa3_get_hdr_proc_ctx_hdl(struct ipa_ioc_get_hdr *lookup);
@@ -3196,6 +3358,9 @@ int ipa3_set_single_ndp_per_mbim(bool enable);
 int ipa3_tx_dp(enum ipa_client_type dst, struct sk_buff *skb,
 		struct ipa_tx_meta *metadata);
 
+int ipa3_tx_dp_xmit_more(enum ipa_client_type dst, struct sk_buff *skb,
+		struct ipa_tx_meta *metadata, bool xmit_more);
+
 /*
  * To transfer multiple data packets
  * While passing the data descriptor list, the anchor node
@@ -3215,6 +3380,11 @@ int ipa3_setup_sys_pipe(struct ipa_sys_connect_params *sys_in, u32 *clnt_hdl);
 
 int ipa3_teardown_sys_pipe(u32 clnt_hdl);
 
+int ipa3_set_rx_list_notify(u32 clnt_hdl,
+	void (*notify)(void *priv, struct list_head *skbs));
+
+void ipa3_rx_dim_reset(struct ipa3_sys_context *sys);
+
 int ipa3_connect_wdi_pipe(struct ipa_wdi_in_params *in,
 		struct ipa_wdi_out_params *out);
 int ipa3_connect_gsi_wdi_pipe(struct ipa_wdi_in_params *in,
@@ -3457,6 +3627,9 @@ int ipa3_controller_static_bind(struct ipa3_controller *controller,
 int ipa3_cfg_route(struct ipahal_reg_route *route);
 int ipa3_send_cmd_timeout(u16 num_desc, struct ipa3_desc *descr, u32 timeout);
 int ipa3_send_cmd(u16 num_desc, struct ipa3_desc *descr);
+int ipa3_batch_send_cmd(u16 num_desc, struct ipa3_desc *descr);
+void ipa3_batch_free_dma_mem(struct ipa_mem_buffer *mem);
+void ipa3_batch_free_coherent(struct ipa_mem_buffer *mem);
 int ipa3_cfg_filter(u32 disable);
 int ipa3_straddle_boundary(u32 start, u32 end, u32 boundary);
 struct ipa3_context *ipa3_get_ctx(void);
@@ -3538,6 +3711,7 @@ int ipa3_id_alloc(void *ptr);
 bool ipa3_check_idr_if_freed(void *ptr);
 void *ipa3_id_find(u32 id);
 void ipa3_id_remove(u32 id);
+u32 ipa3_name_hkey(const char *name);
 int ipa3_enable_force_clear(u32 request_id, bool throttle_source,
 	u32 source_pipe_bitmask, u32 source_pipe_reg_idx);
 int ipa3_disable_force_clear(u32 request_id);
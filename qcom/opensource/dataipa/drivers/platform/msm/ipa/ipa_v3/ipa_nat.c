@@ -37,7 +37,17 @@
 
 #define IPA_NAT_MAX_NUM_OF_INIT_CMD_DESC 4
 #define IPA_IPV6CT_MAX_NUM_OF_INIT_CMD_DESC 3
-#define IPA_MAX_NUM_OF_TABLE_DMA_CMD_DESC 5
+
+/*
+ * A table DMA command goes to the IPA as one immediate command chain, so
+ * it is applied whole or not at all. Keep it to the TLV-safe chain length
+ * the filter and route commits use.
+ */
+#define IPA_MAX_NUM_OF_TABLE_DMA_CMD_DESC 10
+
+/* what is left of the chain once the coal close and NO-OP are in */
+#define IPA_MAX_NUM_OF_TABLE_DMA_ENTRIES \
+	(IPA_MAX_NUM_OF_TABLE_DMA_CMD_DESC - 2)
 
 /*
  * The base table max entries is limited by index into table 13 bits number.
@@ -1933,6 +1943,11 @@ static int ipa3_table_validate_table_dma_one(
  *
  * Called by NAT/IPv6CT clients to post TABLE_DMA command to IPA HW
  *
+ * A single command may carry the DMA entries of several rule updates
+ * (batched add/delete from user space), up to
+ * IPA_MAX_NUM_OF_TABLE_DMA_ENTRIES. They are all sent to the HW in one
+ * descriptor chain, so either all of them are applied or none are.
+ *
  * Returns:	0 on success, negative on failure
  */
 int ipa3_table_dma_cmd(
@@ -1952,7 +1967,6 @@ int ipa3_table_dma_cmd(
 	int i;
 	struct ipahal_reg_valmask valmask;
 	struct ipahal_imm_cmd_register_write reg_write_coal_close;
-	int max_dma_table_cmds = IPA_MAX_NUM_OF_TABLE_DMA_CMD_DESC;
 
 	IPADBG("In\n");
 
@@ -1979,15 +1993,13 @@ int ipa3_table_dma_cmd(
 	memset(desc, 0, sizeof(desc));
 
 	/**
-	 * We use a descriptor for closing coalsceing endpoint
-	 * by immediate command. So, DMA entries should be less than
-	 * IPA_MAX_NUM_OF_TABLE_DMA_CMD_DESC - 1 to overcome
-	 * buffer overflow of ipa3_desc array.
+	 * We use a descriptor for closing coalsceing endpoint and one
+	 * for the pipeline clear, so the entries are limited to what is
+	 * left of the ipa3_desc array. They are not split over several
+	 * sends: that would let part of a command reach the tables while
+	 * user space rolls all of it back.
 	 */
-	if (ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS) != -1)
-		max_dma_table_cmds -= 1;
-
-	if (!dma->entries || dma->entries > (max_dma_table_cmds - 1)) {
+	if (!dma->entries || dma->entries > IPA_MAX_NUM_OF_TABLE_DMA_ENTRIES) {
 		IPAERR_RL("Invalid number of entries %d\n",
 			dma->entries);
 		result = -EPERM;
@@ -2006,6 +2018,12 @@ int ipa3_table_dma_cmd(
 		}
 	}
 
+	/*
+	 * NAT_DMA was renamed to TABLE_DMA starting from IPAv4
+	 */
+	if (ipa3_ctx->ipa_hw_type >= IPA_HW_v4_0)
+		cmd_name = IPA_IMM_CMD_TABLE_DMA;
+
 	/* IC to close the coal frame before HPS Clear if coal is enabled */
 	if (ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS) != -1
 		&& !ipa3_ctx->ulso_wa) {
@@ -2052,12 +2070,6 @@ int ipa3_table_dma_cmd(
 
 	++num_cmd;
 
-	/*
-	 * NAT_DMA was renamed to TABLE_DMA starting from IPAv4
-	 */
-	if (ipa3_ctx->ipa_hw_type >= IPA_HW_v4_0)
-		cmd_name = IPA_IMM_CMD_TABLE_DMA;
-
 	for (cnt = 0; cnt < dma->entries; ++cnt) {
 
 		cmd.table_index = dma->dma[cnt].table_index;
@@ -49,6 +49,65 @@
 	IPA_PM_DBG_LOW("Client[%d] %s: %s\n", hdl, name, \
 		client_state_to_str[state])
 
+#define IPA_PM_TPUT_HIST_LEN 8
+/* votes stay in effect this long after they were replaced */
+#define IPA_PM_TPUT_HOLD_MS 500
+/* two rising votes closer than this are extrapolated */
+#define IPA_PM_TPUT_RAMP_MS 1000
+/* datapath packets per hold period that postpone a scale down */
+#define IPA_PM_TPUT_BUSY_PKTS 1000
+/* hold periods a busy datapath may postpone a scale down by */
+#define IPA_PM_TPUT_BUSY_MAX_HOLDS 4
+#define IPA_PM_SCALE_LOG_LEN 64
+
+/*
+ * struct ipa_pm_tput_hist - recent throughput votes of a client or group
+ * @tput: the votes, @idx is the slot of the next one
+ * @stamp: jiffies at which each vote was set, that is when the vote in
+ * the slot before it was replaced
+ * @idx: slot of the next vote
+ * @cnt: number of valid slots
+ */
+struct ipa_pm_tput_hist {
+	int tput[IPA_PM_TPUT_HIST_LEN];
+	unsigned long stamp[IPA_PM_TPUT_HIST_LEN];
+	int idx;
+	int cnt;
+};
+
+/*
+ * enum ipa_pm_scale_reason - why the clock plan was picked
+ * @IPA_PM_SCALE_VOTE: plan follows the current votes
+ * @IPA_PM_SCALE_HOLD: plan held up by a recent higher vote
+ * @IPA_PM_SCALE_RAMP: plan raised ahead of rising votes
+ * @IPA_PM_SCALE_BUSY: scale down postponed, the datapath is still busy
+ */
+enum ipa_pm_scale_reason {
+	IPA_PM_SCALE_VOTE,
+	IPA_PM_SCALE_HOLD,
+	IPA_PM_SCALE_RAMP,
+	IPA_PM_SCALE_BUSY,
+	IPA_PM_SCALE_REASON_MAX
+};
+
+/*
+ * struct ipa_pm_scale_log_entry - a single clock scaling decision
+ * @time_ms: time of the decision
+ * @tput: aggregated throughput of the current votes
+ * @predicted: aggregated throughput the plan was picked for
+ * @old_vote: clock plan before the decision
+ * @new_vote: clock plan after the decision
+ * @reason: why @new_vote was picked
+ */
+struct ipa_pm_scale_log_entry {
+	s64 time_ms;
+	int tput;
+	int predicted;
+	int old_vote;
+	int new_vote;
+	enum ipa_pm_scale_reason reason;
+};
+
 /*
  * struct ipa_pm_exception_list - holds information about an exception
  * @pending: number of clients in exception that have not yet been adctivated
@@ -74,6 +133,13 @@ struct ipa_pm_exception_list {
  * @cur_vote: idx of the threshold
  * @default_threshold: the thresholds used if no exception passes
  * @current_threshold: the current threshold of the clock plan
+ * @hold_work: re-evaluates the clock once held and predicted votes expire
+ * @hold_pkts: datapath packet count when @hold_work was armed
+ * @busy_holds: times a busy datapath postponed the scale down since the
+ * predicted votes expired
+ * @log: ring of the last scaling decisions, @log_idx is the next slot
+ * @log_idx: slot of the next decision
+ * @log_cnt: number of valid slots
  */
 struct clk_scaling_db {
 	spinlock_t lock;
@@ -85,6 +151,12 @@ struct clk_scaling_db {
 	int cur_vote;
 	int default_threshold[IPA_PM_THRESHOLD_MAX];
 	int *current_threshold;
+	struct delayed_work hold_work;
+	u32 hold_pkts;
+	int busy_holds;
+	struct ipa_pm_scale_log_entry log[IPA_PM_SCALE_LOG_LEN];
+	int log_idx;
+	int log_cnt;
 };
 
 /*
@@ -135,6 +207,7 @@ enum ipa_pm_state {
  * @group: the ipa_pm_group the client belongs to
  * @hdl: handle of the client
  * @throughput: the throughput of the client for clock scaling
+ * @tput_hist: recent throughput votes of the client
  * @state_lock: spinlock to lock the pm_states
  * @activate_work: work for activate (blocking case)
  * @deactivate work: delayed work for deferred_deactivate function
@@ -150,6 +223,7 @@ struct ipa_pm_client {
 	int group;
 	int hdl;
 	int throughput;
+	struct ipa_pm_tput_hist tput_hist;
 	spinlock_t state_lock;
 	struct work_struct activate_work;
 	struct delayed_work deactivate_work;
@@ -166,6 +240,7 @@ struct ipa_pm_client {
  * @client_mutex: global mutex to  lock the client arrays
  * @aggragated_tput: aggragated tput value of all valid activated clients
  * @group_tput: combined throughput for the groups
+ * @group_tput_hist: recent throughput votes of the groups
  */
 struct ipa_pm_ctx {
 	struct ipa_pm_client *clients[IPA_PM_MAX_CLIENTS];
@@ -175,6 +250,7 @@ struct ipa_pm_ctx {
 	struct mutex client_mutex;
 	int aggregated_tput;
 	int group_tput[IPA_PM_GROUP_MAX];
+	struct ipa_pm_tput_hist group_tput_hist[IPA_PM_GROUP_MAX];
 };
 
 static struct ipa_pm_ctx *ipa_pm_ctx;
@@ -195,6 +271,13 @@ static const char *ipa_pm_group_to_str[IPA_PM_GROUP_MAX] = {
 	__stringify(IPA_PM_GROUP_MODEM),
 };
 
+static const char *ipa_pm_scale_reason_to_str[IPA_PM_SCALE_REASON_MAX] = {
+	"vote",
+	"hold",
+	"ramp",
+	"busy",
+};
+
 static int dummy_hdl_1, dummy_hdl_2, tput_modem, tput_apps;
 
 /**
@@ -228,13 +311,85 @@ static int pop_max_from_array(int *arr, int *n)
 	return max;
 }
 
+/**
+ * tput_hist_add() - record a throughput vote
+ * @hist: history of the client or group
+ * @tput: the new vote
+ */
+static void tput_hist_add(struct ipa_pm_tput_hist *hist, int tput)
+{
+	hist->tput[hist->idx] = tput;
+	hist->stamp[hist->idx] = jiffies;
+	hist->idx = (hist->idx + 1) % IPA_PM_TPUT_HIST_LEN;
+	if (hist->cnt < IPA_PM_TPUT_HIST_LEN)
+		hist->cnt++;
+}
+
+/**
+ * predict_throughput() - throughput to scale the clock for
+ * @hist: history of the client or group
+ * @tput: the current vote
+ * @reason: [out] raised to HOLD or RAMP if the result is above @tput
+ *
+ * Votes replaced during the last IPA_PM_TPUT_HOLD_MS keep the result up
+ * so a short dip does not drop the clock in the middle of a burst. A vote
+ * is replaced at the stamp of the slot after it, however long ago it was
+ * set. When the last two votes are rising the last step is extrapolated
+ * once more, so the clock is ahead of the burst instead of catching up
+ * with it.
+ *
+ * Returns: predicted tput value
+ */
+static int predict_throughput(struct ipa_pm_tput_hist *hist, int tput,
+	enum ipa_pm_scale_reason *reason)
+{
+	unsigned long hold = msecs_to_jiffies(IPA_PM_TPUT_HOLD_MS);
+	int i, slot, next, last, prev;
+	int predicted = tput;
+
+	if (hist->cnt == 0)
+		return tput;
+
+	last = (hist->idx + IPA_PM_TPUT_HIST_LEN - 1) % IPA_PM_TPUT_HIST_LEN;
+	if (!time_before(jiffies, hist->stamp[last] + hold))
+		return tput;
+
+	/* the last slot is the current vote, it was never replaced */
+	for (i = 1; i < hist->cnt; i++) {
+		slot = (last + IPA_PM_TPUT_HIST_LEN - i) % IPA_PM_TPUT_HIST_LEN;
+		next = (slot + 1) % IPA_PM_TPUT_HIST_LEN;
+		if (!time_before(jiffies, hist->stamp[next] + hold))
+			break;
+		if (hist->tput[slot] > predicted) {
+			predicted = hist->tput[slot];
+			if (*reason < IPA_PM_SCALE_HOLD)
+				*reason = IPA_PM_SCALE_HOLD;
+		}
+	}
+
+	if (hist->cnt > 1) {
+		prev = (last + IPA_PM_TPUT_HIST_LEN - 1) % IPA_PM_TPUT_HIST_LEN;
+		if (hist->tput[last] > hist->tput[prev] &&
+			time_before_eq(hist->stamp[last], hist->stamp[prev] +
+				msecs_to_jiffies(IPA_PM_TPUT_RAMP_MS)) &&
+			2 * hist->tput[last] - hist->tput[prev] > predicted) {
+			predicted = 2 * hist->tput[last] - hist->tput[prev];
+			*reason = IPA_PM_SCALE_RAMP;
+		}
+	}
+
+	return predicted;
+}
+
 /**
  * calculate_throughput() - calculate the aggregated throughput
  * based on active clients
+ * @reason: NULL for the current votes, otherwise aggregate the predicted
+ * votes and report why they are above the current ones
  *
  * Returns: aggregated tput value
  */
-static int calculate_throughput(void)
+static int calculate_throughput(enum ipa_pm_scale_reason *reason)
 {
 	int client_tput[IPA_PM_MAX_CLIENTS] = { 0 };
 	bool group_voted[IPA_PM_GROUP_MAX] = { false };
@@ -248,10 +403,16 @@ static int calculate_throughput(void)
 		if (client != NULL && IPA_PM_STATE_ACTIVE(client->state)) {
 			/* default case */
 			if (client->group == IPA_PM_GROUP_DEFAULT) {
-				client_tput[n++] = client->throughput;
+				client_tput[n++] = !reason ? client->throughput
+					: predict_throughput(&client->tput_hist,
+						client->throughput, reason);
 			} else if (!group_voted[client->group]) {
-				client_tput[n++] = ipa_pm_ctx->group_tput
-					[client->group];
+				client_tput[n++] = !reason ?
+					ipa_pm_ctx->group_tput[client->group]
+					: predict_throughput(
+					&ipa_pm_ctx->group_tput_hist[client->group],
+					ipa_pm_ctx->group_tput[client->group],
+					reason);
 				group_voted[client->group] = true;
 			}
 		}
@@ -347,15 +508,53 @@ static void set_current_threshold(void)
 	spin_unlock_irqrestore(&ipa_pm_ctx->clk_scaling.lock, flags);
 }
 
+/**
+ * datapath_pkts() - packets seen by the apps datapath so far
+ */
+static u32 datapath_pkts(void)
+{
+	return ipa3_ctx->stats.rx_pkts + ipa3_ctx->stats.tx_sw_pkts +
+		ipa3_ctx->stats.tx_hw_pkts;
+}
+
+/**
+ * log_clk_scaling() - record a clock scaling decision
+ */
+static void log_clk_scaling(int tput, int predicted, int old_vote,
+	int new_vote, enum ipa_pm_scale_reason reason)
+{
+	struct clk_scaling_db *clk = &ipa_pm_ctx->clk_scaling;
+	struct ipa_pm_scale_log_entry *entry;
+	unsigned long flags;
+
+	spin_lock_irqsave(&clk->lock, flags);
+	entry = &clk->log[clk->log_idx];
+	entry->time_ms = ktime_to_ms(ktime_get());
+	entry->tput = tput;
+	entry->predicted = predicted;
+	entry->old_vote = old_vote;
+	entry->new_vote = new_vote;
+	entry->reason = reason;
+	clk->log_idx = (clk->log_idx + 1) % IPA_PM_SCALE_LOG_LEN;
+	if (clk->log_cnt < IPA_PM_SCALE_LOG_LEN)
+		clk->log_cnt++;
+	spin_unlock_irqrestore(&clk->lock, flags);
+}
+
 /**
  * do_clk_scaling() - set the clock based on the activated clients
  *
+ * The clock plan is picked for the predicted throughput of the clients,
+ * see predict_throughput(). While it is above the current votes the
+ * clock is re-evaluated once the predicted votes expire.
+ *
  * Returns: 0 if success, negative otherwise
  */
 static int do_clk_scaling(void)
 {
-	int i, tput;
+	int i, tput, predicted, old_vote;
 	int new_th_idx = 1;
+	enum ipa_pm_scale_reason reason = IPA_PM_SCALE_VOTE;
 	struct clk_scaling_db *clk_scaling;
 
 	if (atomic_read(&ipa3_ctx->ipa_clk_vote) == 0) {
@@ -367,18 +566,20 @@ static int do_clk_scaling(void)
 
 	mutex_lock(&ipa_pm_ctx->client_mutex);
 	IPA_PM_DBG_LOW("clock scaling started\n");
-	tput = calculate_throughput();
+	tput = calculate_throughput(NULL);
+	predicted = calculate_throughput(&reason);
 	ipa_pm_ctx->aggregated_tput = tput;
 	set_current_threshold();
 
 	mutex_unlock(&ipa_pm_ctx->client_mutex);
 
 	for (i = 0; i < clk_scaling->threshold_size; i++) {
-		if (tput >= clk_scaling->current_threshold[i])
+		if (predicted >= clk_scaling->current_threshold[i])
 			new_th_idx++;
 	}
 
-	IPA_PM_DBG_LOW("old idx was at %d\n", ipa_pm_ctx->clk_scaling.cur_vote);
+	old_vote = ipa_pm_ctx->clk_scaling.cur_vote;
+	IPA_PM_DBG_LOW("old idx was at %d\n", old_vote);
 
 
 	if (ipa_pm_ctx->clk_scaling.cur_vote != new_th_idx) {
@@ -387,6 +588,14 @@ static int do_clk_scaling(void)
 	}
 
 	IPA_PM_DBG_LOW("new idx is at %d\n", ipa_pm_ctx->clk_scaling.cur_vote);
+	log_clk_scaling(tput, predicted, old_vote, new_th_idx, reason);
+
+	if (predicted > tput) {
+		clk_scaling->hold_pkts = datapath_pkts();
+		clk_scaling->busy_holds = 0;
+		mod_delayed_work(ipa_pm_ctx->wq, &clk_scaling->hold_work,
+			msecs_to_jiffies(IPA_PM_TPUT_HOLD_MS));
+	}
 
 	return 0;
 }
@@ -399,6 +608,36 @@ static void clock_scaling_func(struct work_struct *work)
 	do_clk_scaling();
 }
 
+/**
+ * clock_scaling_hold_func() - re-evaluate the clock once held and predicted
+ * votes expired, unless the datapath is still busy
+ *
+ * A busy datapath postpones the scale down by at most
+ * IPA_PM_TPUT_BUSY_MAX_HOLDS hold periods, after that the clock follows
+ * the votes again.
+ */
+static void clock_scaling_hold_func(struct work_struct *work)
+{
+	struct clk_scaling_db *clk = &ipa_pm_ctx->clk_scaling;
+	u32 pkts = datapath_pkts();
+
+	if (pkts - clk->hold_pkts >= IPA_PM_TPUT_BUSY_PKTS &&
+		clk->busy_holds < IPA_PM_TPUT_BUSY_MAX_HOLDS) {
+		IPA_PM_DBG_LOW("datapath busy, holding clock at %d\n",
+			clk->cur_vote);
+		log_clk_scaling(ipa_pm_ctx->aggregated_tput,
+			ipa_pm_ctx->aggregated_tput, clk->cur_vote,
+			clk->cur_vote, IPA_PM_SCALE_BUSY);
+		clk->hold_pkts = pkts;
+		clk->busy_holds++;
+		queue_delayed_work(ipa_pm_ctx->wq, &clk->hold_work,
+			msecs_to_jiffies(IPA_PM_TPUT_HOLD_MS));
+		return;
+	}
+
+	do_clk_scaling();
+}
+
 /**
  * activate_work_func - activate a client and vote for clock on a work queue
  */
@@ -663,6 +902,7 @@ int ipa_pm_init(struct ipa_pm_init_params *params)
 	clk_scaling->threshold_size = params->threshold_size;
 	clk_scaling->exception_size = params->exception_size;
 	INIT_WORK(&clk_scaling->work, clock_scaling_func);
+	INIT_DELAYED_WORK(&clk_scaling->hold_work, clock_scaling_hold_func);
 
 	for (i = 0; i < params->threshold_size; i++)
 		clk_scaling->default_threshold[i] =
@@ -718,6 +958,7 @@ int ipa_pm_destroy(void)
 		return -EPERM;
 	}
 
+	cancel_delayed_work_sync(&ipa_pm_ctx->clk_scaling.hold_work);
 	destroy_workqueue(ipa_pm_ctx->wq);
 
 	kfree(ipa_pm_ctx);
@@ -1312,10 +1553,14 @@ int ipa_pm_set_throughput(u32 hdl, int throughput)
 		IPA_PM_DBG_LOW("old Group %d throughput: %d\n",
 			client->group, ipa_pm_ctx->group_tput[client->group]);
 
-	if (client->group == IPA_PM_GROUP_DEFAULT)
+	if (client->group == IPA_PM_GROUP_DEFAULT) {
 		client->throughput = throughput;
-	else
+		tput_hist_add(&client->tput_hist, throughput);
+	} else {
 		ipa_pm_ctx->group_tput[client->group] = throughput;
+		tput_hist_add(&ipa_pm_ctx->group_tput_hist[client->group],
+			throughput);
+	}
 
 	if (client->group == IPA_PM_GROUP_DEFAULT)
 		IPA_PM_DBG_LOW("New throughput: %d\n",  client->throughput);
@@ -1472,6 +1717,49 @@ int ipa_pm_exceptions_stat(char *buf, int size)
 	return cnt;
 }
 
+/**
+ * ipa_pm_scaling_log_stat() - print the last clock scaling decisions
+ * @buf: [in] The user buff used to print
+ * @size: [in] The size of buf
+ * Returns: number of bytes used on success, negative on failure
+ *
+ * This function is called by ipa_debugfs, the oldest decision is printed
+ * first
+ */
+int ipa_pm_scaling_log_stat(char *buf, int size)
+{
+	struct clk_scaling_db *clk;
+	struct ipa_pm_scale_log_entry *entry;
+	int i, slot, cnt = 0, result = 0;
+	unsigned long flags;
+
+	if (!buf || size < 0)
+		return -EINVAL;
+
+	if (!ipa_pm_ctx)
+		return -EPERM;
+
+	clk = &ipa_pm_ctx->clk_scaling;
+	result = scnprintf(buf + cnt, size - cnt, "\n");
+	cnt += result;
+
+	spin_lock_irqsave(&clk->lock, flags);
+	for (i = 0; i < clk->log_cnt; i++) {
+		slot = (clk->log_idx + IPA_PM_SCALE_LOG_LEN - clk->log_cnt + i)
+			% IPA_PM_SCALE_LOG_LEN;
+		entry = &clk->log[slot];
+		result = scnprintf(buf + cnt, size - cnt,
+			"%lld: tput %d pred %d vote %d->%d %s\n",
+			entry->time_ms, entry->tput, entry->predicted,
+			entry->old_vote, entry->new_vote,
+			ipa_pm_scale_reason_to_str[entry->reason]);
+		cnt += result;
+	}
+	spin_unlock_irqrestore(&clk->lock, flags);
+
+	return cnt;
+}
+
 int ipa_pm_get_scaling_bw_levels(struct ipa_lnx_clock_stats *clock_stats)
 {
 	struct clk_scaling_db *clk;
@@ -102,6 +102,7 @@ int ipa_pm_handle_suspend(u32 pipe_bitmask, u32 pipe_arr_idx);
 int ipa_pm_deactivate_all_deferred(void);
 int ipa_pm_stat(char *buf, int size);
 int ipa_pm_exceptions_stat(char *buf, int size);
+int ipa_pm_scaling_log_stat(char *buf, int size);
 void ipa_pm_set_clock_index(int index);
 int ipa_pm_add_dummy_clients(s8 power_plan);
 int ipa_pm_remove_dummy_clients(void);
@@ -181,6 +182,11 @@ static inline int ipa_pm_exceptions_stat(char *buf, int size)
 	return -EPERM;
 }
 
+static inline int ipa_pm_scaling_log_stat(char *buf, int size)
+{
+	return -EPERM;
+}
+
 static inline int ipa_pm_add_dummy_clients(s8 power_plan);
 {
 	return -EPERM;
@@ -6,6 +6,7 @@
 
 #include <linux/bitops.h>
 #include <linux/idr.h>
+#include <linux/hashtable.h>
 #include "ipa_i.h"
 #include "ipahal.h"
 #include "ipahal_fltrt.h"
@@ -16,6 +17,9 @@
 #define IPA_RT_STATUS_OF_MDFY_FAILED (-1)
 
 #define IPA_RT_MAX_NUM_OF_COMMIT_TABLES_CMD_DESC 6
+/* coal close and cache flush leave room for this many table updates */
+#define IPA_RT_MAX_NUM_OF_DELTA_BDYS \
+	(IPA_RT_MAX_NUM_OF_COMMIT_TABLES_CMD_DESC - 2)
 
 #define IPA_RT_GET_RULE_TYPE(__entry) \
 	( \
@@ -23,6 +27,18 @@
 	(IPA_RULE_HASHABLE) : (IPA_RULE_NON_HASHABLE) \
 	)
 
+/**
+ * struct ipa_rt_delta_bdy - rt table body rebuilt by a delta commit
+ * @tbl: the rt table
+ * @rlt: the rule type of the body (hashable or non-hashable)
+ * @mem: the generated body
+ */
+struct ipa_rt_delta_bdy {
+	struct ipa3_rt_tbl *tbl;
+	enum ipa_rule_type rlt;
+	struct ipa_mem_buffer mem;
+};
+
 /**
  * ipa_generate_rt_hw_rule() - Generated the RT H/W single rule
  *  This func will do the preparation core driver work and then calls
@@ -209,6 +225,7 @@ static int ipa_translate_rt_tbl_to_hw_fmt(enum ipa_ip_type ip,
 			tbl->curr_mem[rlt] = tbl_mem;
 		} else {
 			offset = body_i - base + body_ofst;
+			tbl->lcl_ofst[rlt] = body_i - base;
 
 			/* update the hdr at the right index */
 			if (ipahal_fltrt_write_addr_to_hdr(offset, hdr,
@@ -264,7 +281,7 @@ static void __ipa_reap_sys_rt_tbls(enum ipa_ip_type ip)
 				IPADBG_LOW(
 				"reaping sys rt tbl name=%s ip=%d rlt=%d\n",
 				tbl->name, ip, i);
-				ipahal_free_dma_mem(&tbl->prev_mem[i]);
+				ipa3_batch_free_dma_mem(&tbl->prev_mem[i]);
 				memset(&tbl->prev_mem[i], 0,
 					sizeof(tbl->prev_mem[i]));
 			}
@@ -279,7 +296,7 @@ static void __ipa_reap_sys_rt_tbls(enum ipa_ip_type ip)
 				IPADBG_LOW(
 				"reaping sys rt tbl name=%s ip=%d rlt=%d\n",
 				tbl->name, ip, i);
-				ipahal_free_dma_mem(&tbl->curr_mem[i]);
+				ipa3_batch_free_dma_mem(&tbl->curr_mem[i]);
 			}
 		}
 		list_del(&tbl->link);
@@ -454,6 +471,353 @@ static bool ipa_rt_valid_lcl_tbl_size(enum ipa_ip_type ipt,
 	return false;
 }
 
+/**
+ * ipa_rt_add_flush_cmds() - add the imm commands that should precede an rt
+ *  tables update: closing the coalescing frame and flushing the rt rules cache
+ * @ip: the ip address family type
+ * @desc: descriptors array to fill
+ * @cmd_pyld: imm commands payload pointers array to fill
+ * @num_cmd: [IN/OUT] number of commands already in the arrays
+ *
+ * Return: 0 on success, negative on failure
+ */
+static int ipa_rt_add_flush_cmds(enum ipa_ip_type ip, struct ipa3_desc *desc,
+	struct ipahal_imm_cmd_pyld **cmd_pyld, int *num_cmd)
+{
+	struct ipahal_imm_cmd_register_write reg_write_cmd = {0};
+	struct ipahal_imm_cmd_register_write reg_write_coal_close;
+	struct ipahal_reg_valmask valmask;
+	int i;
+
+	/* IC to close the coal frame before HPS Clear if coal is enabled */
+	if (ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS) != -1
+		&& !ipa3_ctx->ulso_wa) {
+		u32 offset = 0;
+
+		i = ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS);
+		reg_write_coal_close.skip_pipeline_clear = false;
+		reg_write_coal_close.pipeline_clear_options = IPAHAL_HPS_CLEAR;
+		if (ipa3_ctx->ipa_hw_type < IPA_HW_v5_0)
+			offset = ipahal_get_reg_ofst(
+				IPA_AGGR_FORCE_CLOSE);
+		else
+			offset = ipahal_get_ep_reg_offset(
+				IPA_AGGR_FORCE_CLOSE_n, i);
+		reg_write_coal_close.offset = offset;
+		ipahal_get_aggr_force_close_valmask(i, &valmask);
+		reg_write_coal_close.value = valmask.val;
+		reg_write_coal_close.value_mask = valmask.mask;
+		cmd_pyld[*num_cmd] = ipahal_construct_imm_cmd(
+			IPA_IMM_CMD_REGISTER_WRITE,
+			&reg_write_coal_close, false);
+		if (!cmd_pyld[*num_cmd]) {
+			IPAERR("failed to construct coal close IC\n");
+			return -ENOMEM;
+		}
+		ipa3_init_imm_cmd_desc(&desc[*num_cmd], cmd_pyld[*num_cmd]);
+		++(*num_cmd);
+	}
+
+	/*
+	 * SRAM memory not allocated to hash tables. Sending
+	 * command to hash tables(filer/routing) operation not supported.
+	 */
+	if (!ipa3_ctx->ipa_fltrt_not_hashable) {
+		/* flushing ipa internal hashable rt rules cache */
+		if (ipa3_ctx->ipa_hw_type >= IPA_HW_v5_0) {
+			struct ipahal_reg_fltrt_cache_flush flush_cache;
+
+			memset(&flush_cache, 0, sizeof(flush_cache));
+			flush_cache.rt = true;
+			ipahal_get_fltrt_cache_flush_valmask(
+				&flush_cache, &valmask);
+			reg_write_cmd.offset = ipahal_get_reg_ofst(
+				IPA_FILT_ROUT_CACHE_FLUSH);
+		} else {
+			struct ipahal_reg_fltrt_hash_flush flush_hash;
+
+			memset(&flush_hash, 0, sizeof(flush_hash));
+			if (ip == IPA_IP_v4)
+				flush_hash.v4_rt = true;
+			else
+				flush_hash.v6_rt = true;
+			ipahal_get_fltrt_hash_flush_valmask(
+				&flush_hash, &valmask);
+			reg_write_cmd.offset = ipahal_get_reg_ofst(
+				IPA_FILT_ROUT_HASH_FLUSH);
+		}
+		reg_write_cmd.skip_pipeline_clear = false;
+		reg_write_cmd.pipeline_clear_options = IPAHAL_HPS_CLEAR;
+		reg_write_cmd.value = valmask.val;
+		reg_write_cmd.value_mask = valmask.mask;
+		cmd_pyld[*num_cmd] = ipahal_construct_imm_cmd(
+				IPA_IMM_CMD_REGISTER_WRITE, &reg_write_cmd,
+							false);
+		if (!cmd_pyld[*num_cmd]) {
+			IPAERR(
+			"fail construct register_write imm cmd. IP %d\n", ip);
+			return -ENOMEM;
+		}
+		ipa3_init_imm_cmd_desc(&desc[*num_cmd], cmd_pyld[*num_cmd]);
+		++(*num_cmd);
+	}
+
+	return 0;
+}
+
+/**
+ * ipa_rt_gen_tbl_bdy() - generate the body of a single rt table into a
+ *  newly allocated DMA buffer
+ * @ip: the ip address family type
+ * @tbl: the rt tbl, already prepared for commit
+ * @rlt: the type of the rules to generate (hashable or non-hashable)
+ * @mem: [OUT] the generated body
+ *
+ * Return: 0 on success, negative on failure
+ */
+static int ipa_rt_gen_tbl_bdy(enum ipa_ip_type ip, struct ipa3_rt_tbl *tbl,
+	enum ipa_rule_type rlt, struct ipa_mem_buffer *mem)
+{
+	struct ipa3_rt_entry *entry;
+	u8 *bdy_i;
+
+	/* only body (no header) */
+	mem->size = tbl->sz[rlt] - ipahal_get_hw_tbl_hdr_width();
+	if (tbl->in_sys[rlt])
+		mem->size += ipahal_get_hw_prefetch_buf_size();
+	if (ipahal_fltrt_allocate_hw_sys_tbl(mem)) {
+		IPAERR_RL("fail to alloc tbl bdy of size %d\n", mem->size);
+		return -ENOMEM;
+	}
+
+	bdy_i = mem->base;
+	list_for_each_entry(entry, &tbl->head_rt_rule_list, link) {
+		if (IPA_RT_GET_RULE_TYPE(entry) != rlt)
+			continue;
+		if (ipa_generate_rt_hw_rule(ip, entry, bdy_i)) {
+			IPAERR_RL("failed to gen HW RT rule\n");
+			ipahal_free_dma_mem(mem);
+			return -EPERM;
+		}
+		bdy_i += entry->hw_len;
+	}
+
+	return 0;
+}
+
+/**
+ * ipa_rt_commit_delta() - commit only the rt tables that changed since the
+ *  last commit
+ * @ip: the ip address family type
+ *
+ * Rule priorities are assigned per table, so a changed table is rebuilt as a
+ * whole while all other tables are left untouched. A system table gets a new
+ * body in DDR and only its own header entry is rewritten. A local table is
+ * rewritten in place, which is possible only while its size is unchanged, as
+ * local bodies are packed back-to-back in SRAM.
+ *
+ * Return: 0 on success, -EAGAIN if a full commit is needed instead,
+ *  other negative value on failure
+ */
+static int ipa_rt_commit_delta(enum ipa_ip_type ip)
+{
+	struct ipa3_desc desc[IPA_RT_MAX_NUM_OF_COMMIT_TABLES_CMD_DESC];
+	struct ipahal_imm_cmd_pyld
+		*cmd_pyld[IPA_RT_MAX_NUM_OF_COMMIT_TABLES_CMD_DESC];
+	struct ipahal_imm_cmd_dma_shared_mem mem_cmd = {0};
+	struct ipa_rt_delta_bdy bdy[IPA_RT_MAX_NUM_OF_DELTA_BDYS];
+	struct ipa_mem_buffer hdr_mem = {0};
+	struct ipa3_rt_tbl_set *set;
+	struct ipa3_rt_tbl *tbl;
+	u32 lcl_hdr[IPA_RULE_TYPE_MAX], lcl_bdy[IPA_RULE_TYPE_MAX];
+	u32 prev_sz[IPA_RULE_TYPE_MAX];
+	u32 num_modem_rt_index, apps_start_idx;
+	u32 tbl_hdr_width;
+	int num_bdy = 0, num_cmd = 0;
+	int rlt, i;
+	int rc = -EAGAIN;
+
+	tbl_hdr_width = ipahal_get_hw_tbl_hdr_width();
+	memset(desc, 0, sizeof(desc));
+	memset(cmd_pyld, 0, sizeof(cmd_pyld));
+
+	if (ip == IPA_IP_v4) {
+		num_modem_rt_index =
+			IPA_MEM_PART(v4_modem_rt_index_hi) -
+			IPA_MEM_PART(v4_modem_rt_index_lo) + 1;
+		lcl_hdr[IPA_RULE_HASHABLE] = ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(v4_rt_hash_ofst) +
+			num_modem_rt_index * tbl_hdr_width;
+		lcl_hdr[IPA_RULE_NON_HASHABLE] =
+			ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(v4_rt_nhash_ofst) +
+			num_modem_rt_index * tbl_hdr_width;
+		lcl_bdy[IPA_RULE_HASHABLE] = ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(apps_v4_rt_hash_ofst);
+		lcl_bdy[IPA_RULE_NON_HASHABLE] =
+			ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(apps_v4_rt_nhash_ofst);
+		apps_start_idx = IPA_MEM_PART(v4_apps_rt_index_lo);
+	} else {
+		num_modem_rt_index =
+			IPA_MEM_PART(v6_modem_rt_index_hi) -
+			IPA_MEM_PART(v6_modem_rt_index_lo) + 1;
+		lcl_hdr[IPA_RULE_HASHABLE] = ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(v6_rt_hash_ofst) +
+			num_modem_rt_index * tbl_hdr_width;
+		lcl_hdr[IPA_RULE_NON_HASHABLE] =
+			ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(v6_rt_nhash_ofst) +
+			num_modem_rt_index * tbl_hdr_width;
+		lcl_bdy[IPA_RULE_HASHABLE] = ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(apps_v6_rt_hash_ofst);
+		lcl_bdy[IPA_RULE_NON_HASHABLE] =
+			ipa3_ctx->smem_restricted_bytes +
+			IPA_MEM_PART(apps_v6_rt_nhash_ofst);
+		apps_start_idx = IPA_MEM_PART(v6_apps_rt_index_lo);
+	}
+
+	set = &ipa3_ctx->rt_tbl_set[ip];
+	list_for_each_entry(tbl, &set->head_rt_tbl_list, link) {
+		if (!tbl->dirty)
+			continue;
+
+		prev_sz[IPA_RULE_HASHABLE] = tbl->sz[IPA_RULE_HASHABLE];
+		prev_sz[IPA_RULE_NON_HASHABLE] = tbl->sz[IPA_RULE_NON_HASHABLE];
+		if (ipa_prep_rt_tbl_for_cmt(ip, tbl))
+			goto free_bdys;
+
+		for (rlt = 0; rlt < IPA_RULE_TYPE_MAX; rlt++) {
+			if (!prev_sz[rlt] && !tbl->sz[rlt])
+				continue;
+
+			/*
+			 * header entries of empty tables point to the shared
+			 * empty table and local bodies cannot be moved
+			 */
+			if (!prev_sz[rlt] || !tbl->sz[rlt] ||
+				(!tbl->in_sys[rlt] &&
+				tbl->sz[rlt] != prev_sz[rlt])) {
+				IPADBG_LOW("rt tbl %s rlt %d resized %u->%u\n",
+					tbl->name, rlt, prev_sz[rlt],
+					tbl->sz[rlt]);
+				goto free_bdys;
+			}
+
+			if (num_bdy == IPA_RT_MAX_NUM_OF_DELTA_BDYS) {
+				IPADBG_LOW("too many rt tbls changed\n");
+				goto free_bdys;
+			}
+
+			if (!tbl->in_sys[rlt] &&
+				(tbl->lcl_ofst[rlt] % tbl_hdr_width)) {
+				IPADBG_LOW("rt tbl %s lcl ofst %u unaligned\n",
+					tbl->name, tbl->lcl_ofst[rlt]);
+				goto free_bdys;
+			}
+
+			if (ipa_rt_gen_tbl_bdy(ip, tbl, rlt,
+				&bdy[num_bdy].mem))
+				goto free_bdys;
+			bdy[num_bdy].tbl = tbl;
+			bdy[num_bdy].rlt = rlt;
+			num_bdy++;
+		}
+	}
+
+	if (!num_bdy) {
+		IPADBG_LOW("no rt tbl changes to commit. IP %d\n", ip);
+		rc = 0;
+		goto clear_dirty;
+	}
+
+	hdr_mem.size = num_bdy * tbl_hdr_width;
+	hdr_mem.base = dma_alloc_coherent(ipa3_ctx->pdev, hdr_mem.size,
+		&hdr_mem.phys_base, GFP_KERNEL);
+	if (!hdr_mem.base) {
+		IPAERR("fail to alloc DMA buff of size %d\n", hdr_mem.size);
+		goto free_bdys;
+	}
+
+	if (ipa_rt_add_flush_cmds(ip, desc, cmd_pyld, &num_cmd))
+		goto fail_imm_cmd_construct;
+
+	for (i = 0; i < num_bdy; i++) {
+		tbl = bdy[i].tbl;
+		rlt = bdy[i].rlt;
+
+		mem_cmd.is_read = false;
+		mem_cmd.skip_pipeline_clear = false;
+		mem_cmd.pipeline_clear_options = IPAHAL_HPS_CLEAR;
+		if (tbl->in_sys[rlt]) {
+			if (ipahal_fltrt_write_addr_to_hdr(
+				bdy[i].mem.phys_base,
+				hdr_mem.base + i * tbl_hdr_width, 0, true)) {
+				IPAERR_RL("fail to wrt sys tbl addr to hdr\n");
+				goto fail_imm_cmd_construct;
+			}
+			mem_cmd.size = tbl_hdr_width;
+			mem_cmd.system_addr = hdr_mem.phys_base +
+				i * tbl_hdr_width;
+			mem_cmd.local_addr = lcl_hdr[rlt] +
+				(tbl->idx - apps_start_idx) * tbl_hdr_width;
+		} else {
+			mem_cmd.size = tbl->sz[rlt] - tbl_hdr_width;
+			mem_cmd.system_addr = bdy[i].mem.phys_base;
+			mem_cmd.local_addr = lcl_bdy[rlt] + tbl->lcl_ofst[rlt];
+		}
+		IPADBG_LOW("rt tbl %s rlt %d %s update size %u\n",
+			tbl->name, rlt, tbl->in_sys[rlt] ? "hdr" : "bdy",
+			mem_cmd.size);
+		cmd_pyld[num_cmd] = ipahal_construct_imm_cmd(
+			IPA_IMM_CMD_DMA_SHARED_MEM, &mem_cmd, false);
+		if (!cmd_pyld[num_cmd]) {
+			IPAERR("fail construct dma_shared_mem cmd. IP %d\n",
+				ip);
+			goto fail_imm_cmd_construct;
+		}
+		ipa3_init_imm_cmd_desc(&desc[num_cmd], cmd_pyld[num_cmd]);
+		num_cmd++;
+	}
+
+	if (ipa3_batch_send_cmd(num_cmd, desc)) {
+		IPAERR_RL("fail to send immediate command\n");
+		rc = -EFAULT;
+		goto fail_imm_cmd_construct;
+	}
+
+	/* the new sys bodies are now referenced by the hw */
+	for (i = 0; i < num_bdy; i++) {
+		tbl = bdy[i].tbl;
+		rlt = bdy[i].rlt;
+		if (!tbl->in_sys[rlt])
+			continue;
+		if (tbl->curr_mem[rlt].phys_base) {
+			WARN_ON(tbl->prev_mem[rlt].phys_base);
+			tbl->prev_mem[rlt] = tbl->curr_mem[rlt];
+		}
+		tbl->curr_mem[rlt] = bdy[i].mem;
+		memset(&bdy[i].mem, 0, sizeof(bdy[i].mem));
+	}
+	__ipa_reap_sys_rt_tbls(ip);
+	rc = 0;
+
+fail_imm_cmd_construct:
+	for (i = 0; i < num_cmd; i++)
+		ipahal_destroy_imm_cmd(cmd_pyld[i]);
+	ipa3_batch_free_coherent(&hdr_mem);
+free_bdys:
+	for (i = 0; i < num_bdy; i++)
+		if (bdy[i].mem.phys_base)
+			ipa3_batch_free_dma_mem(&bdy[i].mem);
+	if (rc)
+		return rc;
+clear_dirty:
+	list_for_each_entry(tbl, &set->head_rt_tbl_list, link)
+		tbl->dirty = false;
+	return 0;
+}
+
 /**
  * __ipa_commit_rt_v3() - commit rt tables to the hw
  * commit the headers and the bodies if are local with internal cache flushing
@@ -464,7 +828,6 @@ static bool ipa_rt_valid_lcl_tbl_size(enum ipa_ip_type ipt,
 int __ipa_commit_rt_v3(enum ipa_ip_type ip)
 {
 	struct ipa3_desc desc[IPA_RT_MAX_NUM_OF_COMMIT_TABLES_CMD_DESC];
-	struct ipahal_imm_cmd_register_write reg_write_cmd = {0};
 	struct ipahal_imm_cmd_dma_shared_mem  mem_cmd = {0};
 	struct ipahal_imm_cmd_pyld
 		*cmd_pyld[IPA_RT_MAX_NUM_OF_COMMIT_TABLES_CMD_DESC];
@@ -475,12 +838,10 @@ int __ipa_commit_rt_v3(enum ipa_ip_type ip)
 	u32 lcl_hash_hdr, lcl_nhash_hdr;
 	u32 lcl_hash_bdy, lcl_nhash_bdy;
 	bool lcl_hash, lcl_nhash;
-	struct ipahal_reg_valmask valmask;
 	int i;
 	struct ipa3_rt_tbl_set *set;
 	struct ipa3_rt_tbl *tbl;
 	u32 tbl_hdr_width;
-	struct ipahal_imm_cmd_register_write reg_write_coal_close;
 
 	tbl_hdr_width = ipahal_get_hw_tbl_hdr_width();
 	memset(desc, 0, sizeof(desc));
@@ -532,6 +893,18 @@ int __ipa_commit_rt_v3(enum ipa_ip_type ip)
 		goto no_rt_tbls;
 	}
 
+	if (!ipa3_ctx->rt_tbl_full_commit[ip]) {
+		rc = ipa_rt_commit_delta(ip);
+		if (rc != -EAGAIN) {
+			if (rc)
+				ipa3_ctx->rt_tbl_full_commit[ip] = true;
+			return rc;
+		}
+		IPADBG_LOW("rt delta commit not possible. IP %d\n", ip);
+		rc = 0;
+	}
+	ipa3_ctx->rt_tbl_full_commit[ip] = true;
+
 	set = &ipa3_ctx->rt_tbl_set[ip];
 	list_for_each_entry(tbl, &set->head_rt_tbl_list, link) {
 		if (ipa_prep_rt_tbl_for_cmt(ip, tbl)) {
@@ -571,77 +944,9 @@ int __ipa_commit_rt_v3(enum ipa_ip_type ip)
 		goto fail_size_valid;
 	}
 
-	/* IC to close the coal frame before HPS Clear if coal is enabled */
-	if (ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS) != -1
-		&& !ipa3_ctx->ulso_wa) {
-		u32 offset = 0;
-
-		i = ipa3_get_ep_mapping(IPA_CLIENT_APPS_WAN_COAL_CONS);
-		reg_write_coal_close.skip_pipeline_clear = false;
-		reg_write_coal_close.pipeline_clear_options = IPAHAL_HPS_CLEAR;
-		if (ipa3_ctx->ipa_hw_type < IPA_HW_v5_0)
-			offset = ipahal_get_reg_ofst(
-				IPA_AGGR_FORCE_CLOSE);
-		else
-			offset = ipahal_get_ep_reg_offset(
-				IPA_AGGR_FORCE_CLOSE_n, i);
-		reg_write_coal_close.offset = offset;
-		ipahal_get_aggr_force_close_valmask(i, &valmask);
-		reg_write_coal_close.value = valmask.val;
-		reg_write_coal_close.value_mask = valmask.mask;
-		cmd_pyld[num_cmd] = ipahal_construct_imm_cmd(
-			IPA_IMM_CMD_REGISTER_WRITE,
-			&reg_write_coal_close, false);
-		if (!cmd_pyld[num_cmd]) {
-			IPAERR("failed to construct coal close IC\n");
-			goto fail_size_valid;
-		}
-		ipa3_init_imm_cmd_desc(&desc[num_cmd], cmd_pyld[num_cmd]);
-		++num_cmd;
-	}
-
-	/*
-	 * SRAM memory not allocated to hash tables. Sending
-	 * command to hash tables(filer/routing) operation not supported.
-	 */
-	if (!ipa3_ctx->ipa_fltrt_not_hashable) {
-		/* flushing ipa internal hashable rt rules cache */
-		if (ipa3_ctx->ipa_hw_type >= IPA_HW_v5_0) {
-			struct ipahal_reg_fltrt_cache_flush flush_cache;
-
-			memset(&flush_cache, 0, sizeof(flush_cache));
-			flush_cache.rt = true;
-			ipahal_get_fltrt_cache_flush_valmask(
-				&flush_cache, &valmask);
-			reg_write_cmd.offset = ipahal_get_reg_ofst(
-				IPA_FILT_ROUT_CACHE_FLUSH);
-		} else {
-			struct ipahal_reg_fltrt_hash_flush flush_hash;
-
-			memset(&flush_hash, 0, sizeof(flush_hash));
-			if (ip == IPA_IP_v4)
-				flush_hash.v4_rt = true;
-			else
-				flush_hash.v6_rt = true;
-			ipahal_get_fltrt_hash_flush_valmask(
-				&flush_hash, &valmask);
-			reg_write_cmd.offset = ipahal_get_reg_ofst(
-				IPA_FILT_ROUT_HASH_FLUSH);
-		}
-		reg_write_cmd.skip_pipeline_clear = false;
-		reg_write_cmd.pipeline_clear_options = IPAHAL_HPS_CLEAR;
-		reg_write_cmd.value = valmask.val;
-		reg_write_cmd.value_mask = valmask.mask;
-		cmd_pyld[num_cmd] = ipahal_construct_imm_cmd(
-				IPA_IMM_CMD_REGISTER_WRITE, &reg_write_cmd,
-							false);
-		if (!cmd_pyld[num_cmd]) {
-			IPAERR(
-			"fail construct register_write imm cmd. IP %d\n", ip);
-			goto fail_imm_cmd_construct;
-		}
-		ipa3_init_imm_cmd_desc(&desc[num_cmd], cmd_pyld[num_cmd]);
-		num_cmd++;
+	if (ipa_rt_add_flush_cmds(ip, desc, cmd_pyld, &num_cmd)) {
+		rc = -ENOMEM;
+		goto fail_imm_cmd_construct;
 	}
 
 	mem_cmd.is_read = false;
@@ -730,7 +1035,7 @@ int __ipa_commit_rt_v3(enum ipa_ip_type ip)
 		num_cmd++;
 	}
 
-	if (ipa3_send_cmd(num_cmd, desc)) {
+	if (ipa3_batch_send_cmd(num_cmd, desc)) {
 		IPAERR_RL("fail to send immediate command\n");
 		rc = -EFAULT;
 		goto fail_imm_cmd_construct;
@@ -760,17 +1065,21 @@ int __ipa_commit_rt_v3(enum ipa_ip_type ip)
 
 	__ipa_reap_sys_rt_tbls(ip);
 
+	list_for_each_entry(tbl, &set->head_rt_tbl_list, link)
+		tbl->dirty = false;
+	ipa3_ctx->rt_tbl_full_commit[ip] = false;
+
 fail_imm_cmd_construct:
 	for (i = 0 ; i < num_cmd ; i++)
 		ipahal_destroy_imm_cmd(cmd_pyld[i]);
 fail_size_valid:
 	if (alloc_params.hash_hdr.size)
-		ipahal_free_dma_mem(&alloc_params.hash_hdr);
-	ipahal_free_dma_mem(&alloc_params.nhash_hdr);
+		ipa3_batch_free_dma_mem(&alloc_params.hash_hdr);
+	ipa3_batch_free_dma_mem(&alloc_params.nhash_hdr);
 	if (alloc_params.hash_bdy.size)
-		ipahal_free_dma_mem(&alloc_params.hash_bdy);
+		ipa3_batch_free_dma_mem(&alloc_params.hash_bdy);
 	if (alloc_params.nhash_bdy.size)
-		ipahal_free_dma_mem(&alloc_params.nhash_bdy);
+		ipa3_batch_free_dma_mem(&alloc_params.nhash_bdy);
 
 no_rt_tbls:
 	return rc;
@@ -787,7 +1096,7 @@ no_rt_tbls:
  */
 struct ipa3_rt_tbl *__ipa3_find_rt_tbl(enum ipa_ip_type ip, const char *name)
 {
-	struct ipa3_rt_tbl *entry;
+	struct ipa3_rt_tbl *entry, *found = NULL;
 	struct ipa3_rt_tbl_set *set;
 
 	if (strnlen(name, IPA_RESOURCE_NAME_MAX) == IPA_RESOURCE_NAME_MAX) {
@@ -796,6 +1105,22 @@ struct ipa3_rt_tbl *__ipa3_find_rt_tbl(enum ipa_ip_type ip, const char *name)
 	}
 
 	set = &ipa3_ctx->rt_tbl_set[ip];
+	ipa3_ctx->stats.name_lookup_cnt++;
+	hash_for_each_possible(set->name_htable, entry, name_node,
+		ipa3_name_hkey(name)) {
+		ipa3_ctx->stats.name_lookup_cmp_cnt++;
+		if (strcmp(name, entry->name) ||
+			ipa3_check_idr_if_freed(entry))
+			continue;
+		if (found)
+			goto walk_list;
+		found = entry;
+	}
+
+	return found;
+
+walk_list:
+	/* duplicate names, return the first one in list order */
 	list_for_each_entry(entry, &set->head_rt_tbl_list, link) {
 		if (!ipa3_check_idr_if_freed(entry) &&
 			!strcmp(name, entry->name))
@@ -897,6 +1222,8 @@ static struct ipa3_rt_tbl *__ipa_add_rt_tbl(enum ipa_ip_type ip,
 		set->tbl_cnt++;
 		entry->rule_ids = &set->rule_ids;
 		list_add(&entry->link, &set->head_rt_tbl_list);
+		hash_add(set->name_htable, &entry->name_node,
+			ipa3_name_hkey(entry->name));
 
 		IPADBG("add rt tbl idx=%d tbl_cnt=%d ip=%d\n", entry->idx,
 				set->tbl_cnt, ip);
@@ -908,12 +1235,15 @@ static struct ipa3_rt_tbl *__ipa_add_rt_tbl(enum ipa_ip_type ip,
 			goto ipa_insert_failed;
 		}
 		entry->id = id;
+		/* a new table changes the tables layout */
+		ipa3_ctx->rt_tbl_full_commit[ip] = true;
 	}
 
 	return entry;
 ipa_insert_failed:
 	set->tbl_cnt--;
 	list_del(&entry->link);
+	hash_del(&entry->name_node);
 	idr_destroy(entry->rule_ids);
 fail_rt_idx_alloc:
 	entry->cookie = 0;
@@ -948,8 +1278,10 @@ static int __ipa_del_rt_tbl(struct ipa3_rt_tbl *entry)
 	}
 
 	rset = &ipa3_ctx->reap_rt_tbl_set[ip];
+	ipa3_ctx->rt_tbl_full_commit[ip] = true;
 
 	entry->rule_ids = NULL;
+	hash_del(&entry->name_node);
 	if (entry->in_sys[IPA_RULE_HASHABLE] ||
 		entry->in_sys[IPA_RULE_NON_HASHABLE]) {
 		list_move(&entry->link, &rset->head_rt_tbl_list);
@@ -1125,6 +1457,7 @@ static int __ipa_finish_rt_rule_add(struct ipa3_rt_entry *entry, u32 *rule_hdl,
 		tbl->idx, tbl->rule_cnt, entry->rule_id);
 	*rule_hdl = id;
 	entry->id = id;
+	tbl->dirty = true;
 
 	return 0;
 
@@ -1815,6 +2148,7 @@ int __ipa3_del_rt_rule(u32 rule_hdl)
 		__ipa3_release_hdr_proc_ctx(entry->proc_ctx->id);
 	list_del(&entry->link);
 	entry->tbl->rule_cnt--;
+	entry->tbl->dirty = true;
 	IPADBG("del rt rule tbl_idx=%d rule_cnt=%d rule_id=%d\n ref_cnt=%u",
 		entry->tbl->idx, entry->tbl->rule_cnt,
 		entry->rule_id, entry->tbl->ref_cnt);
@@ -1960,6 +2294,7 @@ int ipa3_reset_rt(enum ipa_ip_type ip, bool user_only)
 	rset = &ipa3_ctx->reap_rt_tbl_set[ip];
 	mutex_lock(&ipa3_ctx->lock);
 	IPADBG("reset rt ip=%d\n", ip);
+	ipa3_ctx->rt_tbl_full_commit[ip] = true;
 	list_for_each_entry_safe(tbl, tbl_next, &set->head_rt_tbl_list, link) {
 		tbl_user = false;
 		list_for_each_entry_safe(rule, rule_next,
@@ -2040,6 +2375,7 @@ int ipa3_reset_rt(enum ipa_ip_type ip, bool user_only)
 		if (tbl->idx != apps_start_idx) {
 			if (!user_only || tbl_user) {
 				tbl->rule_ids = NULL;
+				hash_del(&tbl->name_node);
 				if (tbl->in_sys[IPA_RULE_HASHABLE] ||
 					tbl->in_sys[IPA_RULE_NON_HASHABLE]) {
 					list_move(&tbl->link,
@@ -2244,6 +2580,7 @@ static int __ipa_mdfy_rt_rule(struct ipa_rt_rule_mdfy_i *rtrule)
 
 	entry->hw_len = 0;
 	entry->prio = 0;
+	entry->tbl->dirty = true;
 	if (rtrule->rule.enable_stats)
 		entry->cnt_idx = rtrule->rule.cnt_idx;
 	else
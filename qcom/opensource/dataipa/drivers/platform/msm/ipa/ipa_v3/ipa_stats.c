@@ -11,6 +11,8 @@
 #include <linux/device.h>
 #include <linux/slab.h>
 #include <linux/uaccess.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
 #include "ipa_stats.h"
 #include <linux/fs.h>
 #include "ipa_i.h"
@@ -23,6 +25,9 @@
 #define DRIVER_NAME "ipa_lnx_stats_ioctl"
 #define DEV_NAME_IPA_LNX_STATS "ipa-lnx-stats"
 
+#define IPA_LNX_HW_STATS_SHM_INTERVAL_MS 1000
+#define IPA_LNX_HW_STATS_SHM_READ_TRIES 16
+
 #define IPA_STATS_DBG(fmt, args...) \
 	do { \
 		pr_debug(DEV_NAME_IPA_LNX_STATS " %s:%d " fmt, __func__,\
@@ -50,10 +55,18 @@ static unsigned int dev_num = 1;
 static struct cdev ipa_lnx_stats_ioctl_cdev;
 static struct class *class;
 static dev_t device;
+static bool ipa_lnx_stats_ioctl_ready;
 
 struct ipa_lnx_stats_tlpd_ctx ipa_lnx_agent_ctx;
 static DEFINE_MUTEX(ipa_lnx_ctx_mutex);
 
+static struct ipa_lnx_hw_stats_shm *hw_stats_shm;
+static size_t hw_stats_shm_size;
+static unsigned int hw_stats_shm_maps;
+static DEFINE_MUTEX(hw_stats_shm_mutex);
+static void ipa_hw_stats_shm_work_func(struct work_struct *work);
+static DECLARE_DELAYED_WORK(hw_stats_shm_work, ipa_hw_stats_shm_work_func);
+
 struct wlan_intf_mode_cnt {
 	u8 ap_cnt;
 	u8 sta_cnt;
@@ -1733,6 +1746,294 @@ static int ipa_stats_get_alloc_info(unsigned long arg)
 	return 0;
 }
 
+/**
+ * ipa_hw_stats_shm_write_begin() - open an update of the shared region
+ * @shm: region to update
+ *
+ * Leaves seq odd so that readers retry until the matching
+ * ipa_hw_stats_shm_write_end(). Writers are serialized by the caller.
+ */
+void ipa_hw_stats_shm_write_begin(struct ipa_lnx_hw_stats_shm *shm)
+{
+	WRITE_ONCE(shm->seq, shm->seq + 1);
+	smp_wmb();
+}
+
+/**
+ * ipa_hw_stats_shm_write_end() - close an update of the shared region
+ * @shm: region to update
+ */
+void ipa_hw_stats_shm_write_end(struct ipa_lnx_hw_stats_shm *shm)
+{
+	smp_wmb();
+	WRITE_ONCE(shm->seq, shm->seq + 1);
+}
+
+/**
+ * ipa_hw_stats_shm_read_client() - copy one client out of the region
+ * @shm: region to read
+ * @client: index in shm->client[]
+ * @out: where to copy the counters
+ *
+ * Reader side of the sequence count, the same steps a userspace reader of
+ * the mapping has to follow.
+ *
+ * Return: 0 on a consistent copy, -EINVAL for a bad client, -EAGAIN if
+ * the region kept changing under the reader
+ */
+int ipa_hw_stats_shm_read_client(const struct ipa_lnx_hw_stats_shm *shm,
+	u32 client, struct ipa_lnx_hw_stats_client *out)
+{
+	int tries;
+	u32 seq;
+
+	if (client >= READ_ONCE(shm->num_clients))
+		return -EINVAL;
+
+	for (tries = 0; tries < IPA_LNX_HW_STATS_SHM_READ_TRIES; tries++) {
+		seq = smp_load_acquire(&shm->seq);
+		if (seq & 1) {
+			cpu_relax();
+			continue;
+		}
+
+		*out = shm->client[client];
+
+		smp_rmb();
+		if (READ_ONCE(shm->seq) == seq)
+			return 0;
+	}
+
+	return -EAGAIN;
+}
+
+/**
+ * ipa_hw_stats_shm_publish() - copy the HW stats driver caches into the
+ * shared region
+ *
+ * Called by every reader of the quota, teth and drop counters right after
+ * it updated the caches, so the region follows whatever IPA SRAM reads the
+ * driver already does instead of issuing its own.
+ */
+void ipa_hw_stats_shm_publish(void)
+{
+	struct ipa_hw_stats *hw_stats = ipa3_ctx->hw_stats;
+	struct ipa_lnx_hw_stats_client *out;
+	struct ipa_quota_stats *quota;
+	struct ipa_quota_stats *teth;
+	struct ipa_drop_stats *drop;
+	int i, j;
+
+	if (!hw_stats)
+		return;
+
+	mutex_lock(&hw_stats_shm_mutex);
+	if (!hw_stats_shm)
+		goto unlock;
+
+	ipa_hw_stats_shm_write_begin(hw_stats_shm);
+
+	for (i = 0; i < IPA_CLIENT_MAX; i++) {
+		out = &hw_stats_shm->client[i];
+		quota = &hw_stats->quota.stats.client[i];
+		drop = &hw_stats->drop.stats.client[i];
+
+		out->quota_ipv4_bytes = quota->num_ipv4_bytes;
+		out->quota_ipv6_bytes = quota->num_ipv6_bytes;
+		out->quota_ipv4_pkts = quota->num_ipv4_pkts;
+		out->quota_ipv6_pkts = quota->num_ipv6_pkts;
+		out->drop_pkts = drop->drop_packet_cnt;
+		out->drop_bytes = drop->drop_byte_cnt;
+
+		out->teth_ipv4_bytes = 0;
+		out->teth_ipv6_bytes = 0;
+		out->teth_ipv4_pkts = 0;
+		out->teth_ipv6_pkts = 0;
+		if (!IPA_CLIENT_IS_PROD(i))
+			continue;
+
+		for (j = 0; j < IPA_CLIENT_MAX; j++) {
+			if (!IPA_CLIENT_IS_CONS(j))
+				continue;
+			teth = &hw_stats->teth.prod_stats_sum[i].client[j];
+			out->teth_ipv4_bytes += teth->num_ipv4_bytes;
+			out->teth_ipv6_bytes += teth->num_ipv6_bytes;
+			out->teth_ipv4_pkts += teth->num_ipv4_pkts;
+			out->teth_ipv6_pkts += teth->num_ipv6_pkts;
+		}
+	}
+	hw_stats_shm->update_time_ns = ktime_get_ns();
+
+	ipa_hw_stats_shm_write_end(hw_stats_shm);
+
+unlock:
+	mutex_unlock(&hw_stats_shm_mutex);
+}
+
+/**
+ * ipa_hw_stats_shm_refresh() - read the HW counters on behalf of the
+ * shared region
+ *
+ * Only needed when no other reader of the counters published during the
+ * last interval. The counters live in IPA SRAM, so this still costs a DMA
+ * on the command pipe, at most once per interval.
+ */
+static void ipa_hw_stats_shm_refresh(void)
+{
+	struct ipa_active_client_logging_info log_info;
+	struct ipa_hw_stats *hw_stats = ipa3_ctx->hw_stats;
+	u64 age;
+
+	if (!(hw_stats && hw_stats->enabled))
+		return;
+
+	mutex_lock(&hw_stats_shm_mutex);
+	age = hw_stats_shm ?
+		ktime_get_ns() - hw_stats_shm->update_time_ns : 0;
+	mutex_unlock(&hw_stats_shm_mutex);
+	if (age < (u64)IPA_LNX_HW_STATS_SHM_INTERVAL_MS * NSEC_PER_MSEC)
+		return;
+
+	/*
+	 * HW counters do not move while IPA is power collapsed, the periodic
+	 * refresh must not be the one keeping the clocks up.
+	 */
+	IPA_ACTIVE_CLIENTS_PREP_SIMPLE(log_info);
+	if (ipa3_inc_client_enable_clks_no_block(&log_info))
+		return;
+
+	/* each of these publishes the region once its cache is updated */
+	if (ipa_get_quota_stats(NULL))
+		IPA_STATS_ERR("ipa_get_quota_stats failed\n");
+	if (hw_stats->teth_stats_enabled && ipa_get_teth_stats())
+		IPA_STATS_ERR("ipa_get_teth_stats failed\n");
+	if (ipa_get_drop_stats(NULL))
+		IPA_STATS_ERR("ipa_get_drop_stats failed\n");
+
+	ipa3_dec_client_disable_clks(&log_info);
+}
+
+static void ipa_hw_stats_shm_work_func(struct work_struct *work)
+{
+	ipa_hw_stats_shm_refresh();
+
+	/* keep refreshing only while someone has the region mapped */
+	mutex_lock(&hw_stats_shm_mutex);
+	if (hw_stats_shm && hw_stats_shm_maps)
+		schedule_delayed_work(&hw_stats_shm_work,
+			msecs_to_jiffies(IPA_LNX_HW_STATS_SHM_INTERVAL_MS));
+	mutex_unlock(&hw_stats_shm_mutex);
+}
+
+/*
+ * Called with hw_stats_shm_mutex held. Kicking the work on every new
+ * mapping is cheap, the refresh skips the SRAM read while the region is
+ * recent.
+ */
+static void ipa_hw_stats_shm_get_map(void)
+{
+	hw_stats_shm_maps++;
+	if (hw_stats_shm)
+		mod_delayed_work(system_wq, &hw_stats_shm_work, 0);
+}
+
+static void ipa_hw_stats_shm_vm_open(struct vm_area_struct *vma)
+{
+	mutex_lock(&hw_stats_shm_mutex);
+	ipa_hw_stats_shm_get_map();
+	mutex_unlock(&hw_stats_shm_mutex);
+}
+
+static void ipa_hw_stats_shm_vm_close(struct vm_area_struct *vma)
+{
+	mutex_lock(&hw_stats_shm_mutex);
+	if (hw_stats_shm_maps)
+		hw_stats_shm_maps--;
+	mutex_unlock(&hw_stats_shm_mutex);
+}
+
+static const struct vm_operations_struct ipa_hw_stats_shm_vm_ops = {
+	.open = ipa_hw_stats_shm_vm_open,
+	.close = ipa_hw_stats_shm_vm_close,
+};
+
+static int ipa_stats_mmap(struct file *filp, struct vm_area_struct *vma)
+{
+	int ret;
+
+	if (vma->vm_pgoff ||
+		vma->vm_end - vma->vm_start > hw_stats_shm_size) {
+		IPA_STATS_ERR("invalid mmap range\n");
+		return -EINVAL;
+	}
+
+	/* the region is only ever written by the driver */
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(6, 3, 0))
+	vm_flags_clear(vma, VM_MAYWRITE);
+#else
+	vma->vm_flags &= ~VM_MAYWRITE;
+#endif
+
+	mutex_lock(&hw_stats_shm_mutex);
+	if (!hw_stats_shm) {
+		ret = -ENODEV;
+		goto unlock;
+	}
+
+	ret = remap_vmalloc_range(vma, hw_stats_shm, 0);
+	if (ret) {
+		IPA_STATS_ERR("remap_vmalloc_range failed %d\n", ret);
+		goto unlock;
+	}
+
+	vma->vm_ops = &ipa_hw_stats_shm_vm_ops;
+	ipa_hw_stats_shm_get_map();
+
+unlock:
+	mutex_unlock(&hw_stats_shm_mutex);
+	return ret;
+}
+
+static int ipa_hw_stats_shm_init(void)
+{
+	struct ipa_lnx_hw_stats_shm *shm;
+
+	hw_stats_shm_size = PAGE_ALIGN(struct_size(shm, client,
+		IPA_CLIENT_MAX));
+	shm = vmalloc_user(hw_stats_shm_size);
+	if (!shm)
+		return -ENOMEM;
+
+	shm->magic = IPA_LNX_HW_STATS_SHM_MAGIC;
+	shm->version = IPA_LNX_HW_STATS_SHM_VERSION;
+	shm->num_clients = IPA_CLIENT_MAX;
+	shm->interval_ms = IPA_LNX_HW_STATS_SHM_INTERVAL_MS;
+
+	mutex_lock(&hw_stats_shm_mutex);
+	hw_stats_shm = shm;
+	mutex_unlock(&hw_stats_shm_mutex);
+	return 0;
+}
+
+/*
+ * Pages still mapped by userspace hold their own reference and outlive the
+ * vfree(), they just stop being refreshed.
+ */
+static void ipa_hw_stats_shm_deinit(void)
+{
+	struct ipa_lnx_hw_stats_shm *shm;
+
+	mutex_lock(&hw_stats_shm_mutex);
+	shm = hw_stats_shm;
+	hw_stats_shm = NULL;
+	mutex_unlock(&hw_stats_shm_mutex);
+
+	cancel_delayed_work_sync(&hw_stats_shm_work);
+	vfree(shm);
+}
+
 static long ipa_lnx_stats_ioctl(struct file *filp,
 	unsigned int cmd,
 	unsigned long arg)
@@ -1864,6 +2165,7 @@ const struct file_operations ipa_stats_fops = {
 	.open = ipa_stats_ioctl_open,
 	.read = NULL,
 	.unlocked_ioctl = ipa_lnx_stats_ioctl,
+	.mmap = ipa_stats_mmap,
 };
 
 static int ipa_tlpd_stats_ioctl_init(void)
@@ -1903,6 +2205,7 @@ static int ipa_tlpd_stats_ioctl_init(void)
 
 	IPA_STATS_ERR("IPA %s major(%d) initial ok :>>>>\n",
 		DRIVER_NAME, ipa_lnx_stats_ioctl_major);
+	ipa_lnx_stats_ioctl_ready = true;
 	return 0;
 
 cdev_add_err:
@@ -1925,11 +2228,36 @@ int ipa_tlpd_stats_init(void)
 		return -1;
 	}
 	memset(&poll_pack_and_cred_info, 0, sizeof(poll_pack_and_cred_info));
+
+	/* the ioctls keep working without the shared region */
+	if (ipa_hw_stats_shm_init())
+		IPA_STATS_ERR("HW stats shared region alloc failure\n");
+
 	IPA_STATS_ERR("IPA_LNX_STATS_IOCTL init success\n");
 
 	return 0;
 }
 
+/**
+ * ipa_tlpd_stats_deinit() - undo ipa_tlpd_stats_init()
+ *
+ * Cancels the shared region refresh and frees the region before removing
+ * the device, so that a later ipa_tlpd_stats_init() starts clean.
+ */
+void ipa_tlpd_stats_deinit(void)
+{
+	ipa_hw_stats_shm_deinit();
+
+	if (!ipa_lnx_stats_ioctl_ready)
+		return;
+
+	cdev_del(&ipa_lnx_stats_ioctl_cdev);
+	device_destroy(class, device);
+	class_destroy(class);
+	unregister_chrdev_region(device, dev_num);
+	ipa_lnx_stats_ioctl_ready = false;
+}
+
 /* Non periodic/Event based stats update */
 int ipa3_update_usb_per_stats(enum ipa_per_stats_type_e stats_type, uint32_t data) {
 	union ipa_peripheral_stats *peripheral_stats =
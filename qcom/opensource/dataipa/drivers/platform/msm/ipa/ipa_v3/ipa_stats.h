@@ -8,6 +8,8 @@
 #ifndef _IPA_LNX_STATS_I_H_
 #define _IPA_LNX_STATS_I_H_
 
+#include "ipa_lnx_stats_shm.h"
+
 /* This whole header file is a copy of ipa_lnx_agent.h */
 
 /*
@@ -414,6 +416,12 @@ enum ipa_lnx_stats_ioc_cmd_type {
 };
 
 int ipa_tlpd_stats_init(void);
+void ipa_tlpd_stats_deinit(void);
+void ipa_hw_stats_shm_publish(void);
+void ipa_hw_stats_shm_write_begin(struct ipa_lnx_hw_stats_shm *shm);
+void ipa_hw_stats_shm_write_end(struct ipa_lnx_hw_stats_shm *shm);
+int ipa_hw_stats_shm_read_client(const struct ipa_lnx_hw_stats_shm *shm,
+	u32 client, struct ipa_lnx_hw_stats_client *out);
 
 /* Peripheral stats for Q6, should be in the same order, defined by Q6 */
 struct ipa_peripheral_mdm_stats {
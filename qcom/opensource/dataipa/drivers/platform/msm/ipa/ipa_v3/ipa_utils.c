@@ -11,6 +11,7 @@
 #include <linux/interconnect.h>
 #include <linux/msm_gsi.h>
 #include <linux/elf.h>
+#include <linux/jhash.h>
 #include "ipa_i.h"
 #include "ipahal.h"
 #include "ipahal_nat.h"
@@ -10506,6 +10507,17 @@ void ipa3_id_remove(u32 id)
 	spin_unlock(&ipa3_ctx->idr_lock);
 }
 
+/**
+ * ipa3_name_hkey() - hash key of a resource name
+ * @name: [in] header or routing table name
+ *
+ * Returns: key to use with the hdr/rt tbl name hashtables
+ */
+u32 ipa3_name_hkey(const char *name)
+{
+	return jhash(name, strnlen(name, IPA_RESOURCE_NAME_MAX), 0);
+}
+
 void ipa3_tag_destroy_imm(void *user1, int user2)
 {
 	ipahal_destroy_imm_cmd(user1);
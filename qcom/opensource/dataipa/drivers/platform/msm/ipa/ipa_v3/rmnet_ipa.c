@@ -1524,7 +1524,8 @@ send:
 	 * both data packets and command will be routed to
 	 * IPA_CLIENT_Q6_WAN_CONS based on status configuration
 	 */
-	ret = ipa3_tx_dp(IPA_CLIENT_APPS_WAN_PROD, skb, NULL);
+	ret = ipa3_tx_dp_xmit_more(IPA_CLIENT_APPS_WAN_PROD, skb, NULL,
+		netdev_xmit_more());
 	if (ret) {
 		atomic_dec(&wwan_ptr->outstanding_pkts);
 		if (ret == -EPIPE) {
@@ -1668,6 +1669,53 @@ static void apps_ipa_packet_receive_notify(void *priv,
 	}
 }
 
+/**
+ * apps_ipa_packet_receive_list_notify() - Rx notify for a NAPI poll
+ * @priv: the rmnet_ipa net device
+ * @skbs: the skbs of the poll, linked through skb->list
+ *
+ * Same as apps_ipa_packet_receive_notify() for IPA_RECEIVE, but hands all
+ * the skbs to the stack in one go so they are processed as a batch.
+ */
+static void apps_ipa_packet_receive_list_notify(void *priv,
+		struct list_head *skbs)
+{
+	struct net_device *dev = (struct net_device *)priv;
+	struct sk_buff *skb;
+
+	list_for_each_entry(skb, skbs, list) {
+		skb->dev = IPA_NETDEV();
+		skb->protocol = htons(ETH_P_MAP);
+		skb_set_mac_header(skb, 0);
+
+		/* default traffic uses rx-0 queue. */
+		skb_record_rx_queue(skb, 0);
+		trace_rmnet_ipa_netif_rcv_skb3(skb, dev->stats.rx_packets);
+		dev->stats.rx_packets++;
+		dev->stats.rx_bytes += skb->len;
+	}
+
+	netif_receive_skb_list(skbs);
+}
+
+/**
+ * apps_ipa_set_rx_list() - take the WAN rx of a NAPI poll as an skb list
+ * @hdl: handle of the ingress WAN pipe
+ *
+ * Only done with NAPI, where the IPA driver batches completions per poll,
+ * and GRO aggregation, where the IPA driver passes the skbs on as is.
+ * Otherwise the pipe keeps the per skb apps_ipa_packet_receive_notify().
+ */
+static void apps_ipa_set_rx_list(u32 hdl)
+{
+	if (!ipa3_rmnet_res.ipa_napi_enable ||
+		!ipa3_ctx->ipa_client_apps_wan_cons_agg_gro)
+		return;
+
+	if (ipa3_set_rx_list_notify(hdl, apps_ipa_packet_receive_list_notify))
+		IPAWANERR("failed to set list rx on hdl %u\n", hdl);
+}
+
 /* Send RSC endpoint info to modem using QMI indication message */
 static int ipa_send_wan_pipe_ind_to_modem(int ingress_eps_mask)
 {
@@ -1815,6 +1863,7 @@ static int handle3_ingress_format(struct net_device *dev,
 		mutex_unlock(&rmnet_ipa3_ctx->pipe_handle_guard);
 		goto end;
 	}
+	apps_ipa_set_rx_list(rmnet_ipa3_ctx->ipa3_to_apps_hdl);
 	IPAWANDBG("ingress WAN pipe setup successfully\n");
 
 	if (ipa3_ctx->rmnet_ctl_enable) {
@@ -2103,18 +2152,21 @@ static int ipa3_setup_apps_wan_cons_pipes(
 
 	/* Pass dummy handle if coal is already setup to avoid overriding */
 	if (ipa_wan_ep_cfg->client == IPA_CLIENT_APPS_WAN_CONS &&
-		(*ingress_eps_mask & IPA_AP_INGRESS_EP_COALS))
+		(*ingress_eps_mask & IPA_AP_INGRESS_EP_COALS)) {
 		rc = ipa_setup_sys_pipe(&rmnet_ipa3_ctx->ipa_to_apps_ep_cfg,
 			&wan_hdl);
-	else
+	} else {
 		rc = ipa_setup_sys_pipe(&rmnet_ipa3_ctx->ipa_to_apps_ep_cfg,
 			&rmnet_ipa3_ctx->ipa3_to_apps_hdl);
+		wan_hdl = rmnet_ipa3_ctx->ipa3_to_apps_hdl;
+	}
 
 	if (rc) {
 		pipe_status->status = IPA_PIPE_SETUP_FAILURE;
 		IPAWANERR("failed to setup default/coal pipe rc = %d\n", rc);
 		return rc;
 	}
+	apps_ipa_set_rx_list(wan_hdl);
 
 	IPAWANDBG("Ingress default/coal pipe setup successfully\n");
 
@@ -1755,6 +1755,134 @@ static int ipa_pm_ut_simple_exception(void *priv)
 	return rc;
 }
 
+/*test 12*/
+static int ipa_pm_ut_tput_ramp(void *priv)
+{
+	int rc = 0;
+	int hdl_USB, idx;
+
+	struct ipa_pm_init_params init_params = {
+		.threshold_size = 2,
+		.default_threshold = {600, 1000}
+	};
+
+	struct ipa_pm_register_params USB_params = {
+		.name = "USB",
+		.group = IPA_PM_GROUP_DEFAULT,
+		.skip_clk_vote = 0,
+		.callback = ipa_pm_call_back,
+	};
+
+	rc = ipa_pm_init(&init_params);
+	if (rc) {
+		IPA_UT_ERR("Fail to init ipa_pm - rc = %d\n", rc);
+		IPA_UT_TEST_FAIL_REPORT("fail to init params");
+		return -EFAULT;
+	}
+
+	rc = ipa_pm_register(&USB_params, &hdl_USB);
+	if (rc) {
+		IPA_UT_ERR("fail to register client 1 rc = %d\n", rc);
+		IPA_UT_TEST_FAIL_REPORT("fail to register");
+		return -EFAULT;
+	}
+
+	rc = ipa_pm_set_throughput(hdl_USB, 500);
+	if (rc) {
+		IPA_UT_ERR("fail to set tput for client 1 rc = %d\n", rc);
+		IPA_UT_TEST_FAIL_REPORT("fail to set perf profile");
+		return -EFAULT;
+	}
+
+	rc = ipa_pm_activate_sync(hdl_USB);
+	if (rc) {
+		IPA_UT_ERR("fail to activate sync for client 1- rc = %d\n", rc);
+		IPA_UT_TEST_FAIL_REPORT("activate sync failed");
+		return -EFAULT;
+	}
+
+	idx = ipa3_ctx->ipa3_active_clients.bus_vote_idx;
+	if (idx != 1) {
+		IPA_UT_ERR("clock plan is at %d\n", idx);
+		IPA_UT_TEST_FAIL_REPORT("wrong clock plan");
+		return -EINVAL;
+	}
+
+	/* rising votes, the clock should be ahead of the 900 vote */
+	rc = ipa_pm_set_throughput(hdl_USB, 900);
+	if (rc) {
+		IPA_UT_ERR("fail to set tput for client 1 rc = %d\n", rc);
+		IPA_UT_TEST_FAIL_REPORT("fail to set perf profile");
+		return -EFAULT;
+	}
+
+	idx = ipa3_ctx->ipa3_active_clients.bus_vote_idx;
+	if (idx != 3) {
+		IPA_UT_ERR("clock plan is at %d\n", idx);
+		IPA_UT_TEST_FAIL_REPORT("clock plan not ramped up");
+		return -EINVAL;
+	}
+
+	/* a short dip right after the burst should not drop the clock */
+	rc = ipa_pm_set_throughput(hdl_USB, 500);
+	if (rc) {
+		IPA_UT_ERR("fail to set tput for client 1 rc = %d\n", rc);
+		IPA_UT_TEST_FAIL_REPORT("fail to set perf profile");
+		return -EFAULT;
+	}
+
+	idx = ipa3_ctx->ipa3_active_clients.bus_vote_idx;
+	if (idx != 2) {
+		IPA_UT_ERR("clock plan is at %d\n", idx);
+		IPA_UT_TEST_FAIL_REPORT("clock plan not held");
+		return -EINVAL;
+	}
+
+	/* let the ramp and the hold expire, then vote 900 for a while */
+	msleep(1100);
+	rc = ipa_pm_set_throughput(hdl_USB, 900);
+	if (rc) {
+		IPA_UT_ERR("fail to set tput for client 1 rc = %d\n", rc);
+		IPA_UT_TEST_FAIL_REPORT("fail to set perf profile");
+		return -EFAULT;
+	}
+
+	idx = ipa3_ctx->ipa3_active_clients.bus_vote_idx;
+	if (idx != 2) {
+		IPA_UT_ERR("clock plan is at %d\n", idx);
+		IPA_UT_TEST_FAIL_REPORT("wrong clock plan");
+		return -EINVAL;
+	}
+
+	/* the old 900 vote was only replaced now, it should be held */
+	msleep(600);
+	rc = ipa_pm_set_throughput(hdl_USB, 500);
+	if (rc) {
+		IPA_UT_ERR("fail to set tput for client 1 rc = %d\n", rc);
+		IPA_UT_TEST_FAIL_REPORT("fail to set perf profile");
+		return -EFAULT;
+	}
+
+	idx = ipa3_ctx->ipa3_active_clients.bus_vote_idx;
+	if (idx != 2) {
+		IPA_UT_ERR("clock plan is at %d\n", idx);
+		IPA_UT_TEST_FAIL_REPORT("old vote not held");
+		return -EINVAL;
+	}
+
+	/* once the hold expired the clock should follow the vote again */
+	msleep(1100);
+	idx = ipa3_ctx->ipa3_active_clients.bus_vote_idx;
+	if (idx != 1) {
+		IPA_UT_ERR("clock plan is at %d\n", idx);
+		IPA_UT_TEST_FAIL_REPORT("clock plan not dropped after hold");
+		return -EINVAL;
+	}
+
+	rc = clean_up(1, hdl_USB);
+	return rc;
+}
+
 /* Suite definition block */
 IPA_UT_DEFINE_SUITE_START(pm, "PM for IPA",
 	ipa_pm_ut_setup, ipa_pm_ut_teardown)
@@ -1807,4 +1935,8 @@ IPA_UT_DEFINE_SUITE_START(pm, "PM for IPA",
 		"throughput while passing simple exception",
 		ipa_pm_ut_simple_exception,
 		true, IPA_HW_v4_0, IPA_HW_MAX),
+	IPA_UT_ADD_TEST(tput_ramp,
+		"throughput ramp and hold",
+		ipa_pm_ut_tput_ramp,
+		true, IPA_HW_v4_0, IPA_HW_MAX),
 } IPA_UT_DEFINE_SUITE_END(pm);
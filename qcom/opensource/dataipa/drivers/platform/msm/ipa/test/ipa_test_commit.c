@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2026, The Linux Foundation. All rights reserved.
+ */
+
+#include "ipa_ut_framework.h"
+#include "ipa_i.h"
+
+/* longer than IPA_SEND_MAX_DESC, ipa3_send() rejects such a chain */
+#define IPA_TEST_COMMIT_BAD_CHAIN_LEN 30
+
+static int ipa_test_commit_suite_setup(void **ppriv)
+{
+	IPA_UT_DBG("Start Setup\n");
+
+	return 0;
+}
+
+static int ipa_test_commit_suite_teardown(void *priv)
+{
+	IPA_UT_DBG("Start Teardown\n");
+
+	return 0;
+}
+
+/*
+ * Queue NO-OP commands to a batch, in chains of the given lengths. All the
+ * descriptors share a single payload, released by the caller.
+ */
+static struct ipa3_cmd_batch *ipa_test_commit_batch_alloc(
+	struct ipahal_imm_cmd_pyld *nop, const u16 *chain_len, int num_chain)
+{
+	struct ipa3_cmd_batch *batch;
+	int i, j;
+
+	batch = kzalloc(sizeof(*batch), GFP_KERNEL);
+	if (!batch)
+		return NULL;
+	INIT_LIST_HEAD(&batch->free_list);
+
+	for (i = 0; i < num_chain; i++) {
+		for (j = 0; j < chain_len[i]; j++)
+			ipa3_init_imm_cmd_desc(
+				&batch->desc[batch->num_desc++], nop);
+		batch->chain_len[batch->num_chain++] = chain_len[i];
+	}
+
+	return batch;
+}
+
+static int ipa_test_commit_send_nop(void)
+{
+	struct ipahal_imm_cmd_pyld *nop;
+	struct ipa3_desc desc;
+	int rc;
+
+	nop = ipahal_construct_nop_imm_cmd(false,
+		IPAHAL_FULL_PIPELINE_CLEAR, false);
+	if (!nop)
+		return -ENOMEM;
+
+	ipa3_init_imm_cmd_desc(&desc, nop);
+	rc = ipa3_send_cmd(1, &desc);
+	ipahal_destroy_imm_cmd(nop);
+
+	return rc;
+}
+
+static int ipa_test_commit_run_batch(const u16 *chain_len, int num_chain,
+	int expected)
+{
+	struct ipahal_imm_cmd_pyld *nop;
+	struct ipa3_cmd_batch *batch;
+	int rc = 0;
+	int res;
+
+	nop = ipahal_construct_nop_imm_cmd(false,
+		IPAHAL_FULL_PIPELINE_CLEAR, false);
+	if (!nop) {
+		IPA_UT_TEST_FAIL_REPORT("fail to construct nop");
+		return -ENOMEM;
+	}
+
+	batch = ipa_test_commit_batch_alloc(nop, chain_len, num_chain);
+	if (!batch) {
+		IPA_UT_TEST_FAIL_REPORT("fail to alloc batch");
+		rc = -ENOMEM;
+		goto free_nop;
+	}
+
+	res = ipa3_cmd_batch_send(batch);
+	IPA_UT_LOG("%u descs in %u chains: res=%d waits=%u\n",
+		batch->num_desc, batch->num_chain, res, batch->send_cnt);
+
+	if (res != expected) {
+		IPA_UT_LOG("res %d, expected %d\n", res, expected);
+		IPA_UT_TEST_FAIL_REPORT("unexpected batch result");
+		rc = -EFAULT;
+		goto free_batch;
+	}
+
+	if (batch->send_cnt != 1) {
+		IPA_UT_LOG("%u waits\n", batch->send_cnt);
+		IPA_UT_TEST_FAIL_REPORT("batch not sent with a single wait");
+		rc = -EFAULT;
+		goto free_batch;
+	}
+
+	/* the posted chains were waited for, the pipe must still work */
+	if (ipa_test_commit_send_nop()) {
+		IPA_UT_TEST_FAIL_REPORT("cmd pipe stuck after the batch");
+		rc = -EFAULT;
+	}
+
+free_batch:
+	kfree(batch);
+free_nop:
+	ipahal_destroy_imm_cmd(nop);
+	return rc;
+}
+
+static int ipa_test_commit_batch_chains(void *priv)
+{
+	static const u16 chain_len[] = {
+		IPA3_CMD_BATCH_CHAIN_LEN, IPA3_CMD_BATCH_CHAIN_LEN, 5
+	};
+
+	return ipa_test_commit_run_batch(chain_len, ARRAY_SIZE(chain_len), 0);
+}
+
+static int ipa_test_commit_batch_unwind(void *priv)
+{
+	static const u16 chain_len[] = {
+		IPA3_CMD_BATCH_CHAIN_LEN, IPA_TEST_COMMIT_BAD_CHAIN_LEN, 5
+	};
+
+	IPA_UT_LOG("second chain is expected to be rejected with a WARN\n");
+	return ipa_test_commit_run_batch(chain_len, ARRAY_SIZE(chain_len),
+		-EFAULT);
+}
+
+static int ipa_test_commit_bad_mask(void *priv)
+{
+	if (ipa3_commit_tables(0) != -EINVAL) {
+		IPA_UT_TEST_FAIL_REPORT("empty mask accepted");
+		return -EFAULT;
+	}
+
+	if (ipa3_commit_tables(IPA3_COMMIT_ALL + 1) != -EINVAL) {
+		IPA_UT_TEST_FAIL_REPORT("unknown table accepted");
+		return -EFAULT;
+	}
+
+	return 0;
+}
+
+static int ipa_test_commit_all(void *priv)
+{
+	u32 commits = ipa3_ctx->stats.commit_tables;
+	u32 waits = ipa3_ctx->stats.commit_tables_waits;
+	int res;
+
+	/*
+	 * Without a full commit pending, the tables only need a few DMA
+	 * commands each, well within IPA3_CMD_BATCH_MAX_DESC.
+	 */
+	res = ipa3_commit_tables(IPA3_COMMIT_ALL);
+	if (res) {
+		IPA_UT_LOG("commit failed %d\n", res);
+		IPA_UT_TEST_FAIL_REPORT("fail to commit all tables");
+		return -EFAULT;
+	}
+
+	commits = ipa3_ctx->stats.commit_tables - commits;
+	waits = ipa3_ctx->stats.commit_tables_waits - waits;
+	IPA_UT_LOG("%u commits, %u waits\n", commits, waits);
+	if (commits != 1 || waits != 1) {
+		IPA_UT_TEST_FAIL_REPORT("tables not committed in one wait");
+		return -EFAULT;
+	}
+
+	return 0;
+}
+
+/* Suite definition block */
+IPA_UT_DEFINE_SUITE_START(commit, "Table commit transaction",
+	ipa_test_commit_suite_setup, ipa_test_commit_suite_teardown)
+{
+	IPA_UT_ADD_TEST(batch_chains,
+		"Several command chains sent with a single wait",
+		ipa_test_commit_batch_chains, true, IPA_HW_v3_0, IPA_HW_MAX),
+
+	IPA_UT_ADD_TEST(batch_unwind,
+		"Chains posted before a failing one are waited for",
+		ipa_test_commit_batch_unwind, false, IPA_HW_v3_0, IPA_HW_MAX),
+
+	IPA_UT_ADD_TEST(bad_mask,
+		"Reject an invalid tables mask",
+		ipa_test_commit_bad_mask, true, IPA_HW_v3_0, IPA_HW_MAX),
+
+	IPA_UT_ADD_TEST(commit_all,
+		"Commit all the tables in one transaction",
+		ipa_test_commit_all, true, IPA_HW_v3_0, IPA_HW_MAX),
+
+} IPA_UT_DEFINE_SUITE_END(commit);
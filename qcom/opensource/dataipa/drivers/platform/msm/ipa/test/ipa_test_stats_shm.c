@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: GPL-2.0-only
+/*
+ * Copyright (c) 2026, The Linux Foundation. All rights reserved.
+ */
+
+#include <linux/kthread.h>
+#include "ipa_ut_framework.h"
+#include "ipa_i.h"
+#include "ipa_stats.h"
+
+#define IPA_TEST_STATS_SHM_NUM_CLIENTS 2
+#define IPA_TEST_STATS_SHM_READS 100000
+
+struct ipa_test_stats_shm_ctx {
+	struct ipa_lnx_hw_stats_shm *shm;
+	u64 writes;
+};
+
+static struct ipa_test_stats_shm_ctx ipa_test_stats_shm_ctx;
+
+static int ipa_test_stats_shm_suite_setup(void **ppriv)
+{
+	struct ipa_lnx_hw_stats_shm *shm;
+
+	IPA_UT_DBG("Start Setup\n");
+
+	shm = kzalloc(struct_size(shm, client,
+		IPA_TEST_STATS_SHM_NUM_CLIENTS), GFP_KERNEL);
+	if (!shm)
+		return -ENOMEM;
+
+	shm->magic = IPA_LNX_HW_STATS_SHM_MAGIC;
+	shm->version = IPA_LNX_HW_STATS_SHM_VERSION;
+	shm->num_clients = IPA_TEST_STATS_SHM_NUM_CLIENTS;
+
+	ipa_test_stats_shm_ctx.shm = shm;
+	*ppriv = &ipa_test_stats_shm_ctx;
+
+	return 0;
+}
+
+static int ipa_test_stats_shm_suite_teardown(void *priv)
+{
+	struct ipa_test_stats_shm_ctx *ctx = priv;
+
+	IPA_UT_DBG("Start Teardown\n");
+
+	kfree(ctx->shm);
+	ctx->shm = NULL;
+
+	return 0;
+}
+
+/* every counter of the client carries the same value */
+static void ipa_test_stats_shm_fill(struct ipa_lnx_hw_stats_client *client,
+	u64 val)
+{
+	client->quota_ipv4_bytes = val;
+	client->quota_ipv6_bytes = val;
+	client->quota_ipv4_pkts = (u32)val;
+	client->quota_ipv6_pkts = (u32)val;
+	client->teth_ipv4_bytes = val;
+	client->teth_ipv6_bytes = val;
+	client->teth_ipv4_pkts = (u32)val;
+	client->teth_ipv6_pkts = (u32)val;
+	client->drop_pkts = (u32)val;
+	client->drop_bytes = (u32)val;
+}
+
+static bool ipa_test_stats_shm_consistent(
+	const struct ipa_lnx_hw_stats_client *client)
+{
+	u64 val = client->quota_ipv4_bytes;
+
+	return client->quota_ipv6_bytes == val &&
+		client->quota_ipv4_pkts == (u32)val &&
+		client->quota_ipv6_pkts == (u32)val &&
+		client->teth_ipv4_bytes == val &&
+		client->teth_ipv6_bytes == val &&
+		client->teth_ipv4_pkts == (u32)val &&
+		client->teth_ipv6_pkts == (u32)val &&
+		client->drop_pkts == (u32)val &&
+		client->drop_bytes == (u32)val;
+}
+
+static void ipa_test_stats_shm_write(struct ipa_lnx_hw_stats_shm *shm,
+	u64 val)
+{
+	int i;
+
+	ipa_hw_stats_shm_write_begin(shm);
+	for (i = 0; i < shm->num_clients; i++)
+		ipa_test_stats_shm_fill(&shm->client[i], val);
+	ipa_hw_stats_shm_write_end(shm);
+}
+
+static int ipa_test_stats_shm_writer(void *data)
+{
+	struct ipa_test_stats_shm_ctx *ctx = data;
+
+	while (!kthread_should_stop()) {
+		ipa_test_stats_shm_write(ctx->shm, ++ctx->writes);
+		cond_resched();
+	}
+
+	return 0;
+}
+
+static int ipa_test_stats_shm_read_basic(void *priv)
+{
+	struct ipa_test_stats_shm_ctx *ctx = priv;
+	struct ipa_lnx_hw_stats_shm *shm = ctx->shm;
+	struct ipa_lnx_hw_stats_client out;
+	int res;
+
+	ipa_test_stats_shm_write(shm, 7);
+
+	res = ipa_hw_stats_shm_read_client(shm, 1, &out);
+	if (res || !ipa_test_stats_shm_consistent(&out) ||
+		out.quota_ipv4_bytes != 7) {
+		IPA_UT_LOG("res %d val %llu\n", res, out.quota_ipv4_bytes);
+		IPA_UT_TEST_FAIL_REPORT("fail to read a settled region");
+		return -EFAULT;
+	}
+
+	res = ipa_hw_stats_shm_read_client(shm, shm->num_clients, &out);
+	if (res != -EINVAL) {
+		IPA_UT_LOG("res %d\n", res);
+		IPA_UT_TEST_FAIL_REPORT("out of range client accepted");
+		return -EFAULT;
+	}
+
+	/* a writer that never finishes must not hand out a copy */
+	ipa_hw_stats_shm_write_begin(shm);
+	res = ipa_hw_stats_shm_read_client(shm, 0, &out);
+	ipa_hw_stats_shm_write_end(shm);
+	if (res != -EAGAIN) {
+		IPA_UT_LOG("res %d\n", res);
+		IPA_UT_TEST_FAIL_REPORT("read accepted during an update");
+		return -EFAULT;
+	}
+
+	return 0;
+}
+
+static int ipa_test_stats_shm_read_concurrent(void *priv)
+{
+	struct ipa_test_stats_shm_ctx *ctx = priv;
+	struct ipa_lnx_hw_stats_client out;
+	struct task_struct *writer;
+	u32 copies = 0, retries = 0;
+	u64 last = 0;
+	int ret = 0;
+	int res;
+	int i;
+
+	ctx->writes = 0;
+	ipa_test_stats_shm_write(ctx->shm, 0);
+
+	writer = kthread_run(ipa_test_stats_shm_writer, ctx,
+		"ipa_ut_stats_shm");
+	if (IS_ERR(writer)) {
+		IPA_UT_TEST_FAIL_REPORT("fail to start the writer");
+		return PTR_ERR(writer);
+	}
+
+	for (i = 0; i < IPA_TEST_STATS_SHM_READS; i++) {
+		res = ipa_hw_stats_shm_read_client(ctx->shm, 0, &out);
+		if (res == -EAGAIN) {
+			retries++;
+			cond_resched();
+			continue;
+		}
+		if (res) {
+			IPA_UT_LOG("read %d res %d\n", i, res);
+			IPA_UT_TEST_FAIL_REPORT("unexpected read failure");
+			ret = -EFAULT;
+			break;
+		}
+
+		if (!ipa_test_stats_shm_consistent(&out)) {
+			IPA_UT_LOG("read %d torn copy, bytes %llu pkts %u\n",
+				i, out.quota_ipv4_bytes, out.quota_ipv4_pkts);
+			IPA_UT_TEST_FAIL_REPORT("torn copy accepted");
+			ret = -EFAULT;
+			break;
+		}
+
+		if (out.quota_ipv4_bytes < last) {
+			IPA_UT_LOG("read %d went back %llu < %llu\n",
+				i, out.quota_ipv4_bytes, last);
+			IPA_UT_TEST_FAIL_REPORT("stale copy accepted");
+			ret = -EFAULT;
+			break;
+		}
+		last = out.quota_ipv4_bytes;
+		copies++;
+
+		if (!(i % 1024))
+			cond_resched();
+	}
+
+	kthread_stop(writer);
+
+	IPA_UT_LOG("%u copies, %u retries, %llu writes, last %llu\n",
+		copies, retries, ctx->writes, last);
+
+	if (!ret && !copies) {
+		IPA_UT_TEST_FAIL_REPORT("reader never got a copy");
+		ret = -EFAULT;
+	}
+
+	return ret;
+}
+
+/* Suite definition block */
+IPA_UT_DEFINE_SUITE_START(stats_shm, "HW stats shared region",
+	ipa_test_stats_shm_suite_setup, ipa_test_stats_shm_suite_teardown)
+{
+	IPA_UT_ADD_TEST(read_basic,
+		"Reader protocol on a settled and an open region",
+		ipa_test_stats_shm_read_basic, false, IPA_HW_v3_0, IPA_HW_MAX),
+
+	IPA_UT_ADD_TEST(read_concurrent,
+		"Reader never accepts a torn or stale copy",
+		ipa_test_stats_shm_read_concurrent, false,
+		IPA_HW_v3_0, IPA_HW_MAX),
+
+} IPA_UT_DEFINE_SUITE_END(stats_shm);
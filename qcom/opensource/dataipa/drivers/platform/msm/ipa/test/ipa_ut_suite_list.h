@@ -20,6 +20,8 @@ IPA_UT_DECLARE_SUITE(example);
 IPA_UT_DECLARE_SUITE(hw_stats);
 IPA_UT_DECLARE_SUITE(wdi3);
 IPA_UT_DECLARE_SUITE(ntn);
+IPA_UT_DECLARE_SUITE(commit);
+IPA_UT_DECLARE_SUITE(stats_shm);
 
 
 /**
@@ -35,6 +37,8 @@ IPA_UT_DEFINE_ALL_SUITES_START
 	IPA_UT_REGISTER_SUITE(hw_stats),
 	IPA_UT_REGISTER_SUITE(wdi3),
 	IPA_UT_REGISTER_SUITE(ntn),
+	IPA_UT_REGISTER_SUITE(commit),
+	IPA_UT_REGISTER_SUITE(stats_shm),
 } IPA_UT_DEFINE_ALL_SUITES_END;
 
 #endif /* _IPA_UT_SUITE_LIST_H_ */
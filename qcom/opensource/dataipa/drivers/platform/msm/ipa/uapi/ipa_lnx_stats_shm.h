@@ -0,0 +1,54 @@
+/* SPDX-License-Identifier: GPL-2.0-only WITH Linux-syscall-note */
+/*
+ * Copyright (c) 2022 Qualcomm Innovation Center, Inc. All rights reserved.
+ */
+
+#ifndef _UAPI_IPA_LNX_STATS_SHM_H_
+#define _UAPI_IPA_LNX_STATS_SHM_H_
+
+#include <linux/types.h>
+
+/**
+ * HW stats shared region, mapped read-only by userspace through mmap()
+ * on the ipa_lnx_stats_ioctl device at offset 0.
+ *
+ * The driver bumps seq to an odd value before it rewrites the client
+ * counters and back to an even value once done. A reader samples seq,
+ * copies what it needs and re-reads seq; the copy is only consistent if
+ * both samples are equal and even, otherwise it has to retry. The seq
+ * loads need acquire semantics and the copy must not be reordered past
+ * the second load.
+ *
+ * client[] is indexed by enum ipa_client_type and holds num_clients
+ * entries. The counters are cumulative since the stats were last reset.
+ * The region is republished whenever the driver reads the HW counters,
+ * and at least every interval_ms while it is mapped.
+ */
+#define IPA_LNX_HW_STATS_SHM_MAGIC 0x49505348 /* "IPSH" */
+#define IPA_LNX_HW_STATS_SHM_VERSION 1
+
+struct ipa_lnx_hw_stats_client {
+	__u64 quota_ipv4_bytes;
+	__u64 quota_ipv6_bytes;
+	__u32 quota_ipv4_pkts;
+	__u32 quota_ipv6_pkts;
+	__u64 teth_ipv4_bytes;
+	__u64 teth_ipv6_bytes;
+	__u32 teth_ipv4_pkts;
+	__u32 teth_ipv6_pkts;
+	__u32 drop_pkts;
+	__u32 drop_bytes;
+};
+
+struct ipa_lnx_hw_stats_shm {
+	__u32 magic;
+	__u32 version;
+	__u32 seq;
+	__u32 num_clients;
+	__u32 interval_ms;
+	__u32 reserved;
+	__u64 update_time_ns;
+	struct ipa_lnx_hw_stats_client client[];
+};
+
+#endif /* _UAPI_IPA_LNX_STATS_SHM_H_ */
@@ -49,6 +49,18 @@ def gen_ipa_test_headers(verbose, gen_dir, headers_install, unifdef, ipa_test_in
                 ipa_test_uapi_include_prefix, h): error_count += 1
     return error_count
 
+def gen_ipa_headers(verbose, gen_dir, headers_install, unifdef, ipa_include_uapi):
+    error_count = 0
+    for h in ipa_include_uapi:
+        ipa_uapi_include_prefix = os.path.join(h.split('/ipa/uapi/')[0],
+                                                 'ipa',
+                                                 'uapi') + os.sep
+
+        if not run_headers_install(
+                verbose, gen_dir, headers_install, unifdef,
+                ipa_uapi_include_prefix, h): error_count += 1
+    return error_count
+
 def main():
     """Parse command line arguments and perform top level control."""
     parser = argparse.ArgumentParser(
@@ -63,8 +75,11 @@ def main():
             '--gen_dir', required=True,
             help='Where to place the generated files.')
     parser.add_argument(
-            '--ipa_test_include_uapi', required=True, nargs='*',
-            help='The list of header files.')
+            '--ipa_test_include_uapi', default=[], nargs='*',
+            help='The list of ipa_test_module header files.')
+    parser.add_argument(
+            '--ipa_include_uapi', default=[], nargs='*',
+            help='The list of ipa uapi header files.')
     parser.add_argument(
             '--headers_install', required=True,
             help='The headers_install tool to process input headers.')
@@ -78,11 +93,15 @@ def main():
     if args.verbose:
         print('gen_dir [%s]' % args.gen_dir)
         print('ipa_test_include_uapi [%s]' % args.ipa_test_include_uapi)
+        print('ipa_include_uapi [%s]' % args.ipa_include_uapi)
         print('headers_install [%s]' % args.headers_install)
         print('unifdef [%s]' % args.unifdef)
 
-    return gen_ipa_test_headers(args.verbose, args.gen_dir,
+    error_count = gen_ipa_test_headers(args.verbose, args.gen_dir,
             args.headers_install, args.unifdef, args.ipa_test_include_uapi)
+    error_count += gen_ipa_headers(args.verbose, args.gen_dir,
+            args.headers_install, args.unifdef, args.ipa_include_uapi)
+    return error_count
 
 if __name__ == '__main__':
     sys.exit(main())
@@ -133,6 +133,56 @@ int ipa_ipv6ct_del_rule(uint32_t table_handle, uint32_t rule_handle);
  */
 int ipa_ipv6ct_query_timestamp(uint32_t table_handle, uint32_t rule_handle, uint32_t* time_stamp);
 
+/**
+ * ipa_ipv6ct_add_rules() - to insert a batch of new IPv6CT rules
+ * @table_handle: [in] handle of IPv6CT table
+ * @user_rules: [in] array of new rules
+ * @num_rules: [in] number of rules in the array above
+ * @rule_handles: [out] handle of each rule, zero if it wasn't added
+ * @num_added: [out] rules, from the start of the array, that were added
+ *
+ * Like ipa_ipv6ct_add_rule(), but the table lock is taken once and
+ * the rules' DMA updates are posted to the IPA in as few commands as
+ * possible. Rules are added in order; processing stops at the first
+ * rule that can't be added.
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_ipv6ct_add_rules(uint32_t table_handle, const ipa_ipv6ct_rule* user_rules,
+	uint32_t num_rules, uint32_t* rule_handles, uint32_t* num_added);
+
+/**
+ * ipa_ipv6ct_del_rules() - to delete a batch of IPv6CT rules
+ * @table_handle: [in] handle of IPv6CT table
+ * @rule_handles: [in] array of IPv6CT rule handles
+ * @num_rules: [in] number of handles in the array above
+ * @num_deleted: [out] rules, from the start of the array, that were deleted
+ *
+ * Like ipa_ipv6ct_del_rule(), but the table lock is taken once and
+ * the rules' DMA updates are posted to the IPA in as few commands as
+ * possible. Rules are deleted in order; processing stops at the first
+ * rule that can't be deleted.
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_ipv6ct_del_rules(uint32_t table_handle, const uint32_t* rule_handles,
+	uint32_t num_rules, uint32_t* num_deleted);
+
+/**
+ * ipa_ipv6ct_query_timestamps() - to query the timestamps of many rules
+ * @table_handle: [in] handle of IPv6CT table
+ * @rule_handles: [in] array of IPv6CT rule handles
+ * @num_rules: [in] number of handles in the array above
+ * @time_stamps: [out] time stamp of each rule
+ *
+ * Like ipa_ipv6ct_query_timestamp(), but the table lock is taken once
+ * for the whole array. Stops at the first handle that can't be found.
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_ipv6ct_query_timestamps(uint32_t table_handle, const uint32_t* rule_handles,
+	uint32_t num_rules, uint32_t* time_stamps);
+
 /**
  * ipa_ipv6ct_dump_table() - dumps IPv6CT table
  * @table_handle: [in] handle of IPv6CT table
@@ -75,9 +75,9 @@ typedef struct {
 } ipa_nat_ipv4_rule;
 
 static inline char* prep_nat_ipv4_rule_4print(
-	ipa_nat_ipv4_rule* rule_ptr,
-	char*              buf_ptr,
-	uint32_t           buf_sz )
+	const ipa_nat_ipv4_rule* rule_ptr,
+	char*                    buf_ptr,
+	uint32_t                 buf_sz )
 {
 	if ( rule_ptr && buf_ptr && buf_sz )
 	{
@@ -168,6 +168,54 @@ int ipa_nat_add_ipv4_rule(uint32_t table_handle,
 int ipa_nat_del_ipv4_rule(uint32_t table_handle,
 				uint32_t rule_handle);
 
+/**
+ * ipa_nat_add_ipv4_rules() - to insert a batch of new ipv4 rules
+ * @table_handle: [in] handle of ipv4 nat table
+ * @rules: [in] array of new rules
+ * @num_rules: [in] number of rules in the array above
+ * @rule_handles: [out] handle of each rule, zero if it wasn't added
+ * @num_added: [out] rules, from the start of the array, that were added
+ *
+ * Like ipa_nat_add_ipv4_rule(), but the table lock is taken once and
+ * the rules' DMA updates are posted to the IPA in as few commands as
+ * possible. Rules are added in order; processing stops at the first
+ * rule that can't be added.
+ *
+ * Each command is applied by the IPA whole or not at all, so on
+ * failure the first *num_added rules are in the table and the rest
+ * are not (and their handles are zero).
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_add_ipv4_rules(uint32_t table_handle,
+				const ipa_nat_ipv4_rule *rules,
+				uint32_t num_rules,
+				uint32_t *rule_handles,
+				uint32_t *num_added);
+
+/**
+ * ipa_nat_del_ipv4_rules() - to delete a batch of ipv4 nat rules
+ * @table_handle: [in] handle of ipv4 nat table
+ * @rule_handles: [in] array of ipv4 nat rule handles
+ * @num_rules: [in] number of handles in the array above
+ * @num_deleted: [out] rules, from the start of the array, that were deleted
+ *
+ * Like ipa_nat_del_ipv4_rule(), but the table lock is taken once and
+ * the rules' DMA updates are posted to the IPA in as few commands as
+ * possible. Rules are deleted in order; processing stops at the first
+ * rule that can't be deleted.
+ *
+ * Each command is applied by the IPA whole or not at all, so on
+ * failure the first *num_deleted rules are out of the table and the
+ * rest are still in it.
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_del_ipv4_rules(uint32_t table_handle,
+				const uint32_t *rule_handles,
+				uint32_t num_rules,
+				uint32_t *num_deleted);
+
 
 /**
  * ipa_nat_query_timestamp() - to query timestamp
@@ -184,6 +232,31 @@ int ipa_nat_query_timestamp(uint32_t  table_handle,
 				uint32_t  rule_handle,
 				uint32_t  *time_stamp);
 
+/**
+ * ipa_nat_age_ipv4_rules() - to find, and optionally delete, idle rules
+ * @table_handle: [in] handle of ipv4 nat table
+ * @idle_ms: [in] how long a rule must go unused to have expired
+ * @del_expired: [in] whether to delete the expired rules as well
+ * @rule_handles: [out] handles of the expired rules
+ * @max_handles: [in] size of the array above
+ * @num_expired: [out] number of handles written to the array above
+ *
+ * Sweeps the table once, under one lock hold, in place of an
+ * ipa_nat_query_timestamp() per rule. A rule is idle from the first
+ * sweep that sees its current timestamp, so it takes two sweeps at
+ * least idle_ms apart for it to expire. Expired rules that don't fit
+ * in the array are left for a later call. Works alike whether the
+ * table is in DDR, SRAM or moving between them.
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_age_ipv4_rules(uint32_t table_handle,
+				uint32_t idle_ms,
+				bool del_expired,
+				uint32_t *rule_handles,
+				uint32_t max_handles,
+				uint32_t *num_expired);
+
 
 /**
  * ipa_nat_modify_pdn() - modify single PDN entry in the PDN config table
@@ -267,5 +340,81 @@ int ipa_nat_switch_to(
 	enum ipa3_nat_mem_in nmi,
 	bool                 hold_state );
 
+/**
+ * ipa_nat_set_migration_chunk() - While in HYBRID mode only, makes
+ * switches between SRAM and DDR incremental.
+ * @chunk_size: [in] most rules to copy per lock hold, or zero to copy
+ *              the whole table in one go (the default)
+ *
+ * With a non-zero chunk size, a switch (whether asked for via
+ * ipa_nat_switch_to() without a hold, or made when enough rules have
+ * been deleted to go back to SRAM) only starts the copy to the other
+ * memory type. The IPA keeps using the current table meanwhile. Each
+ * subsequent rule add or delete copies another chunk, as does each
+ * call to ipa_nat_migration_step(). The IPA is pointed at the new
+ * table once all of it has been copied. A switch forced by SRAM
+ * filling up is still done in one go. Also resets the max_hold_ns
+ * reported by ipa_nat_get_migration_stats().
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_set_migration_chunk(
+	uint32_t chunk_size );
+
+/**
+ * ipa_nat_migration_step() - copies the next chunk of an incremental
+ * switch between SRAM and DDR, if one is in progress
+ * @done_ptr: [out] set true when no switch is in progress anymore
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_migration_step(
+	bool* done_ptr );
+
+/**
+ * struct ipa_nat_migration_stats - progress of switches between SRAM
+ * and DDR
+ * @in_progress: an incremental switch is under way
+ * @to_nmi: memory type being switched to
+ * @chunk_size: see ipa_nat_set_migration_chunk()
+ * @slots_done: source table slots copied so far
+ * @tot_slots: slots in the source table
+ * @rules_copied: rules copied so far
+ * @rules_mirrored: rule adds/deletes also applied to the new table
+ * @chunks: chunks copied so far
+ * @completed: number of switches done
+ * @aborted: number of incremental switches given up on
+ * @max_hold_ns: longest the table lock was held for a chunk, or for a
+ *               whole switch when not incremental
+ * @last_cutover_ns: time taken to point the IPA at the new table in
+ *                   the last switch
+ * @last_duration_ns: time from start to end of the last switch
+ */
+typedef struct {
+	bool                 in_progress;
+	enum ipa3_nat_mem_in to_nmi;
+	uint32_t             chunk_size;
+	uint32_t             slots_done;
+	uint32_t             tot_slots;
+	uint32_t             rules_copied;
+	uint32_t             rules_mirrored;
+	uint32_t             chunks;
+	uint32_t             completed;
+	uint32_t             aborted;
+	uint64_t             max_hold_ns;
+	uint64_t             last_cutover_ns;
+	uint64_t             last_duration_ns;
+} ipa_nat_migration_stats;
+
+/**
+ * ipa_nat_get_migration_stats() - reports on switches between SRAM
+ * and DDR
+ * @stats_ptr: [out] where to put the stats
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_get_migration_stats(
+	ipa_nat_migration_stats* stats_ptr );
+
 #endif
 
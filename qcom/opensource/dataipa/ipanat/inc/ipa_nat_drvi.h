@@ -160,6 +160,14 @@ struct ipa_nat_rule {
 	uint64_t tcp_udp_chksum:16;
 };
 
+/*
+ * For walk callbacks: reads a rule's timestamp where the IPA keeps it
+ * up to date, in the mapped table, rather than via a handle lookup...
+ */
+#undef  IPA_NATI_REC_TIMESTAMP
+#define IPA_NATI_REC_TIMESTAMP(rec_ptr) \
+	( (uint32_t) ((const volatile struct ipa_nat_rule*) (rec_ptr))->time_stamp )
+
 static inline char* prep_nat_rule_4print(
 	struct ipa_nat_rule* rule_ptr,
 	char*                buf_ptr,
@@ -263,6 +271,15 @@ struct ipa_nat_indx_tbl_meta_info {
 	uint16_t prev_index;
 };
 
+/*
+ * What the aging engine saw in a NAT table slot the last time it
+ * swept the table. See ipa_NATI_age_ipv4_tbl().
+ */
+struct ipa_nati_age_rec {
+	uint32_t time_stamp; /* the rule's timestamp */
+	uint64_t since_ns;   /* when it last moved, zero if never swept */
+};
+
 struct ipa_nat_ip4_table_cache {
 	uint32_t public_addr;
 	ipa_mem_descriptor mem_desc;
@@ -270,6 +287,7 @@ struct ipa_nat_ip4_table_cache {
 	ipa_table index_table;
 	struct ipa_nat_indx_tbl_meta_info *index_expn_table_meta;
 	ipa_table_dma_cmd_helper table_dma_cmd_helpers[IPA_NAT_TABLE_DMA_CMD_MAX];
+	struct ipa_nati_age_rec *age_recs; /* one per slot, made on first sweep */
 };
 
 struct ipa_nat_cache {
@@ -308,6 +326,27 @@ int ipa_nati_add_ipv4_rule(uint32_t tbl_hdl,
 int ipa_nati_del_ipv4_rule(uint32_t tbl_hdl,
 				uint32_t rule_hdl);
 
+int ipa_nati_add_ipv4_rules(
+	uint32_t                 tbl_hdl,
+	const ipa_nat_ipv4_rule* clnt_rules,
+	uint32_t                 num_rules,
+	uint32_t*                rule_hdls,
+	uint32_t*                num_added);
+
+int ipa_nati_del_ipv4_rules(
+	uint32_t        tbl_hdl,
+	const uint32_t* rule_hdls,
+	uint32_t        num_rules,
+	uint32_t*       num_deleted);
+
+int ipa_nati_age_ipv4_rules(
+	uint32_t  tbl_hdl,
+	uint32_t  idle_ms,
+	bool      del_expired,
+	uint32_t* rule_hdls,
+	uint32_t  max_hdls,
+	uint32_t* num_expired);
+
 int ipa_nati_get_sram_size(
 	uint32_t* size_ptr);
 
@@ -336,6 +375,45 @@ int ipa_nati_walk_ipv4_tbl(
 	ipa_table_walk_cb walk_cb,
 	void*             arb_data_ptr );
 
+/*
+ * The following used to walk a table a slice at a time, so that long
+ * walks (eg. expiry sweeps) don't hold off rule adds and deletes for
+ * the length of the table. Zero it, or use ipa_nati_walk_cursor_init(),
+ * to start a walk from the top.
+ *
+ * Rules added or deleted between slices may or may not be seen, and a
+ * rule moved by a delete (ie. the second rule of a chain becoming the
+ * head) may be seen twice or not at all. Fine for a sweep that runs
+ * over and over.
+ */
+typedef struct
+{
+	uint32_t     tbl_hdl;    /* table walked last time */
+	WhichTbl2Use which;
+	uint32_t     next_index; /* slot to resume from */
+	bool         done;       /* every slot has been walked */
+	uint32_t     slices;
+	uint32_t     restarts;   /* table changed under the walk */
+} ipa_nati_walk_cursor;
+
+void ipa_nati_walk_cursor_init(
+	ipa_nati_walk_cursor* cursor_ptr );
+
+/*
+ * Passes at most max_ents rules to walk_cb, starting where the last
+ * slice left off, then returns. The table is only locked for the
+ * slice. walk_cb gets each record in place in the mapped table, so
+ * IPA_NATI_REC_TIMESTAMP() can read its timestamp without a copy or a
+ * lookup.
+ */
+int ipa_nati_walk_ipv4_tbl_slice(
+	uint32_t              tbl_hdl,
+	WhichTbl2Use          which,
+	ipa_nati_walk_cursor* cursor_ptr,
+	uint32_t              max_ents,
+	ipa_table_walk_cb     walk_cb,
+	void*                 arb_data_ptr );
+
 /*
  * The following used for retrieving table stats.
  */
@@ -351,6 +429,7 @@ typedef struct
 	uint32_t min_chain_len;
 	uint32_t max_chain_len;
 	float    avg_chain_len;
+	uint32_t chain_hist[IPA_TABLE_CHAIN_HIST_SZ]; /* see ipa_table.h */
 } ipa_nati_tbl_stats;
 
 int ipa_nati_ipv4_tbl_stats(
@@ -373,12 +452,38 @@ int ipa_NATI_del_ipv4_table(
 int ipa_NATI_clear_ipv4_tbl(
 	uint32_t tbl_hdl );
 
+/*
+ * The walk, stats and timestamp functions below don't take the nat
+ * mutex. They rely on the state machine holding its state lock
+ * (shared or exclusive), so that they can run concurrently with rule
+ * adds and deletes.
+ */
 int ipa_NATI_walk_ipv4_tbl(
 	uint32_t          tbl_hdl,
 	WhichTbl2Use      which,
 	ipa_table_walk_cb walk_cb,
 	void*             arb_data_ptr );
 
+/*
+ * Like ipa_NATI_walk_ipv4_tbl(), but starts at slot start_index. A
+ * walk_cb returning a positive value stops the walk without error, so
+ * that a later call can pick up where it left off.
+ */
+int ipa_NATI_walk_ipv4_tbl_from(
+	uint32_t          tbl_hdl,
+	WhichTbl2Use      which,
+	uint32_t          start_index,
+	ipa_table_walk_cb walk_cb,
+	void*             arb_data_ptr );
+
+int ipa_NATI_walk_ipv4_tbl_slice(
+	uint32_t              tbl_hdl,
+	WhichTbl2Use          which,
+	ipa_nati_walk_cursor* cursor_ptr,
+	uint32_t              max_ents,
+	ipa_table_walk_cb     walk_cb,
+	void*                 arb_data_ptr );
+
 int ipa_NATI_ipv4_tbl_stats(
 	uint32_t            tbl_hdl,
 	ipa_nati_tbl_stats* nat_stats_ptr,
@@ -389,6 +494,21 @@ int ipa_NATI_query_timestamp(
 	uint32_t  rule_hdl,
 	uint32_t* time_stamp);
 
+/*
+ * One pass over the NAT table, reading each rule's timestamp in place
+ * and comparing it with what the last pass saw. Rules whose timestamp
+ * hasn't moved for idle_ms have their handles put in rule_hdls, up to
+ * max_hdls of them. Unlike the walk, stats and timestamp functions
+ * above, it takes the nat mutex, since it updates the table's
+ * age_recs.
+ */
+int ipa_NATI_age_ipv4_tbl(
+	uint32_t  tbl_hdl,
+	uint32_t  idle_ms,
+	uint32_t* rule_hdls,
+	uint32_t  max_hdls,
+	uint32_t* num_expired);
+
 int ipa_NATI_add_ipv4_rule(
 	uint32_t                 tbl_hdl,
 	const ipa_nat_ipv4_rule* clnt_rule,
@@ -398,7 +518,51 @@ int ipa_NATI_del_ipv4_rule(
 	uint32_t tbl_hdl,
 	uint32_t rule_hdl);
 
+int ipa_NATI_add_ipv4_rules(
+	uint32_t                 tbl_hdl,
+	const ipa_nat_ipv4_rule* clnt_rules,
+	uint32_t                 num_rules,
+	uint32_t*                rule_hdls,
+	uint32_t*                num_added);
+
+int ipa_NATI_del_ipv4_rules(
+	uint32_t        tbl_hdl,
+	const uint32_t* rule_hdls,
+	uint32_t        num_rules,
+	uint32_t*       num_deleted);
+
 int ipa_NATI_post_ipv4_init_cmd(
 	uint32_t tbl_hdl );
 
+/*
+ * Offline tables: an IPv4 NAT table in plain malloc'd memory, driven
+ * by the same hash and ipa_table code as a real one, but never shown
+ * to the IPA. For offline analysis of hash quality and chain lengths.
+ * See the "Offline tables" section of ipa_nat_drvi.c.
+ */
+typedef struct ipa_nati_offline_tbl ipa_nati_offline_tbl;
+
+ipa_nati_offline_tbl* ipa_nati_offline_tbl_create(
+	enum ipa3_nat_mem_in nmi,
+	enum ipa_hw_type     hw_ver,
+	uint32_t             public_ip_addr,
+	uint16_t             number_of_entries );
+
+void ipa_nati_offline_tbl_destroy(
+	ipa_nati_offline_tbl* tbl );
+
+int ipa_nati_offline_add_rule(
+	ipa_nati_offline_tbl*    tbl,
+	const ipa_nat_ipv4_rule* clnt_rule,
+	uint32_t*                rule_hdl );
+
+int ipa_nati_offline_del_rule(
+	ipa_nati_offline_tbl* tbl,
+	uint32_t              rule_hdl );
+
+int ipa_nati_offline_tbl_stats(
+	ipa_nati_offline_tbl* tbl,
+	ipa_nati_tbl_stats*   nat_stats_ptr,
+	ipa_nati_tbl_stats*   idx_stats_ptr );
+
 #endif /* #ifndef IPA_NAT_DRVI_H */
@@ -58,7 +58,7 @@ typedef enum
 } ipa_which_map;
 
 #define VALID_IPA_USE_MAP(w) \
-	( (w) >= MAP_NUM_00 || (w) < MAP_NUM_MAX )
+	( (w) >= MAP_NUM_00 && (w) < MAP_NUM_MAX )
 
 /* KEEP THE FOLLOWING IN SYNC WITH ABOVE. */
 static inline const char* ipa_which_map_as_str(
@@ -79,6 +79,14 @@ static inline const char* ipa_which_map_as_str(
 	return "???";
 }
 
+/*
+ * Size a map up front for num_entries keys, so that adds don't have to
+ * grow it later. Maps grow on their own when not reserved.
+ */
+int ipa_nat_map_reserve(
+	ipa_which_map which,
+	uint32_t      num_entries );
+
 int ipa_nat_map_add(
 	ipa_which_map which,
 	uint32_t      key,
@@ -89,6 +97,15 @@ int ipa_nat_map_find(
 	uint32_t      key,
 	uint32_t*     val_ptr );
 
+/*
+ * Same as ipa_nat_map_find(), but for callers that expect the key may
+ * be missing, so a miss isn't reported as an error.
+ */
+int ipa_nat_map_probe(
+	ipa_which_map which,
+	uint32_t      key,
+	uint32_t*     val_ptr );
+
 int ipa_nat_map_del(
 	ipa_which_map which,
 	uint32_t      key,
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+#ifndef IPA_NAT_SIM_H
+#define IPA_NAT_SIM_H
+
+#include "ipa_nat_utils.h"
+
+#include <stdint.h>
+
+/*
+ * A simulated IPA for running ipanat without the device (eg. the
+ * ipanattest suite and benchmarks on a build host or in CI).
+ *
+ * It implements the IPA_IOC_* calls ipanat makes (table alloc, init,
+ * delete, DMA, PDN modify, SRAM info, etc) against anonymous memory,
+ * with the driver's argument checks. TABLE_DMA commands are applied
+ * the way the IPA applies them: in order, each entry a 16 bit write,
+ * to the NAT table the IPA was last pointed at with an init command.
+ */
+
+typedef struct
+{
+	enum ipa_hw_type hw_ver;    /* reported by IPA_IOC_GET_HW_VERSION */
+	uint32_t         sram_size; /* bytes of SRAM for NAT, zero for none */
+} ipa_nat_sim_cfg;
+
+typedef struct
+{
+	uint64_t init_cmds;
+	uint64_t dma_cmds;
+	uint64_t dma_entries;
+	uint64_t dma_rejects;
+	uint64_t pdn_mods;
+} ipa_nat_sim_stats;
+
+/*
+ * Configures the simulator and plugs it in as the ipanat backend.
+ * Must be called before any table is created.
+ */
+int ipa_nat_sim_enable(
+	const ipa_nat_sim_cfg* cfg_ptr);
+
+void ipa_nat_sim_get_stats(
+	ipa_nat_sim_stats* stats_ptr);
+
+#endif /* IPA_NAT_SIM_H */
@@ -102,6 +102,10 @@ typedef enum {
 	NATI_TRIG_GOTO_DDR   =  9,
 	NATI_TRIG_GOTO_SRAM  = 10,
 	NATI_TRIG_GET_TSTAMP = 11,
+	NATI_TRIG_ADD_RULES  = 12,
+	NATI_TRIG_DEL_RULES  = 13,
+	NATI_TRIG_MIGRATE    = 14,
+	NATI_TRIG_AGE_RULES  = 15,
 
 	NATI_TRIG_LAST
 } ipa_nati_trigger;
@@ -116,6 +120,34 @@ typedef struct
 	uint32_t fail;
 } nati_switch_stats;
 
+/******************************************************************************/
+/**
+ * The following structure used to keep incremental migration state.
+ *
+ * Rather than copying the whole table to the other memory type in
+ * one lock hold, an incremental migration copies at most chunk_size
+ * rules per hold. Meanwhile, rule adds and deletes are applied to both
+ * tables. The IPA is only pointed at the new table once the copy is
+ * complete.
+ */
+typedef struct
+{
+	bool     in_progress;
+	uint32_t chunk_size;       /* zero means migrate in one go */
+	uint32_t src_sub;          /* DDR_SUB or SRAM_SUB, see below */
+	uint32_t next_index;       /* next source table slot to copy */
+	uint32_t tot_slots;        /* slots in source table */
+	uint32_t rules_copied;
+	uint32_t rules_mirrored;
+	uint32_t chunks;
+	uint32_t completed;
+	uint32_t aborted;
+	uint64_t start_ns;
+	uint64_t last_duration_ns;
+	uint64_t last_cutover_ns;
+	uint64_t max_hold_ns;
+} nati_migration;
+
 /******************************************************************************/
 /**
  * The following structure used to direct map usage.
@@ -159,6 +191,7 @@ typedef struct
 	 * sw_stats[1] for sram
 	 */
 	nati_switch_stats sw_stats[2];
+	nati_migration    migration;
 } ipa_nati_obj;
 
 /*
@@ -204,7 +237,9 @@ typedef struct
 #define SRAM_TO_BE_ACCESSED(t) \
 	( SRAM_CURRENTLY_ACTIVE() || \
 	  (t) == NATI_TRIG_GOTO_SRAM || \
-	  (t) == NATI_TRIG_TBL_SWITCH )
+	  (t) == NATI_TRIG_TBL_SWITCH || \
+	  (t) == NATI_TRIG_MIGRATE || \
+	  ( RULE_TRIGGER(t) && nati_obj.migration.in_progress ) )
 
 /*
  * NOTE: The exclusion of timestamp retrieval and table creation
@@ -230,6 +265,34 @@ typedef struct
 	  (t) != NATI_TRIG_GET_TSTAMP && \
 	  (t) != NATI_TRIG_ADD_TABLE )
 
+/*
+ * Triggers are run under one of three locking regimes:
+ *
+ *  Reader triggers only look at table memory. They hold the state
+ *  lock shared and never wait on rule adds/deletes.
+ *
+ *  Rule triggers modify chains within a table. They are serialized
+ *  against each other by the nat mutex alone. A migration step is
+ *  one too, since it only writes the table the IPA isn't using.
+ *
+ *  All other triggers create, clear, delete or move tables. They take
+ *  the nat mutex and then the state lock exclusively.
+ */
+#undef  READER_TRIGGER
+#define READER_TRIGGER(t) \
+	( (t) == NATI_TRIG_WLK_TABLE || \
+	  (t) == NATI_TRIG_TBL_STATS || \
+	  (t) == NATI_TRIG_GET_TSTAMP )
+
+#undef  RULE_TRIGGER
+#define RULE_TRIGGER(t) \
+	( (t) == NATI_TRIG_ADD_RULE  || \
+	  (t) == NATI_TRIG_DEL_RULE  || \
+	  (t) == NATI_TRIG_ADD_RULES || \
+	  (t) == NATI_TRIG_DEL_RULES || \
+	  (t) == NATI_TRIG_AGE_RULES || \
+	  (t) == NATI_TRIG_MIGRATE )
+
 /******************************************************************************/
 /**
  * A helper macro for changing a nati object's state...
@@ -68,6 +68,7 @@
 #include <string.h>
 #include <syslog.h>
 #include <time.h>
+#include <sys/types.h>
 #include <linux/msm_ipa.h>
 
 #ifndef FALSE
@@ -81,6 +82,14 @@
 #define MAX_DMA_ENTRIES_FOR_ADD 4
 #define MAX_DMA_ENTRIES_FOR_DEL 3
 
+/*
+ * Max DMA entries queued into one batched IPA_IOC_TABLE_DMA_CMD (ie.
+ * batched rule add/delete). The driver applies a command whole or not
+ * at all, but may take fewer entries than this. See
+ * ipa_nat_post_batch_cmd().
+ */
+#define IPA_NAT_BATCH_MAX_DMA_ENTRIES 16
+
 #if !defined(MSM_IPA_TESTS) && !defined(FEATURE_IPA_ANDROID)
 #ifdef USE_GLIB
 #include <glib.h>
@@ -99,7 +108,11 @@ size_t strlcpy(char* dst, const char* src, size_t size);
 #ifdef NAT_DEBUG
 #define IPADBG(fmt, ...) printf("%s:%d %s() " fmt, __FILE__,  __LINE__, __FUNCTION__, ##__VA_ARGS__);
 #else
-#define IPADBG(fmt, ...)
+/*
+ * Compiled out, but the arguments still count as used, so locals
+ * that only feed debug output don't draw warnings
+ */
+#define IPADBG(fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
 #endif
 
 typedef struct
@@ -108,6 +121,48 @@ typedef struct
 	enum ipa_hw_type ver;
 } ipa_descriptor;
 
+/*
+ * Every system call ipanat makes on the IPA's device nodes (/dev/ipa,
+ * the NAT and IPv6CT table devices) goes through the backend below.
+ * The default backend is the device itself. Another (eg. the
+ * simulated IPA in ipa_nat_sim.h) can be plugged in with
+ * ipa_nat_set_backend(), but only before any table has been created.
+ */
+typedef struct
+{
+	const char* name;
+	int   (*open)(const char* path, int flags);
+	int   (*close)(int fd);
+	int   (*ioctl)(int fd, unsigned long req, unsigned long arg);
+	void* (*mmap)(void* addr, size_t len, int prot, int flags, int fd, off_t off);
+	int   (*munmap)(void* addr, size_t len);
+} ipa_nat_backend;
+
+/*
+ * Passing NULL restores the device backend
+ */
+void ipa_nat_set_backend(
+	const ipa_nat_backend* backend_ptr);
+
+const ipa_nat_backend* ipa_nat_get_backend(void);
+
+#undef ipa_dev_open
+#undef ipa_dev_close
+#undef ipa_dev_ioctl
+#undef ipa_dev_mmap
+#undef ipa_dev_munmap
+
+#define ipa_dev_open(p, f) \
+	ipa_nat_get_backend()->open((p), (f))
+#define ipa_dev_close(fd) \
+	ipa_nat_get_backend()->close((fd))
+#define ipa_dev_ioctl(fd, req, arg) \
+	ipa_nat_get_backend()->ioctl((fd), (req), (unsigned long) (arg))
+#define ipa_dev_mmap(a, l, p, f, fd, o) \
+	ipa_nat_get_backend()->mmap((a), (l), (p), (f), (fd), (o))
+#define ipa_dev_munmap(a, l) \
+	ipa_nat_get_backend()->munmap((a), (l))
+
 ipa_descriptor* ipa_descriptor_open(void);
 
 void ipa_descriptor_close(
@@ -116,6 +171,26 @@ void ipa_descriptor_close(
 void ipa_read_debug_info(
 	const char* debug_file_path);
 
+typedef int (*ipa_nat_dma_post_cb)(
+	void*                       arg,
+	struct ipa_ioc_nat_dma_cmd* cmd);
+
+/*
+ * Posts a batched table DMA command carrying the entries of num_rules
+ * rules, rule_entries[i] entries for rule i, in order. When the driver
+ * turns the command down, *max_entries is lowered for later batches
+ * and the rules are posted again one command each. *num_posted is set
+ * to the number of leading rules that reached the tables.
+ */
+int ipa_nat_post_batch_cmd(
+	struct ipa_ioc_nat_dma_cmd* cmd,
+	const uint8_t*              rule_entries,
+	uint16_t                    num_rules,
+	ipa_nat_dma_post_cb         post,
+	void*                       arg,
+	uint32_t*                   max_entries,
+	uint16_t*                   num_posted);
+
 static inline char* prep_ioc_nat_dma_cmd_4print(
 	struct ipa_ioc_nat_dma_cmd* cmd_ptr,
 	char*                       buf_ptr,
@@ -77,6 +77,15 @@ typedef enum
 #define IPA_TABLE_INDX_MASK      0x00000FFF
 #define IPA_TABLE_TYPE_MEM_SHIFT 15
 
+#define IPA_TABLE_MAX_BASE_ENTRIES (IPA_TABLE_INDX_MASK + 1)
+
+/*
+ * Chain length histogram buckets. Bucket n counts chains n records
+ * long, except the last, which counts chains that long or longer.
+ * Bucket 0 is unused.
+ */
+#define IPA_TABLE_CHAIN_HIST_SZ 16
+
 #undef BREAK_RULE_HDL
 #define BREAK_RULE_HDL(tbl, hdl, mt, iet, indx) \
 	do { \
@@ -176,6 +185,22 @@ typedef struct
 
 	void*                      meta;
 	int                        meta_entry_size;
+
+	/*
+	 * Maintained as records are added and removed, so that chain
+	 * stats don't need a walk of the table...
+	 */
+	uint16_t                   chain_len[IPA_TABLE_MAX_BASE_ENTRIES];
+	uint32_t                   chain_hist[IPA_TABLE_CHAIN_HIST_SZ];
+	uint32_t                   chain_ents; /* in chains of two or more */
+
+	/*
+	 * Stack of free expansion slots (absolute indices), so that
+	 * adding to a chain doesn't need to search the expansion table
+	 * for an empty slot...
+	 */
+	uint16_t                   expn_free[IPA_TABLE_MAX_BASE_ENTRIES];
+	uint16_t                   expn_free_cnt;
 } ipa_table;
 
 typedef struct
@@ -246,6 +271,10 @@ void* ipa_table_get_entry_by_index(
 	ipa_table* table,
 	uint16_t   index);
 
+uint16_t ipa_table_get_chain_head(
+	ipa_table* table,
+	uint16_t   index);
+
 void ipa_table_dma_cmd_helper_init(
 	ipa_table_dma_cmd_helper* dma_cmd_helper,
 	uint8_t                   table_indx,
@@ -305,6 +334,19 @@ typedef enum
 #define VALID_WHEN2CALLBACK(w) \
 	( (w) >= WHEN_SLOT_EMPTY && (w) < WHEN_SLOT_MAX )
 
+typedef struct
+{
+	uint32_t tot_chains; /* of two or more records */
+	uint32_t min_chain_len;
+	uint32_t max_chain_len;
+	float    avg_chain_len;
+	uint32_t chain_hist[IPA_TABLE_CHAIN_HIST_SZ];
+} ipa_table_chain_stats;
+
+void ipa_table_get_chain_stats(
+	ipa_table*             table,
+	ipa_table_chain_stats* stats_ptr );
+
 int ipa_table_walk(
 	ipa_table*        table,
 	uint16_t          start_index,
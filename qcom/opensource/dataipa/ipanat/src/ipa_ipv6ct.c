@@ -478,6 +478,450 @@ unlock:
 	return ret;
 }
 
+/*
+ * Bulk add/delete: the DMA entries of many rules are queued into one
+ * command and posted with a single IPA_IOC_TABLE_DMA_CMD. Until it has
+ * been posted, software's view of any chain with queued entries is
+ * stale, so a rule landing on a chain already in the batch, or one that
+ * won't fit in the command, has the queued entries posted first. A
+ * command the driver won't take is posted again one rule at a time.
+ */
+#define IPA_IPV6CT_MAX_RULES_PER_BATCH \
+	(IPA_NAT_BATCH_MAX_DMA_ENTRIES / IPA_MAX_DMA_ENTRIES_FOR_ADD)
+
+/* Entries the driver has taken in one command, under ipv6ct_mutex */
+static uint32_t ipv6ct_batch_max_entries = IPA_NAT_BATCH_MAX_DMA_ENTRIES;
+
+typedef struct
+{
+	uint16_t head;
+	uint16_t entry_index;
+	ipa_table_iterator iterator;
+} ipa_ipv6ct_batch_rule;
+
+typedef struct
+{
+	uint32_t first; /* user's index of rules[0] */
+	uint16_t cnt;
+	ipa_ipv6ct_batch_rule rules[IPA_IPV6CT_MAX_RULES_PER_BATCH];
+	uint8_t entries[IPA_IPV6CT_MAX_RULES_PER_BATCH]; /* per rule */
+	struct ipa_ioc_nat_dma_cmd cmd; /* must be last */
+} ipa_ipv6ct_batch;
+
+static ipa_ipv6ct_batch* ipa_ipv6ct_batch_alloc(void)
+{
+	return (ipa_ipv6ct_batch*) calloc(1, sizeof(ipa_ipv6ct_batch) +
+		(IPA_NAT_BATCH_MAX_DMA_ENTRIES * sizeof(struct ipa_ioc_nat_dma_one)));
+}
+
+static void ipa_ipv6ct_batch_reset(ipa_ipv6ct_batch* batch, uint32_t first)
+{
+	batch->first = first;
+	batch->cnt = 0;
+	batch->cmd.entries = 0;
+}
+
+static bool ipa_ipv6ct_batch_must_post(ipa_ipv6ct_batch* batch, uint16_t head, uint32_t max_dma_entries)
+{
+	uint16_t i;
+
+	if (batch->cnt == 0)
+		return false;
+
+	if (batch->cnt >= IPA_IPV6CT_MAX_RULES_PER_BATCH ||
+		batch->cmd.entries + max_dma_entries > ipv6ct_batch_max_entries)
+		return true;
+
+	for (i = 0; i < batch->cnt; i++)
+	{
+		if (batch->rules[i].head == head)
+		{
+			IPADBG("chain %u already in batch\n", head);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int ipa_ipv6ct_post_batch_dma_cmd(void* arg, struct ipa_ioc_nat_dma_cmd* cmd)
+{
+	(void)arg;
+	return ipa_ipv6ct_post_dma_cmd(cmd);
+}
+
+/*
+ * Post what's queued in an add batch. On failure, the queued rules that
+ * didn't reach the table are taken back out and their handles zeroed.
+ */
+static int ipa_ipv6ct_post_add_batch(ipa_ipv6ct_table* ipv6ct_table, ipa_ipv6ct_batch* batch,
+	uint32_t* rule_handles, uint32_t* num_added)
+{
+	uint16_t posted = 0;
+	int i, ret;
+
+	if (batch->cnt == 0)
+		return 0;
+
+	ret = ipa_nat_post_batch_cmd(&batch->cmd, batch->entries, batch->cnt,
+		ipa_ipv6ct_post_batch_dma_cmd, NULL, &ipv6ct_batch_max_entries, &posted);
+	*num_added = batch->first + posted;
+	if (ret)
+	{
+		IPAERR("unable to post dma command for %u of %u rules\n", batch->cnt - posted, batch->cnt);
+		for (i = batch->cnt - 1; i >= posted; i--)
+		{
+			ipa_table_erase_entry(&ipv6ct_table->table, batch->rules[i].entry_index);
+			rule_handles[batch->first + i] = 0;
+		}
+		return ret;
+	}
+
+	ipa_ipv6ct_batch_reset(batch, *num_added);
+	return 0;
+}
+
+/*
+ * Post what's queued in a delete batch, then finish (in software) the
+ * deletes that reached the table.
+ */
+static int ipa_ipv6ct_post_del_batch(ipa_ipv6ct_table* ipv6ct_table, ipa_ipv6ct_batch* batch,
+	uint32_t* num_deleted)
+{
+	ipa_table_iterator* iterator;
+	uint8_t is_prev_empty;
+	uint16_t i, posted = 0;
+	int ret;
+
+	if (batch->cnt == 0)
+		return 0;
+
+	ret = ipa_nat_post_batch_cmd(&batch->cmd, batch->entries, batch->cnt,
+		ipa_ipv6ct_post_batch_dma_cmd, NULL, &ipv6ct_batch_max_entries, &posted);
+	if (ret)
+		IPAERR("unable to post dma command for %u of %u rules\n", batch->cnt - posted, batch->cnt);
+
+	for (i = 0; i < posted; i++)
+	{
+		iterator = &batch->rules[i].iterator;
+
+		if (ipa_table_iterator_is_head_with_tail(iterator))
+			continue;
+
+		is_prev_empty = (iterator->prev_entry != NULL &&
+			((ipa_ipv6ct_hw_entry*)iterator->prev_entry)->protocol == IPA_IPV6CT_INVALID_PROTO_FIELD_CMP);
+		ipa_table_delete_entry(&ipv6ct_table->table, iterator, is_prev_empty);
+	}
+
+	*num_deleted = batch->first + posted;
+	if (ret)
+		return ret;
+
+	ipa_ipv6ct_batch_reset(batch, *num_deleted);
+	return 0;
+}
+
+int ipa_ipv6ct_add_rules(uint32_t table_handle, const ipa_ipv6ct_rule* user_rules,
+	uint32_t num_rules, uint32_t* rule_handles, uint32_t* num_added)
+{
+	ipa_ipv6ct_table* ipv6ct_table;
+	ipa_ipv6ct_batch* batch;
+	ipa_ipv6ct_batch_rule* brule;
+	uint16_t head;
+	uint32_t i;
+	uint8_t entries;
+	int ret = 0, post_ret;
+
+	IPADBG("\n");
+
+	if (ipv6ct.ipa_desc->ver < IPA_HW_v4_0)
+	{
+		IPAERR("IPv6 connection tracking isn't supported for IPA version %d\n", ipv6ct.ipa_desc->ver);
+		return -EINVAL;
+	}
+
+	if (table_handle == IPA_TABLE_INVALID_ENTRY || table_handle > IPA_IPV6CT_MAX_TBLS ||
+		user_rules == NULL || rule_handles == NULL || num_added == NULL)
+	{
+		IPAERR("Invalid parameters table_handle=%d user_rules=%pK rule_handles=%pK num_added=%pK\n",
+			table_handle, user_rules, rule_handles, num_added);
+		return -EINVAL;
+	}
+	IPADBG("Passed Table handle: 0x%x num_rules: %u\n", table_handle, num_rules);
+
+	*num_added = 0;
+	memset(rule_handles, 0, num_rules * sizeof(uint32_t));
+
+	batch = ipa_ipv6ct_batch_alloc();
+	if (batch == NULL)
+	{
+		IPAERR("unable to allocate memory for batch\n");
+		return -ENOMEM;
+	}
+
+	if (pthread_mutex_lock(&ipv6ct_mutex))
+	{
+		IPAERR("unable to lock the ipv6ct mutex\n");
+		free(batch);
+		return -EINVAL;
+	}
+
+	ipv6ct_table = &ipv6ct.tables[table_handle - 1];
+	if (!ipv6ct_table->mem_desc.valid)
+	{
+		IPAERR("invalid table handle %d\n", table_handle);
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	ipa_ipv6ct_batch_reset(batch, 0);
+
+	for (i = 0; i < num_rules; i++)
+	{
+		if (user_rules[i].protocol == IPA_IPV6CT_INVALID_PROTO_FIELD_CMP)
+		{
+			IPAERR("invalid parameter protocol=%d in rule %u of %u\n",
+				user_rules[i].protocol, i, num_rules);
+			ret = -EINVAL;
+			break;
+		}
+
+		head = ipa_ipv6ct_hash(&user_rules[i], ipv6ct_table->table.table_entries - 1);
+
+		if (ipa_ipv6ct_batch_must_post(batch, head, IPA_MAX_DMA_ENTRIES_FOR_ADD))
+		{
+			ret = ipa_ipv6ct_post_add_batch(ipv6ct_table, batch, rule_handles, num_added);
+			if (ret)
+				goto unlock;
+		}
+
+		brule = &batch->rules[batch->cnt];
+		entries = batch->cmd.entries;
+
+		brule->head = head;
+		brule->entry_index = head;
+
+		ret = ipa_table_add_entry(&ipv6ct_table->table, (void*)&user_rules[i],
+			&brule->entry_index, &rule_handles[i], &batch->cmd);
+		if (ret)
+		{
+			IPAERR("failed to add IPV6CT rule %u of %u\n", i, num_rules);
+			batch->cmd.entries = entries;
+			break;
+		}
+
+		batch->entries[batch->cnt] = batch->cmd.entries - entries;
+		batch->cnt++;
+	}
+
+	post_ret = ipa_ipv6ct_post_add_batch(ipv6ct_table, batch, rule_handles, num_added);
+	ret = (ret) ? ret : post_ret;
+
+	IPADBG("%u of %u rules added\n", *num_added, num_rules);
+
+unlock:
+	if (pthread_mutex_unlock(&ipv6ct_mutex))
+	{
+		IPAERR("unable to unlock the ipv6ct mutex\n");
+		ret = (ret) ? ret : -EPERM;
+	}
+
+	free(batch);
+
+	IPADBG("return\n");
+	return ret;
+}
+
+int ipa_ipv6ct_del_rules(uint32_t table_handle, const uint32_t* rule_handles,
+	uint32_t num_rules, uint32_t* num_deleted)
+{
+	ipa_ipv6ct_table* ipv6ct_table;
+	ipa_ipv6ct_batch* batch;
+	ipa_ipv6ct_batch_rule* brule;
+	ipa_ipv6ct_hw_entry* entry;
+	uint16_t index, head;
+	uint32_t i;
+	uint8_t entries;
+	int ret = 0, post_ret;
+
+	IPADBG("\n");
+
+	if (ipv6ct.ipa_desc->ver < IPA_HW_v4_0)
+	{
+		IPAERR("IPv6 connection tracking isn't supported for IPA version %d\n", ipv6ct.ipa_desc->ver);
+		return -EINVAL;
+	}
+
+	if (table_handle == IPA_TABLE_INVALID_ENTRY || table_handle > IPA_IPV6CT_MAX_TBLS ||
+		rule_handles == NULL || num_deleted == NULL)
+	{
+		IPAERR("Invalid parameters table_handle=%d rule_handles=%pK num_deleted=%pK\n",
+			table_handle, rule_handles, num_deleted);
+		return -EINVAL;
+	}
+	IPADBG("Passed Table handle: 0x%x num_rules: %u\n", table_handle, num_rules);
+
+	*num_deleted = 0;
+
+	batch = ipa_ipv6ct_batch_alloc();
+	if (batch == NULL)
+	{
+		IPAERR("unable to allocate memory for batch\n");
+		return -ENOMEM;
+	}
+
+	if (pthread_mutex_lock(&ipv6ct_mutex))
+	{
+		IPAERR("unable to lock the ipv6ct mutex\n");
+		free(batch);
+		return -EINVAL;
+	}
+
+	ipv6ct_table = &ipv6ct.tables[table_handle - 1];
+	if (!ipv6ct_table->mem_desc.valid)
+	{
+		IPAERR("invalid table handle %d\n", table_handle);
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	ipa_ipv6ct_batch_reset(batch, 0);
+
+	for (i = 0; i < num_rules; i++)
+	{
+		if (rule_handles[i] == IPA_TABLE_INVALID_ENTRY)
+		{
+			IPAERR("invalid rule handle in rule %u of %u\n", i, num_rules);
+			ret = -EINVAL;
+			break;
+		}
+
+		ret = ipa_table_get_entry(&ipv6ct_table->table, rule_handles[i], (void**)&entry, &index);
+		if (ret)
+		{
+			IPAERR("unable to retrive the entry with handle=%d in IPV6CT table with handle=%d\n",
+				rule_handles[i], table_handle);
+			break;
+		}
+
+		head = ipa_table_get_chain_head(&ipv6ct_table->table, index);
+
+		if (ipa_ipv6ct_batch_must_post(batch, head, IPA_MAX_DMA_ENTRIES_FOR_DEL))
+		{
+			ret = ipa_ipv6ct_post_del_batch(ipv6ct_table, batch, num_deleted);
+			if (ret)
+				goto unlock;
+		}
+
+		brule = &batch->rules[batch->cnt];
+		entries = batch->cmd.entries;
+
+		brule->head = head;
+		brule->entry_index = index;
+
+		ret = ipa_table_iterator_init(&brule->iterator, &ipv6ct_table->table, entry, index);
+		if (ret)
+		{
+			IPAERR("unable to create iterator which points to the entry index=%d in IPV6CT table with handle=%d\n",
+				index, table_handle);
+			batch->cmd.entries = entries;
+			break;
+		}
+
+		ipa_table_create_delete_command(&ipv6ct_table->table, &batch->cmd, &brule->iterator);
+
+		batch->entries[batch->cnt] = batch->cmd.entries - entries;
+		batch->cnt++;
+	}
+
+	post_ret = ipa_ipv6ct_post_del_batch(ipv6ct_table, batch, num_deleted);
+	ret = (ret) ? ret : post_ret;
+
+	IPADBG("%u of %u rules deleted\n", *num_deleted, num_rules);
+
+unlock:
+	if (pthread_mutex_unlock(&ipv6ct_mutex))
+	{
+		IPAERR("unable to unlock the ipv6ct mutex\n");
+		ret = (ret) ? ret : -EPERM;
+	}
+
+	free(batch);
+
+	IPADBG("return\n");
+	return ret;
+}
+
+int ipa_ipv6ct_query_timestamps(uint32_t table_handle, const uint32_t* rule_handles,
+	uint32_t num_rules, uint32_t* time_stamps)
+{
+	ipa_ipv6ct_table* ipv6ct_table;
+	ipa_ipv6ct_hw_entry* entry;
+	uint32_t i;
+	int ret = 0;
+
+	IPADBG("\n");
+
+	if (ipv6ct.ipa_desc->ver < IPA_HW_v4_0)
+	{
+		IPAERR("IPv6 connection tracking isn't supported for IPA version %d\n", ipv6ct.ipa_desc->ver);
+		return -EINVAL;
+	}
+
+	if (table_handle == IPA_TABLE_INVALID_ENTRY || table_handle > IPA_IPV6CT_MAX_TBLS ||
+		rule_handles == NULL || time_stamps == NULL)
+	{
+		IPAERR("invalid parameters passed table_handle=%d rule_handles=%pK time_stamps=%pK\n",
+			table_handle, rule_handles, time_stamps);
+		return -EINVAL;
+	}
+	IPADBG("Passed Table: %d num_rules: %u\n", table_handle, num_rules);
+
+	if (pthread_mutex_lock(&ipv6ct_mutex))
+	{
+		IPAERR("unable to lock the ipv6ct mutex\n");
+		return -EINVAL;
+	}
+
+	ipv6ct_table = &ipv6ct.tables[table_handle - 1];
+	if (!ipv6ct_table->mem_desc.valid)
+	{
+		IPAERR("invalid table handle %d\n", table_handle);
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	for (i = 0; i < num_rules; i++)
+	{
+		if (rule_handles[i] == IPA_TABLE_INVALID_ENTRY)
+		{
+			IPAERR("invalid rule handle in rule %u of %u\n", i, num_rules);
+			ret = -EINVAL;
+			break;
+		}
+
+		ret = ipa_table_get_entry(&ipv6ct_table->table, rule_handles[i], (void**)&entry, NULL);
+		if (ret)
+		{
+			IPAERR("unable to retrive the entry with handle=%d in IPV6CT table with handle=%d\n",
+				rule_handles[i], table_handle);
+			break;
+		}
+
+		time_stamps[i] = entry->time_stamp;
+	}
+
+unlock:
+	if (pthread_mutex_unlock(&ipv6ct_mutex))
+	{
+		IPAERR("unable to unlock the ipv6ct mutex\n");
+		return (ret) ? ret : -EPERM;
+	}
+
+	IPADBG("return\n");
+	return ret;
+}
+
 /**
 * ipv6ct_hash() - Find the index into ipv6ct table
 * @rule: [in] an IPv6CT rule
@@ -492,10 +936,10 @@ static uint16_t ipa_ipv6ct_hash(const ipa_ipv6ct_rule* rule, uint16_t size)
 {
 	uint16_t hash = 0;
 
-	IPADBG("src_ipv6_lsb 0x%llx\n", rule->src_ipv6_lsb);
-	IPADBG("src_ipv6_msb 0x%llx\n", rule->src_ipv6_msb);
-	IPADBG("dest_ipv6_lsb 0x%llx\n", rule->dest_ipv6_lsb);
-	IPADBG("dest_ipv6_msb 0x%llx\n", rule->dest_ipv6_msb);
+	IPADBG("src_ipv6_lsb 0x%llx\n", (unsigned long long) rule->src_ipv6_lsb);
+	IPADBG("src_ipv6_msb 0x%llx\n", (unsigned long long) rule->src_ipv6_msb);
+	IPADBG("dest_ipv6_lsb 0x%llx\n", (unsigned long long) rule->dest_ipv6_lsb);
+	IPADBG("dest_ipv6_msb 0x%llx\n", (unsigned long long) rule->dest_ipv6_msb);
 	IPADBG("src_port: 0x%x dest_port: 0x%x\n", rule->src_port, rule->dest_port);
 	IPADBG("protocol: 0x%x size: 0x%x\n", rule->protocol, size);
 
@@ -823,7 +1267,7 @@ static int ipa_ipv6ct_post_init_cmd(ipa_ipv6ct_table* ipv6ct_table, uint8_t tbl_
 	cmd.table_entries = ipv6ct_table->table.table_entries - 1;
 	cmd.expn_table_entries = ipv6ct_table->table.expn_table_entries;
 
-	ret = ioctl(ipv6ct.ipa_desc->fd, IPA_IOC_INIT_IPV6CT_TABLE, &cmd);
+	ret = ipa_dev_ioctl(ipv6ct.ipa_desc->fd, IPA_IOC_INIT_IPV6CT_TABLE, &cmd);
 	if (ret)
 	{
 		IPAERR("unable to post init cmd Error: %d IPA fd %d\n", ret, ipv6ct.ipa_desc->fd);
@@ -840,7 +1284,7 @@ static int ipa_ipv6ct_post_dma_cmd(struct ipa_ioc_nat_dma_cmd* cmd)
 
 	cmd->mem_type = IPA_NAT_MEM_IN_DDR;
 
-	if (ioctl(ipv6ct.ipa_desc->fd, IPA_IOC_TABLE_DMA_CMD, cmd))
+	if (ipa_dev_ioctl(ipv6ct.ipa_desc->fd, IPA_IOC_TABLE_DMA_CMD, cmd))
 	{
 		IPAERR("ioctl (IPA_IOC_TABLE_DMA_CMD) on fd %d has failed\n",
 			   ipv6ct.ipa_desc->fd);
@@ -900,7 +1344,7 @@ int ipa_ipv6ct_add_uc_act_entry(union ipa_ioc_uc_activation_entry *u)
 {
 	IPADBG("\n");
 
-	if(ioctl(ipv6ct.ipa_desc->fd, IPA_IOC_ADD_UC_ACT_ENTRY, u))
+	if(ipa_dev_ioctl(ipv6ct.ipa_desc->fd, IPA_IOC_ADD_UC_ACT_ENTRY, u))
 	{
 		IPAERR("ioctl (IPA_IOC_ADD_UC_ACT_ENTRY) on fd %d has failed\n",
 			ipv6ct.ipa_desc->fd);
@@ -921,7 +1365,7 @@ int ipa_ipv6ct_del_uc_act_entry(uint16_t index)
 {
 	IPADBG("\n");
 
-	if(ioctl(ipv6ct.ipa_desc->fd, IPA_IOC_DEL_UC_ACT_ENTRY, index))
+	if(ipa_dev_ioctl(ipv6ct.ipa_desc->fd, IPA_IOC_DEL_UC_ACT_ENTRY, index))
 	{
 		IPAERR("ioctl (IPA_IOC_DEL_UC_ACT_ENTRY) on fd %d has failed\n",
 			ipv6ct.ipa_desc->fd);
@@ -169,6 +169,101 @@ int ipa_nat_del_ipv4_rule(
 	return 0;
 }
 
+/**
+ * ipa_nat_add_ipv4_rules() - to insert a batch of new ipv4 rules
+ * @table_handle: [in] handle of ipv4 nat table
+ * @rules: [in] array of new rules
+ * @num_rules: [in] number of rules in the array above
+ * @rule_handles: [out] handle of each rule, zero if it wasn't added
+ * @num_added: [out] rules, from the start of the array, that were added
+ *
+ * To insert new ipv4 nat rules into ipv4 nat table
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_add_ipv4_rules(
+	uint32_t tbl_hdl,
+	const ipa_nat_ipv4_rule *clnt_rules,
+	uint32_t num_rules,
+	uint32_t *rule_hdls,
+	uint32_t *num_added)
+{
+	int result = -EINVAL;
+
+	if ( ! VALID_TBL_HDL(tbl_hdl) ||
+		 clnt_rules == NULL ||
+		 rule_hdls == NULL ||
+		 num_added == NULL ||
+		 num_rules == 0 ) {
+		IPAERR(
+			"Invalid parameters tbl_hdl=%d clnt_rules=%pK num_rules=%u "
+			"rule_hdls=%pK num_added=%pK\n",
+			tbl_hdl, clnt_rules, num_rules, rule_hdls, num_added);
+		return result;
+	}
+
+	*num_added = 0;
+
+	IPADBG("Passed Table handle: 0x%x with %u rules\n", tbl_hdl, num_rules);
+
+	if (ipa_nati_add_ipv4_rules(
+			tbl_hdl, clnt_rules, num_rules, rule_hdls, num_added) ||
+		*num_added != num_rules) {
+		IPAERR("Only %u of %u rules added to NAT table with handle 0x%08X\n",
+			   *num_added, num_rules, tbl_hdl);
+		return result;
+	}
+
+	return 0;
+}
+
+/**
+ * ipa_nat_del_ipv4_rules() - to delete a batch of ipv4 nat rules
+ * @table_handle: [in] handle of ipv4 nat table
+ * @rule_handles: [in] array of ipv4 nat rule handles
+ * @num_rules: [in] number of handles in the array above
+ * @num_deleted: [out] rules, from the start of the array, that were deleted
+ *
+ * To delete ipv4 nat rules from ipv4 nat table
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_del_ipv4_rules(
+	uint32_t tbl_hdl,
+	const uint32_t *rule_hdls,
+	uint32_t num_rules,
+	uint32_t *num_deleted)
+{
+	int result = -EINVAL;
+
+	if ( ! VALID_TBL_HDL(tbl_hdl) ||
+		 rule_hdls == NULL ||
+		 num_deleted == NULL ||
+		 num_rules == 0 )
+	{
+		IPAERR("Invalid parameters tbl_hdl=0x%08X rule_hdls=%pK "
+			   "num_rules=%u num_deleted=%pK\n",
+			   tbl_hdl, rule_hdls, num_rules, num_deleted);
+		return result;
+	}
+
+	*num_deleted = 0;
+
+	IPADBG("Passed Table: 0x%08X with %u rule handles\n", tbl_hdl, num_rules);
+
+	if (ipa_nati_del_ipv4_rules(
+			tbl_hdl, rule_hdls, num_rules, num_deleted) ||
+		*num_deleted != num_rules) {
+		IPAERR(
+			"Only %u of %u rules deleted "
+			"from hw for NAT table with handle 0x%08X\n",
+			*num_deleted, num_rules, tbl_hdl);
+		return result;
+	}
+
+	return 0;
+}
+
 /**
  * ipa_nat_query_timestamp() - to query timestamp
  * @table_handle: [in] handle of ipv4 nat table
@@ -199,6 +294,47 @@ int ipa_nat_query_timestamp(
 	return ipa_nati_query_timestamp(tbl_hdl, rule_hdl, time_stamp);
 }
 
+/**
+ * ipa_nat_age_ipv4_rules() - to find, and optionally delete, idle rules
+ * @table_handle: [in] handle of ipv4 nat table
+ * @idle_ms: [in] how long a rule must go unused to have expired
+ * @del_expired: [in] whether to delete the expired rules as well
+ * @rule_handles: [out] handles of the expired rules
+ * @max_handles: [in] size of the array above
+ * @num_expired: [out] number of handles written to the array above
+ *
+ * To sweep an ipv4 nat table for rules that have gone idle
+ *
+ * Returns:	0  On Success, negative on failure
+ */
+int ipa_nat_age_ipv4_rules(
+	uint32_t tbl_hdl,
+	uint32_t idle_ms,
+	bool del_expired,
+	uint32_t *rule_hdls,
+	uint32_t max_hdls,
+	uint32_t *num_expired)
+{
+	if ( ! VALID_TBL_HDL(tbl_hdl) ||
+		 rule_hdls == NULL ||
+		 num_expired == NULL ||
+		 max_hdls == 0 )
+	{
+		IPAERR("Invalid parameters tbl_hdl=0x%08X rule_hdls=%pK "
+			   "max_hdls=%u num_expired=%pK\n",
+			   tbl_hdl, rule_hdls, max_hdls, num_expired);
+		return -EINVAL;
+	}
+
+	*num_expired = 0;
+
+	IPADBG("Passed Table: 0x%08X idle_ms=%u del_expired=%u\n",
+		   tbl_hdl, idle_ms, del_expired);
+
+	return ipa_nati_age_ipv4_rules(
+		tbl_hdl, idle_ms, del_expired, rule_hdls, max_hdls, num_expired);
+}
+
 /**
 * ipa_nat_modify_pdn() - modify single PDN entry in the PDN config table
 * @table_handle: [in] handle of ipv4 nat table
@@ -738,7 +738,7 @@ static int ipa_nati_create_table(
 
 	if (nat_table->index_expn_table_meta == NULL) {
 		IPAERR(
-			"Fail to allocate ipv4 index expansion table meta with size %d\n",
+			"Fail to allocate ipv4 index expansion table meta with size %zu\n",
 			nat_table->table.expn_table_entries *
 			sizeof(struct ipa_nat_indx_tbl_meta_info));
 		ret = -ENOMEM;
@@ -789,7 +789,7 @@ static int ipa_nati_create_table(
 	base_addr = nat_table->mem_desc.base_addr;
 
 #ifdef IPA_ON_R3PC
-	ret = ioctl(nat_cache_ptr->ipa_desc->fd,
+	ret = ipa_dev_ioctl(nat_cache_ptr->ipa_desc->fd,
 				IPA_IOC_GET_NAT_OFFSET,
 				&nat_mem_offset);
 	if (ret) {
@@ -841,6 +841,7 @@ static int ipa_nati_destroy_table(
 		IPAERR("unable to delete NAT descriptor\n");
 
 	free(nat_table->index_expn_table_meta);
+	free(nat_table->age_recs);
 
 	memset(nat_table, 0, sizeof(*nat_table));
 
@@ -900,7 +901,7 @@ static int ipa_nati_post_ipv4_init_cmd(
 
 	IPADBG("%s\n", ipa_ioc_v4_nat_init_as_str(&cmd, buf, sizeof(buf)));
 
-	ret = ioctl(nat_cache_ptr->ipa_desc->fd, IPA_IOC_V4_INIT_NAT, &cmd);
+	ret = ipa_dev_ioctl(nat_cache_ptr->ipa_desc->fd, IPA_IOC_V4_INIT_NAT, &cmd);
 
 	if (ret) {
 		IPAERR("unable to post init cmd Error: %d IPA fd %d\n",
@@ -1078,6 +1079,68 @@ static uint16_t src_hash(
 	return hash;
 }
 
+/*
+ * The IPA applies a TABLE_DMA command to the table it was last pointed
+ * at with an init command, whatever the command's mem_type says. A
+ * table the IPA isn't using (eg. the destination of a migration
+ * between SRAM and DDR) has no hardware reader to order the writes
+ * against, so its updates are simply written here instead.
+ */
+static int ipa_nati_apply_ipv4_dma_cmd(
+	struct ipa_nat_cache*       nat_cache_ptr,
+	struct ipa_ioc_nat_dma_cmd* cmd)
+{
+	struct ipa_nat_ip4_table_cache* nat_table;
+	struct ipa_ioc_nat_dma_one*     dma;
+	uint8_t*                        base;
+	uint32_t                        i;
+
+	int ret = 0;
+
+	IPADBG("In\n");
+
+	for ( i = 0; i < cmd->entries; i++ )
+	{
+		dma = &cmd->dma[i];
+
+		if ( dma->table_index >= nat_cache_ptr->table_cnt )
+		{
+			IPAERR("Bad table_index(%u)\n", dma->table_index);
+			ret = -EINVAL;
+			goto bail;
+		}
+
+		nat_table = &nat_cache_ptr->ip4_tbl[dma->table_index];
+
+		switch ( dma->base_addr )
+		{
+		case IPA_NAT_BASE_TBL:
+			base = nat_table->table.table_addr;
+			break;
+		case IPA_NAT_EXPN_TBL:
+			base = nat_table->table.expn_table_addr;
+			break;
+		case IPA_NAT_INDX_TBL:
+			base = nat_table->index_table.table_addr;
+			break;
+		case IPA_NAT_INDEX_EXPN_TBL:
+			base = nat_table->index_table.expn_table_addr;
+			break;
+		default:
+			IPAERR("Bad base_addr(%u)\n", dma->base_addr);
+			ret = -EINVAL;
+			goto bail;
+		}
+
+		*((uint16_t*) (base + dma->offset)) = dma->data;
+	}
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
 static int ipa_nati_post_ipv4_dma_cmd(
 	struct ipa_nat_cache*       nat_cache_ptr,
 	struct ipa_ioc_nat_dma_cmd* cmd)
@@ -1091,7 +1154,15 @@ static int ipa_nati_post_ipv4_dma_cmd(
 
 	IPADBG("%s\n", prep_ioc_nat_dma_cmd_4print(cmd, buf, sizeof(buf)));
 
-	if (ioctl(nat_cache_ptr->ipa_desc->fd, IPA_IOC_TABLE_DMA_CMD, cmd)) {
+	if ( active_nat_cache_ptr && nat_cache_ptr != active_nat_cache_ptr )
+	{
+		IPADBG("%s table not in use by IPA, applying locally\n",
+			   ipa3_nat_mem_in_as_str(nat_cache_ptr->nmi));
+		ret = ipa_nati_apply_ipv4_dma_cmd(nat_cache_ptr, cmd);
+		goto bail;
+	}
+
+	if (ipa_dev_ioctl(nat_cache_ptr->ipa_desc->fd, IPA_IOC_TABLE_DMA_CMD, cmd)) {
 		IPAERR("ioctl (IPA_IOC_TABLE_DMA_CMD) on fd %d has failed\n",
 			   nat_cache_ptr->ipa_desc->fd);
 		ret = -EIO;
@@ -1134,7 +1205,7 @@ int ipa_nati_modify_pdn(
 	if (entry->public_ip == 0)
 		IPADBG("PDN %d public ip will be set  to 0\n", entry->pdn_index);
 
-	ret = ioctl(nat_cache_ptr->ipa_desc->fd, IPA_IOC_NAT_MODIFY_PDN, entry);
+	ret = ipa_dev_ioctl(nat_cache_ptr->ipa_desc->fd, IPA_IOC_NAT_MODIFY_PDN, entry);
 
 	if ( ret ) {
 		IPAERR("unable to call modify pdn icotl\nindex %d, ip 0x%X, src_metdata 0x%X, dst_metadata 0x%X IPA fd %d\n",
@@ -1581,16 +1652,10 @@ int ipa_NATI_query_timestamp(
 
 	nat_table = &nat_cache_ptr->ip4_tbl[tbl_hdl - 1];
 
-	if (pthread_mutex_lock(&nat_mutex)) {
-		IPAERR("unable to lock the nat mutex\n");
-		ret = -EINVAL;
-		goto bail;
-	}
-
 	if ( ! nat_table->mem_desc.valid ) {
 		IPAERR("invalid table handle %d\n", tbl_hdl);
 		ret = -EINVAL;
-		goto unlock;
+		goto bail;
 	}
 
 	ret = ipa_table_get_entry(
@@ -1603,7 +1668,7 @@ int ipa_NATI_query_timestamp(
 		IPAERR("Unable to retrive the entry with "
 			   "handle=%u in NAT table with handle=0x%08X\n",
 			   rule_hdl, tbl_hdl);
-		goto unlock;
+		goto bail;
 	}
 
 	IPADBG("rule_hdl(0x%08X) -> %s\n",
@@ -1612,81 +1677,182 @@ int ipa_NATI_query_timestamp(
 
 	*time_stamp = rule_ptr->time_stamp;
 
-unlock:
-	if (pthread_mutex_unlock(&nat_mutex)) {
-		IPAERR("unable to unlock the nat mutex\n");
-		ret = (ret) ? ret : -EPERM;
-	}
-
 bail:
 	IPADBG("Out\n");
 
 	return ret;
 }
 
-int ipa_NATI_add_ipv4_rule(
-	uint32_t                 tbl_hdl,
-	const ipa_nat_ipv4_rule* clnt_rule,
-	uint32_t*                rule_hdl)
+/*
+ * ----------------------------------------------------------------------------
+ * Aging
+ *
+ * The IPA stamps a rule each time it's hit, but its timestamps can't
+ * be read against a clock of ours. So a sweep compares each rule's
+ * timestamp with the one the previous sweep saw, and a rule is idle
+ * for as long as its timestamp hasn't moved. A slot's record is reset
+ * when its rule is deleted, so a new rule in the slot starts afresh.
+ * ----------------------------------------------------------------------------
+ */
+typedef struct
 {
-	uint32_t cmd_sz =
-		sizeof(struct ipa_ioc_nat_dma_cmd) +
-		(MAX_DMA_ENTRIES_FOR_ADD * sizeof(struct ipa_ioc_nat_dma_one));
-	char cmd_buf[cmd_sz];
-	struct ipa_ioc_nat_dma_cmd* cmd =
-		(struct ipa_ioc_nat_dma_cmd*) cmd_buf;
+	struct ipa_nati_age_rec* recs;
+	uint64_t                 now_ns;
+	uint64_t                 idle_ns;
+	uint32_t*                rule_hdls;
+	uint32_t                 max_hdls;
+	uint32_t                 num_expired;
+} ipa_nati_age_sweep;
+
+static int ipa_nati_age_rule(
+	ipa_table* table_ptr,
+	uint32_t   rule_hdl,
+	void*      record_ptr,
+	uint16_t   record_index,
+	void*      meta_record_ptr,
+	uint16_t   meta_record_index,
+	void*      arb_data_ptr)
+{
+	ipa_nati_age_sweep*      sweep    = (ipa_nati_age_sweep*) arb_data_ptr;
+	struct ipa_nat_rule*     rule_ptr = (struct ipa_nat_rule*) record_ptr;
+	struct ipa_nati_age_rec* rec      = &sweep->recs[record_index];
+	uint32_t                 ts;
+
+	/*
+	 * A deleted head kept for the sake of its chain...
+	 */
+	if (rule_ptr->protocol == IPAHAL_NAT_INVALID_PROTOCOL)
+		return 0;
+
+	ts = IPA_NATI_REC_TIMESTAMP(record_ptr);
+
+	if (rec->since_ns == 0 || rec->time_stamp != ts) {
+		rec->time_stamp = ts;
+		rec->since_ns   = sweep->now_ns;
+	} else if (sweep->now_ns - rec->since_ns >= sweep->idle_ns &&
+			   sweep->num_expired < sweep->max_hdls) {
+		sweep->rule_hdls[sweep->num_expired++] = rule_hdl;
+	}
+
+	return 0;
+}
 
+int ipa_NATI_age_ipv4_tbl(
+	uint32_t  tbl_hdl,
+	uint32_t  idle_ms,
+	uint32_t* rule_hdls,
+	uint32_t  max_hdls,
+	uint32_t* num_expired)
+{
 	enum ipa3_nat_mem_in            nmi;
+	uint32_t                        broken_tbl_hdl;
 	struct ipa_nat_cache*           nat_cache_ptr;
 	struct ipa_nat_ip4_table_cache* nat_table;
-	struct ipa_nat_rule*            rule;
-
-	uint16_t new_entry_index;
-	uint16_t new_index_tbl_entry_index;
-	uint32_t new_entry_handle;
-	char     buf[1024];
+	ipa_nati_age_sweep              sweep;
 
 	int ret = 0;
 
 	IPADBG("In\n");
 
-	memset(cmd_buf, 0, sizeof(cmd_buf));
-
 	if ( ! VALID_TBL_HDL(tbl_hdl) ||
-		 ! clnt_rule ||
-		 ! rule_hdl )
+		 ! rule_hdls ||
+		 ! num_expired )
 	{
-		IPAERR("Bad arg: tbl_hdl(0x%08X) and/or clnt_rule(%p) and/or rule_hdl(%p)\n",
-			   tbl_hdl, clnt_rule, rule_hdl);
+		IPAERR("Bad arg: tbl_hdl(0x%08X) and/or rule_hdls(%p) "
+			   "and/or num_expired(%p)\n",
+			   tbl_hdl, rule_hdls, num_expired);
 		ret = -EINVAL;
-		goto done;
+		goto bail;
 	}
 
-	*rule_hdl = 0;
-
-	IPADBG("tbl_hdl(0x%08X)\n", tbl_hdl);
+	*num_expired = 0;
 
-	BREAK_TBL_HDL(tbl_hdl, nmi, tbl_hdl);
+	BREAK_TBL_HDL(tbl_hdl, nmi, broken_tbl_hdl);
 
 	if ( ! IPA_VALID_NAT_MEM_IN(nmi) ) {
 		IPAERR("Bad cache type argument passed\n");
 		ret = -EINVAL;
-		goto done;
+		goto bail;
 	}
 
-	IPADBG("tbl_hdl(0x%08X) nmi(%s) %s\n",
-		   tbl_hdl,
-		   ipa3_nat_mem_in_as_str(nmi),
-		   prep_nat_ipv4_rule_4print(clnt_rule, buf, sizeof(buf)));
-
 	nat_cache_ptr = &ipv4_nat_cache[nmi];
 
-	nat_table = &nat_cache_ptr->ip4_tbl[tbl_hdl - 1];
+	nat_table = &nat_cache_ptr->ip4_tbl[broken_tbl_hdl - 1];
+
+	if (pthread_mutex_lock(&nat_mutex)) {
+		IPAERR("unable to lock the nat mutex\n");
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	if ( ! nat_table->mem_desc.valid ) {
+		IPAERR("invalid table handle 0x%08X\n", tbl_hdl);
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	if ( ! nat_table->age_recs ) {
+		nat_table->age_recs = (struct ipa_nati_age_rec*) calloc(
+			nat_table->table.tot_tbl_ents, sizeof(struct ipa_nati_age_rec));
+
+		if ( ! nat_table->age_recs ) {
+			IPAERR("Unable to allocate memory for age records\n");
+			ret = -ENOMEM;
+			goto unlock;
+		}
+	}
+
+	memset(&sweep, 0, sizeof(sweep));
+
+	sweep.recs      = nat_table->age_recs;
+	sweep.idle_ns   = (uint64_t) idle_ms * (NANOS_PER_SEC / MILLIS_PER_SEC);
+	sweep.rule_hdls = rule_hdls;
+	sweep.max_hdls  = max_hdls;
+
+	currTimeAs(TimeAsNanSecs, &sweep.now_ns);
+
+	ret = ipa_table_walk(
+		&nat_table->table, 0, WHEN_SLOT_FILLED, ipa_nati_age_rule, &sweep);
+
+	if ( ret < 0 ) {
+		IPAERR("ipa_table_walk returned non-zero (%d)\n", ret);
+		goto unlock;
+	}
+
+	ret = 0;
+
+	*num_expired = sweep.num_expired;
+
+	IPADBG("%u rules idle for %u ms or more\n", *num_expired, idle_ms);
+
+unlock:
+	if (pthread_mutex_unlock(&nat_mutex)) {
+		IPAERR("unable to unlock the nat mutex\n");
+		ret = (ret) ? ret : -EPERM;
+	}
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ * Private helpers shared by the single and batched rule add/delete
+ * ----------------------------------------------------------------------------
+ */
+static int ipa_nati_validate_ipv4_rule(
+	const ipa_nat_ipv4_rule* clnt_rule)
+{
+	int ret = 0;
+
+	IPADBG("In\n");
 
 	if (clnt_rule->protocol == IPAHAL_NAT_INVALID_PROTOCOL) {
 		IPAERR("invalid parameter protocol=%d\n", clnt_rule->protocol);
 		ret = -EINVAL;
-		goto done;
+		goto bail;
 	}
 
 	/*
@@ -1697,26 +1863,33 @@ int ipa_NATI_add_ipv4_rule(
 		IPAERR("invalid parameters, pdn index %d, public ip = 0x%X\n",
 			   clnt_rule->pdn_index, pdns[clnt_rule->pdn_index].public_ip);
 		ret = -EINVAL;
-		goto done;
+		goto bail;
 	}
 
-	if (pthread_mutex_lock(&nat_mutex)) {
-		IPAERR("unable to lock the nat mutex\n");
-		ret = -EINVAL;
-		goto done;
-	}
+bail:
+	IPADBG("Out\n");
 
-	if (! nat_table->mem_desc.valid) {
-		IPAERR("invalid table handle %d\n", tbl_hdl);
-		ret = -EINVAL;
-		goto unlock;
-	}
+	return ret;
+}
+
+static void ipa_nati_calc_ipv4_rule_hashes(
+	struct ipa_nat_cache*           nat_cache_ptr,
+	struct ipa_nat_ip4_table_cache* nat_table,
+	uint32_t                        public_ip,
+	const ipa_nat_ipv4_rule*        clnt_rule,
+	uint16_t*                       entry_index,
+	uint16_t*                       index_tbl_entry_index)
+{
+	uint16_t new_entry_index;
+	uint16_t new_index_tbl_entry_index;
+
+	IPADBG("In\n");
 
 	/* src_only */
 	if (clnt_rule->src_only) {
 		new_entry_index = dst_hash(
 			nat_cache_ptr,
-			pdns[clnt_rule->pdn_index].public_ip,
+			public_ip,
 			clnt_rule->target_ip,
 			clnt_rule->target_port,
 			clnt_rule->public_port,
@@ -1730,7 +1903,7 @@ int ipa_NATI_add_ipv4_rule(
 	} else {
 	new_entry_index = dst_hash(
 		nat_cache_ptr,
-		pdns[clnt_rule->pdn_index].public_ip,
+		public_ip,
 		clnt_rule->target_ip,
 		clnt_rule->target_port,
 		clnt_rule->public_port,
@@ -1738,18 +1911,6 @@ int ipa_NATI_add_ipv4_rule(
 		nat_table->table.table_entries - 1);
 	}
 
-	ret = ipa_table_add_entry(
-		&nat_table->table,
-		(void*) clnt_rule,
-		&new_entry_index,
-		&new_entry_handle,
-		cmd);
-
-	if (ret) {
-		IPAERR("Failed to add a new NAT entry\n");
-		goto unlock;
-	}
-
 	/* dst_only */
 	if (clnt_rule->dst_only) {
 		new_index_tbl_entry_index =
@@ -1773,6 +1934,51 @@ int ipa_NATI_add_ipv4_rule(
 				 clnt_rule->protocol,
 				 nat_table->table.table_entries - 1);
 	}
+
+	*entry_index           = new_entry_index;
+	*index_tbl_entry_index = new_index_tbl_entry_index;
+
+	IPADBG("Out\n");
+}
+
+/*
+ * On entry, *entry_index and *index_tbl_entry_index are the hashed
+ * slots. On success, they are where the rule was actually put and the
+ * needed DMA entries have been appended to cmd. On failure, nothing
+ * is left in either table.
+ */
+static int ipa_nati_add_ipv4_rule_entries(
+	struct ipa_nat_ip4_table_cache* nat_table,
+	uint32_t                        tbl_hdl,
+	const ipa_nat_ipv4_rule*        clnt_rule,
+	uint16_t*                       entry_index,
+	uint16_t*                       index_tbl_entry_index,
+	uint32_t*                       rule_hdl,
+	struct ipa_ioc_nat_dma_cmd*     cmd)
+{
+	struct ipa_nat_rule* rule;
+
+	uint16_t new_entry_index           = *entry_index;
+	uint16_t new_index_tbl_entry_index = *index_tbl_entry_index;
+	uint32_t new_entry_handle;
+	char     buf[1024];
+
+	int ret = 0;
+
+	IPADBG("In\n");
+
+	ret = ipa_table_add_entry(
+		&nat_table->table,
+		(void*) clnt_rule,
+		&new_entry_index,
+		&new_entry_handle,
+		cmd);
+
+	if (ret) {
+		IPAERR("Failed to add a new NAT entry\n");
+		goto done;
+	}
+
 	ret = ipa_table_add_entry(
 		&nat_table->index_table,
 		(void*) &new_entry_index,
@@ -1809,22 +2015,9 @@ int ipa_NATI_add_ipv4_rule(
 		   new_entry_handle,
 		   prep_nat_rule_4print(rule, buf, sizeof(buf)));
 
-	ret = ipa_nati_post_ipv4_dma_cmd(nat_cache_ptr, cmd);
-
-	if (ret) {
-		IPAERR("unable to post dma command\n");
-		goto bail;
-	}
-
-	if (pthread_mutex_unlock(&nat_mutex)) {
-		IPAERR("unable to unlock the nat mutex\n");
-		ret = -EPERM;
-		goto done;
-	}
-
-	*rule_hdl = new_entry_handle;
-
-	IPADBG("rule_hdl value(%u)\n", *rule_hdl);
+	*entry_index           = new_entry_index;
+	*index_tbl_entry_index = new_index_tbl_entry_index;
+	*rule_hdl              = new_entry_handle;
 
 	goto done;
 
@@ -1834,34 +2027,27 @@ bail:
 fail_add_index_entry:
 	ipa_table_erase_entry(&nat_table->table, new_entry_index);
 
-unlock:
-	if (pthread_mutex_unlock(&nat_mutex))
-		IPAERR("unable to unlock the nat mutex\n");
 done:
 	IPADBG("Out\n");
 
 	return ret;
 }
 
-int ipa_NATI_del_ipv4_rule(
-	uint32_t tbl_hdl,
-	uint32_t rule_hdl )
+/*
+ * Appends the DMA entries needed to unlink rule_hdl to cmd, and
+ * leaves the iterators ready for ipa_nati_finish_ipv4_rule_delete(),
+ * which must only be called once cmd has been posted.
+ */
+static int ipa_nati_prep_ipv4_rule_delete(
+	struct ipa_nat_ip4_table_cache* nat_table,
+	uint32_t                        tbl_hdl,
+	uint32_t                        rule_hdl,
+	ipa_table_iterator*             table_iterator,
+	ipa_table_iterator*             index_table_iterator,
+	struct ipa_ioc_nat_dma_cmd*     cmd)
 {
-	uint32_t cmd_sz =
-		sizeof(struct ipa_ioc_nat_dma_cmd) +
-		(MAX_DMA_ENTRIES_FOR_DEL * sizeof(struct ipa_ioc_nat_dma_one));
-	char cmd_buf[cmd_sz];
-	struct ipa_ioc_nat_dma_cmd* cmd =
-		(struct ipa_ioc_nat_dma_cmd*) cmd_buf;
-
-	enum ipa3_nat_mem_in            nmi;
-	struct ipa_nat_cache*           nat_cache_ptr;
-	struct ipa_nat_ip4_table_cache* nat_table;
-	struct ipa_nat_rule*            table_rule;
-	struct ipa_nat_indx_tbl_rule*   index_table_rule;
-
-	ipa_table_iterator table_iterator;
-	ipa_table_iterator index_table_iterator;
+	struct ipa_nat_rule*          table_rule;
+	struct ipa_nat_indx_tbl_rule* index_table_rule;
 
 	uint16_t index;
 	char     buf[1024];
@@ -1869,36 +2055,6 @@ int ipa_NATI_del_ipv4_rule(
 
 	IPADBG("In\n");
 
-	memset(cmd_buf, 0, sizeof(cmd_buf));
-
-	IPADBG("tbl_hdl(0x%08X) rule_hdl(%u)\n", tbl_hdl, rule_hdl);
-
-	BREAK_TBL_HDL(tbl_hdl, nmi, tbl_hdl);
-
-	if ( ! IPA_VALID_NAT_MEM_IN(nmi) ) {
-		IPAERR("Bad cache type argument passed\n");
-		ret = -EINVAL;
-		goto done;
-	}
-
-	IPADBG("nmi(%s)\n", ipa3_nat_mem_in_as_str(nmi));
-
-	nat_cache_ptr = &ipv4_nat_cache[nmi];
-
-	nat_table = &nat_cache_ptr->ip4_tbl[tbl_hdl - 1];
-
-	if (pthread_mutex_lock(&nat_mutex)) {
-		IPAERR("Unable to lock the nat mutex\n");
-		ret = -EINVAL;
-		goto done;
-	}
-
-	if (! nat_table->mem_desc.valid) {
-		IPAERR("Invalid table handle 0x%08X\n", tbl_hdl);
-		ret = -EINVAL;
-		goto unlock;
-	}
-
 	ret = ipa_table_get_entry(
 		&nat_table->table,
 		rule_hdl,
@@ -1907,7 +2063,7 @@ int ipa_NATI_del_ipv4_rule(
 
 	if (ret) {
 		IPAERR("Unable to retrive the entry with rule_hdl=%u\n", rule_hdl);
-		goto unlock;
+		goto bail;
 	}
 
 	IPADBG("rule_hdl(0x%08X) -> %s\n",
@@ -1915,7 +2071,7 @@ int ipa_NATI_del_ipv4_rule(
 		   prep_nat_rule_4print(table_rule, buf, sizeof(buf)));
 
 	ret = ipa_table_iterator_init(
-		&table_iterator,
+		table_iterator,
 		&nat_table->table,
 		table_rule,
 		index);
@@ -1924,7 +2080,7 @@ int ipa_NATI_del_ipv4_rule(
 		IPAERR("Unable to create iterator which points to the "
 			   "entry %u in NAT table with handle=0x%08X\n",
 			   index, tbl_hdl);
-		goto unlock;
+		goto bail;
 	}
 
 	index = table_rule->indx_tbl_entry;
@@ -1937,11 +2093,11 @@ int ipa_NATI_del_ipv4_rule(
 			   "in NAT index table with handle=0x%08X\n",
 			   index, tbl_hdl);
 		ret = -EPERM;
-		goto unlock;
+		goto bail;
 	}
 
 	ret = ipa_table_iterator_init(
-		&index_table_iterator,
+		index_table_iterator,
 		&nat_table->index_table,
 		index_table_rule,
 		index);
@@ -1950,182 +2106,888 @@ int ipa_NATI_del_ipv4_rule(
 		IPAERR("Unable to create iterator which points to the "
 			   "entry %u in NAT index table with handle=0x%08X\n",
 			   index, tbl_hdl);
-		goto unlock;
+		goto bail;
 	}
 
 	ipa_table_create_delete_command(
 		&nat_table->index_table,
 		cmd,
-		&index_table_iterator);
+		index_table_iterator);
 
-	if (ipa_table_iterator_is_head_with_tail(&index_table_iterator)) {
+	if (ipa_table_iterator_is_head_with_tail(index_table_iterator)) {
 
 		ipa_nati_copy_second_index_entry_to_head(
-			nat_table, &index_table_iterator, cmd);
+			nat_table, index_table_iterator, cmd);
 		/*
 		 * Iterate to the next entry which should be deleted
 		 */
 		ret = ipa_table_iterator_next(
-			&index_table_iterator, &nat_table->index_table);
+			index_table_iterator, &nat_table->index_table);
 
 		if (ret) {
 			IPAERR("Unable to move the iterator to the next entry "
 				   "(points to the entry %u in NAT index table)\n",
 				   index);
-			goto unlock;
+			goto bail;
 		}
 	}
 
 	ipa_table_create_delete_command(
 		&nat_table->table,
 		cmd,
-		&table_iterator);
+		table_iterator);
 
-	ret = ipa_nati_post_ipv4_dma_cmd(nat_cache_ptr, cmd);
+bail:
+	IPADBG("Out\n");
 
-	if (ret) {
-		IPAERR("Unable to post dma command\n");
-		goto unlock;
-	}
+	return ret;
+}
+
+static void ipa_nati_finish_ipv4_rule_delete(
+	struct ipa_nat_ip4_table_cache* nat_table,
+	ipa_table_iterator*             table_iterator,
+	ipa_table_iterator*             index_table_iterator)
+{
+	IPADBG("In\n");
+
+	/*
+	 * Whatever lands in the slot next starts aging afresh...
+	 */
+	if (nat_table->age_recs)
+		nat_table->age_recs[table_iterator->curr_index].since_ns = 0;
 
-	if (! ipa_table_iterator_is_head_with_tail(&table_iterator)) {
+	if (! ipa_table_iterator_is_head_with_tail(table_iterator)) {
 		/* The entry can be deleted */
 		uint8_t is_prev_empty =
-			(table_iterator.prev_entry != NULL &&
-			 ((struct ipa_nat_rule*)table_iterator.prev_entry)->protocol ==
+			(table_iterator->prev_entry != NULL &&
+			 ((struct ipa_nat_rule*)table_iterator->prev_entry)->protocol ==
 			 IPAHAL_NAT_INVALID_PROTOCOL);
 
 		ipa_table_delete_entry(
-			&nat_table->table, &table_iterator, is_prev_empty);
+			&nat_table->table, table_iterator, is_prev_empty);
 	}
 
 	ipa_table_delete_entry(
 		&nat_table->index_table,
-		&index_table_iterator,
+		index_table_iterator,
 		FALSE);
 
-	if (index_table_iterator.curr_index >= nat_table->index_table.table_entries)
+	if (index_table_iterator->curr_index >= nat_table->index_table.table_entries)
 		nat_table->index_expn_table_meta[
-			index_table_iterator.curr_index - nat_table->index_table.table_entries].
+			index_table_iterator->curr_index - nat_table->index_table.table_entries].
 			prev_index = IPA_TABLE_INVALID_ENTRY;
 
-unlock:
-	if (pthread_mutex_unlock(&nat_mutex)) {
-		IPAERR("Unable to unlock the nat mutex\n");
-		ret = (ret) ? ret : -EPERM;
-	}
-
-done:
 	IPADBG("Out\n");
-
-	return ret;
 }
 
-/*
- * ----------------------------------------------------------------------------
- * New function to get sram size.
- * ----------------------------------------------------------------------------
- */
-int ipa_nati_get_sram_size(
-	uint32_t* size_ptr)
+int ipa_NATI_add_ipv4_rule(
+	uint32_t                 tbl_hdl,
+	const ipa_nat_ipv4_rule* clnt_rule,
+	uint32_t*                rule_hdl)
 {
-	struct ipa_nat_cache* nat_cache_ptr =
-		&ipv4_nat_cache[IPA_NAT_MEM_IN_SRAM];
-	struct ipa_nat_in_sram_info nat_sram_info;
-	int ret;
+	uint32_t cmd_sz =
+		sizeof(struct ipa_ioc_nat_dma_cmd) +
+		(MAX_DMA_ENTRIES_FOR_ADD * sizeof(struct ipa_ioc_nat_dma_one));
+	char cmd_buf[cmd_sz];
+	struct ipa_ioc_nat_dma_cmd* cmd =
+		(struct ipa_ioc_nat_dma_cmd*) cmd_buf;
+
+	enum ipa3_nat_mem_in            nmi;
+	struct ipa_nat_cache*           nat_cache_ptr;
+	struct ipa_nat_ip4_table_cache* nat_table;
+
+	uint16_t new_entry_index;
+	uint16_t new_index_tbl_entry_index;
+	uint32_t new_entry_handle;
+	char     buf[1024];
+
+	int ret = 0;
 
 	IPADBG("In\n");
 
+	memset(cmd_buf, 0, sizeof(cmd_buf));
+
+	if ( ! VALID_TBL_HDL(tbl_hdl) ||
+		 ! clnt_rule ||
+		 ! rule_hdl )
+	{
+		IPAERR("Bad arg: tbl_hdl(0x%08X) and/or clnt_rule(%p) and/or rule_hdl(%p)\n",
+			   tbl_hdl, clnt_rule, rule_hdl);
+		ret = -EINVAL;
+		goto done;
+	}
+
+	*rule_hdl = 0;
+
+	IPADBG("tbl_hdl(0x%08X)\n", tbl_hdl);
+
+	BREAK_TBL_HDL(tbl_hdl, nmi, tbl_hdl);
+
+	if ( ! IPA_VALID_NAT_MEM_IN(nmi) ) {
+		IPAERR("Bad cache type argument passed\n");
+		ret = -EINVAL;
+		goto done;
+	}
+
+	IPADBG("tbl_hdl(0x%08X) nmi(%s) %s\n",
+		   tbl_hdl,
+		   ipa3_nat_mem_in_as_str(nmi),
+		   prep_nat_ipv4_rule_4print(clnt_rule, buf, sizeof(buf)));
+
+	nat_cache_ptr = &ipv4_nat_cache[nmi];
+
+	nat_table = &nat_cache_ptr->ip4_tbl[tbl_hdl - 1];
+
+	ret = ipa_nati_validate_ipv4_rule(clnt_rule);
+
+	if (ret) {
+		goto done;
+	}
+
 	if (pthread_mutex_lock(&nat_mutex)) {
 		IPAERR("unable to lock the nat mutex\n");
 		ret = -EINVAL;
-		goto bail;
+		goto done;
 	}
 
-	if ( ! nat_cache_ptr->ipa_desc ) {
-		nat_cache_ptr->ipa_desc = ipa_descriptor_open();
-		if ( nat_cache_ptr->ipa_desc == NULL ) {
-			IPAERR("failed to open IPA driver file descriptor\n");
-			ret = -EIO;
-			goto unlock;
-		}
+	if (! nat_table->mem_desc.valid) {
+		IPAERR("invalid table handle %d\n", tbl_hdl);
+		ret = -EINVAL;
+		goto unlock;
 	}
 
-	memset(&nat_sram_info, 0, sizeof(nat_sram_info));
+	ipa_nati_calc_ipv4_rule_hashes(
+		nat_cache_ptr,
+		nat_table,
+		pdns[clnt_rule->pdn_index].public_ip,
+		clnt_rule,
+		&new_entry_index,
+		&new_index_tbl_entry_index);
 
-	ret = ioctl(nat_cache_ptr->ipa_desc->fd,
-				IPA_IOC_GET_NAT_IN_SRAM_INFO,
-				&nat_sram_info);
+	ret = ipa_nati_add_ipv4_rule_entries(
+		nat_table,
+		tbl_hdl,
+		clnt_rule,
+		&new_entry_index,
+		&new_index_tbl_entry_index,
+		&new_entry_handle,
+		cmd);
 
 	if (ret) {
-		IPAERR("NAT_IN_SRAM_INFO ioctl failure %d on IPA fd %d\n",
-			   ret, nat_cache_ptr->ipa_desc->fd);
 		goto unlock;
 	}
 
-	if ( (*size_ptr = nat_sram_info.sram_mem_available_for_nat) == 0 )
-	{
-		IPAERR("sram_mem_available_for_nat is zero\n");
-		ret = -EINVAL;
-		goto unlock;
+	ret = ipa_nati_post_ipv4_dma_cmd(nat_cache_ptr, cmd);
+
+	if (ret) {
+		IPAERR("unable to post dma command\n");
+		goto bail;
 	}
 
-unlock:
 	if (pthread_mutex_unlock(&nat_mutex)) {
 		IPAERR("unable to unlock the nat mutex\n");
-		ret = (ret) ? ret : -EPERM;
+		ret = -EPERM;
+		goto done;
 	}
 
+	*rule_hdl = new_entry_handle;
+
+	IPADBG("rule_hdl value(%u)\n", *rule_hdl);
+
+	goto done;
+
 bail:
+	ipa_table_erase_entry(&nat_table->index_table, new_index_tbl_entry_index);
+	ipa_table_erase_entry(&nat_table->table, new_entry_index);
+
+unlock:
+	if (pthread_mutex_unlock(&nat_mutex))
+		IPAERR("unable to unlock the nat mutex\n");
+done:
 	IPADBG("Out\n");
 
 	return ret;
 }
 
-/*
- * ----------------------------------------------------------------------------
- * Utility functions
- * ----------------------------------------------------------------------------
- */
-static int print_nat_rule(
-	ipa_table*      table_ptr,
-	uint32_t        rule_hdl,
-	void*           record_ptr,
-	uint16_t        record_index,
-	void*           meta_record_ptr,
-	uint16_t        meta_record_index,
-	void*           arb_data_ptr )
+int ipa_NATI_del_ipv4_rule(
+	uint32_t tbl_hdl,
+	uint32_t rule_hdl )
 {
-	enum ipa3_nat_mem_in nmi;
-	uint8_t              is_expn_tbl;
-	uint16_t             rule_index;
+	uint32_t cmd_sz =
+		sizeof(struct ipa_ioc_nat_dma_cmd) +
+		(MAX_DMA_ENTRIES_FOR_DEL * sizeof(struct ipa_ioc_nat_dma_one));
+	char cmd_buf[cmd_sz];
+	struct ipa_ioc_nat_dma_cmd* cmd =
+		(struct ipa_ioc_nat_dma_cmd*) cmd_buf;
 
-	char buf[1024];
+	enum ipa3_nat_mem_in            nmi;
+	struct ipa_nat_cache*           nat_cache_ptr;
+	struct ipa_nat_ip4_table_cache* nat_table;
 
-	struct ipa_nat_rule* rule_ptr =
-		(struct ipa_nat_rule*) record_ptr;
+	ipa_table_iterator table_iterator;
+	ipa_table_iterator index_table_iterator;
 
-	if ( rule_ptr->protocol == IPA_NAT_INVALID_PROTO_FIELD_VALUE_IN_RULE )
-	{
-		goto bail;
-	}
+	int      ret = 0;
 
-	BREAK_RULE_HDL(table_ptr, rule_hdl, nmi, is_expn_tbl, rule_index);
+	IPADBG("In\n");
 
-	printf("  %s %s (0x%04X) (0x%08X) -> %s\n",
-		   (table_ptr->nmi == IPA_NAT_MEM_IN_DDR) ? "DDR" : "SRAM",
-		   (is_expn_tbl) ? "EXP " : "BASE",
-		   record_index,
-		   rule_hdl,
-		   prep_nat_rule_4print(rule_ptr, buf, sizeof(buf)));
+	memset(cmd_buf, 0, sizeof(cmd_buf));
 
-	fflush(stdout);
+	IPADBG("tbl_hdl(0x%08X) rule_hdl(%u)\n", tbl_hdl, rule_hdl);
 
-	*((bool*) arb_data_ptr) = false;
+	BREAK_TBL_HDL(tbl_hdl, nmi, tbl_hdl);
 
-bail:
-	return 0;
-}
+	if ( ! IPA_VALID_NAT_MEM_IN(nmi) ) {
+		IPAERR("Bad cache type argument passed\n");
+		ret = -EINVAL;
+		goto done;
+	}
+
+	IPADBG("nmi(%s)\n", ipa3_nat_mem_in_as_str(nmi));
+
+	nat_cache_ptr = &ipv4_nat_cache[nmi];
+
+	nat_table = &nat_cache_ptr->ip4_tbl[tbl_hdl - 1];
+
+	if (pthread_mutex_lock(&nat_mutex)) {
+		IPAERR("Unable to lock the nat mutex\n");
+		ret = -EINVAL;
+		goto done;
+	}
+
+	if (! nat_table->mem_desc.valid) {
+		IPAERR("Invalid table handle 0x%08X\n", tbl_hdl);
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	ret = ipa_nati_prep_ipv4_rule_delete(
+		nat_table,
+		tbl_hdl,
+		rule_hdl,
+		&table_iterator,
+		&index_table_iterator,
+		cmd);
+
+	if (ret) {
+		goto unlock;
+	}
+
+	ret = ipa_nati_post_ipv4_dma_cmd(nat_cache_ptr, cmd);
+
+	if (ret) {
+		IPAERR("Unable to post dma command\n");
+		goto unlock;
+	}
+
+	ipa_nati_finish_ipv4_rule_delete(
+		nat_table, &table_iterator, &index_table_iterator);
+
+unlock:
+	if (pthread_mutex_unlock(&nat_mutex)) {
+		IPAERR("Unable to unlock the nat mutex\n");
+		ret = (ret) ? ret : -EPERM;
+	}
+
+done:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ * Batched rule add/delete
+ *
+ * A batch queues the DMA entries of several rules into one command and
+ * posts them with a single IPA_IOC_TABLE_DMA_CMD, under a single hold
+ * of the nat mutex. The IPA applies a command whole or not at all, so
+ * a failed post only has to undo the rules queued in it. A command the
+ * driver won't take is posted again one rule at a time.
+ *
+ * The enable, protocol and next_index fields named in queued DMA
+ * entries are written by the IPA, not here, so until the command has
+ * been posted, software's view of any chain with queued entries is
+ * stale. Hence, when a rule lands on a chain already in the batch, or
+ * when the command is full, the queued entries are posted first.
+ * Expansion slots come off the table's free list, so a slot that is
+ * still waiting on its enable bit is never handed out twice.
+ * ----------------------------------------------------------------------------
+ */
+#define MAX_RULES_PER_BATCH (IPA_NAT_BATCH_MAX_DMA_ENTRIES / 2)
+
+/* Entries the driver has taken in one command, under nat_mutex */
+static uint32_t nati_batch_max_entries = IPA_NAT_BATCH_MAX_DMA_ENTRIES;
+
+typedef struct
+{
+	uint16_t           tbl_head;
+	uint16_t           idx_head;
+	uint16_t           entry_index;
+	uint16_t           index_tbl_entry_index;
+	ipa_table_iterator table_iterator;
+	ipa_table_iterator index_table_iterator;
+} ipa_nati_batch_rule;
+
+typedef struct
+{
+	uint32_t                   first;  /* user's index of rules[0] */
+	uint16_t                   cnt;
+	ipa_nati_batch_rule        rules[MAX_RULES_PER_BATCH];
+	uint8_t                    entries[MAX_RULES_PER_BATCH]; /* per rule */
+	struct ipa_ioc_nat_dma_cmd cmd;    /* must be last */
+} ipa_nati_batch;
+
+static ipa_nati_batch* ipa_nati_batch_alloc(void)
+{
+	return (ipa_nati_batch*) calloc(
+		1,
+		sizeof(ipa_nati_batch) +
+		(IPA_NAT_BATCH_MAX_DMA_ENTRIES * sizeof(struct ipa_ioc_nat_dma_one)));
+}
+
+static void ipa_nati_batch_reset(
+	ipa_nati_batch* batch,
+	uint32_t        first)
+{
+	batch->first       = first;
+	batch->cnt         = 0;
+	batch->cmd.entries = 0;
+}
+
+static bool ipa_nati_batch_must_post(
+	ipa_nati_batch* batch,
+	uint16_t        tbl_head,
+	uint16_t        idx_head,
+	uint32_t        max_dma_entries)
+{
+	uint16_t i;
+
+	if (batch->cnt == 0)
+		return false;
+
+	if (batch->cnt >= MAX_RULES_PER_BATCH ||
+		batch->cmd.entries + max_dma_entries > nati_batch_max_entries)
+		return true;
+
+	for (i = 0; i < batch->cnt; i++) {
+		if (batch->rules[i].tbl_head == tbl_head ||
+			batch->rules[i].idx_head == idx_head) {
+			IPADBG("Chain (%u/%u) already in batch\n", tbl_head, idx_head);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static int ipa_nati_post_batch_dma_cmd(
+	void*                       arg,
+	struct ipa_ioc_nat_dma_cmd* cmd)
+{
+	return ipa_nati_post_ipv4_dma_cmd((struct ipa_nat_cache*) arg, cmd);
+}
+
+/*
+ * Post what's queued in an add batch. On failure, the queued rules that
+ * didn't reach the tables are taken back out and their handles zeroed.
+ */
+static int ipa_nati_post_add_batch(
+	struct ipa_nat_cache*           nat_cache_ptr,
+	struct ipa_nat_ip4_table_cache* nat_table,
+	ipa_nati_batch*                 batch,
+	uint32_t*                       rule_hdls,
+	uint32_t*                       num_added)
+{
+	uint16_t posted = 0;
+	int i, ret = 0;
+
+	IPADBG("In\n");
+
+	if (batch->cnt == 0)
+		goto bail;
+
+	ret = ipa_nat_post_batch_cmd(
+		&batch->cmd, batch->entries, batch->cnt,
+		ipa_nati_post_batch_dma_cmd, nat_cache_ptr,
+		&nati_batch_max_entries, &posted);
+
+	*num_added = batch->first + posted;
+
+	if (ret) {
+		IPAERR("unable to post dma command for %u of %u rules\n",
+			   batch->cnt - posted, batch->cnt);
+
+		for (i = batch->cnt - 1; i >= posted; i--) {
+			ipa_table_erase_entry(
+				&nat_table->index_table,
+				batch->rules[i].index_tbl_entry_index);
+			ipa_table_erase_entry(
+				&nat_table->table,
+				batch->rules[i].entry_index);
+			rule_hdls[batch->first + i] = 0;
+		}
+
+		goto bail;
+	}
+
+	ipa_nati_batch_reset(batch, *num_added);
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/*
+ * Post what's queued in a delete batch, then finish (in software) the
+ * deletes that reached the tables.
+ */
+static int ipa_nati_post_del_batch(
+	struct ipa_nat_cache*           nat_cache_ptr,
+	struct ipa_nat_ip4_table_cache* nat_table,
+	ipa_nati_batch*                 batch,
+	uint32_t*                       num_deleted)
+{
+	uint16_t i, posted = 0;
+	int      ret = 0;
+
+	IPADBG("In\n");
+
+	if (batch->cnt == 0)
+		goto bail;
+
+	ret = ipa_nat_post_batch_cmd(
+		&batch->cmd, batch->entries, batch->cnt,
+		ipa_nati_post_batch_dma_cmd, nat_cache_ptr,
+		&nati_batch_max_entries, &posted);
+
+	if (ret)
+		IPAERR("Unable to post dma command for %u of %u rules\n",
+			   batch->cnt - posted, batch->cnt);
+
+	for (i = 0; i < posted; i++) {
+		ipa_nati_finish_ipv4_rule_delete(
+			nat_table,
+			&batch->rules[i].table_iterator,
+			&batch->rules[i].index_table_iterator);
+	}
+
+	*num_deleted = batch->first + posted;
+
+	if (ret)
+		goto bail;
+
+	ipa_nati_batch_reset(batch, *num_deleted);
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+int ipa_NATI_add_ipv4_rules(
+	uint32_t                 tbl_hdl,
+	const ipa_nat_ipv4_rule* clnt_rules,
+	uint32_t                 num_rules,
+	uint32_t*                rule_hdls,
+	uint32_t*                num_added)
+{
+	enum ipa3_nat_mem_in            nmi;
+	struct ipa_nat_cache*           nat_cache_ptr;
+	struct ipa_nat_ip4_table_cache* nat_table;
+	ipa_nati_batch*                 batch = NULL;
+	ipa_nati_batch_rule*            brule;
+
+	uint16_t new_entry_index;
+	uint16_t new_index_tbl_entry_index;
+	uint32_t i;
+	uint8_t  entries;
+
+	int ret = 0, post_ret;
+
+	IPADBG("In\n");
+
+	if ( ! VALID_TBL_HDL(tbl_hdl) ||
+		 ! clnt_rules ||
+		 ! rule_hdls ||
+		 ! num_added )
+	{
+		IPAERR("Bad arg: tbl_hdl(0x%08X) and/or clnt_rules(%p) "
+			   "and/or rule_hdls(%p) and/or num_added(%p)\n",
+			   tbl_hdl, clnt_rules, rule_hdls, num_added);
+		ret = -EINVAL;
+		goto done;
+	}
+
+	*num_added = 0;
+
+	memset(rule_hdls, 0, num_rules * sizeof(uint32_t));
+
+	IPADBG("tbl_hdl(0x%08X) num_rules(%u)\n", tbl_hdl, num_rules);
+
+	BREAK_TBL_HDL(tbl_hdl, nmi, tbl_hdl);
+
+	if ( ! IPA_VALID_NAT_MEM_IN(nmi) ) {
+		IPAERR("Bad cache type argument passed\n");
+		ret = -EINVAL;
+		goto done;
+	}
+
+	nat_cache_ptr = &ipv4_nat_cache[nmi];
+
+	nat_table = &nat_cache_ptr->ip4_tbl[tbl_hdl - 1];
+
+	batch = ipa_nati_batch_alloc();
+
+	if (batch == NULL) {
+		IPAERR("Unable to allocate memory for batch\n");
+		ret = -ENOMEM;
+		goto done;
+	}
+
+	if (pthread_mutex_lock(&nat_mutex)) {
+		IPAERR("unable to lock the nat mutex\n");
+		ret = -EINVAL;
+		goto done;
+	}
+
+	if (! nat_table->mem_desc.valid) {
+		IPAERR("invalid table handle %d\n", tbl_hdl);
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	ipa_nati_batch_reset(batch, 0);
+
+	for (i = 0; i < num_rules; i++) {
+
+		ret = ipa_nati_validate_ipv4_rule(&clnt_rules[i]);
+
+		if (ret) {
+			IPAERR("rule %u of %u is invalid\n", i, num_rules);
+			break;
+		}
+
+		ipa_nati_calc_ipv4_rule_hashes(
+			nat_cache_ptr,
+			nat_table,
+			pdns[clnt_rules[i].pdn_index].public_ip,
+			&clnt_rules[i],
+			&new_entry_index,
+			&new_index_tbl_entry_index);
+
+		if (ipa_nati_batch_must_post(
+				batch,
+				new_entry_index,
+				new_index_tbl_entry_index,
+				MAX_DMA_ENTRIES_FOR_ADD))
+		{
+			ret = ipa_nati_post_add_batch(
+				nat_cache_ptr, nat_table, batch, rule_hdls, num_added);
+
+			if (ret)
+				goto unlock;
+		}
+
+		brule   = &batch->rules[batch->cnt];
+		entries = batch->cmd.entries;
+
+		brule->tbl_head = new_entry_index;
+		brule->idx_head = new_index_tbl_entry_index;
+
+		ret = ipa_nati_add_ipv4_rule_entries(
+			nat_table,
+			tbl_hdl,
+			&clnt_rules[i],
+			&new_entry_index,
+			&new_index_tbl_entry_index,
+			&rule_hdls[i],
+			&batch->cmd);
+
+		if (ret) {
+			IPAERR("unable to add rule %u of %u\n", i, num_rules);
+			batch->cmd.entries = entries;
+			break;
+		}
+
+		brule->entry_index           = new_entry_index;
+		brule->index_tbl_entry_index = new_index_tbl_entry_index;
+
+		batch->entries[batch->cnt] = batch->cmd.entries - entries;
+		batch->cnt++;
+	}
+
+	post_ret = ipa_nati_post_add_batch(
+		nat_cache_ptr, nat_table, batch, rule_hdls, num_added);
+
+	ret = (ret) ? ret : post_ret;
+
+	IPADBG("%u of %u rules added\n", *num_added, num_rules);
+
+unlock:
+	if (pthread_mutex_unlock(&nat_mutex)) {
+		IPAERR("unable to unlock the nat mutex\n");
+		ret = (ret) ? ret : -EPERM;
+	}
+
+done:
+	free(batch);
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+int ipa_NATI_del_ipv4_rules(
+	uint32_t        tbl_hdl,
+	const uint32_t* rule_hdls,
+	uint32_t        num_rules,
+	uint32_t*       num_deleted)
+{
+	enum ipa3_nat_mem_in            nmi;
+	struct ipa_nat_cache*           nat_cache_ptr;
+	struct ipa_nat_ip4_table_cache* nat_table;
+	struct ipa_nat_rule*            table_rule;
+	ipa_nati_batch*                 batch = NULL;
+	ipa_nati_batch_rule*            brule;
+
+	uint16_t tbl_head, idx_head, index;
+	uint32_t i;
+	uint8_t  entries;
+
+	int ret = 0, post_ret;
+
+	IPADBG("In\n");
+
+	if ( ! VALID_TBL_HDL(tbl_hdl) ||
+		 ! rule_hdls ||
+		 ! num_deleted )
+	{
+		IPAERR("Bad arg: tbl_hdl(0x%08X) and/or rule_hdls(%p) "
+			   "and/or num_deleted(%p)\n",
+			   tbl_hdl, rule_hdls, num_deleted);
+		ret = -EINVAL;
+		goto done;
+	}
+
+	*num_deleted = 0;
+
+	IPADBG("tbl_hdl(0x%08X) num_rules(%u)\n", tbl_hdl, num_rules);
+
+	BREAK_TBL_HDL(tbl_hdl, nmi, tbl_hdl);
+
+	if ( ! IPA_VALID_NAT_MEM_IN(nmi) ) {
+		IPAERR("Bad cache type argument passed\n");
+		ret = -EINVAL;
+		goto done;
+	}
+
+	nat_cache_ptr = &ipv4_nat_cache[nmi];
+
+	nat_table = &nat_cache_ptr->ip4_tbl[tbl_hdl - 1];
+
+	batch = ipa_nati_batch_alloc();
+
+	if (batch == NULL) {
+		IPAERR("Unable to allocate memory for batch\n");
+		ret = -ENOMEM;
+		goto done;
+	}
+
+	if (pthread_mutex_lock(&nat_mutex)) {
+		IPAERR("Unable to lock the nat mutex\n");
+		ret = -EINVAL;
+		goto done;
+	}
+
+	if (! nat_table->mem_desc.valid) {
+		IPAERR("Invalid table handle 0x%08X\n", tbl_hdl);
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+	ipa_nati_batch_reset(batch, 0);
+
+	for (i = 0; i < num_rules; i++) {
+
+		ret = ipa_table_get_entry(
+			&nat_table->table,
+			rule_hdls[i],
+			(void**) &table_rule,
+			&index);
+
+		if (ret) {
+			IPAERR("Unable to retrive the entry with rule_hdl=%u\n",
+				   rule_hdls[i]);
+			break;
+		}
+
+		tbl_head = ipa_table_get_chain_head(&nat_table->table, index);
+
+		idx_head = ipa_table_get_chain_head(
+			&nat_table->index_table, table_rule->indx_tbl_entry);
+
+		if (ipa_nati_batch_must_post(
+				batch, tbl_head, idx_head, MAX_DMA_ENTRIES_FOR_DEL))
+		{
+			ret = ipa_nati_post_del_batch(
+				nat_cache_ptr, nat_table, batch, num_deleted);
+
+			if (ret)
+				goto unlock;
+		}
+
+		brule   = &batch->rules[batch->cnt];
+		entries = batch->cmd.entries;
+
+		brule->tbl_head = tbl_head;
+		brule->idx_head = idx_head;
+
+		ret = ipa_nati_prep_ipv4_rule_delete(
+			nat_table,
+			tbl_hdl,
+			rule_hdls[i],
+			&brule->table_iterator,
+			&brule->index_table_iterator,
+			&batch->cmd);
+
+		if (ret) {
+			IPAERR("Unable to delete rule %u of %u\n", i, num_rules);
+			batch->cmd.entries = entries;
+			break;
+		}
+
+		batch->entries[batch->cnt] = batch->cmd.entries - entries;
+		batch->cnt++;
+	}
+
+	post_ret = ipa_nati_post_del_batch(
+		nat_cache_ptr, nat_table, batch, num_deleted);
+
+	ret = (ret) ? ret : post_ret;
+
+	IPADBG("%u of %u rules deleted\n", *num_deleted, num_rules);
+
+unlock:
+	if (pthread_mutex_unlock(&nat_mutex)) {
+		IPAERR("Unable to unlock the nat mutex\n");
+		ret = (ret) ? ret : -EPERM;
+	}
+
+done:
+	free(batch);
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ * New function to get sram size.
+ * ----------------------------------------------------------------------------
+ */
+int ipa_nati_get_sram_size(
+	uint32_t* size_ptr)
+{
+	struct ipa_nat_cache* nat_cache_ptr =
+		&ipv4_nat_cache[IPA_NAT_MEM_IN_SRAM];
+	struct ipa_nat_in_sram_info nat_sram_info;
+	int ret;
+
+	IPADBG("In\n");
+
+	if (pthread_mutex_lock(&nat_mutex)) {
+		IPAERR("unable to lock the nat mutex\n");
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	if ( ! nat_cache_ptr->ipa_desc ) {
+		nat_cache_ptr->ipa_desc = ipa_descriptor_open();
+		if ( nat_cache_ptr->ipa_desc == NULL ) {
+			IPAERR("failed to open IPA driver file descriptor\n");
+			ret = -EIO;
+			goto unlock;
+		}
+	}
+
+	memset(&nat_sram_info, 0, sizeof(nat_sram_info));
+
+	ret = ipa_dev_ioctl(nat_cache_ptr->ipa_desc->fd,
+				IPA_IOC_GET_NAT_IN_SRAM_INFO,
+				&nat_sram_info);
+
+	if (ret) {
+		IPAERR("NAT_IN_SRAM_INFO ioctl failure %d on IPA fd %d\n",
+			   ret, nat_cache_ptr->ipa_desc->fd);
+		goto unlock;
+	}
+
+	if ( (*size_ptr = nat_sram_info.sram_mem_available_for_nat) == 0 )
+	{
+		IPAERR("sram_mem_available_for_nat is zero\n");
+		ret = -EINVAL;
+		goto unlock;
+	}
+
+unlock:
+	if (pthread_mutex_unlock(&nat_mutex)) {
+		IPAERR("unable to unlock the nat mutex\n");
+		ret = (ret) ? ret : -EPERM;
+	}
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ * Utility functions
+ * ----------------------------------------------------------------------------
+ */
+static int print_nat_rule(
+	ipa_table*      table_ptr,
+	uint32_t        rule_hdl,
+	void*           record_ptr,
+	uint16_t        record_index,
+	void*           meta_record_ptr,
+	uint16_t        meta_record_index,
+	void*           arb_data_ptr )
+{
+	enum ipa3_nat_mem_in nmi;
+	uint8_t              is_expn_tbl;
+	uint16_t             rule_index;
+
+	char buf[1024];
+
+	struct ipa_nat_rule* rule_ptr =
+		(struct ipa_nat_rule*) record_ptr;
+
+	if ( rule_ptr->protocol == IPA_NAT_INVALID_PROTO_FIELD_VALUE_IN_RULE )
+	{
+		goto bail;
+	}
+
+	BREAK_RULE_HDL(table_ptr, rule_hdl, nmi, is_expn_tbl, rule_index);
+
+	printf("  %s %s (0x%04X) (0x%08X) -> %s\n",
+		   (nmi == IPA_NAT_MEM_IN_DDR) ? "DDR" : "SRAM",
+		   (is_expn_tbl) ? "EXP " : "BASE",
+		   record_index,
+		   rule_hdl,
+		   prep_nat_rule_4print(rule_ptr, buf, sizeof(buf)));
+
+	fflush(stdout);
+
+	*((bool*) arb_data_ptr) = false;
+
+bail:
+	return 0;
+}
 
 static int print_meta_data(
 	ipa_table*      table_ptr,
@@ -2152,7 +3014,7 @@ static int print_meta_data(
 	{
 		printf("  %s %s Entry_Index=0x%04X Table_Entry=0x%04X -> "
 			   "Prev_Index=0x%04X Next_Index=0x%04X\n",
-			   (table_ptr->nmi == IPA_NAT_MEM_IN_DDR) ? "DDR" : "SRAM",
+			   (nmi == IPA_NAT_MEM_IN_DDR) ? "DDR" : "SRAM",
 			   (is_expn_tbl) ? "EXP " : "BASE",
 			   record_index,
 			   index_entry->tbl_entry,
@@ -2163,7 +3025,7 @@ static int print_meta_data(
 	{
 		printf("  %s %s Entry_Index=0x%04X Table_Entry=0x%04X -> "
 			   "Prev_Index=0xXXXX Next_Index=0x%04X\n",
-			   (table_ptr->nmi == IPA_NAT_MEM_IN_DDR) ? "DDR" : "SRAM",
+			   (nmi == IPA_NAT_MEM_IN_DDR) ? "DDR" : "SRAM",
 			   (is_expn_tbl) ? "EXP " : "BASE",
 			   record_index,
 			   index_entry->tbl_entry,
@@ -2260,6 +3122,10 @@ int ipa_NATI_clear_ipv4_tbl(
 	nat_table->index_table.cur_tbl_cnt =
 		nat_table->index_table.cur_expn_tbl_cnt = 0;
 
+	if (nat_table->age_recs)
+		memset(nat_table->age_recs, 0,
+			   nat_table->table.tot_tbl_ents * sizeof(struct ipa_nati_age_rec));
+
 unlock:
 	if (pthread_mutex_unlock(&nat_mutex)) {
 		IPAERR("unable to unlock the nat mutex\n");
@@ -2307,7 +3173,7 @@ int ipa_nati_copy_ipv4_tbl(
 		 * user's copy callback...
 		 */
 		ret = ipa_NATI_walk_ipv4_tbl(
-			src_tbl_hdl, USE_NAT_TABLE, copy_cb, dst_tbl_hdl);
+			src_tbl_hdl, USE_NAT_TABLE, copy_cb, (void*)(uintptr_t) dst_tbl_hdl);
 
 		if ( ret != 0 )
 		{
@@ -2334,6 +3200,17 @@ int ipa_NATI_walk_ipv4_tbl(
 	WhichTbl2Use      which,
 	ipa_table_walk_cb walk_cb,
 	void*             arb_data_ptr )
+{
+	return ipa_NATI_walk_ipv4_tbl_from(
+		tbl_hdl, which, 0, walk_cb, arb_data_ptr);
+}
+
+int ipa_NATI_walk_ipv4_tbl_from(
+	uint32_t          tbl_hdl,
+	WhichTbl2Use      which,
+	uint32_t          start_index,
+	ipa_table_walk_cb walk_cb,
+	void*             arb_data_ptr )
 {
 	enum ipa3_nat_mem_in            nmi;
 	uint32_t                        broken_tbl_hdl;
@@ -2355,329 +3232,652 @@ int ipa_NATI_walk_ipv4_tbl(
 		goto bail;
 	}
 
-	if ( pthread_mutex_lock(&nat_mutex) )
+	/*
+	 * Now walk the table and pass the valid records to the user's
+	 * walk callback...
+	 */
+	BREAK_TBL_HDL(tbl_hdl, nmi, broken_tbl_hdl);
+
+	if ( ! IPA_VALID_NAT_MEM_IN(nmi) )
 	{
-		IPAERR("unable to lock the nat mutex\n");
+		IPAERR("Bad cache type argument passed\n");
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	nat_cache_ptr = &ipv4_nat_cache[nmi];
+
+	if ( ! nat_cache_ptr->table_cnt )
+	{
+		IPAERR("No initialized table in NAT cache\n");
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	nat_table = &nat_cache_ptr->ip4_tbl[broken_tbl_hdl - 1];
+
+	ipa_tbl_ptr =
+		(which == USE_NAT_TABLE) ?
+		&nat_table->table     :
+		&nat_table->index_table;
+
+	/*
+	 * Nothing left to walk...
+	 */
+	if ( start_index >=
+		 ipa_tbl_ptr->table_entries + ipa_tbl_ptr->expn_table_entries )
+	{
+		goto bail;
+	}
+
+	ret = ipa_table_walk(
+		ipa_tbl_ptr, start_index, WHEN_SLOT_FILLED, walk_cb, arb_data_ptr);
+
+	if ( ret < 0 )
+	{
+		IPAERR("ipa_table_walk returned non-zero (%d)\n", ret);
+		goto bail;
+	}
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/*
+ * The following used to pass state to walk_slice_cb() below.
+ */
+typedef struct
+{
+	ipa_nati_walk_cursor* cursor_ptr;
+	uint32_t              max_ents;
+	uint32_t              cnt;
+	bool                  full;
+	ipa_table_walk_cb     walk_cb;
+	void*                 arb_data_ptr;
+} walk_slice_help;
+
+static int walk_slice_cb(
+	ipa_table*      table_ptr,
+	uint32_t        rule_hdl,
+	void*           record_ptr,
+	uint16_t        record_index,
+	void*           meta_record_ptr,
+	uint16_t        meta_record_index,
+	void*           arb_data_ptr )
+{
+	walk_slice_help* wsh_ptr = (walk_slice_help*) arb_data_ptr;
+
+	int ret;
+
+	if ( wsh_ptr->cnt == wsh_ptr->max_ents )
+	{
+		wsh_ptr->cursor_ptr->next_index = record_index;
+		wsh_ptr->full = true;
+		return 1;
+	}
+
+	ret = wsh_ptr->walk_cb(
+		table_ptr,
+		rule_hdl,
+		record_ptr,
+		record_index,
+		meta_record_ptr,
+		meta_record_index,
+		wsh_ptr->arb_data_ptr);
+
+	wsh_ptr->cnt++;
+	wsh_ptr->cursor_ptr->next_index = record_index + 1;
+
+	return ret;
+}
+
+int ipa_NATI_walk_ipv4_tbl_slice(
+	uint32_t              tbl_hdl,
+	WhichTbl2Use          which,
+	ipa_nati_walk_cursor* cursor_ptr,
+	uint32_t              max_ents,
+	ipa_table_walk_cb     walk_cb,
+	void*                 arb_data_ptr )
+{
+	walk_slice_help wsh;
+
+	int ret = 0;
+
+	IPADBG("In\n");
+
+	if ( ! cursor_ptr || ! max_ents )
+	{
+		IPAERR("Bad arg: cursor_ptr(%p) and/or max_ents(%u)\n",
+			   cursor_ptr, max_ents);
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	/*
+	 * A different table than last time (eg. a hybrid switch between
+	 * slices), means slot numbers no longer line up, so start over...
+	 */
+	if ( cursor_ptr->tbl_hdl != tbl_hdl || cursor_ptr->which != which )
+	{
+		if ( cursor_ptr->next_index )
+		{
+			cursor_ptr->restarts++;
+		}
+
+		cursor_ptr->tbl_hdl    = tbl_hdl;
+		cursor_ptr->which      = which;
+		cursor_ptr->next_index = 0;
+		cursor_ptr->done       = false;
+	}
+
+	if ( cursor_ptr->done )
+	{
+		goto bail;
+	}
+
+	memset(&wsh, 0, sizeof(wsh));
+
+	wsh.cursor_ptr   = cursor_ptr;
+	wsh.max_ents     = max_ents;
+	wsh.walk_cb      = walk_cb;
+	wsh.arb_data_ptr = arb_data_ptr;
+
+	ret = ipa_NATI_walk_ipv4_tbl_from(
+		tbl_hdl, which, cursor_ptr->next_index, walk_slice_cb, &wsh);
+
+	if ( ret < 0 )
+	{
+		goto bail;
+	}
+
+	if ( wsh.full )
+	{
+		ret = 0;
+	}
+	else if ( ret == 0 )
+	{
+		cursor_ptr->done = true;
+	}
+
+	cursor_ptr->slices++;
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/*
+ * Chain stats are kept up to date by the table as rules are added and
+ * deleted, so there's no need to walk the table for them...
+ */
+static void ipa_nati_chain_stats(
+	ipa_table*          ipa_tbl_ptr,
+	ipa_nati_tbl_stats* stats_ptr )
+{
+	ipa_table_chain_stats cs;
+
+	ipa_table_get_chain_stats(ipa_tbl_ptr, &cs);
+
+	stats_ptr->tot_chains    = cs.tot_chains;
+	stats_ptr->min_chain_len = cs.min_chain_len;
+	stats_ptr->max_chain_len = cs.max_chain_len;
+	stats_ptr->avg_chain_len = cs.avg_chain_len;
+
+	memcpy(stats_ptr->chain_hist, cs.chain_hist, sizeof(cs.chain_hist));
+}
+
+static void ipa_nati_tbl_stats_fill(
+	ipa_table*           ipa_tbl_ptr,
+	enum ipa3_nat_mem_in nmi,
+	ipa_nati_tbl_stats*  stats_ptr )
+{
+	stats_ptr->nmi                  = nmi;
+
+	stats_ptr->tot_base_ents        = ipa_tbl_ptr->table_entries;
+	stats_ptr->tot_expn_ents        = ipa_tbl_ptr->expn_table_entries;
+	stats_ptr->tot_ents             =
+		stats_ptr->tot_base_ents + stats_ptr->tot_expn_ents;
+
+	stats_ptr->tot_base_ents_filled = ipa_tbl_ptr->cur_tbl_cnt;
+	stats_ptr->tot_expn_ents_filled = ipa_tbl_ptr->cur_expn_tbl_cnt;
+
+	ipa_nati_chain_stats(ipa_tbl_ptr, stats_ptr);
+}
+
+int ipa_NATI_ipv4_tbl_stats(
+	uint32_t            tbl_hdl,
+	ipa_nati_tbl_stats* nat_stats_ptr,
+	ipa_nati_tbl_stats* idx_stats_ptr )
+{
+	enum ipa3_nat_mem_in            nmi;
+	uint32_t                        broken_tbl_hdl;
+	struct ipa_nat_cache*           nat_cache_ptr;
+	struct ipa_nat_ip4_table_cache* nat_table;
+
+	int ret = 0;
+
+	IPADBG("In\n");
+
+	if ( ! VALID_TBL_HDL(tbl_hdl) ||
+		 ! nat_stats_ptr ||
+		 ! idx_stats_ptr )
+	{
+		IPAERR("Bad arg: "
+			   "tbl_hdl(0x%08X) and/or "
+			   "nat_stats_ptr(%p) and/or "
+			   "idx_stats_ptr(%p)\n",
+			   tbl_hdl,
+			   nat_stats_ptr,
+			   idx_stats_ptr );
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	memset(nat_stats_ptr, 0, sizeof(ipa_nati_tbl_stats));
+	memset(idx_stats_ptr, 0, sizeof(ipa_nati_tbl_stats));
+
+	BREAK_TBL_HDL(tbl_hdl, nmi, broken_tbl_hdl);
+
+	if ( ! IPA_VALID_NAT_MEM_IN(nmi) )
+	{
+		IPAERR("Bad cache type argument passed\n");
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	nat_cache_ptr = &ipv4_nat_cache[nmi];
+
+	if ( ! nat_cache_ptr->table_cnt )
+	{
+		IPAERR("No initialized table in NAT cache\n");
 		ret = -EINVAL;
 		goto bail;
 	}
 
-	/*
-	 * Now walk the table and pass the valid records to the user's
-	 * walk callback...
-	 */
-	BREAK_TBL_HDL(tbl_hdl, nmi, broken_tbl_hdl);
+	nat_table = &nat_cache_ptr->ip4_tbl[broken_tbl_hdl - 1];
+
+	ipa_nati_tbl_stats_fill(&nat_table->table, nmi, nat_stats_ptr);
+	ipa_nati_tbl_stats_fill(&nat_table->index_table, nmi, idx_stats_ptr);
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+int ipa_nati_vote_clock(
+    enum ipa_app_clock_vote_type vote_type )
+{
+	struct ipa_nat_cache* nat_cache_ptr =
+		&ipv4_nat_cache[IPA_NAT_MEM_IN_SRAM];
+
+	int ret = 0;
+
+	IPADBG("In\n");
+
+	if ( ! nat_cache_ptr->ipa_desc ) {
+		nat_cache_ptr->ipa_desc = ipa_descriptor_open();
+		if ( nat_cache_ptr->ipa_desc == NULL ) {
+			IPAERR("failed to open IPA driver file descriptor\n");
+			ret = -EIO;
+			goto bail;
+		}
+	}
+
+	ret = ipa_dev_ioctl(nat_cache_ptr->ipa_desc->fd,
+				IPA_IOC_APP_CLOCK_VOTE,
+				vote_type);
+
+	if (ret) {
+		IPAERR("APP_CLOCK_VOTE ioctl failure %d on IPA fd %d\n",
+			   ret, nat_cache_ptr->ipa_desc->fd);
+		goto bail;
+	}
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/*
+ * ----------------------------------------------------------------------------
+ * Offline tables
+ *
+ * An offline table is an IPv4 NAT table built in malloc'd memory,
+ * rather than memory shared with the IPA. It uses the same hashes,
+ * the same ipa_table insert/delete code and the same DMA commands as
+ * a real table, but the commands are applied by the CPU and nothing
+ * is ever posted to the driver. It's meant for tools (eg. the replay
+ * tool in the test directory) that study how a traffic mix lands in
+ * the tables, on a host without an IPA.
+ *
+ * Offline tables are not part of ipv4_nat_cache, aren't known to the
+ * state machine and have no locking of their own.
+ * ----------------------------------------------------------------------------
+ */
+struct ipa_nati_offline_tbl {
+	struct ipa_nat_cache cache;
+	ipa_descriptor       desc;
+	uint32_t             public_ip_addr;
+	uint8_t*             mem;
+};
+
+ipa_nati_offline_tbl* ipa_nati_offline_tbl_create(
+	enum ipa3_nat_mem_in nmi,
+	enum ipa_hw_type     hw_ver,
+	uint32_t             public_ip_addr,
+	uint16_t             number_of_entries )
+{
+	ipa_nati_offline_tbl*           tbl;
+	struct ipa_nat_ip4_table_cache* nat_table;
+
+	void* base_addr;
+	int   ret, size;
+
+	IPADBG("In\n");
 
-	if ( ! IPA_VALID_NAT_MEM_IN(nmi) )
+	if ( ! IPA_VALID_NAT_MEM_IN(nmi) || number_of_entries == 0 )
 	{
-		IPAERR("Bad cache type argument passed\n");
-		ret = -EINVAL;
-		goto unlock;
+		IPAERR("Bad arg: nmi(%u) and/or number_of_entries(%u)\n",
+			   nmi, number_of_entries);
+		tbl = NULL;
+		goto done;
 	}
 
-	nat_cache_ptr = &ipv4_nat_cache[nmi];
+	tbl = calloc(1, sizeof(*tbl));
 
-	if ( ! nat_cache_ptr->table_cnt )
+	if ( tbl == NULL )
 	{
-		IPAERR("No initialized table in NAT cache\n");
-		ret = -EINVAL;
-		goto unlock;
+		IPAERR("Unable to allocate offline table\n");
+		goto done;
 	}
 
-	nat_table = &nat_cache_ptr->ip4_tbl[broken_tbl_hdl - 1];
+	tbl->desc.fd  = -1;
+	tbl->desc.ver = hw_ver;
 
-	ipa_tbl_ptr =
-		(which == USE_NAT_TABLE) ?
-		&nat_table->table     :
-		&nat_table->index_table;
+	tbl->public_ip_addr = public_ip_addr;
+
+	tbl->cache.ipa_desc = &tbl->desc;
+	tbl->cache.nmi      = nmi;
+
+	nat_table = &tbl->cache.ip4_tbl[0];
+
+	nat_table->public_addr = public_ip_addr;
+
+	ipa_table_init(
+		&nat_table->table,
+		IPA_NAT_TABLE_NAME,
+		nmi,
+		sizeof(struct ipa_nat_rule),
+		NULL,
+		0,
+		&entry_interface);
 
-	ret = ipa_table_walk(ipa_tbl_ptr, 0, WHEN_SLOT_FILLED, walk_cb, arb_data_ptr);
+	ret = ipa_table_calculate_entries_num(
+		&nat_table->table,
+		number_of_entries,
+		nmi);
 
-	if ( ret != 0 )
+	if ( ret )
 	{
-		IPAERR("ipa_table_walk returned non-zero (%d)\n", ret);
-		goto unlock;
+		IPAERR("Unable to calculate number of entries for %u\n",
+			   number_of_entries);
+		goto bail_tbl;
 	}
 
-unlock:
-	if ( pthread_mutex_unlock(&nat_mutex) )
+	nat_table->index_expn_table_meta = (struct ipa_nat_indx_tbl_meta_info*)
+		calloc(nat_table->table.expn_table_entries,
+			   sizeof(struct ipa_nat_indx_tbl_meta_info));
+
+	if ( nat_table->index_expn_table_meta == NULL )
 	{
-		IPAERR("unable to unlock the nat mutex\n");
-		ret = (ret) ? ret : -EPERM;
+		IPAERR("Unable to allocate index expansion table meta\n");
+		goto bail_tbl;
 	}
 
-bail:
-	IPADBG("Out\n");
-
-	return ret;
-}
+	ipa_table_init(
+		&nat_table->index_table,
+		IPA_NAT_INDEX_TABLE_NAME,
+		nmi,
+		sizeof(struct ipa_nat_indx_tbl_rule),
+		nat_table->index_expn_table_meta,
+		sizeof(struct ipa_nat_indx_tbl_meta_info),
+		&index_entry_interface);
 
-typedef struct
-{
-	WhichTbl2Use        which;
-	uint32_t            tot_for_avg;
-	ipa_nati_tbl_stats* stats_ptr;
-} chain_stat_help;
+	nat_table->index_table.table_entries =
+		nat_table->table.table_entries;
 
-static int gen_chain_stats(
-	ipa_table*      table_ptr,
-	uint32_t        rule_hdl,
-	void*           record_ptr,
-	uint16_t        record_index,
-	void*           meta_record_ptr,
-	uint16_t        meta_record_index,
-	void*           arb_data_ptr )
-{
-	chain_stat_help* csh_ptr = (chain_stat_help*) arb_data_ptr;
+	nat_table->index_table.expn_table_entries =
+		nat_table->table.expn_table_entries;
 
-	enum ipa3_nat_mem_in nmi;
-	uint8_t              is_expn_tbl;
-	uint16_t             rule_index;
+	nat_table->index_table.tot_tbl_ents =
+		nat_table->table.tot_tbl_ents;
 
-	uint32_t             chain_len = 0;
+	size  = ipa_table_calculate_size(&nat_table->table);
+	size += ipa_table_calculate_size(&nat_table->index_table);
 
-	BREAK_RULE_HDL(table_ptr, rule_hdl, nmi, is_expn_tbl, rule_index);
+	tbl->mem = calloc(1, size);
 
-	if ( is_expn_tbl )
+	if ( tbl->mem == NULL )
 	{
-		return 1;
+		IPAERR("Unable to allocate %d bytes of table memory\n", size);
+		goto bail_meta;
 	}
 
-	if ( csh_ptr->which == USE_NAT_TABLE )
-	{
-		struct ipa_nat_rule* list_elem_ptr =
-			(struct ipa_nat_rule*) record_ptr;
+	base_addr =
+		ipa_table_calculate_addresses(&nat_table->table, tbl->mem);
+	ipa_table_calculate_addresses(&nat_table->index_table, base_addr);
 
-		if ( list_elem_ptr->next_index )
-		{
-			chain_len = 1;
+	ipa_table_reset(&nat_table->table);
+	ipa_table_reset(&nat_table->index_table);
 
-			while ( list_elem_ptr->next_index )
-			{
-				chain_len++;
+	ipa_nati_create_table_dma_cmd_helpers(nat_table, 0);
 
-				list_elem_ptr = GOTO_REC(table_ptr, list_elem_ptr->next_index);
-			}
-		}
-	}
-	else
-	{
-		struct ipa_nat_indx_tbl_rule* list_elem_ptr =
-			(struct ipa_nat_indx_tbl_rule*) record_ptr;
+	tbl->cache.table_cnt = 1;
 
-		if ( list_elem_ptr->next_index )
-		{
-			chain_len = 1;
+	goto done;
 
-			while ( list_elem_ptr->next_index )
-			{
-				chain_len++;
+bail_meta:
+	free(nat_table->index_expn_table_meta);
 
-				list_elem_ptr = GOTO_REC(table_ptr, list_elem_ptr->next_index);
-			}
-		}
-	}
+bail_tbl:
+	free(tbl);
+	tbl = NULL;
 
-	if ( chain_len )
-	{
-		csh_ptr->stats_ptr->tot_chains += 1;
+done:
+	IPADBG("Out\n");
 
-		csh_ptr->tot_for_avg += chain_len;
+	return tbl;
+}
 
-		if ( csh_ptr->stats_ptr->min_chain_len == 0 )
-		{
-			csh_ptr->stats_ptr->min_chain_len = chain_len;
-		}
-		else
-		{
-			csh_ptr->stats_ptr->min_chain_len =
-				min(csh_ptr->stats_ptr->min_chain_len, chain_len);
-		}
+void ipa_nati_offline_tbl_destroy(
+	ipa_nati_offline_tbl* tbl )
+{
+	IPADBG("In\n");
 
-		csh_ptr->stats_ptr->max_chain_len =
-			max(csh_ptr->stats_ptr->max_chain_len, chain_len);
+	if ( tbl )
+	{
+		free(tbl->cache.ip4_tbl[0].index_expn_table_meta);
+		free(tbl->mem);
+		free(tbl);
 	}
 
-	return 0;
+	IPADBG("Out\n");
 }
 
-int ipa_NATI_ipv4_tbl_stats(
-	uint32_t            tbl_hdl,
-	ipa_nati_tbl_stats* nat_stats_ptr,
-	ipa_nati_tbl_stats* idx_stats_ptr )
+/*
+ * The rule's pdn_index is not looked at: all rules hash against the
+ * public address the table was created with.
+ */
+int ipa_nati_offline_add_rule(
+	ipa_nati_offline_tbl*    tbl,
+	const ipa_nat_ipv4_rule* clnt_rule,
+	uint32_t*                rule_hdl )
 {
-	enum ipa3_nat_mem_in            nmi;
-	uint32_t                        broken_tbl_hdl;
-	struct ipa_nat_cache*           nat_cache_ptr;
+	uint32_t cmd_sz =
+		sizeof(struct ipa_ioc_nat_dma_cmd) +
+		(MAX_DMA_ENTRIES_FOR_ADD * sizeof(struct ipa_ioc_nat_dma_one));
+	char cmd_buf[cmd_sz];
+	struct ipa_ioc_nat_dma_cmd* cmd =
+		(struct ipa_ioc_nat_dma_cmd*) cmd_buf;
+
 	struct ipa_nat_ip4_table_cache* nat_table;
-	ipa_table*                      ipa_tbl_ptr;
 
-	chain_stat_help                 csh;
+	uint16_t new_entry_index;
+	uint16_t new_index_tbl_entry_index;
 
 	int ret = 0;
 
 	IPADBG("In\n");
 
-	if ( ! VALID_TBL_HDL(tbl_hdl) ||
-		 ! nat_stats_ptr ||
-		 ! idx_stats_ptr )
+	memset(cmd_buf, 0, sizeof(cmd_buf));
+
+	if ( ! tbl || ! clnt_rule || ! rule_hdl )
 	{
-		IPAERR("Bad arg: "
-			   "tbl_hdl(0x%08X) and/or "
-			   "nat_stats_ptr(%p) and/or "
-			   "idx_stats_ptr(%p)\n",
-			   tbl_hdl,
-			   nat_stats_ptr,
-			   idx_stats_ptr );
+		IPAERR("Bad arg: tbl(%p) and/or clnt_rule(%p) and/or rule_hdl(%p)\n",
+			   tbl, clnt_rule, rule_hdl);
 		ret = -EINVAL;
-		goto bail;
+		goto done;
 	}
 
-	if ( pthread_mutex_lock(&nat_mutex) )
+	*rule_hdl = 0;
+
+	if ( clnt_rule->protocol == IPAHAL_NAT_INVALID_PROTOCOL )
 	{
-		IPAERR("unable to lock the nat mutex\n");
+		IPAERR("invalid parameter protocol=%d\n", clnt_rule->protocol);
 		ret = -EINVAL;
-		goto bail;
+		goto done;
 	}
 
-	memset(nat_stats_ptr, 0, sizeof(ipa_nati_tbl_stats));
-	memset(idx_stats_ptr, 0, sizeof(ipa_nati_tbl_stats));
+	nat_table = &tbl->cache.ip4_tbl[0];
 
-	BREAK_TBL_HDL(tbl_hdl, nmi, broken_tbl_hdl);
+	ipa_nati_calc_ipv4_rule_hashes(
+		&tbl->cache,
+		nat_table,
+		tbl->public_ip_addr,
+		clnt_rule,
+		&new_entry_index,
+		&new_index_tbl_entry_index);
 
-	if ( ! IPA_VALID_NAT_MEM_IN(nmi) )
+	ret = ipa_nati_add_ipv4_rule_entries(
+		nat_table,
+		1,
+		clnt_rule,
+		&new_entry_index,
+		&new_index_tbl_entry_index,
+		rule_hdl,
+		cmd);
+
+	if ( ret )
 	{
-		IPAERR("Bad cache type argument passed\n");
-		ret = -EINVAL;
-		goto unlock;
+		goto done;
 	}
 
-	nat_cache_ptr = &ipv4_nat_cache[nmi];
+	ret = ipa_nati_apply_ipv4_dma_cmd(&tbl->cache, cmd);
 
-	if ( ! nat_cache_ptr->table_cnt )
+	if ( ret )
 	{
-		IPAERR("No initialized table in NAT cache\n");
-		ret = -EINVAL;
-		goto unlock;
+		IPAERR("Unable to apply dma command\n");
+		ipa_table_erase_entry(&nat_table->index_table, new_index_tbl_entry_index);
+		ipa_table_erase_entry(&nat_table->table, new_entry_index);
+		*rule_hdl = 0;
 	}
 
-	nat_table = &nat_cache_ptr->ip4_tbl[broken_tbl_hdl - 1];
+done:
+	IPADBG("Out\n");
 
-	/*
-	 * Gather NAT table stats...
-	 */
-	ipa_tbl_ptr = &nat_table->table;
+	return ret;
+}
 
-	nat_stats_ptr->nmi                  = nmi;
+int ipa_nati_offline_del_rule(
+	ipa_nati_offline_tbl* tbl,
+	uint32_t              rule_hdl )
+{
+	uint32_t cmd_sz =
+		sizeof(struct ipa_ioc_nat_dma_cmd) +
+		(MAX_DMA_ENTRIES_FOR_DEL * sizeof(struct ipa_ioc_nat_dma_one));
+	char cmd_buf[cmd_sz];
+	struct ipa_ioc_nat_dma_cmd* cmd =
+		(struct ipa_ioc_nat_dma_cmd*) cmd_buf;
 
-	nat_stats_ptr->tot_base_ents        = ipa_tbl_ptr->table_entries;
-	nat_stats_ptr->tot_expn_ents        = ipa_tbl_ptr->expn_table_entries;
-	nat_stats_ptr->tot_ents             =
-		nat_stats_ptr->tot_base_ents + nat_stats_ptr->tot_expn_ents;
+	struct ipa_nat_ip4_table_cache* nat_table;
 
-	nat_stats_ptr->tot_base_ents_filled = ipa_tbl_ptr->cur_tbl_cnt;
-	nat_stats_ptr->tot_expn_ents_filled = ipa_tbl_ptr->cur_expn_tbl_cnt;
+	ipa_table_iterator table_iterator;
+	ipa_table_iterator index_table_iterator;
 
-	memset(&csh, 0, sizeof(chain_stat_help));
+	int ret = 0;
 
-	csh.which     = USE_NAT_TABLE;
-	csh.stats_ptr = nat_stats_ptr;
+	IPADBG("In\n");
 
-	ret = ipa_table_walk(
-		ipa_tbl_ptr, 0, WHEN_SLOT_FILLED, gen_chain_stats, &csh);
+	memset(cmd_buf, 0, sizeof(cmd_buf));
 
-	if ( ret < 0 )
+	if ( ! tbl )
 	{
-		IPAERR("Error gathering chain stats\n");
+		IPAERR("Bad arg: tbl(%p)\n", tbl);
 		ret = -EINVAL;
-		goto unlock;
-	}
-
-	if ( csh.tot_for_avg && nat_stats_ptr->tot_chains )
-	{
-		nat_stats_ptr->avg_chain_len =
-			(float) csh.tot_for_avg / (float) nat_stats_ptr->tot_chains;
+		goto done;
 	}
 
-	/*
-	 * Now lets gather index table stats...
-	 */
-	ipa_tbl_ptr = &nat_table->index_table;
-
-	idx_stats_ptr->nmi                  = nmi;
-
-	idx_stats_ptr->tot_base_ents        = ipa_tbl_ptr->table_entries;
-	idx_stats_ptr->tot_expn_ents        = ipa_tbl_ptr->expn_table_entries;
-	idx_stats_ptr->tot_ents             =
-		idx_stats_ptr->tot_base_ents + idx_stats_ptr->tot_expn_ents;
+	nat_table = &tbl->cache.ip4_tbl[0];
 
-	idx_stats_ptr->tot_base_ents_filled = ipa_tbl_ptr->cur_tbl_cnt;
-	idx_stats_ptr->tot_expn_ents_filled = ipa_tbl_ptr->cur_expn_tbl_cnt;
-
-	memset(&csh, 0, sizeof(chain_stat_help));
-
-	csh.which     = USE_INDEX_TABLE;
-	csh.stats_ptr = idx_stats_ptr;
-
-	ret = ipa_table_walk(
-		ipa_tbl_ptr, 0, WHEN_SLOT_FILLED, gen_chain_stats, &csh);
-
-	if ( ret < 0 )
-	{
-		IPAERR("Error gathering chain stats\n");
-		ret = -EINVAL;
-		goto unlock;
-	}
+	ret = ipa_nati_prep_ipv4_rule_delete(
+		nat_table,
+		1,
+		rule_hdl,
+		&table_iterator,
+		&index_table_iterator,
+		cmd);
 
-	if ( csh.tot_for_avg && idx_stats_ptr->tot_chains )
+	if ( ret )
 	{
-		idx_stats_ptr->avg_chain_len =
-			(float) csh.tot_for_avg / (float) idx_stats_ptr->tot_chains;
+		goto done;
 	}
 
-	ret = 0;
+	ret = ipa_nati_apply_ipv4_dma_cmd(&tbl->cache, cmd);
 
-unlock:
-	if ( pthread_mutex_unlock(&nat_mutex) )
+	if ( ret )
 	{
-		IPAERR("unable to unlock the nat mutex\n");
-		ret = (ret) ? ret : -EPERM;
+		IPAERR("Unable to apply dma command\n");
+		goto done;
 	}
 
-bail:
+	ipa_nati_finish_ipv4_rule_delete(
+		nat_table, &table_iterator, &index_table_iterator);
+
+done:
 	IPADBG("Out\n");
 
 	return ret;
 }
 
-int ipa_nati_vote_clock(
-    enum ipa_app_clock_vote_type vote_type )
+int ipa_nati_offline_tbl_stats(
+	ipa_nati_offline_tbl* tbl,
+	ipa_nati_tbl_stats*   nat_stats_ptr,
+	ipa_nati_tbl_stats*   idx_stats_ptr )
 {
-	struct ipa_nat_cache* nat_cache_ptr =
-		&ipv4_nat_cache[IPA_NAT_MEM_IN_SRAM];
-
 	int ret = 0;
 
 	IPADBG("In\n");
 
-	if ( ! nat_cache_ptr->ipa_desc ) {
-		nat_cache_ptr->ipa_desc = ipa_descriptor_open();
-		if ( nat_cache_ptr->ipa_desc == NULL ) {
-			IPAERR("failed to open IPA driver file descriptor\n");
-			ret = -EIO;
-			goto bail;
-		}
+	if ( ! tbl || ! nat_stats_ptr || ! idx_stats_ptr )
+	{
+		IPAERR("Bad arg: tbl(%p) and/or nat_stats_ptr(%p) and/or idx_stats_ptr(%p)\n",
+			   tbl, nat_stats_ptr, idx_stats_ptr);
+		ret = -EINVAL;
+		goto bail;
 	}
 
-	ret = ioctl(nat_cache_ptr->ipa_desc->fd,
-				IPA_IOC_APP_CLOCK_VOTE,
-				vote_type);
+	memset(nat_stats_ptr, 0, sizeof(ipa_nati_tbl_stats));
+	memset(idx_stats_ptr, 0, sizeof(ipa_nati_tbl_stats));
 
-	if (ret) {
-		IPAERR("APP_CLOCK_VOTE ioctl failure %d on IPA fd %d\n",
-			   ret, nat_cache_ptr->ipa_desc->fd);
-		goto bail;
-	}
+	ipa_nati_tbl_stats_fill(
+		&tbl->cache.ip4_tbl[0].table, tbl->cache.nmi, nat_stats_ptr);
+	ipa_nati_tbl_stats_fill(
+		&tbl->cache.ip4_tbl[0].index_table, tbl->cache.nmi, idx_stats_ptr);
 
 bail:
 	IPADBG("Out\n");
@@ -26,14 +26,232 @@
  * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
  * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-#include <map>
-#include <iterator>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
 
 #include "ipa_nat_utils.h"
 
 #include "ipa_nat_map.h"
 
-static std::map<uint32_t, uint32_t> map_array[MAP_NUM_MAX];
+/*
+ * Each map is an open addressing (linear probing) hash table held in
+ * one flat array of slots, so a lookup touches a cache line or two
+ * rather than chasing tree nodes, and an add doesn't allocate unless
+ * the map has to grow. Deletes shift the rest of the probe run back,
+ * so there are no tombstones to slow down later lookups.
+ */
+#undef  MAP_MIN_CAPACITY
+#define MAP_MIN_CAPACITY 64
+
+/* Grow once more than 3/4 full */
+#undef  MAP_OVER_LOAD
+#define MAP_OVER_LOAD(cnt, cap) \
+	( (uint64_t) (cnt) * 4 > (uint64_t) (cap) * 3 )
+
+typedef struct
+{
+	uint32_t key;
+	uint32_t val;
+	bool     used;
+} ipa_nat_map_slot;
+
+typedef struct
+{
+	ipa_nat_map_slot* slots;
+	uint32_t          capacity; /* zero or a power of two */
+	uint32_t          cnt;
+} ipa_nat_flat_map;
+
+static ipa_nat_flat_map map_array[MAP_NUM_MAX];
+
+/*
+ * Timestamp queries look up handles without holding the nat mutex, so
+ * the maps carry their own lock...
+ */
+static pthread_rwlock_t map_lock = PTHREAD_RWLOCK_INITIALIZER;
+
+/******************************************************************************/
+
+static inline uint32_t map_home(
+	const ipa_nat_flat_map* map,
+	uint32_t                key )
+{
+	/*
+	 * Rule handles are small and sequential, so spread them with a
+	 * multiplicative (Fibonacci) hash before masking...
+	 */
+	return (key * 2654435769U) & (map->capacity - 1);
+}
+
+static ipa_nat_map_slot* map_lookup(
+	const ipa_nat_flat_map* map,
+	uint32_t                key )
+{
+	uint32_t i;
+
+	if ( map->cnt == 0 )
+	{
+		return NULL;
+	}
+
+	for ( i = map_home(map, key);
+		  map->slots[i].used;
+		  i = (i + 1) & (map->capacity - 1) )
+	{
+		if ( map->slots[i].key == key )
+		{
+			return &map->slots[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void map_place(
+	ipa_nat_flat_map* map,
+	uint32_t          key,
+	uint32_t          val )
+{
+	uint32_t i = map_home(map, key);
+
+	while ( map->slots[i].used )
+	{
+		i = (i + 1) & (map->capacity - 1);
+	}
+
+	map->slots[i].key  = key;
+	map->slots[i].val  = val;
+	map->slots[i].used = true;
+
+	map->cnt++;
+}
+
+static int map_resize(
+	ipa_nat_flat_map* map,
+	uint32_t          capacity )
+{
+	ipa_nat_map_slot* old_slots    = map->slots;
+	uint32_t          old_capacity = map->capacity;
+	uint32_t          i;
+
+	ipa_nat_map_slot* slots =
+		(ipa_nat_map_slot*) calloc(capacity, sizeof(ipa_nat_map_slot));
+
+	if ( ! slots )
+	{
+		IPAERR("Unable to allocate %u map slots\n", capacity);
+		return -1;
+	}
+
+	map->slots    = slots;
+	map->capacity = capacity;
+	map->cnt      = 0;
+
+	for ( i = 0; i < old_capacity; i++ )
+	{
+		if ( old_slots[i].used )
+		{
+			map_place(map, old_slots[i].key, old_slots[i].val);
+		}
+	}
+
+	free(old_slots);
+
+	return 0;
+}
+
+static uint32_t map_capacity_for(
+	uint32_t num_entries )
+{
+	uint32_t capacity = MAP_MIN_CAPACITY;
+
+	while ( MAP_OVER_LOAD(num_entries, capacity) && capacity < (1U << 31) )
+	{
+		capacity <<= 1;
+	}
+
+	return capacity;
+}
+
+static void map_remove_slot(
+	ipa_nat_flat_map* map,
+	ipa_nat_map_slot* slot )
+{
+	uint32_t mask = map->capacity - 1;
+	uint32_t hole = slot - map->slots;
+	uint32_t i    = hole;
+	uint32_t home;
+
+	/*
+	 * Shift back any entry further along the probe run that can
+	 * legally live in the hole, so lookups never stop short...
+	 */
+	for ( ;; )
+	{
+		i = (i + 1) & mask;
+
+		if ( ! map->slots[i].used )
+		{
+			break;
+		}
+
+		home = map_home(map, map->slots[i].key);
+
+		if ( ((i - home) & mask) >= ((i - hole) & mask) )
+		{
+			map->slots[hole] = map->slots[i];
+			hole = i;
+		}
+	}
+
+	map->slots[hole].used = false;
+
+	map->cnt--;
+}
+
+/******************************************************************************/
+
+int ipa_nat_map_reserve(
+	ipa_which_map which,
+	uint32_t      num_entries )
+{
+	ipa_nat_flat_map* map;
+	uint32_t          capacity;
+
+	int ret_val = 0;
+
+	IPADBG("In\n");
+
+	if ( ! VALID_IPA_USE_MAP(which) )
+	{
+		IPAERR("Bad arg which(%u)\n", which);
+		ret_val = -1;
+		goto bail;
+	}
+
+	IPADBG("[%s] num_entries(%u)\n",
+		   ipa_which_map_as_str(which), num_entries);
+
+	map      = &map_array[which];
+	capacity = map_capacity_for(num_entries);
+
+	pthread_rwlock_wrlock(&map_lock);
+
+	if ( capacity > map->capacity )
+	{
+		ret_val = map_resize(map, capacity);
+	}
+
+	pthread_rwlock_unlock(&map_lock);
+
+bail:
+	IPADBG("Out\n");
+
+	return ret_val;
+}
 
 /******************************************************************************/
 
@@ -42,9 +260,9 @@ int ipa_nat_map_add(
 	uint32_t      key,
 	uint32_t      val )
 {
-	int ret_val = 0;
+	ipa_nat_flat_map* map;
 
-	std::pair<std::map<uint32_t, uint32_t>::iterator, bool> ret;
+	int ret_val = 0;
 
 	IPADBG("In\n");
 
@@ -58,15 +276,30 @@ int ipa_nat_map_add(
 	IPADBG("[%s] key(%u) -> val(%u)\n",
 		   ipa_which_map_as_str(which), key, val);
 
-	ret = map_array[which].insert(std::pair<uint32_t, uint32_t>(key, val));
+	map = &map_array[which];
 
-	if ( ret.second == false )
+	pthread_rwlock_wrlock(&map_lock);
+
+	if ( map_lookup(map, key) )
 	{
 		IPAERR("[%s] key(%u) already exists in map\n",
 			   ipa_which_map_as_str(which),
 			   key);
 		ret_val = -1;
 	}
+	else if ( map->capacity == 0 || MAP_OVER_LOAD(map->cnt + 1, map->capacity) )
+	{
+		ret_val = map_resize(
+			map,
+			(map->capacity) ? map->capacity << 1 : MAP_MIN_CAPACITY);
+	}
+
+	if ( ret_val == 0 )
+	{
+		map_place(map, key, val);
+	}
+
+	pthread_rwlock_unlock(&map_lock);
 
 bail:
 	IPADBG("Out\n");
@@ -76,14 +309,15 @@ bail:
 
 /******************************************************************************/
 
-int ipa_nat_map_find(
+static int map_find(
 	ipa_which_map which,
 	uint32_t      key,
-	uint32_t*     val_ptr )
+	uint32_t*     val_ptr,
+	bool          quiet )
 {
-	int ret_val = 0;
+	ipa_nat_map_slot* slot;
 
-	std::map<uint32_t, uint32_t>::iterator it;
+	int ret_val = 0;
 
 	IPADBG("In\n");
 
@@ -97,32 +331,61 @@ int ipa_nat_map_find(
 	IPADBG("[%s] key(%u)\n",
 		   ipa_which_map_as_str(which), key);
 
-	it = map_array[which].find(key);
+	pthread_rwlock_rdlock(&map_lock);
+
+	slot = map_lookup(&map_array[which], key);
 
-	if ( it == map_array[which].end() )
+	if ( ! slot )
 	{
-		IPAERR("[%s] key(%u) not found in map\n",
-			   ipa_which_map_as_str(which),
-			   key);
+		if ( quiet )
+		{
+			IPADBG("[%s] key(%u) not found in map\n",
+				   ipa_which_map_as_str(which),
+				   key);
+		}
+		else
+		{
+			IPAERR("[%s] key(%u) not found in map\n",
+				   ipa_which_map_as_str(which),
+				   key);
+		}
 		ret_val = -1;
 	}
 	else
 	{
 		if ( val_ptr )
 		{
-			*val_ptr = it->second;
+			*val_ptr = slot->val;
 			IPADBG("[%s] key(%u) -> val(%u)\n",
 				   ipa_which_map_as_str(which),
 				   key, *val_ptr);
 		}
 	}
 
+	pthread_rwlock_unlock(&map_lock);
+
 bail:
 	IPADBG("Out\n");
 
 	return ret_val;
 }
 
+int ipa_nat_map_find(
+	ipa_which_map which,
+	uint32_t      key,
+	uint32_t*     val_ptr )
+{
+	return map_find(which, key, val_ptr, false);
+}
+
+int ipa_nat_map_probe(
+	ipa_which_map which,
+	uint32_t      key,
+	uint32_t*     val_ptr )
+{
+	return map_find(which, key, val_ptr, true);
+}
+
 /******************************************************************************/
 
 int ipa_nat_map_del(
@@ -130,9 +393,9 @@ int ipa_nat_map_del(
 	uint32_t      key,
 	uint32_t*     val_ptr )
 {
-	int ret_val = 0;
+	ipa_nat_map_slot* slot;
 
-	std::map<uint32_t, uint32_t>::iterator it;
+	int ret_val = 0;
 
 	IPADBG("In\n");
 
@@ -146,9 +409,11 @@ int ipa_nat_map_del(
 	IPADBG("[%s] key(%u)\n",
 		   ipa_which_map_as_str(which), key);
 
-	it = map_array[which].find(key);
+	pthread_rwlock_wrlock(&map_lock);
+
+	slot = map_lookup(&map_array[which], key);
 
-	if ( it == map_array[which].end() )
+	if ( ! slot )
 	{
 		IPAERR("[%s] key(%u) not found in map\n",
 			   ipa_which_map_as_str(which),
@@ -159,23 +424,30 @@ int ipa_nat_map_del(
 	{
 		if ( val_ptr )
 		{
-			*val_ptr = it->second;
+			*val_ptr = slot->val;
 			IPADBG("[%s] key(%u) -> val(%u)\n",
 				   ipa_which_map_as_str(which),
 				   key, *val_ptr);
 		}
-		map_array[which].erase(it);
+		map_remove_slot(&map_array[which], slot);
 	}
 
+	pthread_rwlock_unlock(&map_lock);
+
 bail:
 	IPADBG("Out\n");
 
 	return ret_val;
 }
 
+/*
+ * Empties the map, but keeps its capacity for reuse...
+ */
 int ipa_nat_map_clear(
 	ipa_which_map which )
 {
+	ipa_nat_flat_map* map;
+
 	int ret_val = 0;
 
 	IPADBG("In\n");
@@ -187,7 +459,18 @@ int ipa_nat_map_clear(
 		goto bail;
 	}
 
-	map_array[which].clear();
+	map = &map_array[which];
+
+	pthread_rwlock_wrlock(&map_lock);
+
+	if ( map->slots )
+	{
+		memset(map->slots, 0, map->capacity * sizeof(ipa_nat_map_slot));
+	}
+
+	map->cnt = 0;
+
+	pthread_rwlock_unlock(&map_lock);
 
 bail:
 	IPADBG("Out\n");
@@ -198,7 +481,8 @@ bail:
 int ipa_nat_map_dump(
 	ipa_which_map which )
 {
-	std::map<uint32_t, uint32_t>::iterator it;
+	ipa_nat_flat_map* map;
+	uint32_t          i;
 
 	int ret_val = 0;
 
@@ -213,17 +497,26 @@ int ipa_nat_map_dump(
 
 	printf("Dumping: %s\n", ipa_which_map_as_str(which));
 
-	for ( it  = map_array[which].begin();
-		  it != map_array[which].end();
-		  it++ )
+	map = &map_array[which];
+
+	pthread_rwlock_rdlock(&map_lock);
+
+	for ( i = 0; i < map->capacity; i++ )
 	{
+		if ( ! map->slots[i].used )
+		{
+			continue;
+		}
+
 		printf("  Key[%u|0x%08X] -> Value[%u|0x%08X]\n",
-			   it->first,
-			   it->first,
-			   it->second,
-			   it->second);
+			   map->slots[i].key,
+			   map->slots[i].key,
+			   map->slots[i].val,
+			   map->slots[i].val);
 	}
 
+	pthread_rwlock_unlock(&map_lock);
+
 bail:
 	IPADBG("Out\n");
 
@@ -0,0 +1,625 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+#include "ipa_nat_sim.h"
+#include "ipa_nat_drv.h"
+#include "ipa_nat_drvi.h"
+#include "ipa_ipv6ct.h"
+#include "ipa_ipv6cti.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+/*
+ * The simulator's "file descriptors"
+ */
+#define SIM_FD_IPA    0x1A00
+#define SIM_FD_NAT    0x1A01
+#define SIM_FD_IPV6CT 0x1A02
+
+#define SIM_VALID_FD(fd) \
+	( (fd) >= SIM_FD_IPA && (fd) <= SIM_FD_IPV6CT )
+
+/*
+ * DMA entries the driver takes in one table DMA command: one TLV-safe
+ * chain of 10 immediate commands, less the coal close and the NO-OP
+ */
+#define SIM_MAX_DMA_ENTRIES_PER_CMD 8
+
+/*
+ * One chunk of table memory, as the driver would have allocated it
+ * (for NAT: one per memory type; for IPv6CT: just the one)
+ */
+typedef struct
+{
+	uint8_t* mem;
+	uint32_t size;
+	bool     in_use;
+	bool     is_hw_init;
+	uint32_t offset[IPA_IPV6CT_EXPN_TBL + 1]; /* from the init command */
+	uint32_t table_entries;                   /* from the init command */
+	uint32_t expn_table_entries;              /* from the init command */
+} sim_mem_loc;
+
+typedef struct
+{
+	ipa_nat_sim_cfg      cfg;
+	ipa_nat_sim_stats    stats;
+	sim_mem_loc          nat[IPA_NAT_MEM_IN_MAX];
+	sim_mem_loc          ipv6ct;
+	enum ipa3_nat_mem_in last_alloc_loc; /* what the NAT device mmaps */
+	enum ipa3_nat_mem_in active_loc;     /* what the IPA uses */
+	struct ipa_ioc_nat_pdn_entry pdns[IPA_MAX_PDN_NUM];
+	pthread_mutex_t      lock;
+} sim_ipa;
+
+static sim_ipa sim = {
+	.cfg  = { IPA_HW_v4_0, 0 },
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+#undef SIM_FAIL
+#define SIM_FAIL(e) \
+	do { errno = (e); ret = -1; goto unlock; } while (0)
+
+static int sim_open(
+	const char* path,
+	int         flags)
+{
+	IPADBG("path(%s) flags(0x%x)\n", path, flags);
+
+	if ( ! strcmp(path, IPA_DEV_NAME) )
+		return SIM_FD_IPA;
+
+	if ( strstr(path, IPA_NAT_DEV_NAME) )
+		return SIM_FD_NAT;
+
+	if ( strstr(path, IPA_IPV6CT_DEV_NAME) )
+		return SIM_FD_IPV6CT;
+
+	errno = ENOENT;
+
+	return -1;
+}
+
+static int sim_close(
+	int fd)
+{
+	if ( ! SIM_VALID_FD(fd) )
+	{
+		errno = EBADF;
+		return -1;
+	}
+
+	return 0;
+}
+
+static void* sim_mmap(
+	void*  addr,
+	size_t len,
+	int    prot,
+	int    flags,
+	int    fd,
+	off_t  off)
+{
+	sim_mem_loc* loc_ptr;
+	void*        ret = MAP_FAILED;
+
+	pthread_mutex_lock(&sim.lock);
+
+	if ( fd == SIM_FD_NAT )
+	{
+		loc_ptr = &sim.nat[sim.last_alloc_loc];
+	}
+	else if ( fd == SIM_FD_IPV6CT )
+	{
+		loc_ptr = &sim.ipv6ct;
+	}
+	else
+	{
+		errno = EBADF;
+		goto unlock;
+	}
+
+	if ( ! loc_ptr->in_use || off != 0 || len > loc_ptr->size )
+	{
+		IPAERR("Bad mmap: in_use(%u) len(%zu) size(%u) off(%ld)\n",
+			   loc_ptr->in_use, len, loc_ptr->size, (long) off);
+		errno = EINVAL;
+		goto unlock;
+	}
+
+	ret = loc_ptr->mem;
+
+unlock:
+	pthread_mutex_unlock(&sim.lock);
+
+	return ret;
+}
+
+/*
+ * The memory belongs to the "driver" until the table is deleted
+ */
+static int sim_munmap(
+	void*  addr,
+	size_t len)
+{
+	return 0;
+}
+
+static int sim_alloc_loc(
+	sim_mem_loc* loc_ptr,
+	uint32_t     size)
+{
+	if ( loc_ptr->in_use )
+	{
+		IPAERR("Memory already allocated\n");
+		return -EPERM;
+	}
+
+	loc_ptr->mem = calloc(1, size);
+
+	if ( loc_ptr->mem == NULL )
+	{
+		return -ENOMEM;
+	}
+
+	loc_ptr->size       = size;
+	loc_ptr->in_use     = true;
+	loc_ptr->is_hw_init = false;
+
+	return 0;
+}
+
+static void sim_free_loc(
+	sim_mem_loc* loc_ptr)
+{
+	free(loc_ptr->mem);
+
+	memset(loc_ptr, 0, sizeof(*loc_ptr));
+}
+
+/*
+ * Where base_addr's table lives, and how big it is, per the init
+ * command (the base tables hold table_entries + 1 entries)
+ */
+static uint8_t* sim_table(
+	enum ipa3_nat_mem_in nmi,
+	uint8_t              base_addr,
+	uint32_t*            size_ptr)
+{
+	sim_mem_loc* loc_ptr;
+	uint32_t     ents, ent_sz;
+
+	switch ( base_addr )
+	{
+	case IPA_NAT_BASE_TBL:
+	case IPA_NAT_INDX_TBL:
+		loc_ptr = &sim.nat[nmi];
+		ents    = loc_ptr->table_entries + 1;
+		break;
+	case IPA_NAT_EXPN_TBL:
+	case IPA_NAT_INDEX_EXPN_TBL:
+		loc_ptr = &sim.nat[nmi];
+		ents    = loc_ptr->expn_table_entries;
+		break;
+	case IPA_IPV6CT_BASE_TBL:
+		loc_ptr = &sim.ipv6ct;
+		ents    = loc_ptr->table_entries + 1;
+		break;
+	case IPA_IPV6CT_EXPN_TBL:
+		loc_ptr = &sim.ipv6ct;
+		ents    = loc_ptr->expn_table_entries;
+		break;
+	default:
+		return NULL;
+	}
+
+	switch ( base_addr )
+	{
+	case IPA_NAT_BASE_TBL:
+	case IPA_NAT_EXPN_TBL:
+		ent_sz = sizeof(struct ipa_nat_rule);
+		break;
+	case IPA_NAT_INDX_TBL:
+	case IPA_NAT_INDEX_EXPN_TBL:
+		ent_sz = sizeof(struct ipa_nat_indx_tbl_rule);
+		break;
+	default:
+		ent_sz = sizeof(ipa_ipv6ct_hw_entry);
+		break;
+	}
+
+	if ( ! loc_ptr->is_hw_init )
+	{
+		return NULL;
+	}
+
+	*size_ptr = ents * ent_sz;
+
+	return loc_ptr->mem + loc_ptr->offset[base_addr];
+}
+
+/*
+ * Checks a table DMA command the way the driver does, and only then
+ * applies it. The IPA writes NAT entries to the table it was last
+ * initialized with, whatever the command's mem_type.
+ */
+static int sim_table_dma(
+	struct ipa_ioc_nat_dma_cmd* cmd)
+{
+	struct ipa_ioc_nat_dma_one* dma;
+	enum ipa3_nat_mem_in        nmi;
+	uint8_t*                    tbl;
+	uint32_t                    size, i;
+
+	if ( ! IPA_VALID_NAT_MEM_IN(cmd->mem_type) ||
+		 cmd->entries == 0 ||
+		 cmd->entries > SIM_MAX_DMA_ENTRIES_PER_CMD )
+	{
+		IPAERR("Bad DMA command: mem_type(%u) entries(%u)\n",
+			   cmd->mem_type, cmd->entries);
+		return -EPERM;
+	}
+
+	for ( i = 0; i < cmd->entries; i++ )
+	{
+		dma = &cmd->dma[i];
+
+		if ( dma->table_index >= 1 ||
+			 ( dma->base_addr >= IPA_IPV6CT_BASE_TBL &&
+			   sim.cfg.hw_ver < IPA_HW_v4_0 ) ||
+			 ! (tbl = sim_table(cmd->mem_type, dma->base_addr, &size)) ||
+			 dma->offset >= size )
+		{
+			IPAERR("Table DMA command parameter %u is invalid: "
+				   "table_index(%u) base_addr(%u) offset(%u)\n",
+				   i, dma->table_index, dma->base_addr, dma->offset);
+			return -EPERM;
+		}
+	}
+
+	for ( i = 0; i < cmd->entries; i++ )
+	{
+		dma = &cmd->dma[i];
+
+		nmi = ( dma->base_addr < IPA_IPV6CT_BASE_TBL ) ?
+			sim.active_loc : cmd->mem_type;
+
+		tbl = sim_table(nmi, dma->base_addr, &size);
+
+		if ( tbl == NULL || dma->offset + sizeof(uint16_t) > size )
+		{
+			IPAERR("DMA entry %u falls outside the active table\n", i);
+			return -EPERM;
+		}
+
+		*(volatile uint16_t*) (tbl + dma->offset) = dma->data;
+	}
+
+	sim.stats.dma_cmds++;
+	sim.stats.dma_entries += cmd->entries;
+
+	return 0;
+}
+
+static int sim_ioctl(
+	int           fd,
+	unsigned long req,
+	unsigned long arg)
+{
+	void*        arg_ptr = (void*) arg;
+	sim_mem_loc* loc_ptr;
+	int          ret = 0, err;
+
+	pthread_mutex_lock(&sim.lock);
+
+	if ( fd != SIM_FD_IPA )
+	{
+		SIM_FAIL(EBADF);
+	}
+
+	switch ( req )
+	{
+	case IPA_IOC_GET_HW_VERSION:
+		*(enum ipa_hw_type*) arg_ptr = sim.cfg.hw_ver;
+		break;
+
+	case IPA_IOC_GET_NAT_IN_SRAM_INFO:
+	{
+		struct ipa_nat_in_sram_info* info = arg_ptr;
+
+		if ( sim.cfg.sram_size == 0 )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		info->sram_mem_available_for_nat = sim.cfg.sram_size;
+		info->nat_table_offset_into_mmap = 0;
+		info->best_nat_in_sram_size_rqst = sim.cfg.sram_size;
+		break;
+	}
+
+	case IPA_IOC_ALLOC_NAT_TABLE:
+	{
+		struct ipa_ioc_nat_ipv6ct_table_alloc* alloc = arg_ptr;
+		enum ipa3_nat_mem_in nmi =
+			( sim.cfg.sram_size && alloc->size <= sim.cfg.sram_size ) ?
+			IPA_NAT_MEM_IN_SRAM : IPA_NAT_MEM_IN_DDR;
+
+		if ( alloc->size == 0 )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		/*
+		 * SRAM is a fixed chunk, so it's all handed over
+		 */
+		err = sim_alloc_loc(
+			&sim.nat[nmi],
+			( nmi == IPA_NAT_MEM_IN_SRAM ) ? sim.cfg.sram_size : alloc->size);
+
+		if ( err )
+		{
+			SIM_FAIL(-err);
+		}
+
+		sim.last_alloc_loc = nmi;
+		alloc->offset      = 0;
+		break;
+	}
+
+	case IPA_IOC_ALLOC_IPV6CT_TABLE:
+	{
+		struct ipa_ioc_nat_ipv6ct_table_alloc* alloc = arg_ptr;
+
+		if ( alloc->size == 0 || sim.cfg.hw_ver < IPA_HW_v4_0 )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		if ( (err = sim_alloc_loc(&sim.ipv6ct, alloc->size)) )
+		{
+			SIM_FAIL(-err);
+		}
+
+		alloc->offset = 0;
+		break;
+	}
+
+	case IPA_IOC_V4_INIT_NAT:
+	{
+		struct ipa_ioc_v4_nat_init* init = arg_ptr;
+
+		if ( ! IPA_VALID_NAT_MEM_IN(init->mem_type) || init->tbl_index >= 1 )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		loc_ptr = &sim.nat[init->mem_type];
+
+		if ( ! loc_ptr->in_use )
+		{
+			IPAERR("Init of %s NAT table that isn't allocated\n",
+				   ipa3_nat_mem_in_as_str(init->mem_type));
+			SIM_FAIL(EPERM);
+		}
+
+		/*
+		 * A focus change just points the IPA back at a table it
+		 * was initialized with before
+		 */
+		if ( ! init->focus_change )
+		{
+			if ( init->index_expn_offset +
+				 init->expn_table_entries * sizeof(struct ipa_nat_indx_tbl_rule) >
+				 loc_ptr->size )
+			{
+				IPAERR("Table offset not valid\n");
+				SIM_FAIL(EPERM);
+			}
+
+			loc_ptr->offset[IPA_NAT_BASE_TBL]       = init->ipv4_rules_offset;
+			loc_ptr->offset[IPA_NAT_EXPN_TBL]       = init->expn_rules_offset;
+			loc_ptr->offset[IPA_NAT_INDX_TBL]       = init->index_offset;
+			loc_ptr->offset[IPA_NAT_INDEX_EXPN_TBL] = init->index_expn_offset;
+
+			loc_ptr->table_entries      = init->table_entries;
+			loc_ptr->expn_table_entries = init->expn_table_entries;
+			loc_ptr->is_hw_init         = true;
+		}
+		else if ( ! loc_ptr->is_hw_init )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		sim.active_loc = init->mem_type;
+		sim.stats.init_cmds++;
+		break;
+	}
+
+	case IPA_IOC_INIT_IPV6CT_TABLE:
+	{
+		struct ipa_ioc_ipv6ct_init* init = arg_ptr;
+
+		loc_ptr = &sim.ipv6ct;
+
+		if ( ! loc_ptr->in_use ||
+			 init->tbl_index >= 1 ||
+			 init->expn_table_offset +
+			 init->expn_table_entries * sizeof(ipa_ipv6ct_hw_entry) >
+			 loc_ptr->size )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		loc_ptr->offset[IPA_IPV6CT_BASE_TBL] = init->base_table_offset;
+		loc_ptr->offset[IPA_IPV6CT_EXPN_TBL] = init->expn_table_offset;
+
+		loc_ptr->table_entries      = init->table_entries;
+		loc_ptr->expn_table_entries = init->expn_table_entries;
+		loc_ptr->is_hw_init         = true;
+
+		sim.stats.init_cmds++;
+		break;
+	}
+
+	case IPA_IOC_TABLE_DMA_CMD:
+		if ( (err = sim_table_dma(arg_ptr)) )
+		{
+			sim.stats.dma_rejects++;
+			SIM_FAIL(-err);
+		}
+		break;
+
+	case IPA_IOC_DEL_NAT_TABLE:
+	{
+		struct ipa_ioc_nat_ipv6ct_table_del* del = arg_ptr;
+
+		if ( ! IPA_VALID_NAT_MEM_IN(del->mem_type) ||
+			 ! sim.nat[del->mem_type].in_use )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		sim_free_loc(&sim.nat[del->mem_type]);
+		break;
+	}
+
+	case IPA_IOC_DEL_IPV6CT_TABLE:
+		if ( ! sim.ipv6ct.in_use )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		sim_free_loc(&sim.ipv6ct);
+		break;
+
+	case IPA_IOC_NAT_MODIFY_PDN:
+	{
+		struct ipa_ioc_nat_pdn_entry* pdn = arg_ptr;
+
+		if ( pdn->pdn_index >= IPA_MAX_PDN_NUM )
+		{
+			SIM_FAIL(EPERM);
+		}
+
+		sim.pdns[pdn->pdn_index] = *pdn;
+		sim.stats.pdn_mods++;
+		break;
+	}
+
+	case IPA_IOC_GET_NAT_OFFSET:
+		*(uint32_t*) arg_ptr = 0;
+		break;
+
+	case IPA_IOC_APP_CLOCK_VOTE:
+	case IPA_IOC_ADD_UC_ACT_ENTRY:
+	case IPA_IOC_DEL_UC_ACT_ENTRY:
+		break;
+
+	default:
+		SIM_FAIL(ENOTTY);
+	}
+
+unlock:
+	pthread_mutex_unlock(&sim.lock);
+
+	return ret;
+}
+
+static const ipa_nat_backend sim_backend =
+{
+	"simulated IPA",
+	sim_open,
+	sim_close,
+	sim_ioctl,
+	sim_mmap,
+	sim_munmap
+};
+
+int ipa_nat_sim_enable(
+	const ipa_nat_sim_cfg* cfg_ptr)
+{
+	int ret = 0;
+
+	IPADBG("In\n");
+
+	if ( cfg_ptr == NULL )
+	{
+		IPAERR("Bad arg: cfg_ptr(%p)\n", cfg_ptr);
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	pthread_mutex_lock(&sim.lock);
+
+	if ( sim.nat[IPA_NAT_MEM_IN_DDR].in_use ||
+		 sim.nat[IPA_NAT_MEM_IN_SRAM].in_use ||
+		 sim.ipv6ct.in_use )
+	{
+		IPAERR("Can't reconfigure the simulator with tables allocated\n");
+		ret = -EBUSY;
+	}
+	else
+	{
+		sim.cfg = *cfg_ptr;
+		memset(&sim.stats, 0, sizeof(sim.stats));
+	}
+
+	pthread_mutex_unlock(&sim.lock);
+
+	if ( ret == 0 )
+	{
+		ipa_nat_set_backend(&sim_backend);
+	}
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+void ipa_nat_sim_get_stats(
+	ipa_nat_sim_stats* stats_ptr)
+{
+	pthread_mutex_lock(&sim.lock);
+
+	*stats_ptr = sim.stats;
+
+	pthread_mutex_unlock(&sim.lock);
+}
@@ -76,9 +76,9 @@
 
 #undef  CHOOSE_MEM_SUB
 #define CHOOSE_MEM_SUB() \
-	(nati_obj.curr_state == NATI_STATE_HYBRID) ? \
-	SRAM_SUB : \
-	DDR_SUB
+	( (nati_obj.curr_state == NATI_STATE_HYBRID) ? \
+	  SRAM_SUB : \
+	  DDR_SUB )
 
 #undef  CHOOSE_MAPS
 #define CHOOSE_MAPS(o2n, n2o) \
@@ -96,6 +96,20 @@
 #define CHOOSE_SW_STATS() \
 	&(nati_obj.sw_stats[CHOOSE_MEM_SUB()])
 
+#undef  MIGRATION_DST_SUB
+#define MIGRATION_DST_SUB() \
+	((nati_obj.migration.src_sub == SRAM_SUB) ? DDR_SUB : SRAM_SUB)
+
+#undef  MIGRATION_TBL_HDL
+#define MIGRATION_TBL_HDL(sub) \
+	(((sub) == SRAM_SUB) ? nati_obj.sram_tbl_hdl : nati_obj.ddr_tbl_hdl)
+
+#undef  MIGRATION_CHUNK
+#define MIGRATION_CHUNK() \
+	((nati_obj.migration.chunk_size) ? \
+	 nati_obj.migration.chunk_size : \
+	 UINT32_MAX)
+
 /*
  * BACKROUND INFORMATION
  *
@@ -170,6 +184,12 @@ static ipa_nati_obj nati_obj = {
 	 *   sw_stats[1] for sram
 	 */
 	.sw_stats = { {0, 0}, {0, 0} },
+	/*
+	 * Remember:
+	 *   migration.chunk_size of zero means table switches are done
+	 *   in one go (ie. not incrementally)
+	 */
+	.migration = { 0 },
 };
 
 /*
@@ -225,7 +245,7 @@ bail:
 /*
  * Function for taking/locking the mutex...
  */
-static int take_mutex()
+static int take_mutex(void)
 {
 	int ret;
 
@@ -256,7 +276,7 @@ again:
 /*
  * Function for giving/unlocking the mutex...
  */
-static int give_mutex()
+static int give_mutex(void)
 {
 	int ret = (nat_mutex_init) ? pthread_mutex_unlock(&nat_mutex) : -1;
 
@@ -269,6 +289,106 @@ static int give_mutex()
 	return ret;
 }
 
+/*
+ * The following lets table walks, stats and timestamp queries run
+ * alongside rule adds/deletes. Readers hold it shared. Triggers that
+ * create, clear, delete or move tables hold it exclusively, on top of
+ * the nat mutex. Since the state machine recurses (eg. a rule add
+ * causing a table switch), the exclusive hold is counted; the count is
+ * only touched with the nat mutex held.
+ */
+static pthread_rwlock_t nat_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+static uint32_t         nat_rwlock_wr_depth = 0;
+
+/*
+ * Function for taking the state lock shared...
+ */
+static int take_rdlock(void)
+{
+	int ret = pthread_rwlock_rdlock(&nat_rwlock);
+
+	if ( ret != 0 )
+	{
+		IPAERR("Unable to read lock the nat state lock: ret(%d)\n", ret);
+	}
+
+	return ret;
+}
+
+/*
+ * Function for releasing a shared hold on the state lock...
+ */
+static int give_rdlock(void)
+{
+	int ret = pthread_rwlock_unlock(&nat_rwlock);
+
+	if ( ret != 0 )
+	{
+		IPAERR("Unable to read unlock the nat state lock: ret(%d)\n", ret);
+	}
+
+	return ret;
+}
+
+/*
+ * Function for taking the state lock exclusively. Must be called with
+ * the nat mutex held...
+ */
+static int take_wrlock(void)
+{
+	int ret = 0;
+
+	if ( nat_rwlock_wr_depth == 0 )
+	{
+		ret = pthread_rwlock_wrlock(&nat_rwlock);
+
+		if ( ret != 0 )
+		{
+			IPAERR("Unable to write lock the nat state lock: ret(%d)\n", ret);
+			return ret;
+		}
+	}
+
+	nat_rwlock_wr_depth++;
+
+	return ret;
+}
+
+/*
+ * Function for releasing an exclusive hold on the state lock. Must be
+ * called with the nat mutex held...
+ */
+static int give_wrlock(void)
+{
+	int ret = 0;
+
+	if ( nat_rwlock_wr_depth == 0 )
+	{
+		IPAERR("nat state lock not write locked\n");
+		return -1;
+	}
+
+	if ( --nat_rwlock_wr_depth == 0 )
+	{
+		ret = pthread_rwlock_unlock(&nat_rwlock);
+
+		if ( ret != 0 )
+		{
+			IPAERR("Unable to write unlock the nat state lock: ret(%d)\n", ret);
+		}
+	}
+
+	return ret;
+}
+
+static void abort_migration(
+	ipa_nati_obj* nati_obj_ptr ); /* forward declaration */
+
+static int run_migration(
+	ipa_nati_obj* nati_obj_ptr,
+	bool          begin,
+	bool*         done_ptr ); /* forward declaration */
+
 /*
  * ****************************************************************************
  *
@@ -293,7 +413,7 @@ int ipa_nati_add_ipv4_tbl(
 
 	IPADBG("In\n");
 
-	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_ADD_TABLE, args);
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_ADD_TABLE, (arb_t*) args);
 
 	if ( ret == 0 )
 	{
@@ -316,7 +436,7 @@ int ipa_nati_del_ipv4_table(
 
 	IPADBG("In\n");
 
-	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_DEL_TABLE, args);
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_DEL_TABLE, (arb_t*) args);
 
 	IPADBG("Out\n");
 
@@ -334,7 +454,7 @@ int ipa_nati_clear_ipv4_tbl(
 
 	IPADBG("In\n");
 
-	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_CLR_TABLE, args);
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_CLR_TABLE, (arb_t*) args);
 
 	IPADBG("Out\n");
 
@@ -352,14 +472,62 @@ int ipa_nati_walk_ipv4_tbl(
 		(arb_t*)(arb_t)which,
 		(arb_t*) walk_cb,
 		(arb_t*) arb_data_ptr,
+		NULL, /* no cursor, walk it all */
+		0,
+	};
+
+	int ret;
+
+	IPADBG("In\n");
+
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_WLK_TABLE, (arb_t*) args);
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+void ipa_nati_walk_cursor_init(
+	ipa_nati_walk_cursor* cursor_ptr )
+{
+	if ( cursor_ptr )
+	{
+		memset(cursor_ptr, 0, sizeof(ipa_nati_walk_cursor));
+	}
+}
+
+int ipa_nati_walk_ipv4_tbl_slice(
+	uint32_t              tbl_hdl,
+	WhichTbl2Use          which,
+	ipa_nati_walk_cursor* cursor_ptr,
+	uint32_t              max_ents,
+	ipa_table_walk_cb     walk_cb,
+	void*                 arb_data_ptr )
+{
+	arb_t* args[] = {
+		(arb_t*)(arb_t)tbl_hdl,
+		(arb_t*)(arb_t)which,
+		(arb_t*) walk_cb,
+		(arb_t*) arb_data_ptr,
+		(arb_t*) cursor_ptr,
+		(arb_t*)(arb_t)max_ents,
 	};
 
 	int ret;
 
 	IPADBG("In\n");
 
-	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_WLK_TABLE, args);
+	if ( ! cursor_ptr || ! max_ents )
+	{
+		IPAERR("Bad arg: cursor_ptr(%p) and/or max_ents(%u)\n",
+			   cursor_ptr, max_ents);
+		ret = -EINVAL;
+		goto bail;
+	}
 
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_WLK_TABLE, (arb_t*) args);
+
+bail:
 	IPADBG("Out\n");
 
 	return ret;
@@ -380,7 +548,7 @@ int ipa_nati_ipv4_tbl_stats(
 
 	IPADBG("In\n");
 
-	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_TBL_STATS, args);
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_TBL_STATS, (arb_t*) args);
 
 	IPADBG("Out\n");
 
@@ -402,7 +570,7 @@ int ipa_nati_add_ipv4_rule(
 
 	IPADBG("In\n");
 
-	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_ADD_RULE, args);
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_ADD_RULE, (arb_t*) args);
 
 	if ( ret == 0 )
 	{
@@ -427,7 +595,100 @@ int ipa_nati_del_ipv4_rule(
 
 	IPADBG("In\n");
 
-	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_DEL_RULE, args);
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_DEL_RULE, (arb_t*) args);
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+int ipa_nati_add_ipv4_rules(
+	uint32_t                 tbl_hdl,
+	const ipa_nat_ipv4_rule* clnt_rules,
+	uint32_t                 num_rules,
+	uint32_t*                rule_hdls,
+	uint32_t*                num_added )
+{
+	arb_t* args[] = {
+		(arb_t*)(arb_t)tbl_hdl,
+		(arb_t*) clnt_rules,
+		(arb_t*)(arb_t)num_rules,
+		(arb_t*) rule_hdls,
+		(arb_t*) num_added,
+	};
+
+	int ret;
+
+	IPADBG("In\n");
+
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_ADD_RULES, (arb_t*) args);
+
+	if ( ret == 0 )
+	{
+		IPADBG("%u of %u rules added\n", *num_added, num_rules);
+	}
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+int ipa_nati_del_ipv4_rules(
+	uint32_t        tbl_hdl,
+	const uint32_t* rule_hdls,
+	uint32_t        num_rules,
+	uint32_t*       num_deleted )
+{
+	arb_t* args[] = {
+		(arb_t*)(arb_t)tbl_hdl,
+		(arb_t*) rule_hdls,
+		(arb_t*)(arb_t)num_rules,
+		(arb_t*) num_deleted,
+	};
+
+	int ret;
+
+	IPADBG("In\n");
+
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_DEL_RULES, (arb_t*) args);
+
+	if ( ret == 0 )
+	{
+		IPADBG("%u of %u rules deleted\n", *num_deleted, num_rules);
+	}
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+int ipa_nati_age_ipv4_rules(
+	uint32_t  tbl_hdl,
+	uint32_t  idle_ms,
+	bool      del_expired,
+	uint32_t* rule_hdls,
+	uint32_t  max_hdls,
+	uint32_t* num_expired )
+{
+	arb_t* args[] = {
+		(arb_t*)(arb_t)tbl_hdl,
+		(arb_t*)(arb_t)idle_ms,
+		(arb_t*)(arb_t)del_expired,
+		(arb_t*) rule_hdls,
+		(arb_t*)(arb_t)max_hdls,
+		(arb_t*) num_expired,
+	};
+
+	int ret;
+
+	IPADBG("In\n");
+
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_AGE_RULES, (arb_t*) args);
+
+	if ( ret == 0 )
+	{
+		IPADBG("%u rules expired\n", *num_expired);
+	}
 
 	IPADBG("Out\n");
 
@@ -449,7 +710,7 @@ int ipa_nati_query_timestamp(
 
 	IPADBG("In\n");
 
-	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_GET_TSTAMP, args);
+	ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_GET_TSTAMP, (arb_t*) args);
 
 	if ( ret == 0 )
 	{
@@ -517,7 +778,26 @@ int ipa_nat_switch_to(
 
 		if ( COMPATIBLE_NMI_4SWITCH(nmi) )
 		{
-			ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_TBL_SWITCH, 0);
+			if ( nati_obj.migration.chunk_size && ! hold_state )
+			{
+				/*
+				 * Only start the switch. See
+				 * ipa_nat_migration_step()...
+				 */
+				ret = run_migration(&nati_obj, true, NULL);
+			}
+			else
+			{
+				ret = ipa_nati_statemach(&nati_obj, NATI_TRIG_TBL_SWITCH, 0);
+			}
+		}
+		else if ( hold_state )
+		{
+			/*
+			 * Holding the memory type in use, so any switch away
+			 * from it has to go...
+			 */
+			abort_migration(&nati_obj);
 		}
 
 		if ( ret == 0 )
@@ -604,6 +884,124 @@ bail:
 	return ret;
 }
 
+int ipa_nat_set_migration_chunk(
+	uint32_t chunk_size )
+{
+	int ret;
+
+	IPADBG("In\n");
+
+	ret = take_mutex();
+
+	if ( ret != 0 )
+	{
+		goto bail;
+	}
+
+	nati_obj.migration.chunk_size = chunk_size;
+
+	/*
+	 * Worst hold time is only meaningful for a given chunk size...
+	 */
+	nati_obj.migration.max_hold_ns = 0;
+
+	IPADBG("Table switches will copy %u rules per chunk\n", chunk_size);
+
+	ret = give_mutex();
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+int ipa_nat_migration_step(
+	bool* done_ptr )
+{
+	bool done = true;
+
+	int  ret;
+
+	IPADBG("In\n");
+
+	ret = take_mutex();
+
+	if ( ret != 0 )
+	{
+		goto bail;
+	}
+
+	if ( nati_obj.migration.in_progress )
+	{
+		ret = run_migration(&nati_obj, false, &done);
+	}
+
+	if ( give_mutex() != 0 && ret == 0 )
+	{
+		ret = -1;
+	}
+
+	if ( done_ptr )
+	{
+		*done_ptr = done;
+	}
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+int ipa_nat_get_migration_stats(
+	ipa_nat_migration_stats* stats_ptr )
+{
+	nati_migration* mig_ptr = &nati_obj.migration;
+
+	int ret;
+
+	IPADBG("In\n");
+
+	if ( ! stats_ptr )
+	{
+		IPAERR("stats_ptr is null\n");
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	ret = take_mutex();
+
+	if ( ret != 0 )
+	{
+		goto bail;
+	}
+
+	memset(stats_ptr, 0, sizeof(*stats_ptr));
+
+	stats_ptr->in_progress      = mig_ptr->in_progress;
+	stats_ptr->to_nmi           =
+		(MIGRATION_DST_SUB() == SRAM_SUB) ?
+		IPA_NAT_MEM_IN_SRAM                :
+		IPA_NAT_MEM_IN_DDR;
+	stats_ptr->chunk_size       = mig_ptr->chunk_size;
+	stats_ptr->slots_done       = mig_ptr->next_index;
+	stats_ptr->tot_slots        = mig_ptr->tot_slots;
+	stats_ptr->rules_copied     = mig_ptr->rules_copied;
+	stats_ptr->rules_mirrored   = mig_ptr->rules_mirrored;
+	stats_ptr->chunks           = mig_ptr->chunks;
+	stats_ptr->completed        = mig_ptr->completed;
+	stats_ptr->aborted          = mig_ptr->aborted;
+	stats_ptr->max_hold_ns      = mig_ptr->max_hold_ns;
+	stats_ptr->last_cutover_ns  = mig_ptr->last_cutover_ns;
+	stats_ptr->last_duration_ns = mig_ptr->last_duration_ns;
+
+	ret = give_mutex();
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
 bool ipa_nat_is_sram_supported(void)
 {
 	return VALID_TBL_HDL(nati_obj.sram_tbl_hdl);
@@ -675,14 +1073,14 @@ static int migrate_rule(
 	void*           arb_data_ptr )
 {
 	struct ipa_nat_rule* nat_rule_ptr = (struct ipa_nat_rule*) record_ptr;
-	uint32_t             dst_tbl_hdl  = (uint32_t) arb_data_ptr;
+	uint32_t             dst_tbl_hdl  = (uint32_t)(arb_t) arb_data_ptr;
 
 	ipa_nat_ipv4_rule    v4_rule;
 
 	uint32_t             orig_rule_hdl;
 	uint32_t             new_rule_hdl;
 
-	uint32_t             src_orig2new_map, src_new2orig_map;
+	uint32_t             src_new2orig_map;
 	uint32_t             dst_orig2new_map, dst_new2orig_map;
 	uint32_t*            cnt_ptr;
 
@@ -707,7 +1105,6 @@ static int migrate_rule(
 	{
 		mig_dir_ptr = "SRAM -> DDR";
 
-		src_orig2new_map = nati_obj.map_pairs[SRAM_SUB].orig2new_map;
 		src_new2orig_map = nati_obj.map_pairs[SRAM_SUB].new2orig_map;
 
 		dst_orig2new_map = nati_obj.map_pairs[DDR_SUB].orig2new_map;
@@ -719,7 +1116,6 @@ static int migrate_rule(
 	{
 		mig_dir_ptr = "DDR -> SRAM";
 
-		src_orig2new_map = nati_obj.map_pairs[DDR_SUB].orig2new_map;
 		src_new2orig_map = nati_obj.map_pairs[DDR_SUB].new2orig_map;
 
 		dst_orig2new_map = nati_obj.map_pairs[SRAM_SUB].orig2new_map;
@@ -745,6 +1141,18 @@ static int migrate_rule(
 		goto bail;
 	}
 
+	/*
+	 * During an incremental migration, rules added since it started
+	 * have already been written to the destination table...
+	 */
+	if ( ipa_nat_map_probe(dst_orig2new_map, orig_rule_hdl, NULL) == 0 )
+	{
+		IPADBG("%s: orig_rule_hdl(0x%08X) already migrated\n",
+			   mig_dir_ptr, orig_rule_hdl);
+		ret = 0;
+		goto bail;
+	}
+
 	memset(&v4_rule, 0, sizeof(v4_rule));
 
 	v4_rule.private_ip   = nat_rule_ptr->private_ip;
@@ -773,6 +1181,8 @@ static int migrate_rule(
 
 	(*cnt_ptr)++;
 
+	nati_obj.migration.rules_copied++;
+
 	/*
 	 * The following is needed to maintain the original handle and
 	 * have it point to the new handle.
@@ -806,11 +1216,220 @@ bail:
 }
 
 /*
- * ****************************************************************************
- *
- * STATE MACHINE CODE BEGINS HERE
- *
- * ****************************************************************************
+ * The following used to pass state to migrate_rule_chunk() below.
+ */
+typedef struct
+{
+	uint32_t dst_tbl_hdl;
+	uint32_t max_rules;
+	uint32_t cnt;
+} migrate_chunk_help;
+
+/******************************************************************************/
+/*
+ * FUNCTION: migrate_rule_chunk
+ *
+ * PARAMS:
+ *
+ *   As for migrate_rule() above, except arb_data_ptr, which is a
+ *   pointer to a migrate_chunk_help structure.
+ *
+ * DESCRIPTION:
+ *
+ *   A table walk callback that hands records to migrate_rule() until
+ *   max_rules have been handed over, then stops the walk. It keeps
+ *   track of where the walk got to, so that the next chunk can start
+ *   from there.
+ *
+ * RETURNS:
+ *
+ *   Returns 0 on success, positive when the chunk is full, negative
+ *   on failure
+ */
+static int migrate_rule_chunk(
+	ipa_table*      table_ptr,
+	uint32_t        tbl_rule_hdl,
+	void*           record_ptr,
+	uint16_t        record_index,
+	void*           meta_record_ptr,
+	uint16_t        meta_record_index,
+	void*           arb_data_ptr )
+{
+	migrate_chunk_help* help_ptr = (migrate_chunk_help*) arb_data_ptr;
+
+	int ret;
+
+	if ( help_ptr->cnt == help_ptr->max_rules )
+	{
+		nati_obj.migration.next_index = record_index;
+		return 1;
+	}
+
+	nati_obj.migration.tot_slots =
+		table_ptr->table_entries + table_ptr->expn_table_entries;
+
+	ret = migrate_rule(
+		table_ptr,
+		tbl_rule_hdl,
+		record_ptr,
+		record_index,
+		meta_record_ptr,
+		meta_record_index,
+		(void*)(uintptr_t) help_ptr->dst_tbl_hdl);
+
+	if ( ret == 0 )
+	{
+		help_ptr->cnt++;
+		nati_obj.migration.next_index = record_index + 1;
+	}
+
+	return ret;
+}
+
+/*
+ * Gives up on an incremental migration. What was copied is left in
+ * the destination table, since the next migration clears it before
+ * using it...
+ */
+static void abort_migration(
+	ipa_nati_obj* nati_obj_ptr )
+{
+	if ( nati_obj_ptr->migration.in_progress )
+	{
+		IPAINFO("Abandoning migration to %s after %u of %u slots\n",
+				(MIGRATION_DST_SUB() == SRAM_SUB) ? "SRAM" : "DDR",
+				nati_obj_ptr->migration.next_index,
+				nati_obj_ptr->migration.tot_slots);
+
+		nati_obj_ptr->migration.in_progress = false;
+		nati_obj_ptr->migration.aborted    += 1;
+	}
+}
+
+/*
+ * Runs the next chunk of a migration through the state machine. When
+ * begin is true, a migration is started if one isn't in progress...
+ */
+static int run_migration(
+	ipa_nati_obj* nati_obj_ptr,
+	bool          begin,
+	bool*         done_ptr )
+{
+	arb_t* args[] = {
+		(arb_t*)(arb_t) MIGRATION_CHUNK(),
+		(arb_t*)(arb_t) begin,
+		(arb_t*) done_ptr,
+	};
+
+	return ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_MIGRATE, (arb_t*) args);
+}
+
+/*
+ * While a migration is in progress, the following two keep the table
+ * being migrated to in step with rule adds and deletes made to the
+ * table in use. Failure here abandons the migration, rather than
+ * failing the rule add or delete...
+ */
+static void mirror_rule_add(
+	ipa_nati_obj*            nati_obj_ptr,
+	const ipa_nat_ipv4_rule* clnt_rule,
+	uint32_t                 orig_rule_hdl )
+{
+	uint32_t dst_sub = MIGRATION_DST_SUB();
+	uint32_t new_rule_hdl;
+
+	int ret;
+
+	if ( ! nati_obj_ptr->migration.in_progress )
+	{
+		return;
+	}
+
+	ret = ipa_NATI_add_ipv4_rule(
+		MIGRATION_TBL_HDL(dst_sub), clnt_rule, &new_rule_hdl);
+
+	if ( ret == 0 )
+	{
+		nati_obj_ptr->tot_rules_in_table[dst_sub]++;
+
+		ret = ipa_nat_map_add(
+			nati_obj_ptr->map_pairs[dst_sub].orig2new_map,
+			orig_rule_hdl,
+			new_rule_hdl);
+
+		if ( ret == 0 )
+		{
+			ret = ipa_nat_map_add(
+				nati_obj_ptr->map_pairs[dst_sub].new2orig_map,
+				new_rule_hdl,
+				orig_rule_hdl);
+		}
+	}
+
+	if ( ret == 0 )
+	{
+		nati_obj_ptr->migration.rules_mirrored++;
+	}
+	else
+	{
+		IPAWARN("Unable to mirror add of orig_rule_hdl(0x%08X)\n",
+				orig_rule_hdl);
+		abort_migration(nati_obj_ptr);
+	}
+}
+
+static void mirror_rule_del(
+	ipa_nati_obj* nati_obj_ptr,
+	uint32_t      orig_rule_hdl )
+{
+	uint32_t dst_sub = MIGRATION_DST_SUB();
+	uint32_t new_rule_hdl;
+
+	int ret;
+
+	if ( ! nati_obj_ptr->migration.in_progress )
+	{
+		return;
+	}
+
+	/*
+	 * Not copied yet?  Then it's gone from the source, and the copy
+	 * won't find it...
+	 */
+	if ( ipa_nat_map_probe(
+			 nati_obj_ptr->map_pairs[dst_sub].orig2new_map,
+			 orig_rule_hdl,
+			 &new_rule_hdl) != 0 )
+	{
+		return;
+	}
+
+	ipa_nat_map_del(
+		nati_obj_ptr->map_pairs[dst_sub].orig2new_map, orig_rule_hdl, NULL);
+	ipa_nat_map_del(
+		nati_obj_ptr->map_pairs[dst_sub].new2orig_map, new_rule_hdl, NULL);
+
+	ret = ipa_NATI_del_ipv4_rule(MIGRATION_TBL_HDL(dst_sub), new_rule_hdl);
+
+	if ( ret == 0 )
+	{
+		nati_obj_ptr->tot_rules_in_table[dst_sub]--;
+		nati_obj_ptr->migration.rules_mirrored++;
+	}
+	else
+	{
+		IPAWARN("Unable to mirror delete of orig_rule_hdl(0x%08X)\n",
+				orig_rule_hdl);
+		abort_migration(nati_obj_ptr);
+	}
+}
+
+/*
+ * ****************************************************************************
+ *
+ * STATE MACHINE CODE BEGINS HERE
+ *
+ * ****************************************************************************
  */
 static int _smUndef(
 	ipa_nati_obj*    nati_obj_ptr,
@@ -843,9 +1462,9 @@ static int _smDelTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**  args = arb_data_ptr;
+	arb_t**  args = (arb_t**) arb_data_ptr;
 
-	uint32_t tbl_hdl = (uint32_t) args[0];
+	uint32_t tbl_hdl = (uint32_t)(arb_t) args[0];
 
 	int ret;
 
@@ -895,12 +1514,9 @@ static int _smFirstTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**   args = arb_data_ptr;
+	arb_t**   args = (arb_t**) arb_data_ptr;
 
-	uint32_t    public_ip_addr    = (uint32_t)    args[0];
-	uint16_t    number_of_entries = (uint16_t)    args[1];
-	uint32_t*   tbl_hdl_ptr       = (uint32_t*)   args[2];
-	const char* mem_type_ptr      = (const char*) args[3];
+	const char* mem_type_ptr = (const char*) args[3];
 
 	int ret;
 
@@ -916,7 +1532,7 @@ static int _smFirstTbl(
 		nati_obj_ptr->state_to_hold                               :
 		mem_type_str_to_ipa_nati_state(mem_type_ptr));
 
-	ret = ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_ADD_TABLE, args);
+	ret = ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_ADD_TABLE, (arb_t*) args);
 
 	IPADBG("Out\n");
 
@@ -948,11 +1564,11 @@ static int _smAddDdrTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**   args = arb_data_ptr;
+	arb_t**   args = (arb_t**) arb_data_ptr;
 
-	uint32_t  public_ip_addr    = (uint32_t)  args[0];
-	uint16_t  number_of_entries = (uint16_t)  args[1];
-	uint32_t* tbl_hdl_ptr       = (uint32_t*) args[2];
+	uint32_t  public_ip_addr    = (uint32_t)(arb_t) args[0];
+	uint16_t  number_of_entries = (uint16_t)(arb_t) args[1];
+	uint32_t* tbl_hdl_ptr       = (uint32_t*)       args[2];
 
 	int ret;
 
@@ -1005,13 +1621,13 @@ static int _smAddSramTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**   args = arb_data_ptr;
+	arb_t**   args = (arb_t**) arb_data_ptr;
 
-	uint32_t  public_ip_addr    = (uint32_t)  args[0];
-	uint16_t  number_of_entries = (uint16_t)  args[1];
-	uint32_t* tbl_hdl_ptr       = (uint32_t*) args[2];
+	uint32_t  public_ip_addr = (uint32_t)(arb_t) args[0];
+	uint32_t* tbl_hdl_ptr    = (uint32_t*)       args[2];
 
 	uint32_t  sram_size = 0;
+	uint16_t  sram_slots;
 
 	int ret;
 
@@ -1028,10 +1644,12 @@ static int _smAddSramTbl(
 			sram_size,
 			sizeof(struct ipa_nat_rule),
 			sizeof(struct ipa_nat_indx_tbl_rule),
-			&nati_obj_ptr->tot_slots_in_sram);
+			&sram_slots);
 
 		if ( ret == 0 )
 		{
+			nati_obj_ptr->tot_slots_in_sram = sram_slots;
+
 			nati_obj_ptr->back_to_sram_thresh =
 				PRCNT_OF(nati_obj_ptr->tot_slots_in_sram);
 
@@ -1102,11 +1720,10 @@ static int _smAddSramAndDdrTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**   args = arb_data_ptr;
+	arb_t**   args = (arb_t**) arb_data_ptr;
 
-	uint32_t  public_ip_addr    = (uint32_t)  args[0];
-	uint16_t  number_of_entries = (uint16_t)  args[1];
-	uint32_t* tbl_hdl_ptr       = (uint32_t*) args[2];
+	uint32_t  public_ip_addr    = (uint32_t)(arb_t) args[0];
+	uint16_t  number_of_entries = (uint16_t)(arb_t) args[1];
 
 	uint32_t tbl_hdl;
 
@@ -1147,7 +1764,27 @@ static int _smAddSramAndDdrTbl(
 				(arb_t*) &tbl_hdl,  /* to protect app's table handle above */
 			};
 
-			ret = _smAddDdrTbl(nati_obj_ptr, trigger, new_args);
+			ret = _smAddDdrTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
+
+			if ( ret == 0 )
+			{
+				/*
+				 * Size the handle maps for the most rules each table
+				 * can hold, so rule adds don't grow them...
+				 */
+				ipa_nat_map_reserve(
+					nati_obj_ptr->map_pairs[SRAM_SUB].orig2new_map,
+					nati_obj_ptr->tot_slots_in_sram);
+				ipa_nat_map_reserve(
+					nati_obj_ptr->map_pairs[SRAM_SUB].new2orig_map,
+					nati_obj_ptr->tot_slots_in_sram);
+				ipa_nat_map_reserve(
+					nati_obj_ptr->map_pairs[DDR_SUB].orig2new_map,
+					number_of_entries);
+				ipa_nat_map_reserve(
+					nati_obj_ptr->map_pairs[DDR_SUB].new2orig_map,
+					number_of_entries);
+			}
 
 			if ( ret == 0 )
 			{
@@ -1208,6 +1845,8 @@ static int _smDelSramAndDdrTbl(
 
 	IPADBG("In\n");
 
+	abort_migration(nati_obj_ptr);
+
 	nati_obj_ptr->tot_rules_in_table[SRAM_SUB] = 0;
 	nati_obj_ptr->tot_rules_in_table[DDR_SUB]  = 0;
 
@@ -1224,7 +1863,7 @@ static int _smDelSramAndDdrTbl(
 			(arb_t*)(arb_t)nati_obj_ptr->ddr_tbl_hdl,
 		};
 
-		ret = _smDelTbl(nati_obj_ptr, trigger, new_args);
+		ret = _smDelTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
 	}
 
 	if ( ret == 0 )
@@ -1266,12 +1905,12 @@ static int _smClrTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**  args = arb_data_ptr;
+	arb_t**  args = (arb_t**) arb_data_ptr;
 
-	uint32_t tbl_hdl = (uint32_t) args[0];
+	uint32_t tbl_hdl = (uint32_t)(arb_t) args[0];
 
 	enum ipa3_nat_mem_in nmi;
-	uint32_t             unused_hdl, sub;
+	uint32_t             tbl_idx, sub;
 
 	int ret;
 
@@ -1279,7 +1918,7 @@ static int _smClrTbl(
 
 	IPADBG("tbl_hdl(0x%08X)\n", tbl_hdl);
 
-	BREAK_TBL_HDL(tbl_hdl, nmi, unused_hdl);
+	BREAK_TBL_HDL(tbl_hdl, nmi, tbl_idx);
 
 	if ( ! IPA_VALID_NAT_MEM_IN(nmi) ) {
 		IPAERR("Bad cache type\n");
@@ -1287,6 +1926,8 @@ static int _smClrTbl(
 		goto bail;
 	}
 
+	IPADBG("nmi(%s) tbl_idx(%u)\n", ipa3_nat_mem_in_as_str(nmi), tbl_idx);
+
 	sub = (nmi == IPA_NAT_MEM_IN_SRAM) ? SRAM_SUB : DDR_SUB;
 
 	nati_obj_ptr->tot_rules_in_table[sub] = 0;
@@ -1328,21 +1969,23 @@ static int _smClrTblHybrid(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**  args = arb_data_ptr;
+	arb_t**  args = (arb_t**) arb_data_ptr;
 
-	uint32_t tbl_hdl = (uint32_t) args[0];
+	uint32_t tbl_hdl = (uint32_t)(arb_t) args[0];
 
 	arb_t*   new_args[] = {
-		(arb_t*)(arb_t)(nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
-		         tbl_hdl :
-		         nati_obj_ptr->ddr_tbl_hdl,
+		(arb_t*)(arb_t)((nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+		          tbl_hdl :
+		          nati_obj_ptr->ddr_tbl_hdl),
 	};
 
 	int ret;
 
 	IPADBG("In\n");
 
-	ret = _smClrTbl(nati_obj_ptr, trigger, new_args);
+	abort_migration(nati_obj_ptr);
+
+	ret = _smClrTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
 
 	IPADBG("Out\n");
 
@@ -1374,12 +2017,14 @@ static int _smWalkTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t** args = arb_data_ptr;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	uint32_t          tbl_hdl = (uint32_t)          args[0];
-	WhichTbl2Use      which   = (WhichTbl2Use)      args[1];
-	ipa_table_walk_cb walk_cb = (ipa_table_walk_cb) args[2];
-	arb_t*            wadp    = (arb_t*)            args[3];
+	uint32_t              tbl_hdl  = (uint32_t)(arb_t)       args[0];
+	WhichTbl2Use          which    = (WhichTbl2Use)(arb_t)   args[1];
+	ipa_table_walk_cb     walk_cb  = (ipa_table_walk_cb)     args[2];
+	arb_t*                wadp     = (arb_t*)                args[3];
+	ipa_nati_walk_cursor* cur_ptr  = (ipa_nati_walk_cursor*) args[4];
+	uint32_t              max_ents = (uint32_t)(arb_t)       args[5];
 
 	int ret;
 
@@ -1387,7 +2032,10 @@ static int _smWalkTbl(
 
 	IPADBG("tbl_hdl(0x%08X)\n", tbl_hdl);
 
-	ret = ipa_NATI_walk_ipv4_tbl(tbl_hdl, which, walk_cb, wadp);
+	ret = (cur_ptr) ?
+		ipa_NATI_walk_ipv4_tbl_slice(
+			tbl_hdl, which, cur_ptr, max_ents, walk_cb, wadp) :
+		ipa_NATI_walk_ipv4_tbl(tbl_hdl, which, walk_cb, wadp);
 
 	IPADBG("Out\n");
 
@@ -1420,27 +2068,29 @@ static int _smWalkTblHybrid(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t** args = arb_data_ptr;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	uint32_t          tbl_hdl = (uint32_t)          args[0];
-	WhichTbl2Use      which   = (WhichTbl2Use)      args[1];
-	ipa_table_walk_cb walk_cb = (ipa_table_walk_cb) args[2];
-	arb_t*            wadp    = (arb_t*)            args[3];
+	uint32_t          tbl_hdl = (uint32_t)(arb_t)     args[0];
+	WhichTbl2Use      which   = (WhichTbl2Use)(arb_t) args[1];
+	ipa_table_walk_cb walk_cb = (ipa_table_walk_cb)   args[2];
+	arb_t*            wadp    = (arb_t*)              args[3];
 
 	arb_t* new_args[] = {
-		(arb_t*)(arb_t)(nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
-		         tbl_hdl :
-		         nati_obj_ptr->ddr_tbl_hdl,
+		(arb_t*)(arb_t)((nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+		          tbl_hdl :
+		          nati_obj_ptr->ddr_tbl_hdl),
 		(arb_t*) which,
 		(arb_t*) walk_cb,
 		(arb_t*) wadp,
+		args[4],
+		args[5],
 	};
 
 	int ret;
 
 	IPADBG("In\n");
 
-	ret = _smWalkTbl(nati_obj_ptr, trigger, new_args);
+	ret = _smWalkTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
 
 	IPADBG("Out\n");
 
@@ -1472,9 +2122,9 @@ static int _smStatTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t** args = arb_data_ptr;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	uint32_t            tbl_hdl       = (uint32_t)            args[0];
+	uint32_t            tbl_hdl       = (uint32_t)(arb_t)     args[0];
 	ipa_nati_tbl_stats* nat_stats_ptr = (ipa_nati_tbl_stats*) args[1];
 	ipa_nati_tbl_stats* idx_stats_ptr = (ipa_nati_tbl_stats*) args[2];
 
@@ -1517,16 +2167,16 @@ static int _smStatTblHybrid(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t** args = arb_data_ptr;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	uint32_t            tbl_hdl       = (uint32_t)            args[0];
+	uint32_t            tbl_hdl       = (uint32_t)(arb_t)     args[0];
 	ipa_nati_tbl_stats* nat_stats_ptr = (ipa_nati_tbl_stats*) args[1];
 	ipa_nati_tbl_stats* idx_stats_ptr = (ipa_nati_tbl_stats*) args[2];
 
 	arb_t* new_args[] = {
-		(arb_t*)(arb_t)(nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
-		         tbl_hdl :
-		         nati_obj_ptr->ddr_tbl_hdl,
+		(arb_t*)(arb_t)((nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+		          tbl_hdl :
+		          nati_obj_ptr->ddr_tbl_hdl),
 		(arb_t*) nat_stats_ptr,
 		(arb_t*) idx_stats_ptr,
 	};
@@ -1535,7 +2185,7 @@ static int _smStatTblHybrid(
 
 	IPADBG("In\n");
 
-	ret = _smStatTbl(nati_obj_ptr, trigger, new_args);
+	ret = _smStatTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
 
 	IPADBG("Out\n");
 
@@ -1568,9 +2218,9 @@ static int _smAddRuleToTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t** args = arb_data_ptr;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	uint32_t           tbl_hdl   = (uint32_t)           args[0];
+	uint32_t           tbl_hdl   = (uint32_t)(arb_t)    args[0];
 	ipa_nat_ipv4_rule* clnt_rule = (ipa_nat_ipv4_rule*) args[1];
 	uint32_t*          rule_hdl  = (uint32_t*)          args[2];
 
@@ -1629,10 +2279,10 @@ static int _smDelRuleFromTbl(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**  args = arb_data_ptr;
+	arb_t**  args = (arb_t**) arb_data_ptr;
 
-	uint32_t tbl_hdl  = (uint32_t) args[0];
-	uint32_t rule_hdl = (uint32_t) args[1];
+	uint32_t tbl_hdl  = (uint32_t)(arb_t) args[0];
+	uint32_t rule_hdl = (uint32_t)(arb_t) args[1];
 
 	int ret;
 
@@ -1686,16 +2336,16 @@ static int _smAddRuleHybrid(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t** args = arb_data_ptr;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	uint32_t           tbl_hdl   = (uint32_t)           args[0];
+	uint32_t           tbl_hdl   = (uint32_t)(arb_t)    args[0];
 	ipa_nat_ipv4_rule* clnt_rule = (ipa_nat_ipv4_rule*) args[1];
 	uint32_t*          rule_hdl  = (uint32_t*)          args[2];
 
 	arb_t*             new_args[] = {
-		(arb_t*)(arb_t)(nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
-		         tbl_hdl :
-		         nati_obj_ptr->ddr_tbl_hdl,
+		(arb_t*)(arb_t)((nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+		          tbl_hdl :
+		          nati_obj_ptr->ddr_tbl_hdl),
 		(arb_t*) clnt_rule,
 		(arb_t*) rule_hdl,
 	};
@@ -1706,7 +2356,7 @@ static int _smAddRuleHybrid(
 
 	IPADBG("In\n");
 
-	ret = _smAddRuleToTbl(nati_obj_ptr, trigger, new_args);
+	ret = _smAddRuleToTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
 
 	if ( ret == 0 )
 	{
@@ -1739,6 +2389,13 @@ static int _smAddRuleHybrid(
 		{
 			ret = ipa_nat_map_add(new2orig_map, *rule_hdl, *rule_hdl);
 		}
+
+		if ( ret == 0 )
+		{
+			mirror_rule_add(nati_obj_ptr, clnt_rule, *rule_hdl);
+
+			run_migration(nati_obj_ptr, false, NULL);
+		}
 	}
 	else
 	{
@@ -1808,10 +2465,10 @@ static int _smDelRuleHybrid(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t**  args = arb_data_ptr;
+	arb_t**  args = (arb_t**) arb_data_ptr;
 
-	uint32_t tbl_hdl       = (uint32_t) args[0];
-	uint32_t orig_rule_hdl = (uint32_t) args[1];
+	uint32_t tbl_hdl       = (uint32_t)(arb_t) args[0];
+	uint32_t orig_rule_hdl = (uint32_t)(arb_t) args[1];
 
 	uint32_t new_rule_hdl;
 
@@ -1848,9 +2505,9 @@ static int _smDelRuleHybrid(
 	if ( ret == 0 )
 	{
 		arb_t* new_args[]  = {
-			(arb_t*)(arb_t)(nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
-			        tbl_hdl :
-			        nati_obj_ptr->ddr_tbl_hdl,
+			(arb_t*)(arb_t)((nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+			         tbl_hdl :
+			         nati_obj_ptr->ddr_tbl_hdl),
 			(arb_t*)(arb_t)new_rule_hdl,
 		};
 
@@ -1859,7 +2516,14 @@ static int _smDelRuleHybrid(
 
 		ipa_nat_map_del(new2orig_map, new_rule_hdl, NULL);
 
-		ret = _smDelRuleFromTbl(nati_obj_ptr, trigger, new_args);
+		ret = _smDelRuleFromTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
+
+		if ( ret == 0 )
+		{
+			mirror_rule_del(nati_obj_ptr, orig_rule_hdl);
+
+			run_migration(nati_obj_ptr, false, NULL);
+		}
 
 		if ( ret == 0 && nati_obj_ptr->curr_state == NATI_STATE_HYBRID_DDR )
 		{
@@ -1876,7 +2540,9 @@ static int _smDelRuleHybrid(
 
 			if ( *cnt_ptr <= nati_obj_ptr->back_to_sram_thresh
 				 &&
-				 ! nati_obj_ptr->hold_state )
+				 ! nati_obj_ptr->hold_state
+				 &&
+				 ! nati_obj_ptr->migration.in_progress )
 			{
 				/*
 				 * The following will focus us on SRAM and cause the copy
@@ -1887,21 +2553,33 @@ static int _smDelRuleHybrid(
 						*cnt_ptr,
 						nati_obj_ptr->back_to_sram_thresh);
 
-				ret = ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_TBL_SWITCH, 0);
-
-				if ( ret == 0 )
+				if ( nati_obj_ptr->migration.chunk_size )
 				{
-					SET_NATIOBJ_STATE(nati_obj_ptr, NATI_STATE_HYBRID);
+					/*
+					 * Only start the copy. Subsequent rule adds and
+					 * deletes move it along, and we stay in DDR until
+					 * it's done...
+					 */
+					run_migration(nati_obj_ptr, true, NULL);
 				}
 				else
 				{
-					/*
-					 * The following will force us stay in DDR for
-					 * now, but the next delete will trigger the
-					 * switch logic above to run again...perhaps it
-					 * will work then.
-					 */
-					ret = 0;
+					ret = ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_TBL_SWITCH, 0);
+
+					if ( ret == 0 )
+					{
+						SET_NATIOBJ_STATE(nati_obj_ptr, NATI_STATE_HYBRID);
+					}
+					else
+					{
+						/*
+						 * The following will force us stay in DDR for
+						 * now, but the next delete will trigger the
+						 * switch logic above to run again...perhaps it
+						 * will work then.
+						 */
+						ret = 0;
+					}
 				}
 			}
 		}
@@ -1914,7 +2592,7 @@ static int _smDelRuleHybrid(
 
 /******************************************************************************/
 /*
- * FUNCTION: _smGoToDdr
+ * FUNCTION: _smAddRulesToTbl
  *
  * PARAMS:
  *
@@ -1926,29 +2604,53 @@ static int _smDelRuleHybrid(
  *
  * DESCRIPTION:
  *
- *   The following will cause the IPA to use the DDR based NAT
- *   table...
+ *   The following will cause the addtion of a batch of NAT rules into
+ *   the currently used table.
  *
  * RETURNS:
  *
  *   zero on success, otherwise non-zero
  */
-static int _smGoToDdr(
+static int _smAddRulesToTbl(
 	ipa_nati_obj*    nati_obj_ptr,
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
+	arb_t** args = (arb_t**) arb_data_ptr;
+
+	uint32_t           tbl_hdl    = (uint32_t)(arb_t)    args[0];
+	ipa_nat_ipv4_rule* clnt_rules = (ipa_nat_ipv4_rule*) args[1];
+	uint32_t           num_rules  = (uint32_t)(arb_t)    args[2];
+	uint32_t*          rule_hdls  = (uint32_t*)          args[3];
+	uint32_t*          num_added  = (uint32_t*)          args[4];
+
+	uint32_t* cnt_ptr;
+	uint32_t  i;
+
 	int ret;
 
 	IPADBG("In\n");
 
-	ret = ipa_NATI_post_ipv4_init_cmd(nati_obj_ptr->ddr_tbl_hdl);
+	IPADBG("tbl_hdl(0x%08X) clnt_rules_ptr(%p) num_rules(%u) rule_hdls_ptr(%p)\n",
+		   tbl_hdl, clnt_rules, num_rules, rule_hdls);
 
-	if ( ret == 0 )
+	for ( i = 0; i < num_rules; i++ )
 	{
-		SET_NATIOBJ_STATE(nati_obj_ptr, NATI_STATE_HYBRID_DDR);
+		clnt_rules[i].redirect   = 0;
+		clnt_rules[i].enable     = 0;
+		clnt_rules[i].time_stamp = 0;
 	}
 
+	ret = ipa_NATI_add_ipv4_rules(
+		tbl_hdl, clnt_rules, num_rules, rule_hdls, num_added);
+
+	/*
+	 * Even on failure, some rules may have gone in...
+	 */
+	cnt_ptr = CHOOSE_CNTR();
+
+	(*cnt_ptr) += *num_added;
+
 	IPADBG("Out\n");
 
 	return ret;
@@ -1956,7 +2658,7 @@ static int _smGoToDdr(
 
 /******************************************************************************/
 /*
- * FUNCTION: _smGoToSram
+ * FUNCTION: _smDelRulesFromTbl
  *
  * PARAMS:
  *
@@ -1968,28 +2670,42 @@ static int _smGoToDdr(
  *
  * DESCRIPTION:
  *
- *   The following will cause the IPA to use the SRAM based NAT
- *   table...
+ *   The following will cause the deletion of a batch of NAT rules from
+ *   the currently used table.
  *
  * RETURNS:
  *
  *   zero on success, otherwise non-zero
  */
-static int _smGoToSram(
+static int _smDelRulesFromTbl(
 	ipa_nati_obj*    nati_obj_ptr,
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
+	arb_t**   args = (arb_t**) arb_data_ptr;
+
+	uint32_t  tbl_hdl     = (uint32_t)(arb_t) args[0];
+	uint32_t* rule_hdls   = (uint32_t*)       args[1];
+	uint32_t  num_rules   = (uint32_t)(arb_t) args[2];
+	uint32_t* num_deleted = (uint32_t*)       args[3];
+
+	uint32_t* cnt_ptr;
+
 	int ret;
 
 	IPADBG("In\n");
 
-	ret = ipa_NATI_post_ipv4_init_cmd(nati_obj_ptr->sram_tbl_hdl);
+	IPADBG("tbl_hdl(0x%08X) rule_hdls_ptr(%p) num_rules(%u)\n",
+		   tbl_hdl, rule_hdls, num_rules);
 
-	if ( ret == 0 )
-	{
-		SET_NATIOBJ_STATE(nati_obj_ptr, NATI_STATE_HYBRID);
-	}
+	ret = ipa_NATI_del_ipv4_rules(tbl_hdl, rule_hdls, num_rules, num_deleted);
+
+	/*
+	 * Even on failure, some rules may have gone out...
+	 */
+	cnt_ptr = CHOOSE_CNTR();
+
+	(*cnt_ptr) -= *num_deleted;
 
 	IPADBG("Out\n");
 
@@ -1998,7 +2714,7 @@ static int _smGoToSram(
 
 /******************************************************************************/
 /*
- * FUNCTION: _smSwitchFromDdrToSram
+ * FUNCTION: _smAddRulesHybrid
  *
  * PARAMS:
  *
@@ -2010,154 +2726,110 @@ static int _smGoToSram(
  *
  * DESCRIPTION:
  *
- *   The following will cause a copy of the DDR table to SRAM and then
- *   will make the IPA use the SRAM...
+ *   The batch equivalent of _smAddRuleHybrid() above. The rules are
+ *   added to SRAM until it fills, then the table is switched to DDR
+ *   and the remaining rules go there.
  *
  * RETURNS:
  *
  *   zero on success, otherwise non-zero
  */
-static int _smSwitchFromDdrToSram(
+static int _smAddRulesHybrid(
 	ipa_nati_obj*    nati_obj_ptr,
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	nati_switch_stats* sw_stats_ptr = CHOOSE_SW_STATS();
-
-	uint32_t*          cnt_ptr      = CHOOSE_CNTR();
-
-	ipa_nati_tbl_stats nat_stats, idx_stats;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	const char*        mem_type;
+	uint32_t           tbl_hdl    = (uint32_t)(arb_t)    args[0];
+	ipa_nat_ipv4_rule* clnt_rules = (ipa_nat_ipv4_rule*) args[1];
+	uint32_t           num_rules  = (uint32_t)(arb_t)    args[2];
+	uint32_t*          rule_hdls  = (uint32_t*)          args[3];
+	uint32_t*          num_added  = (uint32_t*)          args[4];
 
-	uint64_t           start, stop;
+	arb_t*             new_args[] = {
+		(arb_t*)(arb_t)((nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+		          tbl_hdl :
+		          nati_obj_ptr->ddr_tbl_hdl),
+		(arb_t*) clnt_rules,
+		(arb_t*)(arb_t)num_rules,
+		(arb_t*) rule_hdls,
+		(arb_t*) num_added,
+	};
 
-	int                stats_ret, ret;
+	uint32_t orig2new_map, new2orig_map;
+	uint32_t i;
 
-	bool               collect_stats = (bool) arb_data_ptr;
+	int ret, map_ret = 0;
 
 	IPADBG("In\n");
 
-	stats_ret = (collect_stats) ?
-		ipa_NATI_ipv4_tbl_stats(
-			nati_obj_ptr->ddr_tbl_hdl, &nat_stats, &idx_stats) :
-		-1;
-
-	currTimeAs(TimeAsNanSecs, &start);
+	ret = _smAddRulesToTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
 
 	/*
-	 * First, switch focus to SRAM...
+	 * See _smAddRuleHybrid() above in re rule handle mapping...
 	 */
-	ret = ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_GOTO_SRAM, 0);
+	CHOOSE_MAPS(orig2new_map, new2orig_map);
 
-	if ( ret == 0 )
+	for ( i = 0; i < *num_added && map_ret == 0; i++ )
 	{
-		/*
-		 * Clear destination counter...
-		 */
-		nati_obj_ptr->tot_rules_in_table[SRAM_SUB] = 0;
+		map_ret = ipa_nat_map_add(orig2new_map, rule_hdls[i], rule_hdls[i]);
 
-		/*
-		 * Clear destination SRAM maps...
-		 */
-		ipa_nat_map_clear(nati_obj.map_pairs[SRAM_SUB].orig2new_map);
-		ipa_nat_map_clear(nati_obj.map_pairs[SRAM_SUB].new2orig_map);
+		if ( map_ret == 0 )
+		{
+			map_ret = ipa_nat_map_add(new2orig_map, rule_hdls[i], rule_hdls[i]);
+		}
 
+		if ( map_ret == 0 )
+		{
+			mirror_rule_add(nati_obj_ptr, &clnt_rules[i], rule_hdls[i]);
+		}
+	}
+
+	if ( map_ret == 0 )
+	{
+		run_migration(nati_obj_ptr, false, NULL);
+	}
+
+	if ( map_ret != 0 )
+	{
+		ret = map_ret;
+	}
+	else if ( *num_added < num_rules
+			  &&
+			  nati_obj_ptr->curr_state == NATI_STATE_HYBRID
+			  &&
+			  ! nati_obj_ptr->hold_state )
+	{
 		/*
-		 * Now copy DDR's content to SRAM...
+		 * SRAM is full. Focus on DDR, which causes the copy of data
+		 * from SRAM to DDR, then add what's left there...
 		 */
-		ret = ipa_nati_copy_ipv4_tbl(
-			nati_obj_ptr->ddr_tbl_hdl,
-			nati_obj_ptr->sram_tbl_hdl,
-			migrate_rule);
+		IPAINFO("Add of rule %u of %u failed...attempting table switch\n",
+				*num_added, num_rules);
 
-		currTimeAs(TimeAsNanSecs, &stop);
+		ret = ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_TBL_SWITCH, 0);
 
 		if ( ret == 0 )
 		{
-			sw_stats_ptr->pass += 1;
-
-			IPADBG("Transistion from DDR to SRAM took %f microseconds\n",
-				   (float) (stop - start) / 1000.0);
-		}
-		else
-		{
-			sw_stats_ptr->fail += 1;
-		}
-
-		IPADBG("Transistion pass/fail counts (DDR to SRAM) PASS: %u FAIL: %u\n",
-			   sw_stats_ptr->pass,
-			   sw_stats_ptr->fail);
+			uint32_t rest_added = 0;
+
+			arb_t* rest_args[] = {
+				(arb_t*)(arb_t)tbl_hdl,
+				(arb_t*) &clnt_rules[*num_added],
+				(arb_t*)(arb_t)(num_rules - *num_added),
+				(arb_t*) &rule_hdls[*num_added],
+				(arb_t*) &rest_added,
+			};
 
-		if ( stats_ret == 0 )
-		{
-			mem_type = ipa3_nat_mem_in_as_str(nat_stats.nmi);
+			SET_NATIOBJ_STATE(nati_obj_ptr, NATI_STATE_HYBRID_DDR);
 
 			/*
-			 * NAT table stats...
+			 * Now add the rest of the rules to DDR...
 			 */
-			IPADBG("Able to add (%u) records to %s "
-				   "NAT table of size (%u) or (%f) percent\n",
-				   *cnt_ptr,
-				   mem_type,
-				   nat_stats.tot_ents,
-				   ((float) *cnt_ptr / (float) nat_stats.tot_ents) * 100.0);
-
-			IPADBG("Able to add (%u) records to %s "
-				   "NAT BASE table of size (%u) or (%f) percent\n",
-				   nat_stats.tot_base_ents_filled,
-				   mem_type,
-				   nat_stats.tot_base_ents,
-				   ((float) nat_stats.tot_base_ents_filled /
-					(float) nat_stats.tot_base_ents) * 100.0);
-
-			IPADBG("Able to add (%u) records to %s "
-				   "NAT EXPN table of size (%u) or (%f) percent\n",
-				   nat_stats.tot_expn_ents_filled,
-				   mem_type,
-				   nat_stats.tot_expn_ents,
-				   ((float) nat_stats.tot_expn_ents_filled /
-					(float) nat_stats.tot_expn_ents) * 100.0);
-
-			IPADBG("%s NAT table chains: tot_chains(%u) min_len(%u) max_len(%u) avg_len(%f)\n",
-				   mem_type,
-				   nat_stats.tot_chains,
-				   nat_stats.min_chain_len,
-				   nat_stats.max_chain_len,
-				   nat_stats.avg_chain_len);
+			ret = ipa_nati_statemach(nati_obj_ptr, trigger, (arb_t*) rest_args);
 
-			/*
-			 * INDEX table stats...
-			 */
-			IPADBG("Able to add (%u) records to %s "
-				   "IDX table of size (%u) or (%f) percent\n",
-				   *cnt_ptr,
-				   mem_type,
-				   idx_stats.tot_ents,
-				   ((float) *cnt_ptr / (float) idx_stats.tot_ents) * 100.0);
-
-			IPADBG("Able to add (%u) records to %s "
-				   "IDX BASE table of size (%u) or (%f) percent\n",
-				   idx_stats.tot_base_ents_filled,
-				   mem_type,
-				   idx_stats.tot_base_ents,
-				   ((float) idx_stats.tot_base_ents_filled /
-					(float) idx_stats.tot_base_ents) * 100.0);
-
-			IPADBG("Able to add (%u) records to %s "
-				   "IDX EXPN table of size (%u) or (%f) percent\n",
-				   idx_stats.tot_expn_ents_filled,
-				   mem_type,
-				   idx_stats.tot_expn_ents,
-				   ((float) idx_stats.tot_expn_ents_filled /
-					(float) idx_stats.tot_expn_ents) * 100.0);
-
-			IPADBG("%s IDX table chains: tot_chains(%u) min_len(%u) max_len(%u) avg_len(%f)\n",
-				   mem_type,
-				   idx_stats.tot_chains,
-				   idx_stats.min_chain_len,
-				   idx_stats.max_chain_len,
-				   idx_stats.avg_chain_len);
+			*num_added += rest_added;
 		}
 	}
 
@@ -2168,7 +2840,7 @@ static int _smSwitchFromDdrToSram(
 
 /******************************************************************************/
 /*
- * FUNCTION: _smSwitchFromSramToDdr
+ * FUNCTION: _smDelRulesHybrid
  *
  * PARAMS:
  *
@@ -2180,155 +2852,704 @@ static int _smSwitchFromDdrToSram(
  *
  * DESCRIPTION:
  *
- *   The following will cause a copy of the SRAM table to DDR and then
- *   will make the IPA use the DDR...
+ *   The batch equivalent of _smDelRuleHybrid() above. The original
+ *   rule handles are mapped to their current handles, the batch is
+ *   deleted, and then the switch back to SRAM threshold is checked
+ *   once.
  *
  * RETURNS:
  *
  *   zero on success, otherwise non-zero
  */
-static int _smSwitchFromSramToDdr(
+static int _smDelRulesHybrid(
 	ipa_nati_obj*    nati_obj_ptr,
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	nati_switch_stats* sw_stats_ptr = CHOOSE_SW_STATS();
-
-	uint32_t*          cnt_ptr      = CHOOSE_CNTR();
-
-	ipa_nati_tbl_stats nat_stats, idx_stats;
+	arb_t**   args = (arb_t**) arb_data_ptr;
 
-	const char*        mem_type;
+	uint32_t  tbl_hdl        = (uint32_t)(arb_t) args[0];
+	uint32_t* orig_rule_hdls = (uint32_t*)       args[1];
+	uint32_t  num_rules      = (uint32_t)(arb_t) args[2];
+	uint32_t* num_deleted    = (uint32_t*)       args[3];
 
-	uint64_t           start, stop;
+	uint32_t* new_rule_hdls;
+	uint32_t  num_mapped;
 
-	int                stats_ret, ret;
+	uint32_t  orig2new_map,  new2orig_map;
 
-	bool               collect_stats = (bool) arb_data_ptr;
+	int       ret = 0;
 
 	IPADBG("In\n");
 
-	stats_ret = (collect_stats) ?
-		ipa_NATI_ipv4_tbl_stats(
-			nati_obj_ptr->sram_tbl_hdl, &nat_stats, &idx_stats) :
-		-1;
+	*num_deleted = 0;
 
-	currTimeAs(TimeAsNanSecs, &start);
+	new_rule_hdls = (uint32_t*) malloc(num_rules * sizeof(uint32_t));
+
+	if ( new_rule_hdls == NULL )
+	{
+		IPAERR("Unable to allocate memory for %u rule handles\n", num_rules);
+		ret = -ENOMEM;
+		goto bail;
+	}
 
 	/*
-	 * First, switch focus to DDR...
+	 * See _smDelRuleHybrid() above in re rule handle mapping...
 	 */
-	ret = ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_GOTO_DDR, 0);
+	CHOOSE_MAPS(orig2new_map, new2orig_map);
 
-	if ( ret == 0 )
+	for ( num_mapped = 0; num_mapped < num_rules; num_mapped++ )
 	{
-		/*
-		 * Clear destination counter...
-		 */
-		nati_obj_ptr->tot_rules_in_table[DDR_SUB] = 0;
+		if ( ipa_nat_map_find(
+				 orig2new_map,
+				 orig_rule_hdls[num_mapped],
+				 &new_rule_hdls[num_mapped]) != 0 )
+		{
+			IPAERR("No mapping for orig_rule_hdl(0x%08X)\n",
+				   orig_rule_hdls[num_mapped]);
+			ret = -EINVAL;
+			break;
+		}
+	}
 
-		/*
-		 * Clear destination DDR maps...
-		 */
-		ipa_nat_map_clear(nati_obj.map_pairs[DDR_SUB].orig2new_map);
-		ipa_nat_map_clear(nati_obj.map_pairs[DDR_SUB].new2orig_map);
+	if ( num_mapped )
+	{
+		arb_t* new_args[]  = {
+			(arb_t*)(arb_t)((nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+			         tbl_hdl :
+			         nati_obj_ptr->ddr_tbl_hdl),
+			(arb_t*) new_rule_hdls,
+			(arb_t*)(arb_t)num_mapped,
+			(arb_t*) num_deleted,
+		};
 
-		/*
-		 * Now copy SRAM's content to DDR...
-		 */
-		ret = ipa_nati_copy_ipv4_tbl(
-			nati_obj_ptr->sram_tbl_hdl,
-			nati_obj_ptr->ddr_tbl_hdl,
-			migrate_rule);
+		int del_ret = _smDelRulesFromTbl(nati_obj_ptr, trigger, (arb_t*) new_args);
 
-		currTimeAs(TimeAsNanSecs, &stop);
+		ret = (ret) ? ret : del_ret;
+	}
 
-		if ( ret == 0 )
+	for ( num_mapped = 0; num_mapped < *num_deleted; num_mapped++ )
+	{
+		ipa_nat_map_del(orig2new_map, orig_rule_hdls[num_mapped], NULL);
+		ipa_nat_map_del(new2orig_map, new_rule_hdls[num_mapped], NULL);
+
+		mirror_rule_del(nati_obj_ptr, orig_rule_hdls[num_mapped]);
+	}
+
+	if ( *num_deleted )
+	{
+		run_migration(nati_obj_ptr, false, NULL);
+	}
+
+	if ( *num_deleted && nati_obj_ptr->curr_state == NATI_STATE_HYBRID_DDR )
+	{
+		uint32_t* cnt_ptr = CHOOSE_CNTR();
+
+		if ( *cnt_ptr <= nati_obj_ptr->back_to_sram_thresh
+			 &&
+			 ! nati_obj_ptr->hold_state
+			 &&
+			 ! nati_obj_ptr->migration.in_progress )
 		{
-			sw_stats_ptr->pass += 1;
+			IPAINFO("Switch back to SRAM threshold has been reached -> "
+					"Total rules in DDR(%u) <= SRAM THRESH(%u)\n",
+					*cnt_ptr,
+					nati_obj_ptr->back_to_sram_thresh);
 
-			IPADBG("Transistion from SRAM to DDR took %f microseconds\n",
-				   (float) (stop - start) / 1000.0);
+			/*
+			 * On failure, we stay in DDR for now and the next
+			 * delete will try again...
+			 */
+			if ( nati_obj_ptr->migration.chunk_size )
+			{
+				run_migration(nati_obj_ptr, true, NULL);
+			}
+			else if ( ipa_nati_statemach(nati_obj_ptr, NATI_TRIG_TBL_SWITCH, 0) == 0 )
+			{
+				SET_NATIOBJ_STATE(nati_obj_ptr, NATI_STATE_HYBRID);
+			}
 		}
-		else
+	}
+
+	free(new_rule_hdls);
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/******************************************************************************/
+/*
+ * FUNCTION: _smGoToDdr
+ *
+ * PARAMS:
+ *
+ *   nati_obj_ptr (IN) A pointer to an initialized nati object
+ *
+ *   trigger      (IN) The trigger to run through the state machine
+ *
+ *   arb_data_ptr (IN) Whatever you like
+ *
+ * DESCRIPTION:
+ *
+ *   The following will cause the IPA to use the DDR based NAT
+ *   table...
+ *
+ * RETURNS:
+ *
+ *   zero on success, otherwise non-zero
+ */
+static int _smGoToDdr(
+	ipa_nati_obj*    nati_obj_ptr,
+	ipa_nati_trigger trigger,
+	arb_t*           arb_data_ptr )
+{
+	int ret;
+
+	IPADBG("In\n");
+
+	ret = ipa_NATI_post_ipv4_init_cmd(nati_obj_ptr->ddr_tbl_hdl);
+
+	if ( ret == 0 )
+	{
+		SET_NATIOBJ_STATE(nati_obj_ptr, NATI_STATE_HYBRID_DDR);
+	}
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/******************************************************************************/
+/*
+ * FUNCTION: _smGoToSram
+ *
+ * PARAMS:
+ *
+ *   nati_obj_ptr (IN) A pointer to an initialized nati object
+ *
+ *   trigger      (IN) The trigger to run through the state machine
+ *
+ *   arb_data_ptr (IN) Whatever you like
+ *
+ * DESCRIPTION:
+ *
+ *   The following will cause the IPA to use the SRAM based NAT
+ *   table...
+ *
+ * RETURNS:
+ *
+ *   zero on success, otherwise non-zero
+ */
+static int _smGoToSram(
+	ipa_nati_obj*    nati_obj_ptr,
+	ipa_nati_trigger trigger,
+	arb_t*           arb_data_ptr )
+{
+	int ret;
+
+	IPADBG("In\n");
+
+	ret = ipa_NATI_post_ipv4_init_cmd(nati_obj_ptr->sram_tbl_hdl);
+
+	if ( ret == 0 )
+	{
+		SET_NATIOBJ_STATE(nati_obj_ptr, NATI_STATE_HYBRID);
+	}
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/******************************************************************************/
+/*
+ * FUNCTION: _smMigrate
+ *
+ * PARAMS:
+ *
+ *   nati_obj_ptr (IN) A pointer to an initialized nati object
+ *
+ *   trigger      (IN) The trigger to run through the state machine
+ *
+ *   arb_data_ptr (IN) An array of: the most rules to copy, whether to
+ *                     start a migration if none is in progress, and
+ *                     where to say whether the migration is done (can
+ *                     be NULL)
+ *
+ * DESCRIPTION:
+ *
+ *   The following copies the next chunk of rules from the table in
+ *   use to the table in the other memory type. When the whole table
+ *   has been copied, the IPA is told to use the copy.
+ *
+ *   Only the copy is written to, and the IPA isn't looking at it, so
+ *   the nat mutex need only be held for the chunk. Rule adds and
+ *   deletes between chunks are mirrored to the copy (see
+ *   mirror_rule_add() and mirror_rule_del()).
+ *
+ * RETURNS:
+ *
+ *   zero on success, otherwise non-zero
+ */
+static int _smMigrate(
+	ipa_nati_obj*    nati_obj_ptr,
+	ipa_nati_trigger trigger,
+	arb_t*           arb_data_ptr )
+{
+	arb_t** args = (arb_t**) arb_data_ptr;
+
+	uint32_t           max_rules = (uint32_t)(arb_t) args[0];
+	bool               begin     = (bool)(arb_t)     args[1];
+	bool*              done_ptr  = (bool*)           args[2];
+
+	nati_migration*    mig_ptr   = &nati_obj_ptr->migration;
+
+	migrate_chunk_help help;
+
+	uint32_t           dst_sub;
+
+	uint64_t           start, cut_start, stop;
+
+	int                ret = 0;
+
+	IPADBG("In\n");
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	if ( ! mig_ptr->in_progress )
+	{
+		if ( ! begin )
 		{
-			sw_stats_ptr->fail += 1;
+			goto done;
 		}
 
-		IPADBG("Transistion pass/fail counts (SRAM to DDR) PASS: %u FAIL: %u\n",
-			   sw_stats_ptr->pass,
-			   sw_stats_ptr->fail);
+		mig_ptr->src_sub = CHOOSE_MEM_SUB();
 
-		if ( stats_ret == 0 )
-		{
-			mem_type = ipa3_nat_mem_in_as_str(nat_stats.nmi);
+		dst_sub = MIGRATION_DST_SUB();
 
-			/*
-			 * NAT table stats...
-			 */
-			IPADBG("Able to add (%u) records to %s "
-				   "NAT table of size (%u) or (%f) percent\n",
-				   *cnt_ptr,
-				   mem_type,
-				   nat_stats.tot_ents,
-				   ((float) *cnt_ptr / (float) nat_stats.tot_ents) * 100.0);
-
-			IPADBG("Able to add (%u) records to %s "
-				   "NAT BASE table of size (%u) or (%f) percent\n",
-				   nat_stats.tot_base_ents_filled,
-				   mem_type,
-				   nat_stats.tot_base_ents,
-				   ((float) nat_stats.tot_base_ents_filled /
-					(float) nat_stats.tot_base_ents) * 100.0);
-
-			IPADBG("Able to add (%u) records to %s "
-				   "NAT EXPN table of size (%u) or (%f) percent\n",
-				   nat_stats.tot_expn_ents_filled,
-				   mem_type,
-				   nat_stats.tot_expn_ents,
-				   ((float) nat_stats.tot_expn_ents_filled /
-					(float) nat_stats.tot_expn_ents) * 100.0);
-
-			IPADBG("%s NAT table chains: tot_chains(%u) min_len(%u) max_len(%u) avg_len(%f)\n",
-				   mem_type,
-				   nat_stats.tot_chains,
-				   nat_stats.min_chain_len,
-				   nat_stats.max_chain_len,
-				   nat_stats.avg_chain_len);
+		/*
+		 * Clear destination counter, maps and table...
+		 */
+		nati_obj_ptr->tot_rules_in_table[dst_sub] = 0;
 
-			/*
-			 * INDEX table stats...
-			 */
-			IPADBG("Able to add (%u) records to %s "
-				   "IDX table of size (%u) or (%f) percent\n",
-				   *cnt_ptr,
-				   mem_type,
-				   idx_stats.tot_ents,
-				   ((float) *cnt_ptr / (float) idx_stats.tot_ents) * 100.0);
-
-			IPADBG("Able to add (%u) records to %s "
-				   "IDX BASE table of size (%u) or (%f) percent\n",
-				   idx_stats.tot_base_ents_filled,
-				   mem_type,
-				   idx_stats.tot_base_ents,
-				   ((float) idx_stats.tot_base_ents_filled /
-					(float) idx_stats.tot_base_ents) * 100.0);
-
-			IPADBG("Able to add (%u) records to %s "
-				   "IDX EXPN table of size (%u) or (%f) percent\n",
-				   idx_stats.tot_expn_ents_filled,
-				   mem_type,
-				   idx_stats.tot_expn_ents,
-				   ((float) idx_stats.tot_expn_ents_filled /
-					(float) idx_stats.tot_expn_ents) * 100.0);
-
-			IPADBG("%s IDX table chains: tot_chains(%u) min_len(%u) max_len(%u) avg_len(%f)\n",
-				   mem_type,
-				   idx_stats.tot_chains,
-				   idx_stats.min_chain_len,
-				   idx_stats.max_chain_len,
-				   idx_stats.avg_chain_len);
+		ipa_nat_map_clear(nati_obj_ptr->map_pairs[dst_sub].orig2new_map);
+		ipa_nat_map_clear(nati_obj_ptr->map_pairs[dst_sub].new2orig_map);
+
+		ret = ipa_NATI_clear_ipv4_tbl(MIGRATION_TBL_HDL(dst_sub));
+
+		if ( ret != 0 )
+		{
+			goto bail;
 		}
+
+		mig_ptr->next_index     = 0;
+		mig_ptr->tot_slots      = 0;
+		mig_ptr->rules_copied   = 0;
+		mig_ptr->rules_mirrored = 0;
+		mig_ptr->chunks         = 0;
+		mig_ptr->start_ns       = start;
+		mig_ptr->in_progress    = true;
+
+		IPADBG("Starting migration to %s\n",
+			   (dst_sub == SRAM_SUB) ? "SRAM" : "DDR");
+	}
+
+	dst_sub = MIGRATION_DST_SUB();
+
+	help.dst_tbl_hdl = MIGRATION_TBL_HDL(dst_sub);
+	help.max_rules   = max_rules;
+	help.cnt         = 0;
+
+	ret = ipa_NATI_walk_ipv4_tbl_from(
+		MIGRATION_TBL_HDL(mig_ptr->src_sub),
+		USE_NAT_TABLE,
+		mig_ptr->next_index,
+		migrate_rule_chunk,
+		&help);
+
+	mig_ptr->chunks++;
+
+	if ( ret < 0 )
+	{
+		abort_migration(nati_obj_ptr);
+		goto bail;
+	}
+
+	if ( ret > 0 )
+	{
+		/*
+		 * Chunk is full, but there's more to copy...
+		 */
+		IPADBG("Migrated through slot %u of %u\n",
+			   mig_ptr->next_index, mig_ptr->tot_slots);
+		ret = 0;
+		goto done;
+	}
+
+	/*
+	 * All copied, so have the IPA use the copy...
+	 */
+	mig_ptr->next_index = mig_ptr->tot_slots;
+
+	currTimeAs(TimeAsNanSecs, &cut_start);
+
+	ipa_nati_statemach(
+		nati_obj_ptr,
+		(dst_sub == SRAM_SUB) ? NATI_TRIG_GOTO_SRAM : NATI_TRIG_GOTO_DDR,
+		0);
+
+	currTimeAs(TimeAsNanSecs, &stop);
+
+	/*
+	 * The state machine doesn't hand back its callback's return
+	 * value, so see if the state moved...
+	 */
+	if ( CHOOSE_MEM_SUB() != dst_sub )
+	{
+		IPAERR("Unable to point the IPA at the %s table\n",
+			   (dst_sub == SRAM_SUB) ? "SRAM" : "DDR");
+		abort_migration(nati_obj_ptr);
+		ret = -EIO;
+		goto bail;
+	}
+
+	mig_ptr->in_progress      = false;
+	mig_ptr->completed       += 1;
+	mig_ptr->last_cutover_ns  = stop - cut_start;
+	mig_ptr->last_duration_ns = stop - mig_ptr->start_ns;
+
+	IPADBG("Migration to %s done: %u rules copied, %u mirrored, "
+		   "%u chunks, cutover took %f microseconds\n",
+		   (dst_sub == SRAM_SUB) ? "SRAM" : "DDR",
+		   mig_ptr->rules_copied,
+		   mig_ptr->rules_mirrored,
+		   mig_ptr->chunks,
+		   (float) mig_ptr->last_cutover_ns / 1000.0);
+
+done:
+	if ( done_ptr )
+	{
+		*done_ptr = ! mig_ptr->in_progress;
+	}
+
+bail:
+	currTimeAs(TimeAsNanSecs, &stop);
+
+	if ( stop - start > mig_ptr->max_hold_ns )
+	{
+		mig_ptr->max_hold_ns = stop - start;
+	}
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/******************************************************************************/
+/*
+ * FUNCTION: _smSwitchFromDdrToSram
+ *
+ * PARAMS:
+ *
+ *   nati_obj_ptr (IN) A pointer to an initialized nati object
+ *
+ *   trigger      (IN) The trigger to run through the state machine
+ *
+ *   arb_data_ptr (IN) Whatever you like
+ *
+ * DESCRIPTION:
+ *
+ *   The following will cause a copy of the DDR table to SRAM and then
+ *   will make the IPA use the SRAM...
+ *
+ * RETURNS:
+ *
+ *   zero on success, otherwise non-zero
+ */
+static int _smSwitchFromDdrToSram(
+	ipa_nati_obj*    nati_obj_ptr,
+	ipa_nati_trigger trigger,
+	arb_t*           arb_data_ptr )
+{
+	nati_switch_stats* sw_stats_ptr = CHOOSE_SW_STATS();
+
+	uint32_t*          cnt_ptr      = CHOOSE_CNTR();
+
+	ipa_nati_tbl_stats nat_stats, idx_stats;
+
+	const char*        mem_type;
+
+	uint64_t           start, stop;
+
+	int                stats_ret, ret;
+
+	bool               collect_stats = (bool) arb_data_ptr;
+
+	arb_t*             mig_args[] = {
+		(arb_t*)(arb_t) UINT32_MAX,
+		(arb_t*)(arb_t) true,
+		NULL,
+	};
+
+	IPADBG("In\n");
+
+	stats_ret = (collect_stats) ?
+		ipa_NATI_ipv4_tbl_stats(
+			nati_obj_ptr->ddr_tbl_hdl, &nat_stats, &idx_stats) :
+		-1;
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	/*
+	 * Copy DDR's content to SRAM, and only then have the IPA use SRAM.
+	 * An incremental migration already under way is finished off...
+	 */
+	ret = _smMigrate(nati_obj_ptr, trigger, (arb_t*) mig_args);
+
+	currTimeAs(TimeAsNanSecs, &stop);
+
+	if ( ret == 0 )
+	{
+		sw_stats_ptr->pass += 1;
+
+		IPADBG("Transistion from DDR to SRAM took %f microseconds\n",
+			   (float) (stop - start) / 1000.0);
+	}
+	else
+	{
+		sw_stats_ptr->fail += 1;
+	}
+
+	IPADBG("Transistion pass/fail counts (DDR to SRAM) PASS: %u FAIL: %u\n",
+		   sw_stats_ptr->pass,
+		   sw_stats_ptr->fail);
+
+	if ( stats_ret == 0 )
+	{
+		mem_type = ipa3_nat_mem_in_as_str(nat_stats.nmi);
+
+		/*
+		 * NAT table stats...
+		 */
+		IPADBG("Able to add (%u) records to %s "
+			   "NAT table of size (%u) or (%f) percent\n",
+			   *cnt_ptr,
+			   mem_type,
+			   nat_stats.tot_ents,
+			   ((float) *cnt_ptr / (float) nat_stats.tot_ents) * 100.0);
+
+		IPADBG("Able to add (%u) records to %s "
+			   "NAT BASE table of size (%u) or (%f) percent\n",
+			   nat_stats.tot_base_ents_filled,
+			   mem_type,
+			   nat_stats.tot_base_ents,
+			   ((float) nat_stats.tot_base_ents_filled /
+				(float) nat_stats.tot_base_ents) * 100.0);
+
+		IPADBG("Able to add (%u) records to %s "
+			   "NAT EXPN table of size (%u) or (%f) percent\n",
+			   nat_stats.tot_expn_ents_filled,
+			   mem_type,
+			   nat_stats.tot_expn_ents,
+			   ((float) nat_stats.tot_expn_ents_filled /
+				(float) nat_stats.tot_expn_ents) * 100.0);
+
+		IPADBG("%s NAT table chains: tot_chains(%u) min_len(%u) max_len(%u) avg_len(%f)\n",
+			   mem_type,
+			   nat_stats.tot_chains,
+			   nat_stats.min_chain_len,
+			   nat_stats.max_chain_len,
+			   nat_stats.avg_chain_len);
+
+		/*
+		 * INDEX table stats...
+		 */
+		IPADBG("Able to add (%u) records to %s "
+			   "IDX table of size (%u) or (%f) percent\n",
+			   *cnt_ptr,
+			   mem_type,
+			   idx_stats.tot_ents,
+			   ((float) *cnt_ptr / (float) idx_stats.tot_ents) * 100.0);
+
+		IPADBG("Able to add (%u) records to %s "
+			   "IDX BASE table of size (%u) or (%f) percent\n",
+			   idx_stats.tot_base_ents_filled,
+			   mem_type,
+			   idx_stats.tot_base_ents,
+			   ((float) idx_stats.tot_base_ents_filled /
+				(float) idx_stats.tot_base_ents) * 100.0);
+
+		IPADBG("Able to add (%u) records to %s "
+			   "IDX EXPN table of size (%u) or (%f) percent\n",
+			   idx_stats.tot_expn_ents_filled,
+			   mem_type,
+			   idx_stats.tot_expn_ents,
+			   ((float) idx_stats.tot_expn_ents_filled /
+				(float) idx_stats.tot_expn_ents) * 100.0);
+
+		IPADBG("%s IDX table chains: tot_chains(%u) min_len(%u) max_len(%u) avg_len(%f)\n",
+			   mem_type,
+			   idx_stats.tot_chains,
+			   idx_stats.min_chain_len,
+			   idx_stats.max_chain_len,
+			   idx_stats.avg_chain_len);
+	}
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/******************************************************************************/
+/*
+ * FUNCTION: _smSwitchFromSramToDdr
+ *
+ * PARAMS:
+ *
+ *   nati_obj_ptr (IN) A pointer to an initialized nati object
+ *
+ *   trigger      (IN) The trigger to run through the state machine
+ *
+ *   arb_data_ptr (IN) Whatever you like
+ *
+ * DESCRIPTION:
+ *
+ *   The following will cause a copy of the SRAM table to DDR and then
+ *   will make the IPA use the DDR...
+ *
+ * RETURNS:
+ *
+ *   zero on success, otherwise non-zero
+ */
+static int _smSwitchFromSramToDdr(
+	ipa_nati_obj*    nati_obj_ptr,
+	ipa_nati_trigger trigger,
+	arb_t*           arb_data_ptr )
+{
+	nati_switch_stats* sw_stats_ptr = CHOOSE_SW_STATS();
+
+	uint32_t*          cnt_ptr      = CHOOSE_CNTR();
+
+	ipa_nati_tbl_stats nat_stats, idx_stats;
+
+	const char*        mem_type;
+
+	uint64_t           start, stop;
+
+	int                stats_ret, ret;
+
+	bool               collect_stats = (bool) arb_data_ptr;
+
+	arb_t*             mig_args[] = {
+		(arb_t*)(arb_t) UINT32_MAX,
+		(arb_t*)(arb_t) true,
+		NULL,
+	};
+
+	IPADBG("In\n");
+
+	stats_ret = (collect_stats) ?
+		ipa_NATI_ipv4_tbl_stats(
+			nati_obj_ptr->sram_tbl_hdl, &nat_stats, &idx_stats) :
+		-1;
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	/*
+	 * Copy SRAM's content to DDR, and only then have the IPA use DDR.
+	 * An incremental migration already under way is finished off...
+	 */
+	ret = _smMigrate(nati_obj_ptr, trigger, (arb_t*) mig_args);
+
+	currTimeAs(TimeAsNanSecs, &stop);
+
+	if ( ret == 0 )
+	{
+		sw_stats_ptr->pass += 1;
+
+		IPADBG("Transistion from SRAM to DDR took %f microseconds\n",
+			   (float) (stop - start) / 1000.0);
+	}
+	else
+	{
+		sw_stats_ptr->fail += 1;
+	}
+
+	IPADBG("Transistion pass/fail counts (SRAM to DDR) PASS: %u FAIL: %u\n",
+		   sw_stats_ptr->pass,
+		   sw_stats_ptr->fail);
+
+	if ( stats_ret == 0 )
+	{
+		mem_type = ipa3_nat_mem_in_as_str(nat_stats.nmi);
+
+		/*
+		 * NAT table stats...
+		 */
+		IPADBG("Able to add (%u) records to %s "
+			   "NAT table of size (%u) or (%f) percent\n",
+			   *cnt_ptr,
+			   mem_type,
+			   nat_stats.tot_ents,
+			   ((float) *cnt_ptr / (float) nat_stats.tot_ents) * 100.0);
+
+		IPADBG("Able to add (%u) records to %s "
+			   "NAT BASE table of size (%u) or (%f) percent\n",
+			   nat_stats.tot_base_ents_filled,
+			   mem_type,
+			   nat_stats.tot_base_ents,
+			   ((float) nat_stats.tot_base_ents_filled /
+				(float) nat_stats.tot_base_ents) * 100.0);
+
+		IPADBG("Able to add (%u) records to %s "
+			   "NAT EXPN table of size (%u) or (%f) percent\n",
+			   nat_stats.tot_expn_ents_filled,
+			   mem_type,
+			   nat_stats.tot_expn_ents,
+			   ((float) nat_stats.tot_expn_ents_filled /
+				(float) nat_stats.tot_expn_ents) * 100.0);
+
+		IPADBG("%s NAT table chains: tot_chains(%u) min_len(%u) max_len(%u) avg_len(%f)\n",
+			   mem_type,
+			   nat_stats.tot_chains,
+			   nat_stats.min_chain_len,
+			   nat_stats.max_chain_len,
+			   nat_stats.avg_chain_len);
+
+		/*
+		 * INDEX table stats...
+		 */
+		IPADBG("Able to add (%u) records to %s "
+			   "IDX table of size (%u) or (%f) percent\n",
+			   *cnt_ptr,
+			   mem_type,
+			   idx_stats.tot_ents,
+			   ((float) *cnt_ptr / (float) idx_stats.tot_ents) * 100.0);
+
+		IPADBG("Able to add (%u) records to %s "
+			   "IDX BASE table of size (%u) or (%f) percent\n",
+			   idx_stats.tot_base_ents_filled,
+			   mem_type,
+			   idx_stats.tot_base_ents,
+			   ((float) idx_stats.tot_base_ents_filled /
+				(float) idx_stats.tot_base_ents) * 100.0);
+
+		IPADBG("Able to add (%u) records to %s "
+			   "IDX EXPN table of size (%u) or (%f) percent\n",
+			   idx_stats.tot_expn_ents_filled,
+			   mem_type,
+			   idx_stats.tot_expn_ents,
+			   ((float) idx_stats.tot_expn_ents_filled /
+				(float) idx_stats.tot_expn_ents) * 100.0);
+
+		IPADBG("%s IDX table chains: tot_chains(%u) min_len(%u) max_len(%u) avg_len(%f)\n",
+			   mem_type,
+			   idx_stats.tot_chains,
+			   idx_stats.min_chain_len,
+			   idx_stats.max_chain_len,
+			   idx_stats.avg_chain_len);
 	}
 
 	IPADBG("Out\n");
@@ -2361,11 +3582,11 @@ static int _smGetTmStmp(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t** args = arb_data_ptr;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	uint32_t  tbl_hdl    = (uint32_t)  args[0];
-	uint32_t  rule_hdl   = (uint32_t)  args[1];
-	uint32_t* time_stamp = (uint32_t*) args[2];
+	uint32_t  tbl_hdl    = (uint32_t)(arb_t) args[0];
+	uint32_t  rule_hdl   = (uint32_t)(arb_t) args[1];
+	uint32_t* time_stamp = (uint32_t*)       args[2];
 
 	int ret;
 
@@ -2411,35 +3632,35 @@ static int _smGetTmStmpHybrid(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	arb_t** args = arb_data_ptr;
+	arb_t** args = (arb_t**) arb_data_ptr;
 
-	uint32_t  tbl_hdl       = (uint32_t)  args[0];
-	uint32_t  orig_rule_hdl = (uint32_t)  args[1];
-	uint32_t* time_stamp    = (uint32_t*) args[2];
+	uint32_t  tbl_hdl       = (uint32_t)(arb_t) args[0];
+	uint32_t  orig_rule_hdl = (uint32_t)(arb_t) args[1];
+	uint32_t* time_stamp    = (uint32_t*)       args[2];
 
 	uint32_t  new_rule_hdl;
 
-	uint32_t  orig2new_map, new2orig_map;
+	uint32_t  orig2new_map;
 
 	int       ret;
 
 	IPADBG("In\n");
 
-	CHOOSE_MAPS(orig2new_map, new2orig_map);
+	orig2new_map = nati_obj.map_pairs[CHOOSE_MEM_SUB()].orig2new_map;
 
 	ret = ipa_nat_map_find(orig2new_map, orig_rule_hdl, &new_rule_hdl);
 
 	if ( ret == 0 )
 	{
 		arb_t* new_args[] = {
-			(arb_t*)(arb_t)(nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
-			         tbl_hdl :
-			         nati_obj_ptr->ddr_tbl_hdl,
+			(arb_t*)(arb_t)((nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+			          tbl_hdl :
+			          nati_obj_ptr->ddr_tbl_hdl),
 			(arb_t*)(arb_t)new_rule_hdl,
 			(arb_t*) time_stamp,
 		};
 
-		ret = _smGetTmStmp(nati_obj_ptr, trigger, new_args);
+		ret = _smGetTmStmp(nati_obj_ptr, trigger, (arb_t*) new_args);
 	}
 
 	IPADBG("Out\n");
@@ -2447,6 +3668,173 @@ static int _smGetTmStmpHybrid(
 	return ret;
 }
 
+/******************************************************************************/
+/*
+ * FUNCTION: _smAgeTbl
+ *
+ * PARAMS:
+ *
+ *   nati_obj_ptr (IN) A pointer to an initialized nati object
+ *
+ *   trigger      (IN) The trigger to run through the state machine
+ *
+ *   arb_data_ptr (IN) Whatever you like
+ *
+ * DESCRIPTION:
+ *
+ *   Sweep the currently used table for rules whose timestamps haven't
+ *   moved in the given idle time and, when asked, delete them.
+ *
+ * RETURNS:
+ *
+ *   zero on success, otherwise non-zero
+ */
+static int _smAgeTbl(
+	ipa_nati_obj*    nati_obj_ptr,
+	ipa_nati_trigger trigger,
+	arb_t*           arb_data_ptr )
+{
+	arb_t** args = (arb_t**) arb_data_ptr;
+
+	uint32_t  tbl_hdl     = (uint32_t)(arb_t) args[0];
+	uint32_t  idle_ms     = (uint32_t)(arb_t) args[1];
+	bool      del_expired = (bool)(arb_t)     args[2];
+	uint32_t* rule_hdls   = (uint32_t*)       args[3];
+	uint32_t  max_hdls    = (uint32_t)(arb_t) args[4];
+	uint32_t* num_expired = (uint32_t*)       args[5];
+
+	int ret;
+
+	IPADBG("In\n");
+
+	IPADBG("tbl_hdl(0x%08X) idle_ms(%u) del_expired(%u) max_hdls(%u)\n",
+		   tbl_hdl, idle_ms, del_expired, max_hdls);
+
+	ret = ipa_NATI_age_ipv4_tbl(
+		tbl_hdl, idle_ms, rule_hdls, max_hdls, num_expired);
+
+	if ( ret == 0 && del_expired && *num_expired )
+	{
+		uint32_t num_deleted = 0;
+
+		arb_t* del_args[] = {
+			(arb_t*)(arb_t)tbl_hdl,
+			(arb_t*) rule_hdls,
+			(arb_t*)(arb_t)*num_expired,
+			(arb_t*) &num_deleted,
+		};
+
+		ret = _smDelRulesFromTbl(nati_obj_ptr, trigger, (arb_t*) del_args);
+
+		if ( ret == 0 && num_deleted != *num_expired )
+		{
+			IPAERR("Only %u of %u expired rules deleted\n",
+				   num_deleted, *num_expired);
+			ret = -EIO;
+		}
+	}
+
+	IPADBG("Out\n");
+
+	return ret;
+}
+
+/******************************************************************************/
+/*
+ * FUNCTION: _smAgeTblHybrid
+ *
+ * PARAMS:
+ *
+ *   nati_obj_ptr (IN) A pointer to an initialized nati object
+ *
+ *   trigger      (IN) The trigger to run through the state machine
+ *
+ *   arb_data_ptr (IN) Whatever you like
+ *
+ * DESCRIPTION:
+ *
+ *   Sweep the state appropriate table, then hand back the expired
+ *   rules' original handles, which are what the caller knows them
+ *   by.
+ *
+ * RETURNS:
+ *
+ *   zero on success, otherwise non-zero
+ */
+static int _smAgeTblHybrid(
+	ipa_nati_obj*    nati_obj_ptr,
+	ipa_nati_trigger trigger,
+	arb_t*           arb_data_ptr )
+{
+	arb_t** args = (arb_t**) arb_data_ptr;
+
+	uint32_t  tbl_hdl     = (uint32_t)(arb_t) args[0];
+	uint32_t  idle_ms     = (uint32_t)(arb_t) args[1];
+	bool      del_expired = (bool)(arb_t)     args[2];
+	uint32_t* rule_hdls   = (uint32_t*)       args[3];
+	uint32_t  max_hdls    = (uint32_t)(arb_t) args[4];
+	uint32_t* num_expired = (uint32_t*)       args[5];
+
+	uint32_t  new2orig_map;
+	uint32_t  i;
+
+	int       ret;
+
+	IPADBG("In\n");
+
+	ret = ipa_NATI_age_ipv4_tbl(
+		(nati_obj_ptr->curr_state == NATI_STATE_HYBRID) ?
+		tbl_hdl :
+		nati_obj_ptr->ddr_tbl_hdl,
+		idle_ms, rule_hdls, max_hdls, num_expired);
+
+	if ( ret != 0 )
+	{
+		goto bail;
+	}
+
+	/*
+	 * See _smDelRuleHybrid() above in re rule handle mapping...
+	 */
+	new2orig_map = nati_obj.map_pairs[CHOOSE_MEM_SUB()].new2orig_map;
+
+	for ( i = 0; i < *num_expired; i++ )
+	{
+		if ( ipa_nat_map_find(new2orig_map, rule_hdls[i], &rule_hdls[i]) != 0 )
+		{
+			IPAERR("No mapping for new_rule_hdl(0x%08X)\n", rule_hdls[i]);
+			ret = -EINVAL;
+			goto bail;
+		}
+	}
+
+	if ( del_expired && *num_expired )
+	{
+		uint32_t num_deleted = 0;
+
+		arb_t* del_args[] = {
+			(arb_t*)(arb_t)tbl_hdl,
+			(arb_t*) rule_hdls,
+			(arb_t*)(arb_t)*num_expired,
+			(arb_t*) &num_deleted,
+		};
+
+		ret = _smDelRulesHybrid(nati_obj_ptr, trigger, (arb_t*) del_args);
+
+		if ( ret == 0 && num_deleted != *num_expired )
+		{
+			IPAERR("Only %u of %u expired rules deleted\n",
+				   num_deleted, *num_expired);
+			ret = -EIO;
+		}
+	}
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
 /******************************************************************************/
 /*
  * The following table relates a nati object's state and a transition
@@ -2468,6 +3856,10 @@ _state_mach_tbl[NATI_STATE_LAST+1][NATI_TRIG_LAST+1] =
 		SM_ROW( NATI_STATE_NULL,       NATI_TRIG_GOTO_DDR,   _smUndef ),
 		SM_ROW( NATI_STATE_NULL,       NATI_TRIG_GOTO_SRAM,  _smUndef ),
 		SM_ROW( NATI_STATE_NULL,       NATI_TRIG_GET_TSTAMP, _smUndef ),
+		SM_ROW( NATI_STATE_NULL,       NATI_TRIG_ADD_RULES,  _smUndef ),
+		SM_ROW( NATI_STATE_NULL,       NATI_TRIG_DEL_RULES,  _smUndef ),
+		SM_ROW( NATI_STATE_NULL,       NATI_TRIG_MIGRATE,    _smUndef ),
+		SM_ROW( NATI_STATE_NULL,       NATI_TRIG_AGE_RULES,  _smUndef ),
 		SM_ROW( NATI_STATE_NULL,       NATI_TRIG_LAST,       _smUndef ),
 	},
 
@@ -2484,6 +3876,10 @@ _state_mach_tbl[NATI_STATE_LAST+1][NATI_TRIG_LAST+1] =
 		SM_ROW( NATI_STATE_DDR_ONLY,   NATI_TRIG_GOTO_DDR,   _smUndef ),
 		SM_ROW( NATI_STATE_DDR_ONLY,   NATI_TRIG_GOTO_SRAM,  _smUndef ),
 		SM_ROW( NATI_STATE_DDR_ONLY,   NATI_TRIG_GET_TSTAMP, _smGetTmStmp ),
+		SM_ROW( NATI_STATE_DDR_ONLY,   NATI_TRIG_ADD_RULES,  _smAddRulesToTbl ),
+		SM_ROW( NATI_STATE_DDR_ONLY,   NATI_TRIG_DEL_RULES,  _smDelRulesFromTbl ),
+		SM_ROW( NATI_STATE_DDR_ONLY,   NATI_TRIG_MIGRATE,    _smUndef ),
+		SM_ROW( NATI_STATE_DDR_ONLY,   NATI_TRIG_AGE_RULES,  _smAgeTbl ),
 		SM_ROW( NATI_STATE_DDR_ONLY,   NATI_TRIG_LAST,       _smUndef ),
 	},
 
@@ -2500,6 +3896,10 @@ _state_mach_tbl[NATI_STATE_LAST+1][NATI_TRIG_LAST+1] =
 		SM_ROW( NATI_STATE_SRAM_ONLY,  NATI_TRIG_GOTO_DDR,   _smUndef ),
 		SM_ROW( NATI_STATE_SRAM_ONLY,  NATI_TRIG_GOTO_SRAM,  _smUndef ),
 		SM_ROW( NATI_STATE_SRAM_ONLY,  NATI_TRIG_GET_TSTAMP, _smGetTmStmp ),
+		SM_ROW( NATI_STATE_SRAM_ONLY,  NATI_TRIG_ADD_RULES,  _smAddRulesToTbl ),
+		SM_ROW( NATI_STATE_SRAM_ONLY,  NATI_TRIG_DEL_RULES,  _smDelRulesFromTbl ),
+		SM_ROW( NATI_STATE_SRAM_ONLY,  NATI_TRIG_MIGRATE,    _smUndef ),
+		SM_ROW( NATI_STATE_SRAM_ONLY,  NATI_TRIG_AGE_RULES,  _smAgeTbl ),
 		SM_ROW( NATI_STATE_SRAM_ONLY,  NATI_TRIG_LAST,       _smUndef ),
 	},
 
@@ -2516,6 +3916,10 @@ _state_mach_tbl[NATI_STATE_LAST+1][NATI_TRIG_LAST+1] =
 		SM_ROW( NATI_STATE_HYBRID,     NATI_TRIG_GOTO_DDR,   _smGoToDdr ),
 		SM_ROW( NATI_STATE_HYBRID,     NATI_TRIG_GOTO_SRAM,  _smGoToSram ),
 		SM_ROW( NATI_STATE_HYBRID,     NATI_TRIG_GET_TSTAMP, _smGetTmStmpHybrid ),
+		SM_ROW( NATI_STATE_HYBRID,     NATI_TRIG_ADD_RULES,  _smAddRulesHybrid ),
+		SM_ROW( NATI_STATE_HYBRID,     NATI_TRIG_DEL_RULES,  _smDelRulesHybrid ),
+		SM_ROW( NATI_STATE_HYBRID,     NATI_TRIG_MIGRATE,    _smMigrate ),
+		SM_ROW( NATI_STATE_HYBRID,     NATI_TRIG_AGE_RULES,  _smAgeTblHybrid ),
 		SM_ROW( NATI_STATE_HYBRID,     NATI_TRIG_LAST,       _smUndef ),
 	},
 
@@ -2532,6 +3936,10 @@ _state_mach_tbl[NATI_STATE_LAST+1][NATI_TRIG_LAST+1] =
 		SM_ROW( NATI_STATE_HYBRID_DDR, NATI_TRIG_GOTO_DDR,   _smGoToDdr ),
 		SM_ROW( NATI_STATE_HYBRID_DDR, NATI_TRIG_GOTO_SRAM,  _smGoToSram ),
 		SM_ROW( NATI_STATE_HYBRID_DDR, NATI_TRIG_GET_TSTAMP, _smGetTmStmpHybrid ),
+		SM_ROW( NATI_STATE_HYBRID_DDR, NATI_TRIG_ADD_RULES,  _smAddRulesHybrid ),
+		SM_ROW( NATI_STATE_HYBRID_DDR, NATI_TRIG_DEL_RULES,  _smDelRulesHybrid ),
+		SM_ROW( NATI_STATE_HYBRID_DDR, NATI_TRIG_MIGRATE,    _smMigrate ),
+		SM_ROW( NATI_STATE_HYBRID_DDR, NATI_TRIG_AGE_RULES,  _smAgeTblHybrid ),
 		SM_ROW( NATI_STATE_HYBRID_DDR, NATI_TRIG_LAST,       _smUndef ),
 	},
 
@@ -2548,6 +3956,10 @@ _state_mach_tbl[NATI_STATE_LAST+1][NATI_TRIG_LAST+1] =
 		SM_ROW( NATI_STATE_LAST,       NATI_TRIG_GOTO_DDR,   _smUndef ),
 		SM_ROW( NATI_STATE_LAST,       NATI_TRIG_GOTO_SRAM,  _smUndef ),
 		SM_ROW( NATI_STATE_LAST,       NATI_TRIG_GET_TSTAMP, _smUndef ),
+		SM_ROW( NATI_STATE_LAST,       NATI_TRIG_ADD_RULES,  _smUndef ),
+		SM_ROW( NATI_STATE_LAST,       NATI_TRIG_DEL_RULES,  _smUndef ),
+		SM_ROW( NATI_STATE_LAST,       NATI_TRIG_MIGRATE,    _smUndef ),
+		SM_ROW( NATI_STATE_LAST,       NATI_TRIG_AGE_RULES,  _smUndef ),
 		SM_ROW( NATI_STATE_LAST,       NATI_TRIG_LAST,       _smUndef ),
 	},
 };
@@ -2613,9 +4025,12 @@ int ipa_nati_statemach(
 	ipa_nati_trigger trigger,
 	arb_t*           arb_data_ptr )
 {
-	const char* ss_ptr  = _state_mach_tbl[nati_obj_ptr->curr_state][trigger].state_as_str;
-	const char* ts_ptr  = _state_mach_tbl[nati_obj_ptr->curr_state][trigger].trigger_as_str;
-	const char* cbs_ptr = _state_mach_tbl[nati_obj_ptr->curr_state][trigger].sm_cb_as_str;
+	const char* ss_ptr;
+	const char* ts_ptr;
+	const char* cbs_ptr;
+
+	bool reader = READER_TRIGGER(trigger);
+	bool excl   = ! reader && ! RULE_TRIGGER(trigger);
 
 	bool vote = false;
 
@@ -2623,13 +4038,28 @@ int ipa_nati_statemach(
 
 	IPADBG("In\n");
 
-	ret = take_mutex();
+	ret = (reader) ? take_rdlock() : take_mutex();
 
 	if ( ret != 0 )
 	{
 		goto bail;
 	}
 
+	if ( excl )
+	{
+		ret = take_wrlock();
+
+		if ( ret != 0 )
+		{
+			give_mutex();
+			goto bail;
+		}
+	}
+
+	ss_ptr  = _state_mach_tbl[nati_obj_ptr->curr_state][trigger].state_as_str;
+	ts_ptr  = _state_mach_tbl[nati_obj_ptr->curr_state][trigger].trigger_as_str;
+	cbs_ptr = _state_mach_tbl[nati_obj_ptr->curr_state][trigger].sm_cb_as_str;
+
 	IPADBG("STATE(%s) TRIGGER(%s) CB(%s)\n", ss_ptr, ts_ptr, cbs_ptr);
 
 	vote = VOTE_REQUIRED(trigger);
@@ -2662,7 +4092,15 @@ int ipa_nati_statemach(
 	}
 
 unlock:
-	ret = give_mutex();
+	if ( excl )
+	{
+		give_wrlock();
+	}
+
+	if ( ((reader) ? give_rdlock() : give_mutex()) != 0 && ret == 0 )
+	{
+		ret = -1;
+	}
 
 bail:
 	IPADBG("Out\n");
@@ -32,6 +32,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sys/mman.h>
 
 #define IPA_MAX_MSG_LEN 4096
 
@@ -54,6 +55,53 @@ size_t strlcpy(char* dst, const char* src, size_t size)
 }
 #endif
 
+/*
+ * The device backend: straight through to the system calls
+ */
+static int dev_open(
+	const char* path,
+	int         flags)
+{
+	return open(path, flags);
+}
+
+static int dev_ioctl(
+	int           fd,
+	unsigned long req,
+	unsigned long arg)
+{
+	return ioctl(fd, req, arg);
+}
+
+static const ipa_nat_backend dev_backend =
+{
+	"device",
+	dev_open,
+	close,
+	dev_ioctl,
+	mmap,
+	munmap
+};
+
+static const ipa_nat_backend* backend_ptr = &dev_backend;
+
+void ipa_nat_set_backend(
+	const ipa_nat_backend* new_backend_ptr)
+{
+	IPADBG("In\n");
+
+	backend_ptr = ( new_backend_ptr ) ? new_backend_ptr : &dev_backend;
+
+	IPAINFO("Using the %s backend\n", backend_ptr->name);
+
+	IPADBG("Out\n");
+}
+
+const ipa_nat_backend* ipa_nat_get_backend(void)
+{
+	return backend_ptr;
+}
+
 ipa_descriptor* ipa_descriptor_open(void)
 {
 	ipa_descriptor* desc_ptr;
@@ -69,7 +117,7 @@ ipa_descriptor* ipa_descriptor_open(void)
 		goto bail;
 	}
 
-	desc_ptr->fd = open(IPA_DEV_NAME, O_RDONLY);
+	desc_ptr->fd = ipa_dev_open(IPA_DEV_NAME, O_RDONLY);
 
 	if (desc_ptr->fd < 0)
 	{
@@ -77,7 +125,7 @@ ipa_descriptor* ipa_descriptor_open(void)
 		goto free;
 	}
 
-	res = ioctl(desc_ptr->fd, IPA_IOC_GET_HW_VERSION, &desc_ptr->ver);
+	res = ipa_dev_ioctl(desc_ptr->fd, IPA_IOC_GET_HW_VERSION, &desc_ptr->ver);
 
 	if (res == 0)
 	{
@@ -110,7 +158,7 @@ void ipa_descriptor_close(
 	{
 		if ( desc_ptr->fd >= 0)
 		{
-			close(desc_ptr->fd);
+			ipa_dev_close(desc_ptr->fd);
 		}
 		free(desc_ptr);
 	}
@@ -161,6 +209,99 @@ void ipa_read_debug_info(
 	fclose(debug_file);
 }
 
+int ipa_nat_post_batch_cmd(
+	struct ipa_ioc_nat_dma_cmd* cmd,
+	const uint8_t*              rule_entries,
+	uint16_t                    num_rules,
+	ipa_nat_dma_post_cb         post,
+	void*                       arg,
+	uint32_t*                   max_entries,
+	uint16_t*                   num_posted)
+{
+	struct ipa_ioc_nat_dma_cmd* one_cmd = NULL;
+	uint32_t first = 0;
+	uint16_t i;
+	int ret;
+
+	IPADBG("In\n");
+
+	*num_posted = 0;
+
+	ret = post(arg, cmd);
+
+	if ( ! ret )
+	{
+		*num_posted = num_rules;
+		goto bail;
+	}
+
+	if ( num_rules < 2 )
+		goto bail;
+
+	/*
+	 * A single rule's entries always fit, so whatever the reason for
+	 * the failure, later batches only risk being smaller than needed
+	 */
+	*max_entries = cmd->entries / 2;
+
+	if ( *max_entries < MAX_DMA_ENTRIES_FOR_ADD )
+		*max_entries = MAX_DMA_ENTRIES_FOR_ADD;
+
+	IPAWARN("Batch of %u rules (%u entries) refused, posting them singly "
+			"and capping batches at %u entries\n",
+			num_rules, cmd->entries, *max_entries);
+
+	one_cmd = calloc(
+		1,
+		sizeof(struct ipa_ioc_nat_dma_cmd) +
+		(MAX_DMA_ENTRIES_FOR_ADD * sizeof(struct ipa_ioc_nat_dma_one)));
+
+	if ( one_cmd == NULL )
+	{
+		IPAERR("Unable to allocate memory for dma command\n");
+		ret = -ENOMEM;
+		goto bail;
+	}
+
+	one_cmd->mem_type = cmd->mem_type;
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		if ( rule_entries[i] > MAX_DMA_ENTRIES_FOR_ADD )
+		{
+			IPAERR("Rule %u has too many entries (%u)\n",
+				   i, rule_entries[i]);
+			ret = -EINVAL;
+			break;
+		}
+
+		memcpy(one_cmd->dma,
+			   &cmd->dma[first],
+			   rule_entries[i] * sizeof(struct ipa_ioc_nat_dma_one));
+
+		one_cmd->entries = rule_entries[i];
+
+		ret = post(arg, one_cmd);
+
+		if ( ret )
+		{
+			IPAERR("Unable to post rule %u of %u\n", i, num_rules);
+			break;
+		}
+
+		first += rule_entries[i];
+
+		(*num_posted)++;
+	}
+
+	free(one_cmd);
+
+bail:
+	IPADBG("Out\n");
+
+	return ret;
+}
+
 void log_nat_message(char *msg)
 {
 	 return;
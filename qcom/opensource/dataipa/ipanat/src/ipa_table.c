@@ -37,6 +37,10 @@
 #define IPA_BASE_TABLE_PCNT_4SRAM      1.00
 #define IPA_EXPANSION_TABLE_PCNT_4SRAM 0.43
 
+#undef  CHAIN_HIST_BUCKET
+#define CHAIN_HIST_BUCKET(len) \
+	( ((len) < IPA_TABLE_CHAIN_HIST_SZ) ? (len) : IPA_TABLE_CHAIN_HIST_SZ - 1 )
+
 /*
  * The table number of entries is limited by Entry ID structure
  * above. The base table max entries is limited by index into table
@@ -70,6 +74,15 @@ static int FindExpnTblFreeEntry(
 	void**     free_entry,
 	uint16_t*  entry_index );
 
+static uint16_t FindChainHead(
+	ipa_table* table,
+	uint16_t   index );
+
+static void AdjustChainLen(
+	ipa_table* table,
+	uint16_t   head_index,
+	int        delta );
+
 static int Get2PowerTightUpperBound(
 	uint16_t num);
 
@@ -217,6 +230,18 @@ void ipa_table_reset(
 	for (i = 0; i < tot; i++)
 		table->expn_table_addr[i] = '\0';
 
+	memset(table->chain_len,  0, sizeof(table->chain_len));
+	memset(table->chain_hist, 0, sizeof(table->chain_hist));
+	table->chain_ents = 0;
+
+	/*
+	 * Lowest index on top, so slots get handed out in the same
+	 * order a walk of the expansion table would find them...
+	 */
+	table->expn_free_cnt = 0;
+	for (i = table->expn_table_entries; i > 0; i--)
+		table->expn_free[table->expn_free_cnt++] = table->table_entries + i - 1;
+
 	IPADBG("Out\n");
 }
 
@@ -375,6 +400,8 @@ void ipa_table_delete_entry(
 			IPADBG("deleting the dead node %d for %s\n",
 				   iterator->prev_index, table->name);
 
+			AdjustChainLen(table, iterator->prev_index, -1);
+
 			memset(iterator->prev_entry, 0, table->entry_size);
 
 			--table->cur_tbl_cnt;
@@ -396,6 +423,8 @@ void ipa_table_erase_entry(
 
 	IPADBG("table(%p) index(%u)\n", table, index);
 
+	AdjustChainLen(table, FindChainHead(table, index), -1);
+
 	memset(entry, 0, table->entry_size);
 
 	if ( index < table->table_entries )
@@ -405,6 +434,8 @@ void ipa_table_erase_entry(
 	else
 	{
 		--table->cur_expn_tbl_cnt;
+
+		table->expn_free[table->expn_free_cnt++] = index;
 	}
 
 	IPADBG("Out\n");
@@ -443,6 +474,9 @@ int ipa_table_get_entry(
 	 */
 	BREAK_RULE_HDL(table, entry_handle, nmi, is_expn_tbl, rec_index);
 
+	IPADBG("nmi(%d) is_expn_tbl(%u) rec_index(%u)\n",
+		   nmi, is_expn_tbl, rec_index);
+
 	if ( is_expn_tbl )
 	{
 		IPADBG("Retrieving entry from expansion table\n");
@@ -501,6 +535,13 @@ bail:
 	return result;
 }
 
+uint16_t ipa_table_get_chain_head(
+	ipa_table* table,
+	uint16_t   rec_index )
+{
+	return FindChainHead(table, rec_index);
+}
+
 void ipa_table_dma_cmd_helper_init(
 	ipa_table_dma_cmd_helper* dma_cmd_helper,
 	uint8_t table_indx,
@@ -804,6 +845,8 @@ static int InsertHead(
 
 	++table->cur_tbl_cnt;
 
+	AdjustChainLen(table, rec_index, 1);
+
 bail:
 	IPADBG("Out\n");
 
@@ -821,6 +864,7 @@ static int InsertTail(
 
 	ipa_table_iterator iterator;
 
+	uint16_t head_index  = *rec_index_ptr;
 	uint16_t enable_data = 0;
 
 	int ret = 0;
@@ -877,6 +921,7 @@ static int InsertTail(
 	if (ret)
 	{
 		IPAERR("Unable to insert a new entry to the tail in %s\n", table->name);
+		table->expn_free[table->expn_free_cnt++] = iterator.curr_index;
 		goto bail;
 	}
 
@@ -919,6 +964,8 @@ static int InsertTail(
 
 	++table->cur_expn_tbl_cnt;
 
+	AdjustChainLen(table, head_index, 1);
+
 	*rec_index_ptr = iterator.curr_index;
 
 bail:
@@ -974,25 +1021,8 @@ static uint16_t MakeEntryHdl(
 	return entry_hdl;
 }
 
-static int mt_slot(
-	ipa_table*      table_ptr,
-	uint32_t        rule_hdl,
-	void*           record_ptr,
-	uint16_t        record_index,
-	void*           meta_record_ptr,
-	uint16_t        meta_record_index,
-	void*           arb_data_ptr )
-{
-	IPADBG("%s: Empty expansion slot: (%u) in table of size: (%u)\n",
-		   table_ptr->name,
-		   record_index,
-		   table_ptr->tot_tbl_ents);
-
-	return record_index;
-}
-
 /*
- * returns expn table entry absolute index
+ * pops a slot off the expansion free list; returns its absolute index
  */
 static int FindExpnTblFreeEntry(
 	ipa_table* table,
@@ -1015,46 +1045,40 @@ static int FindExpnTblFreeEntry(
 	*entry_index = 0;
 	*free_entry  = NULL;
 
-	/*
-	 * The following will start walk at expansion slots
-	 * (ie. just after table->table_entries)...
-	 */
-	ret = ipa_table_walk(table, table->table_entries, WHEN_SLOT_EMPTY, mt_slot, 0);
-
-	if ( ret > 0 )
+	if ( table->expn_free_cnt == 0 )
 	{
-		*entry_index = (uint16_t) ret;
+		IPADBG("%s: No empty slots (ie. expansion table full): "
+			   "BASE (avail/used): (%u/%u) EXPN (avail/used): (%u/%u)\n",
+			   table->name,
+			   table->table_entries,
+			   table->cur_tbl_cnt,
+			   table->expn_table_entries,
+			   table->cur_expn_tbl_cnt);
+		ret = -1;
+		goto bail;
+	}
 
-		*free_entry = GOTO_REC(table, *entry_index);
+	*entry_index = table->expn_free[--table->expn_free_cnt];
 
-		IPADBG("%s: entry_index val (%u) free_entry val (%p)\n",
-			   table->name,
-			   *entry_index,
-			   *free_entry);
+	*free_entry = GOTO_REC(table, *entry_index);
 
-		ret = 0;
-	}
-	else
+	if ( table->entry_interface->entry_is_valid(*free_entry) )
 	{
-		if ( ret < 0 )
-		{
-			IPAERR("%s: While searching table for emtpy slot\n",
-				   table->name);
-		}
-		else
-		{
-			IPADBG("%s: No empty slots (ie. expansion table full): "
-				   "BASE (avail/used): (%u/%u) EXPN (avail/used): (%u/%u)\n",
-				   table->name,
-				   table->table_entries,
-				   table->cur_tbl_cnt,
-				   table->expn_table_entries,
-				   table->cur_expn_tbl_cnt);
-		}
-
+		IPAERR("%s: free list slot (%u) is in use\n",
+			   table->name, *entry_index);
+		*entry_index = 0;
+		*free_entry  = NULL;
 		ret = -1;
+		goto bail;
 	}
 
+	IPADBG("%s: entry_index val (%u) free_entry val (%p)\n",
+		   table->name,
+		   *entry_index,
+		   *free_entry);
+
+	ret = 0;
+
 bail:
 	IPADBG("Out\n");
 
@@ -1270,6 +1294,133 @@ bail:
 	return ret;
 }
 
+/*
+ * Follows prev links from the record at index back to the base table
+ * record heading its chain...
+ */
+static uint16_t FindChainHead(
+	ipa_table* table,
+	uint16_t   index )
+{
+	uint32_t hops = 0;
+
+	while ( VALID_INDEX(index) &&
+			index >= table->table_entries &&
+			hops++ < table->expn_table_entries )
+	{
+		index = table->entry_interface->entry_get_prev_index(
+			GOTO_REC(table, index),
+			index,
+			table->meta,
+			table->table_entries);
+	}
+
+	return index;
+}
+
+/*
+ * Moves the chain headed at head_index from one chain_hist bucket to
+ * another as it grows or shrinks by delta records...
+ */
+static void AdjustChainLen(
+	ipa_table* table,
+	uint16_t   head_index,
+	int        delta )
+{
+	uint32_t old_len, new_len;
+
+	if ( ! VALID_INDEX(head_index) ||
+		 head_index >= table->table_entries ||
+		 (int) table->chain_len[head_index] + delta < 0 )
+	{
+		IPAERR("Bad chain head(%u) or delta(%d) in %s\n",
+			   head_index, delta, table->name);
+		return;
+	}
+
+	old_len = table->chain_len[head_index];
+	new_len = old_len + delta;
+
+	if ( old_len )
+	{
+		table->chain_hist[CHAIN_HIST_BUCKET(old_len)]--;
+
+		if ( old_len > 1 )
+		{
+			table->chain_ents -= old_len;
+		}
+	}
+
+	if ( new_len )
+	{
+		table->chain_hist[CHAIN_HIST_BUCKET(new_len)]++;
+
+		if ( new_len > 1 )
+		{
+			table->chain_ents += new_len;
+		}
+	}
+
+	table->chain_len[head_index] = new_len;
+}
+
+/**
+ * ipa_table_get_chain_stats() - reports on the table's collision chains
+ * @table: [in] the table
+ * @stats_ptr: [out] the chain stats
+ *
+ * Comes from what's kept as records are added and removed, so costs
+ * a pass over the histogram rather than a walk of the table. Only
+ * chains longer than the histogram's last bucket need a look at each
+ * chain head.
+ */
+void ipa_table_get_chain_stats(
+	ipa_table*             table,
+	ipa_table_chain_stats* stats_ptr )
+{
+	uint32_t i;
+
+	IPADBG("In\n");
+
+	memset(stats_ptr, 0, sizeof(ipa_table_chain_stats));
+
+	memcpy(stats_ptr->chain_hist, table->chain_hist, sizeof(table->chain_hist));
+
+	for ( i = 2; i < IPA_TABLE_CHAIN_HIST_SZ; i++ )
+	{
+		if ( table->chain_hist[i] )
+		{
+			stats_ptr->tot_chains += table->chain_hist[i];
+
+			if ( stats_ptr->min_chain_len == 0 )
+			{
+				stats_ptr->min_chain_len = i;
+			}
+
+			stats_ptr->max_chain_len = i;
+		}
+	}
+
+	if ( table->chain_hist[IPA_TABLE_CHAIN_HIST_SZ - 1] )
+	{
+		for ( i = 0; i < table->table_entries; i++ )
+		{
+			if ( table->chain_len[i] > stats_ptr->max_chain_len )
+			{
+				stats_ptr->max_chain_len = table->chain_len[i];
+			}
+		}
+	}
+
+	if ( stats_ptr->tot_chains )
+	{
+		stats_ptr->avg_chain_len =
+			(float) table->chain_ents / (float) stats_ptr->tot_chains;
+	}
+
+	IPADBG("Out\n");
+}
+
 int ipa_table_add_dma_cmd(
 	ipa_table*                  tbl_ptr,
 	dma_help_type               help_type,
@@ -1278,8 +1429,6 @@ int ipa_table_add_dma_cmd(
 	uint16_t                    data_for_entry,
 	struct ipa_ioc_nat_dma_cmd* cmd_ptr )
 {
-	ipa_table_dma_cmd_helper* help_ptr;
-
 	uint32_t tab_sz, entry_offset;
 
 	uint8_t is_expn;
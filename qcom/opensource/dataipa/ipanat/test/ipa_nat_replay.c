@@ -0,0 +1,663 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+/*
+ * ipanatreplay
+ *
+ * Replays a trace of NAT rule adds and deletes against an offline
+ * (malloc'd memory) IPv4 NAT table, then reports how the rules landed:
+ * the chain length distribution of the NAT and index tables, the
+ * expansion table utilization and the add/delete latency percentiles.
+ *
+ * It never opens the IPA device, so it can be run on a host. See
+ * README.txt for the trace format.
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <errno.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "ipa_nat_drv.h"
+#include "ipa_nat_drvi.h"
+
+#define REPLAY_LINE_SZ    256
+#define REPLAY_NUM_SUBS   1024
+#define REPLAY_NUM_SRVS   32
+#define REPLAY_CGNAT_NET  0x64400000 /* 100.64.0.0/10 */
+#define REPLAY_CGNAT_MASK 0x003FFFFF
+#define REPLAY_PUB_ADDR   0xCB007101 /* 203.0.113.1 */
+
+#undef  NS_PER_SEC
+#define NS_PER_SEC 1000000000ULL
+
+typedef struct {
+	bool              is_add;
+	uint32_t          id;
+	ipa_nat_ipv4_rule rule;
+} replay_op;
+
+typedef struct {
+	replay_op* ops;
+	uint32_t   num_ops;
+	uint32_t   max_ops;
+	uint32_t   max_id;
+} replay_trace;
+
+typedef struct {
+	uint64_t* ns;
+	uint32_t  cnt;
+} replay_lat;
+
+static void _dispUsage(
+	const char* progNamePtr )
+{
+	printf("Usage: %s [-f file | -s N [-u N -l N -r N -o file]] [-e N -m mt -L]\n",
+		   progNamePtr);
+	printf("Where:\n");
+	printf("  -f file Replay the trace in file\n");
+	printf("  -s N    Synthesize and replay a CGNAT style trace of N adds\n");
+	printf("  -u N    Number of subscribers in the synthesized trace (default %u)\n",
+		   REPLAY_NUM_SUBS);
+	printf("  -l N    Most rules live at once in the synthesized trace; the\n");
+	printf("          oldest rule is deleted to make room (default 3/4 of -e)\n");
+	printf("  -r N    Seed for the synthesized trace (default 1)\n");
+	printf("  -o file Also write the synthesized trace to file\n");
+	printf("  -e N    Number of entries in the table (default 100)\n");
+	printf("  -m mt   Memory type the table is sized for: DDR or SRAM\n");
+	printf("  -L      Use the dst_hash of IPA versions before v4.0\n");
+}
+
+static int add_op(
+	replay_trace*    trace_ptr,
+	const replay_op* op_ptr )
+{
+	replay_op* ops;
+
+	if ( trace_ptr->num_ops == trace_ptr->max_ops )
+	{
+		trace_ptr->max_ops = ( trace_ptr->max_ops ) ? trace_ptr->max_ops * 2 : 1024;
+
+		ops = realloc(trace_ptr->ops, trace_ptr->max_ops * sizeof(replay_op));
+
+		if ( ! ops )
+		{
+			fprintf(stderr, "Out of memory at op %u\n", trace_ptr->num_ops);
+			return -ENOMEM;
+		}
+
+		trace_ptr->ops = ops;
+	}
+
+	trace_ptr->ops[trace_ptr->num_ops++] = *op_ptr;
+
+	if ( op_ptr->id + 1 > trace_ptr->max_id )
+	{
+		trace_ptr->max_id = op_ptr->id + 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Each line is one of:
+ *
+ *   add <id> <proto> <private ip> <private port> <target ip> <target port> <public port>
+ *   del <id>
+ *
+ * where id names the rule for a later del. Blank lines and lines
+ * starting with # are skipped.
+ */
+static int load_trace(
+	const char*   file_name,
+	replay_trace* trace_ptr )
+{
+	char      line[REPLAY_LINE_SZ];
+	char      priv[32], tgt[32];
+	struct    in_addr addr;
+	unsigned  proto, priv_port, tgt_port, pub_port;
+	uint32_t  line_no = 0;
+	replay_op op;
+	FILE*     fp;
+
+	int ret = 0;
+
+	if ( ! (fp = fopen(file_name, "r")) )
+	{
+		fprintf(stderr, "Unable to open %s: %s\n", file_name, strerror(errno));
+		return -EIO;
+	}
+
+	while ( ret == 0 && fgets(line, sizeof(line), fp) )
+	{
+		line_no++;
+
+		memset(&op, 0, sizeof(op));
+
+		if ( line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0' )
+		{
+			continue;
+		}
+
+		if ( sscanf(line, "add %u %u %31s %u %31s %u %u",
+					&op.id, &proto, priv, &priv_port, tgt, &tgt_port, &pub_port) == 7 )
+		{
+			op.is_add = true;
+
+			op.rule.protocol     = proto;
+			op.rule.private_port = priv_port;
+			op.rule.target_port  = tgt_port;
+			op.rule.public_port  = pub_port;
+
+			if ( ! inet_aton(priv, &addr) )
+			{
+				goto bad_line;
+			}
+			op.rule.private_ip = ntohl(addr.s_addr);
+
+			if ( ! inet_aton(tgt, &addr) )
+			{
+				goto bad_line;
+			}
+			op.rule.target_ip = ntohl(addr.s_addr);
+		}
+		else if ( sscanf(line, "del %u", &op.id) != 1 )
+		{
+			goto bad_line;
+		}
+
+		ret = add_op(trace_ptr, &op);
+
+		continue;
+
+bad_line:
+		fprintf(stderr, "%s:%u: can't parse: %s", file_name, line_no, line);
+		ret = -EINVAL;
+	}
+
+	fclose(fp);
+
+	return ret;
+}
+
+static uint32_t rand32(
+	unsigned int* seed_ptr )
+{
+	uint32_t hi = rand_r(seed_ptr);
+
+	return (hi << 16) ^ rand_r(seed_ptr);
+}
+
+/*
+ * A CGNAT style mix: many subscribers in 100.64.0.0/10 with random
+ * ephemeral ports, most of them talking to a few popular servers on
+ * 443 and 80, some DNS, and public ports handed out sequentially.
+ * Once lim rules are live, the oldest is deleted before each add.
+ */
+static int synth_trace(
+	uint32_t      num_adds,
+	uint32_t      num_subs,
+	uint32_t      lim,
+	unsigned int  seed,
+	replay_trace* trace_ptr )
+{
+	uint32_t  srvs[REPLAY_NUM_SRVS];
+	uint32_t  subs_base = rand_r(&seed) & REPLAY_CGNAT_MASK;
+	uint16_t  pub_port  = 1024;
+	uint32_t  oldest    = 0;
+	uint32_t  i, r;
+	replay_op op;
+
+	int ret = 0;
+
+	for ( i = 0; i < REPLAY_NUM_SRVS; i++ )
+	{
+		srvs[i] = rand32(&seed);
+	}
+
+	for ( i = 0; i < num_adds && ret == 0; i++ )
+	{
+		if ( lim && i - oldest >= lim )
+		{
+			memset(&op, 0, sizeof(op));
+			op.id = oldest++;
+			if ( (ret = add_op(trace_ptr, &op)) )
+			{
+				break;
+			}
+		}
+
+		memset(&op, 0, sizeof(op));
+
+		op.is_add = true;
+		op.id     = i;
+
+		op.rule.private_ip =
+			REPLAY_CGNAT_NET | ((subs_base + rand_r(&seed) % num_subs) & REPLAY_CGNAT_MASK);
+		op.rule.private_port = 32768 + rand_r(&seed) % 28232;
+
+		r = rand_r(&seed) % 100;
+
+		op.rule.target_ip = ( r < 80 ) ?
+			srvs[rand_r(&seed) % REPLAY_NUM_SRVS] :
+			rand32(&seed);
+
+		r = rand_r(&seed) % 100;
+
+		if ( r < 70 )
+		{
+			op.rule.protocol    = IPPROTO_TCP;
+			op.rule.target_port = 443;
+		}
+		else if ( r < 90 )
+		{
+			op.rule.protocol    = IPPROTO_TCP;
+			op.rule.target_port = 80;
+		}
+		else
+		{
+			op.rule.protocol    = IPPROTO_UDP;
+			op.rule.target_port = 53;
+		}
+
+		op.rule.public_port = pub_port;
+
+		pub_port = ( pub_port == 65535 ) ? 1024 : pub_port + 1;
+
+		ret = add_op(trace_ptr, &op);
+	}
+
+	return ret;
+}
+
+static int save_trace(
+	const char*         file_name,
+	const replay_trace* trace_ptr )
+{
+	const replay_op* op;
+	struct in_addr   priv, tgt;
+	uint32_t         i;
+	FILE*            fp;
+
+	if ( ! (fp = fopen(file_name, "w")) )
+	{
+		fprintf(stderr, "Unable to open %s: %s\n", file_name, strerror(errno));
+		return -EIO;
+	}
+
+	for ( i = 0; i < trace_ptr->num_ops; i++ )
+	{
+		op = &trace_ptr->ops[i];
+
+		if ( op->is_add )
+		{
+			char priv_str[INET_ADDRSTRLEN];
+
+			priv.s_addr = htonl(op->rule.private_ip);
+			tgt.s_addr  = htonl(op->rule.target_ip);
+
+			/* inet_ntoa() uses a static buffer, hence the copy */
+			snprintf(priv_str, sizeof(priv_str), "%s", inet_ntoa(priv));
+
+			fprintf(fp, "add %u %u %s %u %s %u %u\n",
+					op->id,
+					op->rule.protocol,
+					priv_str,
+					op->rule.private_port,
+					inet_ntoa(tgt),
+					op->rule.target_port,
+					op->rule.public_port);
+		}
+		else
+		{
+			fprintf(fp, "del %u\n", op->id);
+		}
+	}
+
+	fclose(fp);
+
+	return 0;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+static int cmp_u64(
+	const void* a,
+	const void* b )
+{
+	uint64_t x = *(const uint64_t*) a;
+	uint64_t y = *(const uint64_t*) b;
+
+	return ( x > y ) - ( x < y );
+}
+
+static void report_lat(
+	const char* what,
+	replay_lat* lat_ptr )
+{
+	static const double pcnts[] = { 50.0, 90.0, 99.0, 99.9 };
+
+	uint32_t i;
+
+	if ( ! lat_ptr->cnt )
+	{
+		return;
+	}
+
+	qsort(lat_ptr->ns, lat_ptr->cnt, sizeof(uint64_t), cmp_u64);
+
+	printf("%s latency (ns) over %u:", what, lat_ptr->cnt);
+
+	for ( i = 0; i < sizeof(pcnts) / sizeof(pcnts[0]); i++ )
+	{
+		printf(" p%g=%llu",
+			   pcnts[i],
+			   (unsigned long long)
+			   lat_ptr->ns[(uint32_t) ((lat_ptr->cnt - 1) * pcnts[i] / 100.0)]);
+	}
+
+	printf(" max=%llu\n", (unsigned long long) lat_ptr->ns[lat_ptr->cnt - 1]);
+}
+
+static void report_tbl(
+	const char*               what,
+	const ipa_nati_tbl_stats* stats_ptr,
+	uint32_t                  peak_expn )
+{
+	uint32_t i;
+
+	printf("%s: base %u/%u expn %u/%u (%.1f%%, peak %u %.1f%%)\n",
+		   what,
+		   stats_ptr->tot_base_ents_filled,
+		   stats_ptr->tot_base_ents,
+		   stats_ptr->tot_expn_ents_filled,
+		   stats_ptr->tot_expn_ents,
+		   ( stats_ptr->tot_expn_ents ) ?
+		   100.0 * stats_ptr->tot_expn_ents_filled / stats_ptr->tot_expn_ents : 0.0,
+		   peak_expn,
+		   ( stats_ptr->tot_expn_ents ) ?
+		   100.0 * peak_expn / stats_ptr->tot_expn_ents : 0.0);
+
+	printf("  chains %u min %u max %u avg %.2f\n",
+		   stats_ptr->tot_chains,
+		   stats_ptr->min_chain_len,
+		   stats_ptr->max_chain_len,
+		   stats_ptr->avg_chain_len);
+
+	for ( i = 1; i < IPA_TABLE_CHAIN_HIST_SZ; i++ )
+	{
+		if ( stats_ptr->chain_hist[i] )
+		{
+			printf("  len %s%-3u %u\n",
+				   ( i == IPA_TABLE_CHAIN_HIST_SZ - 1 ) ? ">=" : "",
+				   i,
+				   stats_ptr->chain_hist[i]);
+		}
+	}
+}
+
+static int replay(
+	ipa_nati_offline_tbl* tbl,
+	const replay_trace*   trace_ptr )
+{
+	const replay_op*   op;
+	ipa_nati_tbl_stats nat_stats, idx_stats;
+	replay_lat         add_lat = { NULL, 0 }, del_lat = { NULL, 0 };
+	uint32_t*          hdls;
+	uint32_t           add_fails = 0, del_fails = 0, del_skips = 0;
+	uint32_t           peak_expn = 0, peak_idx_expn = 0;
+	uint64_t           start;
+	uint32_t           i;
+
+	int ret = 0;
+
+	hdls        = calloc(trace_ptr->max_id + 1, sizeof(uint32_t));
+	add_lat.ns  = calloc(trace_ptr->num_ops + 1, sizeof(uint64_t));
+	del_lat.ns  = calloc(trace_ptr->num_ops + 1, sizeof(uint64_t));
+
+	if ( ! hdls || ! add_lat.ns || ! del_lat.ns )
+	{
+		fprintf(stderr, "Out of memory\n");
+		ret = -ENOMEM;
+		goto bail;
+	}
+
+	for ( i = 0; i < trace_ptr->num_ops; i++ )
+	{
+		op = &trace_ptr->ops[i];
+
+		if ( op->is_add )
+		{
+			if ( hdls[op->id] )
+			{
+				fprintf(stderr, "op %u: id %u is already live\n", i, op->id);
+				add_fails++;
+				continue;
+			}
+
+			start = now_ns();
+			ret = ipa_nati_offline_add_rule(tbl, &op->rule, &hdls[op->id]);
+			add_lat.ns[add_lat.cnt++] = now_ns() - start;
+
+			if ( ret )
+			{
+				hdls[op->id] = 0;
+				add_fails++;
+				ret = 0;
+				continue;
+			}
+
+			ipa_nati_offline_tbl_stats(tbl, &nat_stats, &idx_stats);
+
+			if ( nat_stats.tot_expn_ents_filled > peak_expn )
+				peak_expn = nat_stats.tot_expn_ents_filled;
+			if ( idx_stats.tot_expn_ents_filled > peak_idx_expn )
+				peak_idx_expn = idx_stats.tot_expn_ents_filled;
+		}
+		else
+		{
+			if ( ! hdls[op->id] )
+			{
+				/* Never added, or its add failed */
+				del_skips++;
+				continue;
+			}
+
+			start = now_ns();
+			ret = ipa_nati_offline_del_rule(tbl, hdls[op->id]);
+			del_lat.ns[del_lat.cnt++] = now_ns() - start;
+
+			if ( ret )
+			{
+				del_fails++;
+				ret = 0;
+			}
+
+			hdls[op->id] = 0;
+		}
+	}
+
+	ipa_nati_offline_tbl_stats(tbl, &nat_stats, &idx_stats);
+
+	printf("ops %u: adds %u (failed %u) dels %u (failed %u, skipped %u)\n",
+		   trace_ptr->num_ops,
+		   add_lat.cnt, add_fails,
+		   del_lat.cnt, del_fails, del_skips);
+
+	report_tbl("NAT table", &nat_stats, peak_expn);
+	report_tbl("Index table", &idx_stats, peak_idx_expn);
+
+	report_lat("add", &add_lat);
+	report_lat("del", &del_lat);
+
+bail:
+	free(hdls);
+	free(add_lat.ns);
+	free(del_lat.ns);
+
+	return ret;
+}
+
+int main(
+	int   argc,
+	char* argv[] )
+{
+	const char*           in_file   = NULL;
+	const char*           out_file  = NULL;
+	uint32_t              num_adds  = 0;
+	uint32_t              num_subs  = REPLAY_NUM_SUBS;
+	uint32_t              lim       = 0;
+	unsigned int          seed      = 1;
+	int                   tot_ents  = 100;
+	enum ipa3_nat_mem_in  nmi       = IPA_NAT_MEM_IN_DDR;
+	enum ipa_hw_type      hw_ver    = IPA_HW_v4_0;
+	replay_trace          trace;
+	ipa_nati_offline_tbl* tbl;
+
+	int c, ret;
+
+	memset(&trace, 0, sizeof(trace));
+
+	while ( (c = getopt(argc, argv, "f:s:u:l:r:o:e:m:L?")) != -1 )
+	{
+		switch (c)
+		{
+		case 'f':
+			in_file = optarg;
+			break;
+		case 's':
+			num_adds = atoi(optarg);
+			break;
+		case 'u':
+			num_subs = atoi(optarg);
+			break;
+		case 'l':
+			lim = atoi(optarg);
+			break;
+		case 'r':
+			seed = atoi(optarg);
+			break;
+		case 'o':
+			out_file = optarg;
+			break;
+		case 'e':
+			tot_ents = atoi(optarg);
+			break;
+		case 'm':
+			if ( ! strcmp(optarg, "DDR") )
+			{
+				nmi = IPA_NAT_MEM_IN_DDR;
+			}
+			else if ( ! strcmp(optarg, "SRAM") )
+			{
+				nmi = IPA_NAT_MEM_IN_SRAM;
+			}
+			else
+			{
+				fprintf(stderr, "Illegal: -m %s\n", optarg);
+				_dispUsage(basename(argv[0]));
+				exit(1);
+			}
+			break;
+		case 'L':
+			hw_ver = IPA_HW_v3_0;
+			break;
+		case '?':
+		default:
+			_dispUsage(basename(argv[0]));
+			exit(1);
+		}
+	}
+
+	if ( ! in_file == ! num_adds || num_subs == 0 || tot_ents <= 0 )
+	{
+		_dispUsage(basename(argv[0]));
+		exit(1);
+	}
+
+	if ( in_file )
+	{
+		ret = load_trace(in_file, &trace);
+	}
+	else
+	{
+		if ( ! lim )
+		{
+			lim = tot_ents * 3 / 4;
+		}
+
+		ret = synth_trace(num_adds, num_subs, lim, seed, &trace);
+
+		if ( ret == 0 && out_file )
+		{
+			ret = save_trace(out_file, &trace);
+		}
+	}
+
+	if ( ret )
+	{
+		goto bail;
+	}
+
+	tbl = ipa_nati_offline_tbl_create(nmi, hw_ver, REPLAY_PUB_ADDR, tot_ents);
+
+	if ( ! tbl )
+	{
+		fprintf(stderr, "Unable to create a %d entry offline table\n", tot_ents);
+		ret = -EINVAL;
+		goto bail;
+	}
+
+	ret = replay(tbl, &trace);
+
+	ipa_nati_offline_tbl_destroy(tbl);
+
+bail:
+	free(trace.ops);
+
+	return ( ret ) ? 1 : 0;
+}
@@ -64,7 +64,7 @@ int ipa_nat_test024(
 	for ( i = 0; i < 1000; i++ )
 	{
 		ret = ipa_nat_test022(
-			nat_mem_type, pub_ip_add, total_entries, tbl_hdl, !sep, arb_data_ptr);
+			nat_mem_type, pub_ip_add, total_entries, tbl_hdl, 0, arb_data_ptr);
 		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
 	}
 
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+/*=========================================================================*/
+/*!
+	@file
+	ipa_nat_test026.c
+
+	@brief
+	Verify the following scenario:
+	1. Add ipv4 table
+	2. Add and delete the same set of rules one at a time, timing both
+	3. Add and delete the same set of rules using the batch API, timing
+	   both, and check the table is left empty
+	4. Report rules per second for each
+	5. Delete ipv4 table
+*/
+/*=========================================================================*/
+
+#include "ipa_nat_test.h"
+
+#undef  MAX_RULES
+#define MAX_RULES 1024
+
+#undef  RULES_PER_SEC
+#define RULES_PER_SEC(n, ns) \
+	( (ns) ? ((double) (n) * NANOS_PER_SEC / (double) (ns)) : 0.0 )
+
+int ipa_nat_test026(
+	const char* nat_mem_type,
+	u32 pub_ip_add,
+	int total_entries,
+	u32 tbl_hdl,
+	int sep,
+	void* arb_data_ptr)
+{
+	int* tbl_hdl_ptr = (int*) arb_data_ptr;
+
+	static ipa_nat_ipv4_rule ipv4_rules[MAX_RULES];
+	static u32               rule_hdls[MAX_RULES];
+
+	ipa_nati_tbl_stats nstats, istats;
+
+	uint64_t start, one_add_ns, one_del_ns, bat_add_ns, bat_del_ns;
+
+	u32 i, num_rules, num_done;
+
+	int ret;
+
+	IPADBG("In\n");
+
+	if ( sep )
+	{
+		ret = ipa_nat_add_ipv4_tbl(pub_ip_add, nat_mem_type, total_entries, &tbl_hdl);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	ret = ipa_nati_clear_ipv4_tbl(tbl_hdl);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	/*
+	 * Half the table, so that adds don't fail on a full table...
+	 */
+	num_rules = nstats.tot_ents / 2;
+
+	if ( num_rules > MAX_RULES )
+	{
+		num_rules = MAX_RULES;
+	}
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		memset(&ipv4_rules[i], 0, sizeof(ipv4_rules[i]));
+
+		ipv4_rules[i].protocol     = IPPROTO_TCP;
+		ipv4_rules[i].public_port  = RAN_PORT;
+		ipv4_rules[i].target_ip    = RAN_ADDR;
+		ipv4_rules[i].target_port  = RAN_PORT;
+		ipv4_rules[i].private_ip   = RAN_ADDR;
+		ipv4_rules[i].private_port = RAN_PORT;
+	}
+
+	/*
+	 * One at a time. CHECK_ERR_TBL_STOP validates the whole table, so
+	 * only use it on failure to keep it out of the timing...
+	 */
+	currTimeAs(TimeAsNanSecs, &start);
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = ipa_nat_add_ipv4_rule(tbl_hdl, &ipv4_rules[i], &rule_hdls[i]);
+
+		if ( ret )
+		{
+			CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+		}
+	}
+
+	currTimeAs(TimeAsNanSecs, &one_add_ns);
+	one_add_ns -= start;
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[i]);
+
+		if ( ret )
+		{
+			CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+		}
+	}
+
+	currTimeAs(TimeAsNanSecs, &one_del_ns);
+	one_del_ns -= start + one_add_ns;
+
+	/*
+	 * Batched...
+	 */
+	currTimeAs(TimeAsNanSecs, &start);
+
+	ret = ipa_nat_add_ipv4_rules(tbl_hdl, ipv4_rules, num_rules, rule_hdls, &num_done);
+
+	currTimeAs(TimeAsNanSecs, &bat_add_ns);
+	bat_add_ns -= start;
+
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( num_done != num_rules )
+	{
+		IPAERR("Only (%u) of (%u) rules added\n", num_done, num_rules);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( nstats.tot_base_ents_filled + nstats.tot_expn_ents_filled != num_rules )
+	{
+		IPAERR("Table holds (%u) rules, expected (%u)\n",
+			   nstats.tot_base_ents_filled + nstats.tot_expn_ents_filled,
+			   num_rules);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	ret = ipa_nat_del_ipv4_rules(tbl_hdl, rule_hdls, num_rules, &num_done);
+
+	currTimeAs(TimeAsNanSecs, &bat_del_ns);
+	bat_del_ns -= start;
+
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( nstats.tot_base_ents_filled + nstats.tot_expn_ents_filled != 0 )
+	{
+		IPAERR("Table not empty after batched delete\n");
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	IPAINFO("%s table, (%u) rules: "
+			"single add (%.0f/s) del (%.0f/s), "
+			"batch add (%.0f/s) del (%.0f/s)\n",
+			ipa3_nat_mem_in_as_str(nstats.nmi),
+			num_rules,
+			RULES_PER_SEC(num_rules, one_add_ns),
+			RULES_PER_SEC(num_rules, one_del_ns),
+			RULES_PER_SEC(num_rules, bat_add_ns),
+			RULES_PER_SEC(num_rules, bat_del_ns));
+
+	if ( sep )
+	{
+		ret = ipa_nat_del_ipv4_tbl(tbl_hdl);
+		*tbl_hdl_ptr = 0;
+		CHECK_ERR(ret);
+	}
+
+	IPADBG("Out\n");
+
+	return 0;
+}
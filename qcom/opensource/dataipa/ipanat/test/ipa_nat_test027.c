@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+
+/*=========================================================================*/
+/*!
+	@file
+	ipa_nat_test027.c
+
+	@brief
+	Verify the following scenario:
+	1. Add ipv4 table
+	2. Add a set of long lived rules
+	3. For a growing number of threads, have half the threads add and
+	   delete rules while the other half query the long lived rules'
+	   timestamps and walk the table, then report aggregate ops/sec
+	4. Check only the long lived rules remain, then delete them
+	5. Delete ipv4 table
+*/
+/*=========================================================================*/
+
+#include <pthread.h>
+
+#include "ipa_nat_test.h"
+
+#undef  MAX_THREADS
+#define MAX_THREADS 8
+
+#undef  OPS_PER_THREAD
+#define OPS_PER_THREAD 2048
+
+#undef  QUERIES_PER_WALK
+#define QUERIES_PER_WALK 256
+
+#undef  MAX_BASE_RULES
+#define MAX_BASE_RULES 512
+
+#undef  OPS_PER_SEC
+#define OPS_PER_SEC(n, ns) \
+	( (ns) ? ((double) (n) * NANOS_PER_SEC / (double) (ns)) : 0.0 )
+
+typedef struct
+{
+	u32               tbl_hdl;
+	bool              writer;
+	u32               num_base;
+	u32*              base_hdls;
+	ipa_nat_ipv4_rule rules[OPS_PER_THREAD / 2];
+	u32               ops;
+	int               ret;
+} stress_thread;
+
+static int count_rules(
+	ipa_table*      table_ptr,
+	uint32_t        rule_hdl,
+	void*           record_ptr,
+	uint16_t        record_index,
+	void*           meta_record_ptr,
+	uint16_t        meta_record_index,
+	void*           arb_data_ptr )
+{
+	u32* cnt_ptr = (u32*) arb_data_ptr;
+
+	(*cnt_ptr)++;
+
+	return 0;
+}
+
+static void* stress_writer(
+	stress_thread* st )
+{
+	u32 i, rule_hdl;
+
+	for ( i = 0; i < OPS_PER_THREAD / 2 && st->ret == 0; i++ )
+	{
+		st->ret = ipa_nat_add_ipv4_rule(st->tbl_hdl, &st->rules[i], &rule_hdl);
+
+		if ( st->ret == 0 )
+		{
+			st->ret = ipa_nat_del_ipv4_rule(st->tbl_hdl, rule_hdl);
+		}
+
+		st->ops += 2;
+	}
+
+	return NULL;
+}
+
+static void* stress_reader(
+	stress_thread* st )
+{
+	u32 i, time_stamp, cnt;
+
+	for ( i = 0; i < OPS_PER_THREAD && st->ret == 0; i++ )
+	{
+		if ( (i % QUERIES_PER_WALK) == 0 )
+		{
+			cnt = 0;
+
+			st->ret = ipa_nati_walk_ipv4_tbl(
+				st->tbl_hdl, USE_NAT_TABLE, count_rules, &cnt);
+
+			if ( st->ret == 0 && cnt < st->num_base )
+			{
+				IPAERR("Walk saw (%u) rules, expected at least (%u)\n",
+					   cnt, st->num_base);
+				st->ret = -1;
+			}
+		}
+		else
+		{
+			st->ret = ipa_nat_query_timestamp(
+				st->tbl_hdl, st->base_hdls[i % st->num_base], &time_stamp);
+		}
+
+		st->ops++;
+	}
+
+	return NULL;
+}
+
+static void* stress_thread_main(
+	void* arg )
+{
+	stress_thread* st = (stress_thread*) arg;
+
+	return (st->writer) ? stress_writer(st) : stress_reader(st);
+}
+
+int ipa_nat_test027(
+	const char* nat_mem_type,
+	u32 pub_ip_add,
+	int total_entries,
+	u32 tbl_hdl,
+	int sep,
+	void* arb_data_ptr)
+{
+	int* tbl_hdl_ptr = (int*) arb_data_ptr;
+
+	static stress_thread threads[MAX_THREADS];
+	static u32           base_hdls[MAX_BASE_RULES];
+
+	pthread_t tids[MAX_THREADS];
+
+	ipa_nati_tbl_stats nstats, istats;
+
+	ipa_nat_ipv4_rule ipv4_rule;
+
+	uint64_t start, elapsed_ns;
+
+	u32 i, j, num_base, num_threads, tot_ops;
+
+	int ret;
+
+	IPADBG("In\n");
+
+	if ( sep )
+	{
+		ret = ipa_nat_add_ipv4_tbl(pub_ip_add, nat_mem_type, total_entries, &tbl_hdl);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	ret = ipa_nati_clear_ipv4_tbl(tbl_hdl);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	/*
+	 * A quarter of the table, leaving room for the writers...
+	 */
+	num_base = nstats.tot_ents / 4;
+
+	if ( num_base > MAX_BASE_RULES )
+	{
+		num_base = MAX_BASE_RULES;
+	}
+
+	if ( num_base == 0 )
+	{
+		num_base = 1;
+	}
+
+	for ( i = 0; i < num_base; i++ )
+	{
+		memset(&ipv4_rule, 0, sizeof(ipv4_rule));
+
+		ipv4_rule.protocol     = IPPROTO_TCP;
+		ipv4_rule.public_port  = RAN_PORT;
+		ipv4_rule.target_ip    = RAN_ADDR;
+		ipv4_rule.target_port  = RAN_PORT;
+		ipv4_rule.private_ip   = RAN_ADDR;
+		ipv4_rule.private_port = RAN_PORT;
+
+		ret = ipa_nat_add_ipv4_rule(tbl_hdl, &ipv4_rule, &base_hdls[i]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	for ( num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2 )
+	{
+		for ( i = 0; i < num_threads; i++ )
+		{
+			stress_thread* st = &threads[i];
+
+			memset(st, 0, sizeof(stress_thread));
+
+			st->tbl_hdl   = tbl_hdl;
+			st->writer    = ((i % 2) == 0);
+			st->num_base  = num_base;
+			st->base_hdls = base_hdls;
+
+			for ( j = 0; st->writer && j < array_sz(st->rules); j++ )
+			{
+				st->rules[j].protocol     = IPPROTO_TCP;
+				st->rules[j].public_port  = RAN_PORT;
+				st->rules[j].target_ip    = RAN_ADDR;
+				st->rules[j].target_port  = RAN_PORT;
+				st->rules[j].private_ip   = RAN_ADDR;
+				st->rules[j].private_port = RAN_PORT;
+			}
+		}
+
+		currTimeAs(TimeAsNanSecs, &start);
+
+		for ( i = 0; i < num_threads; i++ )
+		{
+			ret = pthread_create(&tids[i], NULL, stress_thread_main, &threads[i]);
+
+			if ( ret != 0 )
+			{
+				IPAERR("pthread_create() failed: ret(%d)\n", ret);
+
+				while ( i-- )
+				{
+					pthread_join(tids[i], NULL);
+				}
+
+				CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+			}
+		}
+
+		for ( i = 0; i < num_threads; i++ )
+		{
+			pthread_join(tids[i], NULL);
+		}
+
+		currTimeAs(TimeAsNanSecs, &elapsed_ns);
+		elapsed_ns -= start;
+
+		for ( i = tot_ops = 0; i < num_threads; i++ )
+		{
+			CHECK_ERR_TBL_STOP(threads[i].ret, tbl_hdl);
+
+			tot_ops += threads[i].ops;
+		}
+
+		IPAINFO("%u thread(s): (%u) ops in (%llu) ns, (%.0f) ops/s\n",
+				num_threads,
+				tot_ops,
+				(unsigned long long) elapsed_ns,
+				OPS_PER_SEC(tot_ops, elapsed_ns));
+	}
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( nstats.tot_base_ents_filled + nstats.tot_expn_ents_filled != num_base )
+	{
+		IPAERR("Table holds (%u) rules, expected (%u)\n",
+			   nstats.tot_base_ents_filled + nstats.tot_expn_ents_filled,
+			   num_base);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	for ( i = 0; i < num_base; i++ )
+	{
+		ret = ipa_nat_del_ipv4_rule(tbl_hdl, base_hdls[i]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	if ( sep )
+	{
+		ret = ipa_nat_del_ipv4_tbl(tbl_hdl);
+		*tbl_hdl_ptr = 0;
+		CHECK_ERR(ret);
+	}
+
+	IPADBG("Out\n");
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+
+/*=========================================================================*/
+/*!
+	@file
+	ipa_nat_test028.c
+
+	@brief
+	Verify the following scenario:
+	1. Add 64K keys to a handle map, timing the adds
+	2. Find each key and check its value, timing the finds
+	3. Delete each key and check its value, timing the deletes
+	4. Report nanoseconds per operation for each
+
+	No NAT table is needed.
+*/
+/*=========================================================================*/
+
+#include "ipa_nat_test.h"
+#include "ipa_nat_map.h"
+
+#undef  NUM_MAP_KEYS
+#define NUM_MAP_KEYS (64 * 1024)
+
+/* Spread keys over 32 bits without repeats (odd multiplier) */
+#undef  MAP_KEY
+#define MAP_KEY(i) \
+	( (u32) (i) * 2246822519U )
+
+#undef  NS_PER_OP
+#define NS_PER_OP(ns, n) \
+	( (double) (ns) / (double) (n) )
+
+int ipa_nat_test028(
+	const char* nat_mem_type,
+	u32 pub_ip_add,
+	int total_entries,
+	u32 tbl_hdl,
+	int sep,
+	void* arb_data_ptr)
+{
+	uint64_t start, add_ns, find_ns, del_ns;
+
+	u32 i, val;
+
+	int ret;
+
+	IPADBG("In\n");
+
+	ret = ipa_nat_map_clear(MAP_NUM_99);
+	CHECK_ERR(ret);
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	for ( i = 0; i < NUM_MAP_KEYS; i++ )
+	{
+		ret = ipa_nat_map_add(MAP_NUM_99, MAP_KEY(i), i);
+
+		if ( ret )
+		{
+			CHECK_ERR(ret);
+		}
+	}
+
+	currTimeAs(TimeAsNanSecs, &add_ns);
+	add_ns -= start;
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	for ( i = 0; i < NUM_MAP_KEYS; i++ )
+	{
+		ret = ipa_nat_map_find(MAP_NUM_99, MAP_KEY(i), &val);
+
+		if ( ret || val != i )
+		{
+			IPAERR("key(%u) -> val(%u), expected (%u)\n", MAP_KEY(i), val, i);
+			CHECK_ERR(-1);
+		}
+	}
+
+	currTimeAs(TimeAsNanSecs, &find_ns);
+	find_ns -= start;
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	for ( i = 0; i < NUM_MAP_KEYS; i++ )
+	{
+		ret = ipa_nat_map_del(MAP_NUM_99, MAP_KEY(i), &val);
+
+		if ( ret || val != i )
+		{
+			IPAERR("key(%u) -> val(%u), expected (%u)\n", MAP_KEY(i), val, i);
+			CHECK_ERR(-1);
+		}
+	}
+
+	currTimeAs(TimeAsNanSecs, &del_ns);
+	del_ns -= start;
+
+	IPAINFO("(%u) keys: add (%.1f) find (%.1f) del (%.1f) ns/op\n",
+			NUM_MAP_KEYS,
+			NS_PER_OP(add_ns,  NUM_MAP_KEYS),
+			NS_PER_OP(find_ns, NUM_MAP_KEYS),
+			NS_PER_OP(del_ns,  NUM_MAP_KEYS));
+
+	IPADBG("Out\n");
+
+	return 0;
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+
+/*=========================================================================*/
+/*!
+	@file
+	ipa_nat_test029.c
+
+	@brief
+	Verify the following scenario (HYBRID only):
+	1. Add ipv4 table
+	2. Add rules until the table moves from SRAM to DDR
+	3. Delete rules until the table moves back to SRAM in one go,
+	   noting how long the table lock was held
+	4. Add rules until the table moves to DDR again
+	5. With a chunk size set, delete rules until the move back to SRAM
+	   starts, then keep adding and deleting rules and stepping the
+	   move along until it's done
+	6. Check every remaining rule can still be found, then compare the
+	   lock hold times of both moves
+	7. Delete the rules and the ipv4 table
+*/
+/*=========================================================================*/
+
+#include "ipa_nat_test.h"
+
+#undef  MAX_RULES
+#define MAX_RULES 4096
+
+#undef  CHUNK_SIZE
+#define CHUNK_SIZE 16
+
+static u32 rule_hdls[MAX_RULES];
+
+static int add_rule(
+	u32  tbl_hdl,
+	u32* rule_hdl_ptr )
+{
+	ipa_nat_ipv4_rule ipv4_rule;
+
+	memset(&ipv4_rule, 0, sizeof(ipv4_rule));
+
+	ipv4_rule.protocol     = IPPROTO_TCP;
+	ipv4_rule.public_port  = RAN_PORT;
+	ipv4_rule.target_ip    = RAN_ADDR;
+	ipv4_rule.target_port  = RAN_PORT;
+	ipv4_rule.private_ip   = RAN_ADDR;
+	ipv4_rule.private_port = RAN_PORT;
+
+	return ipa_nat_add_ipv4_rule(tbl_hdl, &ipv4_rule, rule_hdl_ptr);
+}
+
+/*
+ * Add rules until the table lands in nmi...
+ */
+static int add_until(
+	u32                  tbl_hdl,
+	enum ipa3_nat_mem_in nmi,
+	u32*                 num_ptr )
+{
+	ipa_nati_tbl_stats nstats, istats;
+
+	int ret = 0;
+
+	while ( *num_ptr < MAX_RULES )
+	{
+		ret = add_rule(tbl_hdl, &rule_hdls[*num_ptr]);
+
+		if ( ret != 0 )
+		{
+			break;
+		}
+
+		(*num_ptr)++;
+
+		ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+
+		if ( ret != 0 || nstats.nmi == nmi )
+		{
+			break;
+		}
+	}
+
+	return ret;
+}
+
+int ipa_nat_test029(
+	const char* nat_mem_type,
+	u32 pub_ip_add,
+	int total_entries,
+	u32 tbl_hdl,
+	int sep,
+	void* arb_data_ptr)
+{
+	int* tbl_hdl_ptr = (int*) arb_data_ptr;
+
+	ipa_nat_migration_stats mstats;
+
+	ipa_nati_tbl_stats nstats, istats;
+
+	uint64_t sync_hold_ns;
+
+	u32 i, num_rules, time_stamp, steps;
+
+	bool done;
+
+	int ret;
+
+	IPADBG("In\n");
+
+	if ( strcmp(nat_mem_type, "HYBRID") )
+	{
+		IPAINFO("Only meaningful in HYBRID mode, skipping\n");
+		return 0;
+	}
+
+	if ( sep )
+	{
+		ret = ipa_nat_add_ipv4_tbl(pub_ip_add, nat_mem_type, total_entries, &tbl_hdl);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	ret = ipa_nati_clear_ipv4_tbl(tbl_hdl);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nat_set_migration_chunk(0);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	num_rules = 0;
+
+	ret = add_until(tbl_hdl, IPA_NAT_MEM_IN_DDR, &num_rules);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( nstats.nmi != IPA_NAT_MEM_IN_DDR )
+	{
+		IPAINFO("Table never left SRAM after (%u) rules, skipping\n", num_rules);
+		goto cleanup;
+	}
+
+	/*
+	 * Move back to SRAM in one go...
+	 */
+	while ( num_rules && nstats.nmi != IPA_NAT_MEM_IN_SRAM )
+	{
+		ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[--num_rules]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+		ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	ret = ipa_nat_get_migration_stats(&mstats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	sync_hold_ns = mstats.max_hold_ns;
+
+	IPAINFO("Moved (%u) rules to SRAM in one go: lock held (%llu) ns\n",
+			num_rules,
+			(unsigned long long) sync_hold_ns);
+
+	ret = add_until(tbl_hdl, IPA_NAT_MEM_IN_DDR, &num_rules);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( nstats.nmi != IPA_NAT_MEM_IN_DDR )
+	{
+		IPAERR("Table still in %s after (%u) rules\n",
+			   ipa3_nat_mem_in_as_str(nstats.nmi), num_rules);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	/*
+	 * Now move back to SRAM a chunk at a time...
+	 */
+	ret = ipa_nat_set_migration_chunk(CHUNK_SIZE);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	memset(&mstats, 0, sizeof(mstats));
+
+	while ( num_rules && ! mstats.in_progress )
+	{
+		ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[--num_rules]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+		ret = ipa_nat_get_migration_stats(&mstats);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	if ( ! mstats.in_progress || mstats.to_nmi != IPA_NAT_MEM_IN_SRAM )
+	{
+		IPAERR("Incremental move to SRAM didn't start\n");
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	/*
+	 * Churn while the move is under way: replace the oldest rule with
+	 * a new one, then copy another chunk...
+	 */
+	for ( i = steps = 0, done = false; ! done; steps++ )
+	{
+		ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[i]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+		ret = add_rule(tbl_hdl, &rule_hdls[i]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+		i = (i + 1) % num_rules;
+
+		ret = ipa_nat_migration_step(&done);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	ret = ipa_nat_get_migration_stats(&mstats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( nstats.nmi != IPA_NAT_MEM_IN_SRAM )
+	{
+		IPAERR("Table is in %s after incremental move, expected SRAM\n",
+			   ipa3_nat_mem_in_as_str(nstats.nmi));
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	if ( nstats.tot_base_ents_filled + nstats.tot_expn_ents_filled != num_rules )
+	{
+		IPAERR("Table holds (%u) rules, expected (%u)\n",
+			   nstats.tot_base_ents_filled + nstats.tot_expn_ents_filled,
+			   num_rules);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = ipa_nat_query_timestamp(tbl_hdl, rule_hdls[i], &time_stamp);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	IPAINFO("Moved (%u) rules to SRAM in (%u) chunks over (%u) steps: "
+			"lock held at most (%llu) ns vs (%llu) ns in one go, "
+			"(%u) changes mirrored, cutover took (%llu) ns\n",
+			mstats.rules_copied,
+			mstats.chunks,
+			steps,
+			(unsigned long long) mstats.max_hold_ns,
+			(unsigned long long) sync_hold_ns,
+			mstats.rules_mirrored,
+			(unsigned long long) mstats.last_cutover_ns);
+
+cleanup:
+	ret = ipa_nat_set_migration_chunk(0);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[i]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	if ( sep )
+	{
+		ret = ipa_nat_del_ipv4_tbl(tbl_hdl);
+		*tbl_hdl_ptr = 0;
+		CHECK_ERR(ret);
+	}
+
+	IPADBG("Out\n");
+
+	return 0;
+}
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+
+/*=========================================================================*/
+/*!
+	@file
+	ipa_nat_test030.c
+
+	@brief
+	Verify the following scenario:
+	1. Add ipv4 table
+	2. Fill half the table, then check the chain stats kept by the
+	   table against ones found by walking the chains
+	3. Walk the whole table in one go, reading each rule's timestamp
+	   in place
+	4. Walk it again a slice at a time, replacing a rule between
+	   slices, and check every untouched rule was seen
+	5. Check the chain stats again, delete the rules, and check the
+	   stats show no chains
+	6. Delete ipv4 table
+*/
+/*=========================================================================*/
+
+#include "ipa_nat_test.h"
+
+#undef  MAX_RULES
+#define MAX_RULES 2048
+
+#undef  SLICE_ENTS
+#define SLICE_ENTS 64
+
+typedef struct
+{
+	u32 tot_chains;
+	u32 min_chain_len;
+	u32 max_chain_len;
+} walked_chain_stats;
+
+typedef struct
+{
+	u32 seen;
+	u32 ts_xor;
+} sweep_stats;
+
+static u32 rule_hdls[MAX_RULES];
+
+static int walk_chains(
+	ipa_table*      table_ptr,
+	uint32_t        rule_hdl,
+	void*           record_ptr,
+	uint16_t        record_index,
+	void*           meta_record_ptr,
+	uint16_t        meta_record_index,
+	void*           arb_data_ptr )
+{
+	walked_chain_stats* wcs_ptr = (walked_chain_stats*) arb_data_ptr;
+
+	struct ipa_nat_rule* rule_ptr = (struct ipa_nat_rule*) record_ptr;
+
+	u32 len = 1;
+
+	if ( record_index >= table_ptr->table_entries )
+	{
+		return 1; /* chain heads are all in the base table */
+	}
+
+	if ( ! rule_ptr->next_index )
+	{
+		return 0;
+	}
+
+	while ( rule_ptr->next_index && len < table_ptr->tot_tbl_ents )
+	{
+		len++;
+		rule_ptr = (struct ipa_nat_rule*)
+			GOTO_REC(table_ptr, rule_ptr->next_index);
+	}
+
+	wcs_ptr->tot_chains++;
+
+	if ( wcs_ptr->min_chain_len == 0 || len < wcs_ptr->min_chain_len )
+	{
+		wcs_ptr->min_chain_len = len;
+	}
+
+	if ( len > wcs_ptr->max_chain_len )
+	{
+		wcs_ptr->max_chain_len = len;
+	}
+
+	return 0;
+}
+
+static int sweep_rule(
+	ipa_table*      table_ptr,
+	uint32_t        rule_hdl,
+	void*           record_ptr,
+	uint16_t        record_index,
+	void*           meta_record_ptr,
+	uint16_t        meta_record_index,
+	void*           arb_data_ptr )
+{
+	sweep_stats* ss_ptr = (sweep_stats*) arb_data_ptr;
+
+	ss_ptr->seen++;
+	ss_ptr->ts_xor ^= IPA_NATI_REC_TIMESTAMP(record_ptr);
+
+	return 0;
+}
+
+static int check_chain_stats(
+	u32 tbl_hdl )
+{
+	ipa_nati_tbl_stats nstats, istats;
+
+	walked_chain_stats wcs;
+
+	u32 i, hist_chains;
+
+	int ret;
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+
+	if ( ret != 0 )
+	{
+		return ret;
+	}
+
+	memset(&wcs, 0, sizeof(wcs));
+
+	ret = ipa_nati_walk_ipv4_tbl(tbl_hdl, USE_NAT_TABLE, walk_chains, &wcs);
+
+	if ( ret < 0 )
+	{
+		return ret;
+	}
+
+	for ( i = 2, hist_chains = 0; i < IPA_TABLE_CHAIN_HIST_SZ; i++ )
+	{
+		hist_chains += nstats.chain_hist[i];
+	}
+
+	IPADBG("kept: chains(%u) min(%u) max(%u) avg(%f) "
+		   "walked: chains(%u) min(%u) max(%u)\n",
+		   nstats.tot_chains,
+		   nstats.min_chain_len,
+		   nstats.max_chain_len,
+		   nstats.avg_chain_len,
+		   wcs.tot_chains,
+		   wcs.min_chain_len,
+		   wcs.max_chain_len);
+
+	if ( nstats.tot_chains    != wcs.tot_chains    ||
+		 nstats.min_chain_len != wcs.min_chain_len ||
+		 nstats.max_chain_len != wcs.max_chain_len ||
+		 hist_chains          != wcs.tot_chains )
+	{
+		IPAERR("Kept chain stats (%u/%u/%u) don't match walked (%u/%u/%u)\n",
+			   nstats.tot_chains,
+			   nstats.min_chain_len,
+			   nstats.max_chain_len,
+			   wcs.tot_chains,
+			   wcs.min_chain_len,
+			   wcs.max_chain_len);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int add_rule(
+	u32  tbl_hdl,
+	u32* rule_hdl_ptr )
+{
+	ipa_nat_ipv4_rule ipv4_rule;
+
+	memset(&ipv4_rule, 0, sizeof(ipv4_rule));
+
+	ipv4_rule.protocol     = IPPROTO_TCP;
+	ipv4_rule.public_port  = RAN_PORT;
+	ipv4_rule.target_ip    = RAN_ADDR;
+	ipv4_rule.target_port  = RAN_PORT;
+	ipv4_rule.private_ip   = RAN_ADDR;
+	ipv4_rule.private_port = RAN_PORT;
+
+	return ipa_nat_add_ipv4_rule(tbl_hdl, &ipv4_rule, rule_hdl_ptr);
+}
+
+int ipa_nat_test030(
+	const char* nat_mem_type,
+	u32 pub_ip_add,
+	int total_entries,
+	u32 tbl_hdl,
+	int sep,
+	void* arb_data_ptr)
+{
+	int* tbl_hdl_ptr = (int*) arb_data_ptr;
+
+	ipa_nati_tbl_stats nstats, istats;
+
+	ipa_nati_walk_cursor cursor;
+
+	sweep_stats ss;
+
+	uint64_t start, stop, full_ns, slice_ns, max_slice_ns;
+
+	u32 i, num_rules, replaced;
+
+	int ret;
+
+	IPADBG("In\n");
+
+	if ( sep )
+	{
+		ret = ipa_nat_add_ipv4_tbl(pub_ip_add, nat_mem_type, total_entries, &tbl_hdl);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	ret = ipa_nati_clear_ipv4_tbl(tbl_hdl);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	num_rules = nstats.tot_ents / 2;
+
+	if ( num_rules > MAX_RULES )
+	{
+		num_rules = MAX_RULES;
+	}
+
+	/*
+	 * Random rules may fill a small expansion table early, the walk
+	 * only needs whatever made it in...
+	 */
+	for ( i = 0; i < num_rules; i++ )
+	{
+		if ( add_rule(tbl_hdl, &rule_hdls[i]) != 0 )
+		{
+			break;
+		}
+	}
+
+	num_rules = i;
+
+	if ( num_rules == 0 )
+	{
+		IPAERR("No rule could be added\n");
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	ret = check_chain_stats(tbl_hdl);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	/*
+	 * All of it in one go...
+	 */
+	memset(&ss, 0, sizeof(ss));
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	ret = ipa_nati_walk_ipv4_tbl(tbl_hdl, USE_NAT_TABLE, sweep_rule, &ss);
+
+	currTimeAs(TimeAsNanSecs, &stop);
+
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	full_ns = stop - start;
+
+	if ( ss.seen != num_rules )
+	{
+		IPAERR("Walk saw (%u) rules, expected (%u)\n", ss.seen, num_rules);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	/*
+	 * A slice at a time, with a rule replaced between slices...
+	 */
+	memset(&ss, 0, sizeof(ss));
+
+	ipa_nati_walk_cursor_init(&cursor);
+
+	max_slice_ns = 0;
+
+	for ( replaced = 0; ! cursor.done; replaced++ )
+	{
+		currTimeAs(TimeAsNanSecs, &start);
+
+		ret = ipa_nati_walk_ipv4_tbl_slice(
+			tbl_hdl, USE_NAT_TABLE, &cursor, SLICE_ENTS, sweep_rule, &ss);
+
+		currTimeAs(TimeAsNanSecs, &stop);
+
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+		slice_ns = stop - start;
+
+		if ( slice_ns > max_slice_ns )
+		{
+			max_slice_ns = slice_ns;
+		}
+
+		i = replaced % num_rules;
+
+		if ( rule_hdls[i] )
+		{
+			ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[i]);
+			CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+		}
+
+		/*
+		 * A deleted entry can stay in its chain, so the new rule may not
+		 * find room; it's then simply left out...
+		 */
+		if ( add_rule(tbl_hdl, &rule_hdls[i]) != 0 )
+		{
+			rule_hdls[i] = 0;
+		}
+	}
+
+	if ( cursor.restarts == 0 && ss.seen + replaced < num_rules )
+	{
+		IPAERR("Sliced walk saw (%u) rules, expected at least (%u)\n",
+			   ss.seen, num_rules - replaced);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	IPAINFO("(%u) rules: whole walk (%llu) ns, (%u) slices of (%u) "
+			"held the table at most (%llu) ns each, (%u) restarts\n",
+			num_rules,
+			(unsigned long long) full_ns,
+			cursor.slices,
+			SLICE_ENTS,
+			(unsigned long long) max_slice_ns,
+			cursor.restarts);
+
+	ret = check_chain_stats(tbl_hdl);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		if ( rule_hdls[i] == 0 )
+		{
+			continue;
+		}
+
+		ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[i]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	for ( i = 0; i < IPA_TABLE_CHAIN_HIST_SZ; i++ )
+	{
+		if ( nstats.chain_hist[i] || istats.chain_hist[i] )
+		{
+			IPAERR("Chain histogram bucket (%u) not empty after deletes\n", i);
+			CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+		}
+	}
+
+	if ( sep )
+	{
+		ret = ipa_nat_del_ipv4_tbl(tbl_hdl);
+		*tbl_hdl_ptr = 0;
+		CHECK_ERR(ret);
+	}
+
+	IPADBG("Out\n");
+
+	return 0;
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+/*=========================================================================*/
+/*!
+	@file
+	ipa_nat_test031.c
+
+	@brief
+	IPv6CT churn benchmark:
+	1. Add IPv6CT table
+	2. Add, query the timestamps of, and delete a set of rules one at
+	   a time, timing each
+	3. Do the same using the bulk API, timing each
+	4. Churn: repeatedly bulk delete half the rules and bulk add new
+	   ones in their place, timing each round
+	5. Report rules per second, and DMA commands posted when run
+	   against the simulated IPA (-S)
+	6. Delete IPv6CT table
+
+	Note: ignores the ipv4 table the suite hands it.
+*/
+/*=========================================================================*/
+
+#include "ipa_nat_test.h"
+#include "ipa_ipv6ct.h"
+#include "ipa_nat_sim.h"
+
+#undef  MAX_RULES
+#define MAX_RULES 1024
+
+#undef  CHURN_ROUNDS
+#define CHURN_ROUNDS 16
+
+#undef  RULES_PER_SEC
+#define RULES_PER_SEC(n, ns) \
+	( (ns) ? ((double) (n) * NANOS_PER_SEC / (double) (ns)) : 0.0 )
+
+#undef  CHECK_ERR_CT
+#define CHECK_ERR_CT(x, th)							\
+	if ( x ) {										\
+		IPAERR("Abrupt end of %s with "				\
+			   "err: %d at line: %d\n",				\
+			   __FUNCTION__, x, __LINE__);			\
+		ipa_ipv6ct_del_tbl(th);						\
+		return -1;									\
+	}
+
+static void make_rule(
+	ipa_ipv6ct_rule* rule_ptr )
+{
+	memset(rule_ptr, 0, sizeof(*rule_ptr));
+
+	rule_ptr->src_ipv6_lsb  = ((uint64_t) rand() << 32) | (uint32_t) rand();
+	rule_ptr->src_ipv6_msb  = 0x20010DB800000000ULL | (uint32_t) rand();
+	rule_ptr->dest_ipv6_lsb = ((uint64_t) rand() << 32) | (uint32_t) rand();
+	rule_ptr->dest_ipv6_msb = 0x20010DB800000000ULL | (uint32_t) rand();
+	rule_ptr->src_port      = RAN_PORT;
+	rule_ptr->dest_port     = RAN_PORT;
+	rule_ptr->protocol      = (rand() & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+
+	rule_ptr->direction_settings = IPA_IPV6CT_DIRECTION_ALLOW_ALL;
+}
+
+int ipa_nat_test031(
+	const char* nat_mem_type,
+	u32 pub_ip_add,
+	int total_entries,
+	u32 tbl_hdl,
+	int sep,
+	void* arb_data_ptr)
+{
+	static ipa_ipv6ct_rule ct_rules[MAX_RULES];
+	static u32             rule_hdls[MAX_RULES];
+	static u32             churn_hdls[MAX_RULES / 2];
+	static u32             time_stamps[MAX_RULES];
+
+	ipa_nat_sim_stats ss;
+
+	uint64_t start, stop;
+	uint64_t one_add_ns, one_qry_ns, one_del_ns;
+	uint64_t bat_add_ns, bat_qry_ns, bat_del_ns;
+	uint64_t churn_ns;
+	uint64_t one_dma, bat_dma, dma;
+
+	u32 ct_hdl = 0, i, j, num_rules, num_churn, num_done;
+
+	int ret;
+
+	IPADBG("In\n");
+
+	num_rules = (total_entries > 0 && total_entries < MAX_RULES * 2) ?
+		(u32) total_entries / 2 : MAX_RULES;
+
+	ret = ipa_ipv6ct_add_tbl((uint16_t) (num_rules * 2), &ct_hdl);
+	CHECK_ERR(ret);
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		make_rule(&ct_rules[i]);
+	}
+
+	/*
+	 * One at a time...
+	 */
+	ipa_nat_sim_get_stats(&ss);
+	dma = ss.dma_cmds;
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = ipa_ipv6ct_add_rule(ct_hdl, &ct_rules[i], &rule_hdls[i]);
+		CHECK_ERR_CT(ret, ct_hdl);
+	}
+
+	currTimeAs(TimeAsNanSecs, &stop);
+	one_add_ns = stop - start;
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = ipa_ipv6ct_query_timestamp(ct_hdl, rule_hdls[i], &time_stamps[i]);
+		CHECK_ERR_CT(ret, ct_hdl);
+	}
+
+	currTimeAs(TimeAsNanSecs, &start);
+	one_qry_ns = start - stop;
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = ipa_ipv6ct_del_rule(ct_hdl, rule_hdls[i]);
+		CHECK_ERR_CT(ret, ct_hdl);
+	}
+
+	currTimeAs(TimeAsNanSecs, &stop);
+	one_del_ns = stop - start;
+
+	ipa_nat_sim_get_stats(&ss);
+	one_dma = ss.dma_cmds - dma;
+	dma     = ss.dma_cmds;
+
+	/*
+	 * Bulk...
+	 */
+	currTimeAs(TimeAsNanSecs, &start);
+
+	ret = ipa_ipv6ct_add_rules(ct_hdl, ct_rules, num_rules, rule_hdls, &num_done);
+	CHECK_ERR_CT(ret, ct_hdl);
+
+	currTimeAs(TimeAsNanSecs, &stop);
+	bat_add_ns = stop - start;
+
+	if ( num_done != num_rules )
+	{
+		IPAERR("Only (%u) of (%u) rules added\n", num_done, num_rules);
+		CHECK_ERR_CT(-1, ct_hdl);
+	}
+
+	ret = ipa_ipv6ct_query_timestamps(ct_hdl, rule_hdls, num_rules, time_stamps);
+	CHECK_ERR_CT(ret, ct_hdl);
+
+	currTimeAs(TimeAsNanSecs, &start);
+	bat_qry_ns = start - stop;
+
+	ret = ipa_ipv6ct_del_rules(ct_hdl, rule_hdls, num_rules, &num_done);
+	CHECK_ERR_CT(ret, ct_hdl);
+
+	currTimeAs(TimeAsNanSecs, &stop);
+	bat_del_ns = stop - start;
+
+	if ( num_done != num_rules )
+	{
+		IPAERR("Only (%u) of (%u) rules deleted\n", num_done, num_rules);
+		CHECK_ERR_CT(-1, ct_hdl);
+	}
+
+	ipa_nat_sim_get_stats(&ss);
+	bat_dma = ss.dma_cmds - dma;
+
+	/*
+	 * Churn. Every round replaces half the connections with new ones,
+	 * so expansion slots that weren't handed back would soon run the
+	 * table out of room...
+	 */
+	ret = ipa_ipv6ct_add_rules(ct_hdl, ct_rules, num_rules, rule_hdls, &num_done);
+	CHECK_ERR_CT(ret, ct_hdl);
+
+	num_churn = num_rules / 2;
+	churn_ns  = 0;
+
+	for ( j = 0; j < CHURN_ROUNDS; j++ )
+	{
+		u32 first = (j & 1) ? num_churn : 0;
+
+		for ( i = 0; i < num_churn; i++ )
+		{
+			churn_hdls[i] = rule_hdls[first + i];
+			make_rule(&ct_rules[first + i]);
+		}
+
+		currTimeAs(TimeAsNanSecs, &start);
+
+		ret = ipa_ipv6ct_del_rules(ct_hdl, churn_hdls, num_churn, &num_done);
+		CHECK_ERR_CT(ret, ct_hdl);
+
+		ret = ipa_ipv6ct_add_rules(
+			ct_hdl, &ct_rules[first], num_churn, &rule_hdls[first], &num_done);
+		CHECK_ERR_CT(ret, ct_hdl);
+
+		currTimeAs(TimeAsNanSecs, &stop);
+		churn_ns += stop - start;
+
+		if ( num_done != num_churn )
+		{
+			IPAERR("Round (%u): only (%u) of (%u) rules added\n",
+				   j, num_done, num_churn);
+			CHECK_ERR_CT(-1, ct_hdl);
+		}
+	}
+
+	ret = ipa_ipv6ct_query_timestamps(ct_hdl, rule_hdls, num_rules, time_stamps);
+	CHECK_ERR_CT(ret, ct_hdl);
+
+	ret = ipa_ipv6ct_del_rules(ct_hdl, rule_hdls, num_rules, &num_done);
+	CHECK_ERR_CT(ret, ct_hdl);
+
+	IPAINFO("IPv6CT, (%u) rules: "
+			"single add (%.0f/s) query (%.0f/s) del (%.0f/s), "
+			"bulk add (%.0f/s) query (%.0f/s) del (%.0f/s), "
+			"churn (%.0f/s)\n",
+			num_rules,
+			RULES_PER_SEC(num_rules, one_add_ns),
+			RULES_PER_SEC(num_rules, one_qry_ns),
+			RULES_PER_SEC(num_rules, one_del_ns),
+			RULES_PER_SEC(num_rules, bat_add_ns),
+			RULES_PER_SEC(num_rules, bat_qry_ns),
+			RULES_PER_SEC(num_rules, bat_del_ns),
+			RULES_PER_SEC(2 * num_churn * CHURN_ROUNDS, churn_ns));
+
+	if ( one_dma )
+	{
+		IPAINFO("IPv6CT DMA commands: single (%llu) bulk (%llu)\n",
+				(unsigned long long) one_dma,
+				(unsigned long long) bat_dma);
+
+		if ( bat_dma >= one_dma )
+		{
+			IPAERR("Bulk calls posted no fewer DMA commands than single ones\n");
+			CHECK_ERR_CT(-1, ct_hdl);
+		}
+	}
+
+	ret = ipa_ipv6ct_del_tbl(ct_hdl);
+	CHECK_ERR(ret);
+
+	IPADBG("Out\n");
+
+	return 0;
+}
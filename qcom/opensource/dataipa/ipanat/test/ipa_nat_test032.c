@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+
+/*=========================================================================*/
+/*!
+	@file
+	ipa_nat_test032.c
+
+	@brief
+	Verify the following scenario:
+	1. Add ipv4 table
+	2. Fill half the table, then age it once and check nothing has
+	   expired, since the sweep only now sees the rules' timestamps
+	3. Time that sweep against a timestamp query per rule
+	4. Wait past the idle time and check the expired handles are
+	   capped at the array size given
+	5. Replace a rule and check its new rule hasn't expired
+	6. Age again, deleting the expired rules, then delete the new
+	   rule and check the table is empty
+	7. Delete ipv4 table
+*/
+/*=========================================================================*/
+
+#include "ipa_nat_test.h"
+
+#undef  MAX_RULES
+#define MAX_RULES 2048
+
+#undef  IDLE_MS
+#define IDLE_MS 20
+
+static u32 rule_hdls[MAX_RULES];
+static u32 expired_hdls[MAX_RULES];
+
+static int add_rule(
+	u32  tbl_hdl,
+	u32* rule_hdl_ptr )
+{
+	ipa_nat_ipv4_rule ipv4_rule;
+
+	memset(&ipv4_rule, 0, sizeof(ipv4_rule));
+
+	ipv4_rule.protocol     = IPPROTO_TCP;
+	ipv4_rule.public_port  = RAN_PORT;
+	ipv4_rule.target_ip    = RAN_ADDR;
+	ipv4_rule.target_port  = RAN_PORT;
+	ipv4_rule.private_ip   = RAN_ADDR;
+	ipv4_rule.private_port = RAN_PORT;
+
+	return ipa_nat_add_ipv4_rule(tbl_hdl, &ipv4_rule, rule_hdl_ptr);
+}
+
+static void sleep_past_idle(void)
+{
+	struct timespec ts = { 0, (IDLE_MS + 5) * 1000000L };
+
+	while ( nanosleep(&ts, &ts) != 0 )
+		;
+}
+
+int ipa_nat_test032(
+	const char* nat_mem_type,
+	u32 pub_ip_add,
+	int total_entries,
+	u32 tbl_hdl,
+	int sep,
+	void* arb_data_ptr)
+{
+	int* tbl_hdl_ptr = (int*) arb_data_ptr;
+
+	ipa_nati_tbl_stats nstats, istats;
+
+	uint64_t start, stop, sweep_ns, query_ns;
+
+	u32 i, num_rules, num_expired, time_stamp;
+
+	int ret;
+
+	IPADBG("In\n");
+
+	if ( sep )
+	{
+		ret = ipa_nat_add_ipv4_tbl(pub_ip_add, nat_mem_type, total_entries, &tbl_hdl);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	ret = ipa_nati_clear_ipv4_tbl(tbl_hdl);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	num_rules = nstats.tot_ents / 2;
+
+	if ( num_rules > MAX_RULES )
+	{
+		num_rules = MAX_RULES;
+	}
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = add_rule(tbl_hdl, &rule_hdls[i]);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	/*
+	 * The first sweep only learns the timestamps...
+	 */
+	currTimeAs(TimeAsNanSecs, &start);
+
+	ret = ipa_nat_age_ipv4_rules(
+		tbl_hdl, IDLE_MS, false, expired_hdls, MAX_RULES, &num_expired);
+
+	currTimeAs(TimeAsNanSecs, &stop);
+
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	sweep_ns = stop - start;
+
+	if ( num_expired != 0 )
+	{
+		IPAERR("First sweep expired (%u) rules, expected none\n", num_expired);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	currTimeAs(TimeAsNanSecs, &start);
+
+	for ( i = 0; i < num_rules; i++ )
+	{
+		ret = ipa_nat_query_timestamp(tbl_hdl, rule_hdls[i], &time_stamp);
+		CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+	}
+
+	currTimeAs(TimeAsNanSecs, &stop);
+
+	query_ns = stop - start;
+
+	IPAINFO("(%u) rules: one sweep (%llu) ns, per rule queries (%llu) ns\n",
+			num_rules,
+			(unsigned long long) sweep_ns,
+			(unsigned long long) query_ns);
+
+	sleep_past_idle();
+
+	/*
+	 * Only as many as fit come back...
+	 */
+	ret = ipa_nat_age_ipv4_rules(
+		tbl_hdl, IDLE_MS, false, expired_hdls, num_rules / 2, &num_expired);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( num_expired != num_rules / 2 )
+	{
+		IPAERR("Capped sweep expired (%u) rules, expected (%u)\n",
+			   num_expired, num_rules / 2);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	/*
+	 * A new rule in an old rule's place starts afresh...
+	 */
+	ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[0]);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = add_rule(tbl_hdl, &rule_hdls[0]);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nat_age_ipv4_rules(
+		tbl_hdl, IDLE_MS, false, expired_hdls, MAX_RULES, &num_expired);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( num_expired != num_rules - 1 )
+	{
+		IPAERR("Sweep expired (%u) rules, expected (%u)\n",
+			   num_expired, num_rules - 1);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	for ( i = 0; i < num_expired; i++ )
+	{
+		if ( expired_hdls[i] == rule_hdls[0] )
+		{
+			IPAERR("New rule (%u) expired with the old ones\n", rule_hdls[0]);
+			CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+		}
+	}
+
+	/*
+	 * Now have them deleted too...
+	 */
+	ret = ipa_nat_age_ipv4_rules(
+		tbl_hdl, IDLE_MS, true, expired_hdls, MAX_RULES, &num_expired);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( num_expired != num_rules - 1 )
+	{
+		IPAERR("Deleting sweep expired (%u) rules, expected (%u)\n",
+			   num_expired, num_rules - 1);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	ret = ipa_nat_del_ipv4_rule(tbl_hdl, rule_hdls[0]);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	ret = ipa_nati_ipv4_tbl_stats(tbl_hdl, &nstats, &istats);
+	CHECK_ERR_TBL_STOP(ret, tbl_hdl);
+
+	if ( nstats.tot_base_ents_filled || nstats.tot_expn_ents_filled )
+	{
+		IPAERR("(%u) rules left after deleting sweep and new rule\n",
+			   nstats.tot_base_ents_filled + nstats.tot_expn_ents_filled);
+		CHECK_ERR_TBL_STOP(-1, tbl_hdl);
+	}
+
+	if ( sep )
+	{
+		ret = ipa_nat_del_ipv4_tbl(tbl_hdl);
+		*tbl_hdl_ptr = 0;
+		CHECK_ERR(ret);
+	}
+
+	IPADBG("Out\n");
+
+	return 0;
+}
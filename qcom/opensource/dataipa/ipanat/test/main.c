@@ -39,6 +39,7 @@
 
 #include "ipa_nat_test.h"
 #include "ipa_nat_map.h"
+#include "ipa_nat_sim.h"
 
 #undef strcasesame
 #define strcasesame(x, y) \
@@ -309,7 +310,7 @@ _dispUsage(
 	const char* progNamePtr )
 {
 	printf(
-		"Usage: %s [-d -r N -i N -e N -m mt]\n"
+		"Usage: %s [-d -r N -i N -e N -m mt -S N]\n"
 		"Where:\n"
 		"  -d     Each test is discrete (create table, add rules, destroy table)\n"
 		"         If not specified, only one table create and destroy for all tests\n"
@@ -318,7 +319,9 @@ _dispUsage(
 		"  -e N   Where N is the number of entries in the NAT\n"
 		"  -m mt  Where mt is the type of memory to use for the NAT\n"
 		"         Legal mt's: DDR, SRAM, or HYBRID (ie. use SRAM and DDR)\n"
-		"  -g M-N Run tests M through N only\n",
+		"  -g M-N Run tests M through N only\n"
+		"  -S N   Run against the simulated IPA (no device needed), with\n"
+		"         N bytes of SRAM for the NAT (0 for none)\n",
 		progNamePtr);
 
 	fflush(stdout);
@@ -351,6 +354,13 @@ static NatTests nt_array[] = {
 	NAT_TEST_ENTRY(ipa_nat_test023, IPA_NAT_TEST_PRE_COND_TE, 0),
 	NAT_TEST_ENTRY(ipa_nat_test024, IPA_NAT_TEST_PRE_COND_TE, 0),
 	NAT_TEST_ENTRY(ipa_nat_test025, IPA_NAT_TEST_PRE_COND_TE, 0),
+	NAT_TEST_ENTRY(ipa_nat_test026, IPA_NAT_TEST_PRE_COND_TE, 0),
+	NAT_TEST_ENTRY(ipa_nat_test027, IPA_NAT_TEST_PRE_COND_TE, 0),
+	NAT_TEST_ENTRY(ipa_nat_test028, 1, 0),
+	NAT_TEST_ENTRY(ipa_nat_test029, IPA_NAT_TEST_PRE_COND_TE, 0),
+	NAT_TEST_ENTRY(ipa_nat_test030, IPA_NAT_TEST_PRE_COND_TE, 0),
+	NAT_TEST_ENTRY(ipa_nat_test031, IPA_NAT_TEST_PRE_COND_TE, 0),
+	NAT_TEST_ENTRY(ipa_nat_test032, IPA_NAT_TEST_PRE_COND_TE, 0),
 	/*
 	 * Add new tests just above this comment. Keep the following two
 	 * at the end...
@@ -370,6 +380,9 @@ int main(
 	uint32_t ht         = 0;
 	uint32_t start = 0, end = 0;
 
+	bool            use_sim = false;
+	ipa_nat_sim_cfg sim_cfg = { IPA_HW_v4_0, 0 };
+
 	char* nat_mem_type = "DDR";
 
 	uint32_t tbl_hdl    = 0;
@@ -386,7 +399,7 @@ int main(
 
 	IPADBG("Testing user space nat driver\n");
 
-	while ( (c = getopt(argc, argv, "dr:i:e:m:h:g:?")) != -1 )
+	while ( (c = getopt(argc, argv, "dr:i:e:m:h:g:S:?")) != -1 )
 	{
 		switch (c)
 		{
@@ -423,6 +436,10 @@ int main(
 				exit(0);
 			}
 			break;
+		case 'S':
+			use_sim           = true;
+			sim_cfg.sram_size = atoi(optarg);
+			break;
 		case '?':
 		default:
 			_dispUsage(basename(argv[0]));
@@ -431,6 +448,12 @@ int main(
 		}
 	}
 
+	if ( use_sim && ipa_nat_sim_enable(&sim_cfg) )
+	{
+		fprintf(stderr, "Unable to enable the simulated IPA\n");
+		exit(1);
+	}
+
 	srand(time(&t));
 
 	pub_ip_addr = RAN_ADDR;
@@ -503,5 +526,20 @@ int main(
 	IPADBG("Total NAT Tests Run:%u, Pass:%u, Fail:%u\n",
 		   exec, pass, exec - pass);
 
+	if ( use_sim )
+	{
+		ipa_nat_sim_stats ss;
+
+		ipa_nat_sim_get_stats(&ss);
+
+		IPAINFO("Simulated IPA: init_cmds(%llu) dma_cmds(%llu) "
+				"dma_entries(%llu) dma_rejects(%llu) pdn_mods(%llu)\n",
+				(unsigned long long) ss.init_cmds,
+				(unsigned long long) ss.dma_cmds,
+				(unsigned long long) ss.dma_entries,
+				(unsigned long long) ss.dma_rejects,
+				(unsigned long long) ss.pdn_mods);
+	}
+
 	return 0;
 }
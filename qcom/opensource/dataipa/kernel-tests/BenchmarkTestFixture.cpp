@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>	// std::sort
+#include <sstream>
+#include "BenchmarkTestFixture.h"
+
+//////////////////////////////////////////////////////////////////////
+
+static uint64_t NowNs()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+BenchmarkTestFixture::BenchmarkTestFixture() :
+		m_warmupIterations(DFLT_WARMUP_ITERATIONS),
+		m_measureIterations(DFLT_MEASURE_ITERATIONS),
+		m_packets(0),
+		m_bytes(0),
+		m_elapsedNs(0)
+{
+	memset(m_latencyHist, 0, sizeof(m_latencyHist));
+}
+
+//////////////////////////////////////////////////////////////////////
+
+BenchmarkTestFixture::~BenchmarkTestFixture()
+{
+
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool BenchmarkTestFixture::RunBenchmark(TestBase &test)
+{
+	size_t packets, bytes;
+	uint64_t start, begin, end;
+	unsigned int i, bucket;
+
+	m_packets = m_bytes = m_elapsedNs = 0;
+	m_latencyNs.clear();
+	m_latencyNs.reserve(m_measureIterations);
+	memset(m_latencyHist, 0, sizeof(m_latencyHist));
+
+	printf("Benchmark %s: %u warm-up, %u measured iterations\n",
+		test.m_name.c_str(), m_warmupIterations, m_measureIterations);
+
+	for (i = 0; i < m_warmupIterations; i++) {
+		if (!BenchmarkIteration(packets, bytes)) {
+			printf("Warm-up iteration %u failed\n", i);
+			return false;
+		}
+	}
+
+	start = NowNs();
+
+	for (i = 0; i < m_measureIterations; i++) {
+		packets = bytes = 0;
+
+		begin = NowNs();
+		if (!BenchmarkIteration(packets, bytes)) {
+			printf("Measured iteration %u failed\n", i);
+			return false;
+		}
+		end = NowNs();
+
+		m_packets += packets;
+		m_bytes += bytes;
+		m_latencyNs.push_back(end - begin);
+
+		for (bucket = 0; bucket < LATENCY_HIST_BUCKETS - 1 &&
+			((end - begin) / 1000) >> bucket; bucket++)
+			;
+		m_latencyHist[bucket]++;
+	}
+
+	m_elapsedNs = NowNs() - start;
+
+	Report(test);
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void BenchmarkTestFixture::Report(TestBase &test)
+{
+	double secs = m_elapsedNs / 1e9;
+	double pps = secs ? m_packets / secs : 0;
+	double bps = secs ? m_bytes / secs : 0;
+	uint64_t sum = 0;
+	ostringstream hist;
+	unsigned int i;
+
+	for (i = 0; i < m_latencyNs.size(); i++)
+		sum += m_latencyNs[i];
+
+	sort(m_latencyNs.begin(), m_latencyNs.end());
+
+	test.AddProperty("warmup_iterations", m_warmupIterations);
+	test.AddProperty("iterations", m_measureIterations);
+	test.AddProperty("packets", m_packets);
+	test.AddProperty("bytes", m_bytes);
+	test.AddProperty("packets_per_sec", pps);
+	test.AddProperty("bytes_per_sec", bps);
+
+	if (m_latencyNs.size()) {
+		size_t n = m_latencyNs.size();
+
+		test.AddProperty("latency_min_us", m_latencyNs[0] / 1e3);
+		test.AddProperty("latency_avg_us", sum / n / 1e3);
+		test.AddProperty("latency_p50_us", m_latencyNs[n / 2] / 1e3);
+		test.AddProperty("latency_p99_us", m_latencyNs[(n * 99) / 100] / 1e3);
+		test.AddProperty("latency_max_us", m_latencyNs[n - 1] / 1e3);
+	}
+
+	/* "<upper bound in usec>:<count>" for each non-empty bucket */
+	for (i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+		if (!m_latencyHist[i])
+			continue;
+		if (hist.tellp() > 0)
+			hist << " ";
+		if (i == LATENCY_HIST_BUCKETS - 1)
+			hist << "inf:" << m_latencyHist[i];
+		else
+			hist << (1ULL << i) << ":" << m_latencyHist[i];
+	}
+	test.AddProperty("latency_hist_us", hist.str());
+
+	printf("Benchmark %s: %llu packets, %llu bytes in %g sec\n",
+		test.m_name.c_str(),
+		(unsigned long long)m_packets,
+		(unsigned long long)m_bytes,
+		secs);
+	printf("Benchmark %s: %g packets/sec, %g bytes/sec\n",
+		test.m_name.c_str(), pps, bps);
+	printf("Benchmark %s: latency usec histogram %s\n",
+		test.m_name.c_str(), hist.str().c_str());
+}
+
+//////////////////////////////////////////////////////////////////////
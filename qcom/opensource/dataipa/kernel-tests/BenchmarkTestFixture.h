@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE
+ */
+
+#ifndef _BENCHMARK_TEST_FIXTURE_H_
+#define _BENCHMARK_TEST_FIXTURE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TestBase.h"
+
+using namespace std;
+
+/*
+ * This class is mixed into an existing test (alongside its TestBase
+ * fixture) to make a performance variant of it: the functional test
+ * sets up the rules and pipes, and this class pushes traffic through
+ * them, first to warm up and then to measure.
+ *
+ * The results (packets and bytes per second, and the latency of each
+ * iteration) are printed and attached to the test's entry in the XML
+ * report, so throughput can be compared between driver drops.
+ */
+class BenchmarkTestFixture
+{
+public:
+	BenchmarkTestFixture();
+	virtual ~BenchmarkTestFixture();
+
+	/*
+	 * One unit of work, e.g. send a packet and receive it back.
+	 * Set packets/bytes to what was received; return false on a
+	 * functional failure, which fails the test.
+	 */
+	virtual bool BenchmarkIteration(size_t &packets, size_t &bytes) = 0;
+
+	/*
+	 * Run the warm-up then the measured iterations, and report the
+	 * results as properties of test.
+	 */
+	bool RunBenchmark(TestBase &test);
+
+	static const unsigned int DFLT_WARMUP_ITERATIONS = 100;
+	static const unsigned int DFLT_MEASURE_ITERATIONS = 1000;
+
+	/* Latency histogram buckets: bucket i counts [2^(i-1), 2^i) usec */
+	static const unsigned int LATENCY_HIST_BUCKETS = 24;
+
+	unsigned int m_warmupIterations;
+	unsigned int m_measureIterations;
+
+	/* Results of the last RunBenchmark() */
+	uint64_t m_packets;
+	uint64_t m_bytes;
+	uint64_t m_elapsedNs;
+	vector < uint64_t > m_latencyNs;
+	uint64_t m_latencyHist[LATENCY_HIST_BUCKETS];
+
+private:
+	void Report(TestBase &test);
+};
+
+#endif
@@ -78,6 +78,7 @@
 #include "Filtering.h"
 #include "RoutingDriverWrapper.h"
 #include "IPAFilteringTable.h"
+#include "BenchmarkTestFixture.h"
 
 //TODO Add Enum for IP/TCP/UDP Fields
 
@@ -10733,6 +10734,76 @@ public:
 	} // Teardown()
 };
 
+/*---------------------------------------------------------------------------*/
+/* PerfTest021: Throughput and latency of Test021's end-point filtering      */
+/*---------------------------------------------------------------------------*/
+class IpaFilteringBlockPerfTest021 : public IpaFilteringBlockTest021, public BenchmarkTestFixture
+{
+public:
+	IpaFilteringBlockPerfTest021()
+	{
+		m_name = "IpaFilteringBlockPerfTest021";
+		m_description =
+		"Filtering block perf test 021 - Destination IP address and subnet mask match throughput\
+		1. Add the routing tables and filtering rules of IpaFilteringBlockTest021. \
+		2. Send a packet matching the first filtering rule and receive it on \
+		   the first bypass pipe, first to warm up and then measured. \
+		3. Report packets/bytes per second and the latency histogram.";
+		m_testSuiteName.clear();
+		m_testSuiteName.push_back("Perf");
+		m_runInRegression = false;
+	}
+
+	bool Run()
+	{
+		// Add the relevant filtering rules
+		if (!AddRules()) {
+			printf("Failed adding filtering rules.\n");
+			return false;
+		}
+
+		// Load input data (IP packet) from file
+		if (!LoadFiles(m_IpaIPType)) {
+			printf("Failed loading files.\n");
+			return false;
+		}
+
+		if (!ModifyPackets()) {
+			printf("Failed to modify packets.\n");
+			return false;
+		}
+
+		return RunBenchmark(*this);
+	} // Run()
+
+	bool BenchmarkIteration(size_t &packets, size_t &bytes)
+	{
+		int receivedSize;
+
+		if (!m_producer.SendData(m_sendBuffer, m_sendSize)) {
+			printf("SendData failure.\n");
+			return false;
+		}
+
+		receivedSize = m_consumer.ReceiveData(m_rxBuffer, sizeof(m_rxBuffer));
+		if (receivedSize != (int)m_sendSize ||
+			memcmp(m_rxBuffer, m_sendBuffer, m_sendSize)) {
+			printf("Received %d bytes on %s, expected %zu.\n",
+				receivedSize, m_consumer.m_fromChannelName.c_str(), m_sendSize);
+			return false;
+		}
+
+		packets = 1;
+		bytes = receivedSize;
+
+		return true;
+	}
+
+private:
+	Byte m_rxBuffer[BUFF_MAX_SIZE];
+};
+
+
 
 static class IpaFilteringBlockTest001 ipaFilteringBlockTest001;//Global Filtering Test
 static class IpaFilteringBlockTest002 ipaFilteringBlockTest002;//Global Filtering Test
@@ -10801,3 +10872,5 @@ static class IpaFilteringBlockTest114 ipaFilteringBlockTest114; // IPv4 TTL exce
 static class IpaFilteringBlockTest115 ipaFilteringBlockTest115; // IPv6 TTL exception test, TTL=1
 static class IpaFilteringBlockTest116 ipaFilteringBlockTest116; // IPv4 TTL exception test, TTL=0
 static class IpaFilteringBlockTest117 ipaFilteringBlockTest117; // IPv6 TTL exception test, TTL=0
+
+static class IpaFilteringBlockPerfTest021 ipaFilteringBlockPerfTest021;
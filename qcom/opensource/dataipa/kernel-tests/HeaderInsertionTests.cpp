@@ -65,6 +65,7 @@
 #include "HeaderInsertion.h"
 #include "Filtering.h"
 #include "IPAFilteringTable.h"
+#include "BenchmarkTestFixture.h"
 #include "hton.h" // for htonl
 #include "TestsUtils.h"
 #include <string.h>
@@ -341,7 +342,7 @@ public:
 		}
 		return true;
 	}
-private:
+protected:
 	uint8_t m_aExpectedBuffer[BUFF_MAX_SIZE]; // Input file / IP packet
 	size_t m_aExpectedBufSize;
 	uint8_t m_aHeadertoAdd[MAX_HEADER_SIZE];
@@ -1450,6 +1451,57 @@ private:
 	int ret;
 };
 
+//---------------------------------------------------------------------------/
+// PerfTest001: Throughput and latency of Test001's RMNet header insertion   /
+//---------------------------------------------------------------------------/
+class IPAHeaderInsertionPerfTest001: public IPAHeaderInsertionTest001, public BenchmarkTestFixture {
+public:
+	IPAHeaderInsertionPerfTest001() {
+		m_name = "IPAHeaderInsertionPerfTest001";
+		m_description =
+		"Header Insertion Perf Test 001 - RMNet Header Insertion throughput\
+		1. Add the header, routing and filtering rules of IPAHeaderInsertionTest001. \
+		2. Send a packet and verify the RMNet header was inserted correctly. \
+		3. Send and receive the packet again, first to warm up and then measured. \
+		4. Report packets/bytes per second and the latency histogram.";
+		m_testSuiteName.clear();
+		m_testSuiteName.push_back("Perf");
+		m_runInRegression = false;
+	}
+
+	virtual bool TestLogic() {
+		if (!IPAHeaderInsertionTest001::TestLogic())
+			return false;
+
+		return RunBenchmark(*this);
+	}
+
+	virtual bool BenchmarkIteration(size_t &packets, size_t &bytes) {
+		int nReceivedSize;
+
+		if (!m_producer.SendData(m_aBuffer, m_uBufferSize)) {
+			LOG_MSG_ERROR("SendData failed.");
+			return false;
+		}
+
+		nReceivedSize = m_Consumer1.ReceiveData(m_aRxBuffer, sizeof(m_aRxBuffer));
+		if (nReceivedSize != (int)m_aExpectedBufSize ||
+			memcmp(m_aRxBuffer, m_aExpectedBuffer, m_aExpectedBufSize)) {
+			LOG_MSG_ERROR("Received %d bytes on %s, expected %zu.",
+				nReceivedSize, m_Consumer1.m_fromChannelName.c_str(),
+				m_aExpectedBufSize);
+			return false;
+		}
+
+		packets = 1;
+		bytes = nReceivedSize;
+
+		return true;
+	}
+private:
+	uint8_t m_aRxBuffer[BUFF_MAX_SIZE];
+};
+
 static IPAHeaderInsertionTest001 ipaHeaderInsertionTest001;
 static IPAHeaderInsertionTest002 ipaHeaderInsertionTest002;
 static IPAHeaderInsertionTest003 ipaHeaderInsertionTest003;
@@ -1461,3 +1513,5 @@ static IPAHeaderInsertionTest008 ipaHeaderInsertionTest008;
 static IPAHeaderInsertionTest009 ipaHeaderInsertionTest009;
 static IPAHeaderInsertionTest010 ipaHeaderInsertionTest010;
 
+static IPAHeaderInsertionPerfTest001 ipaHeaderInsertionPerfTest001;
+
@@ -77,6 +77,7 @@
 #include "RoutingDriverWrapper.h"
 #include "Filtering.h"
 #include "IPAFilteringTable.h"
+#include "BenchmarkTestFixture.h"
 
 #define TOS_FIELD_OFFSET (1)
 #define IPV4_TTL_OFFSET      (8)
@@ -6139,6 +6140,73 @@ public:
 	}
 };
 
+/*---------------------------------------------------------------------------*/
+/* PerfTest1: Throughput and latency of Test1's destination address routing  */
+/*---------------------------------------------------------------------------*/
+class IpaRoutingBlockPerfTest1 : public IpaRoutingBlockTest1, public BenchmarkTestFixture
+{
+public:
+	IpaRoutingBlockPerfTest1()
+	{
+		m_name = "IpaRoutingBlockPerfTest1";
+		m_description =" \
+		Routing block perf test 001 - Destination address exact match throughput \
+		1. Add the routing rules of IpaRoutingBlockTest1. \
+		2. Send a packet matching the first rule and receive it on \
+		   IPA_CLIENT_TEST2_CONS, first to warm up and then measured. \
+		3. Report packets/bytes per second and the latency histogram.";
+		m_testSuiteName.clear();
+		m_testSuiteName.push_back("Perf");
+		m_runInRegression = false;
+	}
+
+	bool Run()
+	{
+		// Add the relevant routing rules
+		if (!AddRules()) {
+			printf("Failed adding routing rules.\n");
+			return false;
+		}
+
+		// Load input data (IP packet) from file
+		if (!LoadFiles(IPA_IP_v4)) {
+			printf("Failed loading files.\n");
+			return false;
+		}
+
+		m_sendBuffer[DST_ADDR_LSB_OFFSET_IPV4] = 0xFF;
+
+		return RunBenchmark(*this);
+	} // Run()
+
+	bool BenchmarkIteration(size_t &packets, size_t &bytes)
+	{
+		int receivedSize;
+
+		if (!m_producer.SendData(m_sendBuffer, m_sendSize)) {
+			printf("SendData failure.\n");
+			return false;
+		}
+
+		receivedSize = m_consumer.ReceiveData(m_rxBuffer, sizeof(m_rxBuffer));
+		if (receivedSize != (int)m_sendSize ||
+			memcmp(m_rxBuffer, m_sendBuffer, m_sendSize)) {
+			printf("Received %d bytes on %s, expected %zu.\n",
+				receivedSize, m_consumer.m_fromChannelName.c_str(), m_sendSize);
+			return false;
+		}
+
+		packets = 1;
+		bytes = receivedSize;
+
+		return true;
+	}
+
+private:
+	Byte m_rxBuffer[BUFF_MAX_SIZE];
+};
+
+
 
 static class IpaRoutingBlockTest1 ipaRoutingBlockTest1;
 static class IpaRoutingBlockTest2 ipaRoutingBlockTest2;
@@ -6179,3 +6247,5 @@ static class IpaRoutingBlockTest050 ipaRoutingBlockTest050;
 static class IpaRoutingBlockTest051 ipaRoutingBlockTest051;
 static class IpaRoutingBlockTest052 ipaRoutingBlockTest052;
 static class IpaRoutingBlockTest053 ipaRoutingBlockTest053;
+
+static class IpaRoutingBlockPerfTest1 ipaRoutingBlockPerfTest1;
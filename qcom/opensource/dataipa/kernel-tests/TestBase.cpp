@@ -50,6 +50,13 @@ void TestBase::Register(TestBase &test)
 
 //////////////////////////////////////////////////////////////////////
 
+void TestBase::AddProperty(const string &name, const string &value)
+{
+	m_properties.push_back(make_pair(name, value));
+}
+
+//////////////////////////////////////////////////////////////////////
+
 //Empty default implementation, a test does not have to implement Setup()
 bool TestBase::Setup()
 {
@@ -32,6 +32,8 @@
 
 #include <string>
 #include <vector>
+#include <sstream>
+#include <utility>
 
 #define DFLT_NAT_MEM_TYPE "HYBRID"
 
@@ -59,6 +61,18 @@ public:
 		m_mem_type = mem_type;
 	}
 
+	/* Attach a name/value pair to the test's result in the XML report */
+	void AddProperty(const string &name, const string &value);
+	template <typename T>
+	void AddProperty(const string &name, const T &value)
+	{
+		ostringstream os;
+
+		os.precision(10);
+		os << value;
+		AddProperty(name, os.str());
+	}
+
 	const char* m_mem_type;
 	string m_name;
 	string m_description;
@@ -70,5 +84,7 @@ public:
 	/* The minimal IPA HW version which this test can run on */
 	int m_maxIPAHwType;
 	/* The maximal IPA HW version which this test can run on */
+	vector < pair < string, string > > m_properties;
+	/* Reported along with the result, cleared before each run */
 };
 #endif
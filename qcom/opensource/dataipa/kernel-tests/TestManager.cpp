@@ -121,9 +121,10 @@ xmlNodePtr TestsXMLResult::GetSuiteElement(const string& suite_name)
  * Creates new testcase element
  */
 void TestsXMLResult::AddTestcase(const string &suite_nm, const string &test_nm,
-	double runtime, bool pass)
+	double runtime, bool pass,
+	const vector < pair < string, string > > &properties)
 {
-	xmlNodePtr suite_node, new_testcase, fail_node;
+	xmlNodePtr suite_node, new_testcase, fail_node, props_node, prop_node;
 	ostringstream runtime_str;
 
 	if (!suite_nm.size() || !test_nm.size()) {
@@ -149,6 +150,25 @@ void TestsXMLResult::AddTestcase(const string &suite_nm, const string &test_nm,
 	runtime_str << runtime;
 	xmlSetProp(new_testcase, BAD_CAST "time", BAD_CAST runtime_str.str().c_str());
 
+	if (properties.size()) {
+		props_node = xmlNewChild(new_testcase, NULL, BAD_CAST "properties", NULL);
+		if (!props_node) {
+			printf("failed creating properties node\n");
+			exit(-1);
+		}
+		for (size_t i = 0; i < properties.size(); i++) {
+			prop_node = xmlNewChild(props_node, NULL, BAD_CAST "property", NULL);
+			if (!prop_node) {
+				printf("failed creating property node\n");
+				exit(-1);
+			}
+			xmlSetProp(prop_node, BAD_CAST "name",
+				BAD_CAST properties[i].first.c_str());
+			xmlSetProp(prop_node, BAD_CAST "value",
+				BAD_CAST properties[i].second.c_str());
+		}
+	}
+
 	if (!pass) {
 		fail_node = xmlNewChild(new_testcase, NULL, BAD_CAST "failure", NULL);
 		if (!fail_node) {
@@ -176,7 +196,8 @@ void TestsXMLResult::GenerateXMLReport(void)
 TestsXMLResult::TestsXMLResult() {}
 TestsXMLResult::~TestsXMLResult() {}
 void TestsXMLResult::AddTestcase(const string &suite_nm, const string &test_nm,
-	double runtime, bool pass) {}
+	double runtime, bool pass,
+	const vector < pair < string, string > > &properties) {}
 void TestsXMLResult::GenerateXMLReport(void)
 {
 	printf("No XML support\n");
@@ -272,6 +293,8 @@ bool TestManager::Run(vector<string> testSuiteList, vector<string> testNameList)
 		printf("\n\nExecuting test %s\n", test->m_name.c_str());
 		printf("Description: %s\n", test->m_description.c_str());
 
+		test->m_properties.clear();
+
 		printf("Setup()\n");
 		begin_test_clk = clock();
 		test->SetMemType(GetMemType());
@@ -308,7 +331,8 @@ bool TestManager::Run(vector<string> testSuiteList, vector<string> testNameList)
 			PrintSeparator(test->m_name.size());
 		}
 
-		xml_res.AddTestcase(test->m_testSuiteName[0], test->m_name, test_runtime_sec, pass);
+		xml_res.AddTestcase(test->m_testSuiteName[0], test->m_name, test_runtime_sec, pass,
+			test->m_properties);
 	} // for
 
 	// Print summary
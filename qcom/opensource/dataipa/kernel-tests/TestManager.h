@@ -49,7 +49,8 @@ public:
 	TestsXMLResult();
 	~TestsXMLResult();
 	void AddTestcase(const string &suite_nm, const string &test_nm,
-		double runtime, bool pass);
+		double runtime, bool pass,
+		const vector < pair < string, string > > &properties);
 	void GenerateXMLReport(void);
 private:
 #ifdef HAVE_LIBXML
@@ -73,6 +73,7 @@
 #include "TestsUtils.h"
 #include "UlsoTestFixture.h"
 #include "HeaderInsertion.h"
+#include "BenchmarkTestFixture.h"
 
 #define ARRAY_SIZE(A) (sizeof(ArraySizeHelper(A)))
 
@@ -303,6 +304,86 @@ public:
 	}
 };
 
+template<typename Transport, typename Internet, typename PacketsGenerator>
+class UlsoPerfTest: public UlsoTestFixture, public BenchmarkTestFixture {
+
+private:
+
+	using PacketType = UlsoPacket<Transport, Internet>;
+
+	/* A packet to send and the segments it should come back as */
+	struct Transfer {
+		vector<uint8_t> sendBuf;
+		vector<vector<uint8_t>> segmentBufs;
+	};
+
+	vector<Transfer> mTransfers;
+	size_t mNext {0};
+
+public:
+
+	UlsoPerfTest(const char* name){
+		m_name = name;
+		string title = string("ULSO Perf Test");
+		string packetStructure = string("Structure: ") + string ("QMAP + Ethernet 2 + ")
+			+ string(Internet().name()) + string(" ") + string(Transport().name());
+		string testProcess = string(
+			"1. Config IPA->APPS test pipe\n"
+			"2. Generate a vector of ULSO packets and segment each using the software simulation\n"
+			"3. Repeatedly, first to warm up and then measured, send the next packet in the vector\n"
+			"	and receive and compare its segments\n"
+			"4. Report segments/bytes per second and the latency histogram\n"
+			"5. Clear the IPA->USB pipe and verify there were no bytes left in the pipe");
+		m_description = string(title + "\n" + packetStructure + "\n" + testProcess + "\n").c_str();
+		m_minIPAHwType = IPA_HW_v5_0;
+		m_testSuiteName.clear();
+		m_testSuiteName.push_back("Perf");
+		m_runInRegression = false;
+		Register(*this);
+	}
+
+	virtual bool Run() override {
+		vector<PacketType> packetsVec = PacketsGenerator()();
+		mTransfers.clear();
+		mNext = 0;
+		for(auto& p: packetsVec){
+			Transfer t;
+			t.sendBuf.resize(p.asArray(m_sendBuf));
+			memcpy(t.sendBuf.data(), m_sendBuf, t.sendBuf.size());
+			for(auto& segmentedPacket: p.segment()){
+				vector<uint8_t> segmentBuf(segmentedPacket.asArray(m_segmentBuf));
+				memcpy(segmentBuf.data(), m_segmentBuf, segmentBuf.size());
+				t.segmentBufs.emplace_back(segmentBuf);
+			}
+			mTransfers.emplace_back(t);
+		}
+		if(mTransfers.empty() || !RunBenchmark(*this)){
+			return false;
+		}
+		return clearPipe() == 0;
+	}
+
+	virtual bool BenchmarkIteration(size_t &packets, size_t &bytes) override {
+		Transfer& t = mTransfers[mNext];
+		mNext = (mNext + 1) % mTransfers.size();
+		packets = bytes = 0;
+		memcpy(m_sendBuf, t.sendBuf.data(), t.sendBuf.size());
+		if(m_producer.SendData(m_sendBuf, t.sendBuf.size()) == 0){
+			return false;
+		}
+		for(auto& segmentBuf: t.segmentBufs){
+			size_t recievedBytes = m_consumer.ReceiveSingleDataChunk(m_receiveBuf, segmentBuf.size());
+			if(recievedBytes != segmentBuf.size() || memcmp(segmentBuf.data(), m_receiveBuf, recievedBytes)){
+				memcpy(m_segmentBuf, segmentBuf.data(), segmentBuf.size());
+				return fail(t.sendBuf.size(), segmentBuf.size(), recievedBytes);
+			}
+			packets++;
+			bytes += recievedBytes;
+		}
+		return true;
+	}
+};
+
 /* Tests Macros */
 #define PACKETS_GEN_MODIFY(T, I, a, b, m) PacketsGeneratorClass<T, I, a, ARRAY_SIZE(a), b, ARRAY_SIZE(b), m<UlsoPacket<T, I>>>
 #define PACKETS_GEN(T, I, a, b) PACKETS_GEN_MODIFY(T, I, a, b, NullPacketModifier)//todo: change macro parameters to meaningfull names
@@ -428,3 +509,14 @@ static UlsoHPCTest<UDPH, I4, PACKETS_GEN(UDPH, I4, segmentSizes1, segmentsNum1)>
 static UlsoHPCTest<TCPH, I4, PACKETS_GEN(TCPH, I4, segmentSizes1, segmentsNum1)> Ipv4TcpHpcRndisTest {"Ipv4TcpHpcRndisTest", "IPv4 + TCP"};
 static UlsoHPCTest<UDPH, I6, PACKETS_GEN(UDPH, I6, segmentSizes1, segmentsNum1)> Ipv6UdpHpcRndisTest {"Ipv6UdpHpcRndisTest", "IPv6 + UDP"};
 static UlsoHPCTest<TCPH, I6, PACKETS_GEN(TCPH, I6, segmentSizes1, segmentsNum1)> Ipv6TcpHpcRndisTest {"Ipv6TcpHpcRndisTest", "IPv6 + TCP"};
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////            Throughput                  ////////////////////
+////////////////////////////////////////////////////////////////////////////////
+/*
+ * Send the segmentation & non-segmentation mix over and over and report throughput and latency
+ */
+static UlsoPerfTest<UDPH, I4, PACKETS_GEN(UDPH, I4, segmentSizes2, segmentsNum2)> ulsoPerfTest0 {"Perf: IPV4 UDP"};
+static UlsoPerfTest<TCPH, I4, PACKETS_GEN(TCPH, I4, segmentSizes2, segmentsNum2)> ulsoPerfTest1 {"Perf: IPV4 TCP"};
+static UlsoPerfTest<UDPH, I6, PACKETS_GEN(UDPH, I6, segmentSizes2, segmentsNum2)> ulsoPerfTest2 {"Perf: IPV6 UDP"};
+static UlsoPerfTest<TCPH, I6, PACKETS_GEN(TCPH, I6, segmentSizes2, segmentsNum2)> ulsoPerfTest3 {"Perf: IPV6 TCP"};
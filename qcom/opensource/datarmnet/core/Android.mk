@@ -20,6 +20,11 @@ LOCAL_MODULE := rmnet_core.ko
 LOCAL_SRC_FILES   := $(wildcard $(LOCAL_PATH)/**/*) $(wildcard $(LOCAL_PATH)/*)
 DLKM_DIR := $(TOP)/device/qcom/common/dlkm
 $(warning $(DLKM_DIR))
+#KUnit test modules, set RMNET_CORE_KUNIT := true on a CONFIG_KUNIT kernel
+ifeq ($(RMNET_CORE_KUNIT),true)
+KBUILD_OPTIONS := CONFIG_RMNET_MAP_KUNIT_TEST=m
+KBUILD_OPTIONS += CONFIG_RMNET_QMI_KUNIT_TEST=m
+endif
 include $(DLKM_DIR)/Build_external_kernelmodule.mk
 
 ######## Create RMNET_CTL DLKM ########
@@ -34,5 +39,40 @@ DLKM_DIR := $(TOP)/device/qcom/common/dlkm
 $(warning $(DLKM_DIR))
 include $(DLKM_DIR)/Build_external_kernelmodule.mk
 
+ifeq ($(RMNET_CORE_KUNIT),true)
+######## Create RMNET_MAP_KUNIT DLKM ########
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -Wno-macro-redefined -Wno-unused-function -Wall -Werror
+LOCAL_CLANG :=true
+LOCAL_MODULE_PATH := $(KERNEL_MODULES_OUT)
+LOCAL_MODULE := rmnet_map_kunit.ko
+LOCAL_SRC_FILES   := $(wildcard $(LOCAL_PATH)/**/*) $(wildcard $(LOCAL_PATH)/*)
+DLKM_DIR := $(TOP)/device/qcom/common/dlkm
+include $(DLKM_DIR)/Build_external_kernelmodule.mk
+
+######## Create RMNET_QMI_KUNIT DLKM ########
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -Wno-macro-redefined -Wno-unused-function -Wall -Werror
+LOCAL_CLANG :=true
+LOCAL_MODULE_PATH := $(KERNEL_MODULES_OUT)
+LOCAL_MODULE := rmnet_qmi_kunit.ko
+LOCAL_SRC_FILES   := $(wildcard $(LOCAL_PATH)/**/*) $(wildcard $(LOCAL_PATH)/*)
+DLKM_DIR := $(TOP)/device/qcom/common/dlkm
+include $(DLKM_DIR)/Build_external_kernelmodule.mk
+
+######## Create RMNET_DESC_KUNIT DLKM ########
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -Wno-macro-redefined -Wno-unused-function -Wall -Werror
+LOCAL_CLANG :=true
+LOCAL_MODULE_PATH := $(KERNEL_MODULES_OUT)
+LOCAL_MODULE := rmnet_descriptor_kunit.ko
+LOCAL_SRC_FILES   := $(wildcard $(LOCAL_PATH)/**/*) $(wildcard $(LOCAL_PATH)/*)
+DLKM_DIR := $(TOP)/device/qcom/common/dlkm
+include $(DLKM_DIR)/Build_external_kernelmodule.mk
+endif
+
 endif #End of Check for target
 endif #End of Check for qssi target
@@ -26,14 +26,6 @@
 #include <linux/ip.h>
 #include <linux/ipv6.h>
 
-#define NLMSG_FLOW_ACTIVATE 1
-#define NLMSG_FLOW_DEACTIVATE 2
-#define NLMSG_CLIENT_SETUP 4
-#define NLMSG_CLIENT_DELETE 5
-#define NLMSG_SCALE_FACTOR 6
-#define NLMSG_WQ_FREQUENCY 7
-#define NLMSG_CHANNEL_SWITCH 8
-
 #define FLAG_DFC_MASK 0x000F
 #define FLAG_POWERSAVE_MASK 0x0010
 #define FLAG_QMAP_MASK 0x0020
@@ -48,6 +40,7 @@
 #define FLAG_TO_PS_EXT(f) ((f) & FLAG_PS_EXT_MASK)
 
 int dfc_mode;
+EXPORT_SYMBOL(dfc_mode);
 int dfc_qmap;
 int dfc_ps_ext;
 
@@ -154,11 +147,13 @@ qmi_rmnet_clean_flow_list(struct qos_info *qos)
 	ASSERT_RTNL();
 
 	list_for_each_entry_safe(itm, fl_tmp, &qos->flow_head, list) {
+		hash_del_rcu(&itm->hnode);
 		list_del(&itm->list);
 		kfree(itm);
 	}
 
 	list_for_each_entry_safe(bearer, br_tmp, &qos->bearer_head, list) {
+		hash_del_rcu(&bearer->hnode);
 		list_del(&bearer->list);
 		kfree(bearer);
 	}
@@ -166,6 +161,10 @@ qmi_rmnet_clean_flow_list(struct qos_info *qos)
 	memset(qos->mq, 0, sizeof(qos->mq));
 }
 
+/**
+ * qmi_rmnet_get_flow_map - look up a flow by mark and ip type
+ * Needs to be called with qos_lock or under rcu_read_lock
+ */
 struct rmnet_flow_map *
 qmi_rmnet_get_flow_map(struct qos_info *qos, u32 flow_id, int ip_type)
 {
@@ -174,13 +173,19 @@ qmi_rmnet_get_flow_map(struct qos_info *qos, u32 flow_id, int ip_type)
 	if (!qos)
 		return NULL;
 
-	list_for_each_entry(itm, &qos->flow_head, list) {
+	hash_for_each_possible_rcu(qos->flow_hash, itm, hnode, flow_id,
+				   lockdep_is_held(&qos->qos_lock)) {
 		if ((itm->flow_id == flow_id) && (itm->ip_type == ip_type))
 			return itm;
 	}
 	return NULL;
 }
+EXPORT_SYMBOL(qmi_rmnet_get_flow_map);
 
+/**
+ * qmi_rmnet_get_bearer_map - look up a bearer by id
+ * Needs to be called with qos_lock or under rcu_read_lock
+ */
 struct rmnet_bearer_map *
 qmi_rmnet_get_bearer_map(struct qos_info *qos, uint8_t bearer_id)
 {
@@ -189,12 +194,14 @@ qmi_rmnet_get_bearer_map(struct qos_info *qos, uint8_t bearer_id)
 	if (!qos)
 		return NULL;
 
-	list_for_each_entry(itm, &qos->bearer_head, list) {
+	hash_for_each_possible_rcu(qos->bearer_hash, itm, hnode, bearer_id,
+				   lockdep_is_held(&qos->qos_lock)) {
 		if (itm->bearer_id == bearer_id)
 			return itm;
 	}
 	return NULL;
 }
+EXPORT_SYMBOL(qmi_rmnet_get_bearer_map);
 
 static void qmi_rmnet_update_flow_map(struct rmnet_flow_map *itm,
 				      struct rmnet_flow_map *new_map)
@@ -202,7 +209,7 @@ static void qmi_rmnet_update_flow_map(struct rmnet_flow_map *itm,
 	itm->bearer_id = new_map->bearer_id;
 	itm->flow_id = new_map->flow_id;
 	itm->ip_type = new_map->ip_type;
-	itm->mq_idx = new_map->mq_idx;
+	WRITE_ONCE(itm->mq_idx, new_map->mq_idx);
 }
 
 int qmi_rmnet_flow_control(struct net_device *dev, u32 mq_idx, int enable)
@@ -306,7 +313,8 @@ static void qmi_rmnet_bearer_clean(struct qos_info *qos)
 		del_timer_sync(&qos->removed_bearer->watchdog);
 		qos->removed_bearer->ch_switch.timer_quit = true;
 		del_timer_sync(&qos->removed_bearer->ch_switch.guard_timer);
-		kfree(qos->removed_bearer);
+		/* flows being rebound may still be read by queue selection */
+		kfree_rcu(qos->removed_bearer, rcu);
 		qos->removed_bearer = NULL;
 	}
 }
@@ -335,6 +343,7 @@ static struct rmnet_bearer_map *__qmi_rmnet_bearer_get(
 		timer_setup(&bearer->ch_switch.guard_timer,
 			    rmnet_ll_guard_fn, 0);
 		list_add(&bearer->list, &qos_info->bearer_head);
+		hash_add_rcu(qos_info->bearer_hash, &bearer->hnode, bearer_id);
 	}
 
 	return bearer;
@@ -367,6 +376,7 @@ static void __qmi_rmnet_bearer_put(struct net_device *dev,
 		}
 
 		/* Remove from bearer map */
+		hash_del_rcu(&bearer->hnode);
 		list_del(&bearer->list);
 		qos_info->removed_bearer = bearer;
 	}
@@ -423,7 +433,7 @@ static int __qmi_rmnet_rebind_flow(struct net_device *dev,
 		return -ENOMEM;
 
 	qmi_rmnet_update_flow_map(itm, new_map);
-	itm->bearer = bearer;
+	WRITE_ONCE(itm->bearer, bearer);
 
 	__qmi_rmnet_update_mq(dev, qos_info, bearer, itm);
 
@@ -488,6 +498,7 @@ again:
 
 	qmi_rmnet_update_flow_map(itm, &new_map);
 	list_add(&itm->list, &qos_info->flow_head);
+	hash_add_rcu(qos_info->flow_hash, &itm->hnode, itm->flow_id);
 
 	/* Create or update bearer map */
 	bearer = __qmi_rmnet_bearer_get(qos_info, new_map.bearer_id);
@@ -496,7 +507,7 @@ again:
 		goto done;
 	}
 
-	itm->bearer = bearer;
+	WRITE_ONCE(itm->bearer, bearer);
 
 	__qmi_rmnet_update_mq(dev, qos_info, bearer, itm);
 
@@ -540,8 +551,9 @@ qmi_rmnet_del_flow(struct net_device *dev, struct tcmsg *tcm,
 		__qmi_rmnet_bearer_put(dev, qos_info, itm->bearer, true);
 
 		/* Remove from flow map */
+		hash_del_rcu(&itm->hnode);
 		list_del(&itm->list);
-		kfree(itm);
+		kfree_rcu(itm, rcu);
 	}
 
 	if (list_empty(&qos_info->flow_head))
@@ -1017,6 +1029,7 @@ static inline bool qmi_rmnet_is_tcp_ack(struct sk_buff *skb)
 static int qmi_rmnet_get_queue_sa(struct qos_info *qos, struct sk_buff *skb)
 {
 	struct rmnet_flow_map *itm;
+	struct rmnet_bearer_map *bearer;
 	int ip_type;
 	int txq = DEFAULT_MQ_NUM;
 
@@ -1030,20 +1043,21 @@ static int qmi_rmnet_get_queue_sa(struct qos_info *qos, struct sk_buff *skb)
 
 	ip_type = (skb->protocol == htons(ETH_P_IPV6)) ? AF_INET6 : AF_INET;
 
-	spin_lock_bh(&qos->qos_lock);
+	rcu_read_lock();
 
 	itm = qmi_rmnet_get_flow_map(qos, skb->mark, ip_type);
 	if (unlikely(!itm))
 		goto done;
 
 	/* Put the packet in the assigned mq except TCP ack */
-	if (likely(itm->bearer) && qmi_rmnet_is_tcp_ack(skb))
-		txq = itm->bearer->ack_mq_idx;
+	bearer = READ_ONCE(itm->bearer);
+	if (likely(bearer) && qmi_rmnet_is_tcp_ack(skb))
+		txq = READ_ONCE(bearer->ack_mq_idx);
 	else
-		txq = itm->mq_idx;
+		txq = READ_ONCE(itm->mq_idx);
 
 done:
-	spin_unlock_bh(&qos->qos_lock);
+	rcu_read_unlock();
 	return txq;
 }
 
@@ -1062,13 +1076,13 @@ int qmi_rmnet_get_queue(struct net_device *dev, struct sk_buff *skb)
 
 	ip_type = (skb->protocol == htons(ETH_P_IPV6)) ? AF_INET6 : AF_INET;
 
-	spin_lock_bh(&qos->qos_lock);
+	rcu_read_lock();
 
 	itm = qmi_rmnet_get_flow_map(qos, mark, ip_type);
 	if (itm)
-		txq = itm->mq_idx;
+		txq = READ_ONCE(itm->mq_idx);
 
-	spin_unlock_bh(&qos->qos_lock);
+	rcu_read_unlock();
 
 	return txq;
 }
@@ -1095,6 +1109,8 @@ void *qmi_rmnet_qos_init(struct net_device *real_dev,
 	qos->tran_num = 0;
 	INIT_LIST_HEAD(&qos->flow_head);
 	INIT_LIST_HEAD(&qos->bearer_head);
+	hash_init(qos->flow_hash);
+	hash_init(qos->bearer_hash);
 	spin_lock_init(&qos->qos_lock);
 
 	return qos;
@@ -18,6 +18,7 @@
 #include <linux/netdevice.h>
 #include <linux/skbuff.h>
 #include <linux/timer.h>
+#include <linux/hashtable.h>
 #include <uapi/linux/rtnetlink.h>
 #include <linux/soc/qcom/qmi.h>
 
@@ -34,6 +35,17 @@
 #define DFC_MODE_SA 4
 #define PS_MAX_BEARERS 32
 
+#define NLMSG_FLOW_ACTIVATE 1
+#define NLMSG_FLOW_DEACTIVATE 2
+#define NLMSG_CLIENT_SETUP 4
+#define NLMSG_CLIENT_DELETE 5
+#define NLMSG_SCALE_FACTOR 6
+#define NLMSG_WQ_FREQUENCY 7
+#define NLMSG_CHANNEL_SWITCH 8
+
+#define FLOW_HASH_BITS 5
+#define BEARER_HASH_BITS 4
+
 #define CONFIG_QTI_QMI_RMNET 1
 #define CONFIG_QTI_QMI_DFC  1
 #define CONFIG_QTI_QMI_POWER_COLLAPSE 1
@@ -74,6 +86,8 @@ struct rmnet_ch_switch {
 
 struct rmnet_bearer_map {
 	struct list_head list;
+	struct hlist_node hnode;
+	struct rcu_head rcu;
 	u8 bearer_id;
 	int flow_ref;
 	u32 grant_size;
@@ -100,6 +114,8 @@ struct rmnet_bearer_map {
 
 struct rmnet_flow_map {
 	struct list_head list;
+	struct hlist_node hnode;
+	struct rcu_head rcu;
 	u8 bearer_id;
 	u32 flow_id;
 	int ip_type;
@@ -126,6 +142,9 @@ struct qos_info {
 	struct net_device *vnd_dev;
 	struct list_head flow_head;
 	struct list_head bearer_head;
+	/* RCU readers, updated under qos_lock along with the lists */
+	DECLARE_HASHTABLE(flow_hash, FLOW_HASH_BITS);
+	DECLARE_HASHTABLE(bearer_hash, BEARER_HASH_BITS);
 	struct mq_map mq[MAX_MQ_NUM];
 	u32 tran_num;
 	spinlock_t qos_lock;
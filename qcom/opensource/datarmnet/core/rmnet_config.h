@@ -57,6 +57,7 @@ struct rmnet_endpoint {
 struct rmnet_agg_stats {
 	u64 ul_agg_reuse;
 	u64 ul_agg_alloc;
+	u64 ul_agg_sg;
 };
 
 struct rmnet_port_priv_stats {
@@ -104,6 +105,12 @@ struct rmnet_aggregation_state {
 	int agg_state;
 	u8 agg_count;
 	u8 agg_size_order;
+	/* Aggregate is built from shared page frags, see RMNET_AGG_SG */
+	bool agg_sg;
+	/* Page holding the headers of all but the first packet */
+	struct page *agg_hdr_page;
+	u32 agg_hdr_off;
+	u32 agg_hdr_len;
 	struct list_head agg_list;
 	struct rmnet_agg_page *agg_head;
 	struct rmnet_agg_stats *stats;
@@ -17,6 +17,7 @@
 #include <linux/ip.h>
 #include <linux/ipv6.h>
 #include <linux/inet.h>
+#include <linux/percpu.h>
 #include <net/ipv6.h>
 #include <net/ip6_checksum.h>
 #include "rmnet_config.h"
@@ -51,31 +52,158 @@ typedef void (*rmnet_perf_tether_ingress_hook_t)(struct tcphdr *tp, struct sk_bu
 rmnet_perf_tether_ingress_hook_t rmnet_perf_tether_ingress_hook __rcu __read_mostly;
 EXPORT_SYMBOL(rmnet_perf_tether_ingress_hook);
 
-struct rmnet_frag_descriptor *
-rmnet_get_frag_descriptor(struct rmnet_port *port)
+static struct rmnet_fragment *
+rmnet_frag_alloc(struct rmnet_frag_descriptor *frag_desc)
+{
+	struct rmnet_fragment *frag;
+	unsigned long flags;
+	unsigned int slot;
+
+	slot = ffz(frag_desc->frag_slot_map);
+	if (likely(slot < RMNET_FRAG_DESC_EMBEDDED_FRAGS)) {
+		frag_desc->frag_slot_map |= BIT(slot);
+		frag = &frag_desc->frag_slots[slot];
+		memset(frag, 0, sizeof(*frag));
+		return frag;
+	}
+
+	frag = kzalloc(sizeof(*frag), GFP_ATOMIC);
+	if (frag && frag_desc->pool) {
+		local_irq_save(flags);
+		this_cpu_ptr(frag_desc->pool->mags)->frag_alloc_fallback++;
+		local_irq_restore(flags);
+	}
+
+	return frag;
+}
+
+static void rmnet_frag_free(struct rmnet_frag_descriptor *frag_desc,
+			    struct rmnet_fragment *frag)
+{
+	/* Range check first, frag may not point into frag_slots at all */
+	if (likely(frag >= frag_desc->frag_slots &&
+		   frag < frag_desc->frag_slots +
+			  RMNET_FRAG_DESC_EMBEDDED_FRAGS)) {
+		frag_desc->frag_slot_map &= ~BIT(frag - frag_desc->frag_slots);
+		return;
+	}
+
+	kfree(frag);
+}
+
+static void rmnet_frag_desc_reset(struct rmnet_frag_descriptor *frag_desc)
+{
+	memset(frag_desc, 0, RMNET_FRAG_DESC_META_LEN);
+	INIT_LIST_HEAD(&frag_desc->list);
+	INIT_LIST_HEAD(&frag_desc->frags);
+}
+
+/* Drop the page references and fragments held by a descriptor */
+static void
+rmnet_frag_desc_release_frags(struct rmnet_frag_descriptor *frag_desc)
+{
+	struct rmnet_fragment *frag, *tmp;
+
+	rmnet_descriptor_for_each_frag_safe(frag, tmp, frag_desc) {
+		struct page *page = skb_frag_page(&frag->frag);
+
+		if (page)
+			put_page(page);
+
+		list_del(&frag->list);
+		rmnet_frag_free(frag_desc, frag);
+	}
+}
+
+/* Needs to be called with IRQs disabled */
+static void rmnet_frag_desc_mag_refill(struct rmnet_port *port,
+				       struct rmnet_frag_desc_mag *mag)
 {
 	struct rmnet_frag_descriptor_pool *pool = port->frag_desc_pool;
 	struct rmnet_frag_descriptor *frag_desc;
-	unsigned long flags;
 
-	spin_lock_irqsave(&port->desc_pool_lock, flags);
-	if (!list_empty(&pool->free_list)) {
+	spin_lock(&port->desc_pool_lock);
+	while (mag->count < RMNET_FRAG_DESC_MAG_BATCH &&
+	       !list_empty(&pool->free_list)) {
 		frag_desc = list_first_entry(&pool->free_list,
 					     struct rmnet_frag_descriptor,
 					     list);
 		list_del_init(&frag_desc->list);
-	} else {
-		frag_desc = kzalloc(sizeof(*frag_desc), GFP_ATOMIC);
-		if (!frag_desc)
-			goto out;
+		pool->free_cnt--;
+		mag->descs[mag->count++] = frag_desc;
+	}
+	spin_unlock(&port->desc_pool_lock);
+}
+
+/* Needs to be called with IRQs disabled */
+static void rmnet_frag_desc_mag_drain(struct rmnet_port *port,
+				      struct rmnet_frag_desc_mag *mag)
+{
+	struct rmnet_frag_descriptor_pool *pool = port->frag_desc_pool;
+
+	spin_lock(&port->desc_pool_lock);
+	while (mag->count > RMNET_FRAG_DESC_MAG_BATCH) {
+		list_add(&mag->descs[--mag->count]->list, &pool->free_list);
+		pool->free_cnt++;
+	}
+	spin_unlock(&port->desc_pool_lock);
+}
+
+/* Needs to be called with IRQs disabled */
+static void rmnet_frag_desc_mag_put(struct rmnet_port *port,
+				    struct rmnet_frag_desc_mag *mag,
+				    struct rmnet_frag_descriptor *frag_desc)
+{
+	if (unlikely(mag->count == RMNET_FRAG_DESC_MAG_SIZE))
+		rmnet_frag_desc_mag_drain(port, mag);
+
+	mag->descs[mag->count++] = frag_desc;
+}
+
+static struct rmnet_frag_descriptor *
+rmnet_frag_desc_alloc(struct rmnet_frag_descriptor_pool *pool)
+{
+	struct rmnet_frag_descriptor *frag_desc;
 
-		INIT_LIST_HEAD(&frag_desc->list);
-		INIT_LIST_HEAD(&frag_desc->frags);
+	frag_desc = kzalloc(sizeof(*frag_desc), GFP_ATOMIC);
+	if (!frag_desc)
+		return NULL;
+
+	INIT_LIST_HEAD(&frag_desc->list);
+	INIT_LIST_HEAD(&frag_desc->frags);
+	frag_desc->pool = pool;
+	return frag_desc;
+}
+
+struct rmnet_frag_descriptor *
+rmnet_get_frag_descriptor(struct rmnet_port *port)
+{
+	struct rmnet_frag_descriptor_pool *pool = port->frag_desc_pool;
+	struct rmnet_frag_descriptor *frag_desc = NULL;
+	struct rmnet_frag_desc_mag *mag;
+	unsigned long flags;
+
+	local_irq_save(flags);
+	mag = this_cpu_ptr(pool->mags);
+	if (unlikely(!mag->count))
+		rmnet_frag_desc_mag_refill(port, mag);
+
+	if (likely(mag->count)) {
+		frag_desc = mag->descs[--mag->count];
+		local_irq_restore(flags);
+		return frag_desc;
+	}
+
+	/* Pool exhausted, grow it */
+	frag_desc = rmnet_frag_desc_alloc(pool);
+	if (frag_desc) {
+		mag->desc_alloc_fallback++;
+		spin_lock(&port->desc_pool_lock);
 		pool->pool_size++;
+		spin_unlock(&port->desc_pool_lock);
 	}
+	local_irq_restore(flags);
 
-out:
-	spin_unlock_irqrestore(&port->desc_pool_lock, flags);
 	return frag_desc;
 }
 EXPORT_SYMBOL(rmnet_get_frag_descriptor);
@@ -84,29 +212,46 @@ void rmnet_recycle_frag_descriptor(struct rmnet_frag_descriptor *frag_desc,
 				   struct rmnet_port *port)
 {
 	struct rmnet_frag_descriptor_pool *pool = port->frag_desc_pool;
-	struct rmnet_fragment *frag, *tmp;
 	unsigned long flags;
 
 	list_del(&frag_desc->list);
+	rmnet_frag_desc_release_frags(frag_desc);
+	rmnet_frag_desc_reset(frag_desc);
 
-	rmnet_descriptor_for_each_frag_safe(frag, tmp, frag_desc) {
-		struct page *page = skb_frag_page(&frag->frag);
+	local_irq_save(flags);
+	rmnet_frag_desc_mag_put(port, this_cpu_ptr(pool->mags), frag_desc);
+	local_irq_restore(flags);
+}
+EXPORT_SYMBOL(rmnet_recycle_frag_descriptor);
 
-		if (page)
-			put_page(page);
+/* Recycle all descriptors on a list in one go, e.g. everything delivered
+ * from a HW buffer chain. The list is left empty.
+ */
+void rmnet_recycle_frag_descriptors(struct list_head *list,
+				    struct rmnet_port *port)
+{
+	struct rmnet_frag_descriptor_pool *pool = port->frag_desc_pool;
+	struct rmnet_frag_descriptor *frag_desc, *tmp;
+	struct rmnet_frag_desc_mag *mag;
+	unsigned long flags;
 
-		list_del(&frag->list);
-		kfree(frag);
+	if (list_empty(list))
+		return;
+
+	list_for_each_entry(frag_desc, list, list)
+		rmnet_frag_desc_release_frags(frag_desc);
+
+	local_irq_save(flags);
+	mag = this_cpu_ptr(pool->mags);
+	list_for_each_entry_safe(frag_desc, tmp, list, list) {
+		rmnet_frag_desc_reset(frag_desc);
+		rmnet_frag_desc_mag_put(port, mag, frag_desc);
 	}
+	local_irq_restore(flags);
 
-	memset(frag_desc, 0, sizeof(*frag_desc));
-	INIT_LIST_HEAD(&frag_desc->list);
-	INIT_LIST_HEAD(&frag_desc->frags);
-	spin_lock_irqsave(&port->desc_pool_lock, flags);
-	list_add_tail(&frag_desc->list, &pool->free_list);
-	spin_unlock_irqrestore(&port->desc_pool_lock, flags);
+	INIT_LIST_HEAD(list);
 }
-EXPORT_SYMBOL(rmnet_recycle_frag_descriptor);
+EXPORT_SYMBOL(rmnet_recycle_frag_descriptors);
 
 void *rmnet_frag_pull(struct rmnet_frag_descriptor *frag_desc,
 		      struct rmnet_port *port, unsigned int size)
@@ -136,7 +281,7 @@ void *rmnet_frag_pull(struct rmnet_frag_descriptor *frag_desc,
 			list_del(&frag->list);
 			size -= frag_size;
 			frag_desc->len -= frag_size;
-			kfree(frag);
+			rmnet_frag_free(frag_desc, frag);
 			continue;
 		}
 
@@ -186,7 +331,7 @@ void *rmnet_frag_trim(struct rmnet_frag_descriptor *frag_desc,
 			list_del(&frag->list);
 			eat -= frag_size;
 			frag_desc->len -= frag_size;
-			kfree(frag);
+			rmnet_frag_free(frag_desc, frag);
 			continue;
 		}
 
@@ -235,6 +380,41 @@ static int rmnet_frag_copy_data(struct rmnet_frag_descriptor *frag_desc,
 	return 0;
 }
 
+/* Checksum 'len' bytes starting at 'off' in one pass over the frags. Each
+ * chunk is folded in with csum_block_add() so that a frag ending on an odd
+ * byte doesn't throw off the byte order of the ones after it.
+ */
+__wsum rmnet_frag_csum(struct rmnet_frag_descriptor *frag_desc, u32 off,
+		       u32 len, __wsum csum)
+{
+	struct rmnet_fragment *frag;
+	u32 frag_size, chunk;
+	u32 pos = 0;
+
+	rmnet_descriptor_for_each_frag(frag, frag_desc) {
+		if (!len)
+			break;
+
+		frag_size = skb_frag_size(&frag->frag);
+		if (off >= frag_size) {
+			off -= frag_size;
+			continue;
+		}
+
+		chunk = min_t(u32, len, frag_size - off);
+		csum = csum_block_add(csum,
+				      csum_partial(skb_frag_address(&frag->frag) +
+						   off, chunk, 0),
+				      pos);
+		pos += chunk;
+		len -= chunk;
+		off = 0;
+	}
+
+	return csum;
+}
+EXPORT_SYMBOL(rmnet_frag_csum);
+
 void *rmnet_frag_header_ptr(struct rmnet_frag_descriptor *frag_desc, u32 off,
 			    u32 len, void *buf)
 {
@@ -280,7 +460,7 @@ int rmnet_frag_descriptor_add_frag(struct rmnet_frag_descriptor *frag_desc,
 {
 	struct rmnet_fragment *frag;
 
-	frag = kzalloc(sizeof(*frag), GFP_ATOMIC);
+	frag = rmnet_frag_alloc(frag_desc);
 	if (!frag)
 		return -ENOMEM;
 
@@ -730,6 +910,7 @@ void rmnet_frag_deaggregate(struct sk_buff *skb, struct rmnet_port *port,
 		start += (u32)rc;
 	}
 }
+EXPORT_SYMBOL(rmnet_frag_deaggregate);
 
 /* Fill in GSO metadata to allow the SKB to be segmented by the NW stack
  * if needed (i.e. forwarding, UDP GRO)
@@ -1090,15 +1271,21 @@ skip_trace_print_udp_rx:
 	return head_skb;
 }
 
-/* Deliver the packets contained within a frag descriptor */
-void rmnet_frag_deliver(struct rmnet_frag_descriptor *frag_desc,
-			struct rmnet_port *port)
+static void __rmnet_frag_deliver(struct rmnet_frag_descriptor *frag_desc,
+				 struct rmnet_port *port)
 {
 	struct sk_buff *skb;
 
 	skb = rmnet_alloc_skb(frag_desc, port);
 	if (skb)
 		rmnet_deliver_skb(skb, port);
+}
+
+/* Deliver the packets contained within a frag descriptor */
+void rmnet_frag_deliver(struct rmnet_frag_descriptor *frag_desc,
+			struct rmnet_port *port)
+{
+	__rmnet_frag_deliver(frag_desc, port);
 	rmnet_recycle_frag_descriptor(frag_desc, port);
 }
 EXPORT_SYMBOL(rmnet_frag_deliver);
@@ -1120,7 +1307,7 @@ static void __rmnet_frag_segment_data(struct rmnet_frag_descriptor *coal_desc,
 		return;
 
 	/* Header information and most metadata is the same as the original */
-	memcpy(new_desc, coal_desc, sizeof(*coal_desc));
+	memcpy(new_desc, coal_desc, RMNET_FRAG_DESC_META_LEN);
 	INIT_LIST_HEAD(&new_desc->list);
 	INIT_LIST_HEAD(&new_desc->frags);
 	new_desc->len = 0;
@@ -1239,8 +1426,9 @@ static bool rmnet_frag_validate_csum(struct rmnet_frag_descriptor *frag_desc)
 					  0);
 	}
 
-	csum = csum_partial(data + frag_desc->ip_len, datagram_len,
-			    csum_unfold(pseudo));
+	/* The datagram may span several frags */
+	csum = rmnet_frag_csum(frag_desc, frag_desc->ip_len, datagram_len,
+			       csum_unfold(pseudo));
 	return !csum_fold(csum);
 }
 
@@ -1571,7 +1759,6 @@ rmnet_frag_data_check_coal_header(struct rmnet_frag_descriptor *frag_desc,
 static int rmnet_frag_checksum_pkt(struct rmnet_frag_descriptor *frag_desc)
 {
 	struct rmnet_priv *priv = netdev_priv(frag_desc->dev);
-	struct rmnet_fragment *frag;
 	int offset = sizeof(struct rmnet_map_header) +
 		     sizeof(struct rmnet_map_v5_csum_header);
 	u8 *version, __version;
@@ -1680,25 +1867,7 @@ static int rmnet_frag_checksum_pkt(struct rmnet_frag_descriptor *frag_desc)
 		}
 	}
 
-	/* Walk the frags and checksum each chunk */
-	list_for_each_entry(frag, &frag_desc->frags, list) {
-		u32 frag_size = skb_frag_size(&frag->frag);
-
-		if (!csum_len)
-			break;
-
-		if (offset < frag_size) {
-			void *addr = skb_frag_address(&frag->frag) + offset;
-			u32 len = min_t(u32, csum_len, frag_size - offset);
-
-			/* Checksum 'len' bytes and add them in */
-			csum = csum_partial(addr, len, csum);
-			csum_len -= len;
-			offset = 0;
-		} else {
-			offset -= frag_size;
-		}
-	}
+	csum = rmnet_frag_csum(frag_desc, offset, csum_len, csum);
 
 	priv->stats.csum_sw++;
 	return !csum_fold(csum);
@@ -1786,6 +1955,7 @@ int rmnet_frag_process_next_hdr_packet(struct rmnet_frag_descriptor *frag_desc,
 
 	return rc;
 }
+EXPORT_SYMBOL(rmnet_frag_process_next_hdr_packet);
 
 /* Perf hook handler */
 rmnet_perf_desc_hook_t rmnet_perf_desc_entry __rcu __read_mostly;
@@ -1793,7 +1963,8 @@ EXPORT_SYMBOL(rmnet_perf_desc_entry);
 
 static void
 __rmnet_frag_ingress_handler(struct rmnet_frag_descriptor *frag_desc,
-			     struct rmnet_port *port)
+			     struct rmnet_port *port,
+			     struct list_head *delivered)
 {
 	rmnet_perf_desc_hook_t rmnet_perf_ingress;
 	struct rmnet_map_header *qmap, __qmap;
@@ -1871,10 +2042,10 @@ __rmnet_frag_ingress_handler(struct rmnet_frag_descriptor *frag_desc,
 	rcu_read_unlock();
 
 no_perf:
-	list_for_each_entry_safe(frag, tmp, &segs, list) {
-		list_del_init(&frag->list);
-		rmnet_frag_deliver(frag, port);
-	}
+	/* Descriptors are handed back to the pool in bulk by the caller */
+	list_for_each_entry_safe(frag, tmp, &segs, list)
+		__rmnet_frag_deliver(frag, port);
+	list_splice_tail(&segs, delivered);
 	return;
 
 recycle:
@@ -1925,6 +2096,7 @@ void rmnet_frag_ingress_handler(struct sk_buff *skb,
 {
 	rmnet_perf_chain_hook_t rmnet_perf_opt_chain_end;
 	LIST_HEAD(desc_list);
+	LIST_HEAD(delivered);
 	bool skip_perf = (skb->priority == 0xda1a);
 	u64 chain_count = 0;
 
@@ -1945,10 +2117,13 @@ void rmnet_frag_ingress_handler(struct sk_buff *skb,
 			list_for_each_entry_safe(frag_desc, tmp, &desc_list,
 						 list) {
 				list_del_init(&frag_desc->list);
-				__rmnet_frag_ingress_handler(frag_desc, port);
+				__rmnet_frag_ingress_handler(frag_desc, port,
+							     &delivered);
 			}
 		}
 
+		rmnet_recycle_frag_descriptors(&delivered, port);
+
 		skb_frag = skb_shinfo(skb)->frag_list;
 		skb_shinfo(skb)->frag_list = NULL;
 		consume_skb(skb);
@@ -1971,8 +2146,24 @@ void rmnet_descriptor_deinit(struct rmnet_port *port)
 {
 	struct rmnet_frag_descriptor_pool *pool;
 	struct rmnet_frag_descriptor *frag_desc, *tmp;
+	struct rmnet_frag_desc_mag *mag;
+	int cpu;
 
 	pool = port->frag_desc_pool;
+	if (!pool)
+		return;
+
+	if (pool->mags) {
+		for_each_possible_cpu(cpu) {
+			mag = per_cpu_ptr(pool->mags, cpu);
+			while (mag->count) {
+				kfree(mag->descs[--mag->count]);
+				pool->pool_size--;
+			}
+		}
+
+		free_percpu(pool->mags);
+	}
 
 	list_for_each_entry_safe(frag_desc, tmp, &pool->free_list, list) {
 		kfree(frag_desc);
@@ -1980,7 +2171,9 @@ void rmnet_descriptor_deinit(struct rmnet_port *port)
 	}
 
 	kfree(pool);
+	port->frag_desc_pool = NULL;
 }
+EXPORT_SYMBOL(rmnet_descriptor_deinit);
 
 int rmnet_descriptor_init(struct rmnet_port *port)
 {
@@ -1995,18 +2188,49 @@ int rmnet_descriptor_init(struct rmnet_port *port)
 	INIT_LIST_HEAD(&pool->free_list);
 	port->frag_desc_pool = pool;
 
+	pool->mags = alloc_percpu_gfp(struct rmnet_frag_desc_mag, GFP_ATOMIC);
+	if (!pool->mags)
+		return -ENOMEM;
+
 	for (i = 0; i < RMNET_FRAG_DESCRIPTOR_POOL_SIZE; i++) {
 		struct rmnet_frag_descriptor *frag_desc;
 
-		frag_desc = kzalloc(sizeof(*frag_desc), GFP_ATOMIC);
+		frag_desc = rmnet_frag_desc_alloc(pool);
 		if (!frag_desc)
 			return -ENOMEM;
 
-		INIT_LIST_HEAD(&frag_desc->list);
-		INIT_LIST_HEAD(&frag_desc->frags);
 		list_add_tail(&frag_desc->list, &pool->free_list);
+		pool->free_cnt++;
 		pool->pool_size++;
 	}
 
 	return 0;
 }
+EXPORT_SYMBOL(rmnet_descriptor_init);
+
+/* Pool size, free descriptors, descriptor and fragment fallback allocations */
+void rmnet_descriptor_get_stats(struct rmnet_port *port, u64 *s, int n)
+{
+	struct rmnet_frag_descriptor_pool *pool = port->frag_desc_pool;
+	u64 stats[RMNET_FRAG_DESC_NUM_STATS] = {0};
+	struct rmnet_frag_desc_mag *mag;
+	int cpu;
+
+	if (!pool || !pool->mags)
+		return;
+
+	/* Lockless snapshot, good enough for ethtool */
+	stats[RMNET_FRAG_DESC_POOL_SIZE] = READ_ONCE(pool->pool_size);
+	stats[RMNET_FRAG_DESC_POOL_FREE] = READ_ONCE(pool->free_cnt);
+	for_each_possible_cpu(cpu) {
+		mag = per_cpu_ptr(pool->mags, cpu);
+		stats[RMNET_FRAG_DESC_POOL_FREE] += READ_ONCE(mag->count);
+		stats[RMNET_FRAG_DESC_ALLOC_FALLBACK] +=
+			READ_ONCE(mag->desc_alloc_fallback);
+		stats[RMNET_FRAG_DESC_FRAG_ALLOC_FALLBACK] +=
+			READ_ONCE(mag->frag_alloc_fallback);
+	}
+
+	memcpy(s, stats, min(n, RMNET_FRAG_DESC_NUM_STATS) * sizeof(u64));
+}
+EXPORT_SYMBOL(rmnet_descriptor_get_stats);
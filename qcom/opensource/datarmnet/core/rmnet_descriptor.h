@@ -23,8 +23,25 @@
 #include "rmnet_config.h"
 #include "rmnet_map.h"
 
+#define RMNET_FRAG_DESC_MAG_SIZE 64
+#define RMNET_FRAG_DESC_MAG_BATCH (RMNET_FRAG_DESC_MAG_SIZE / 2)
+#define RMNET_FRAG_DESC_EMBEDDED_FRAGS 8
+
+/* Per-CPU cache of free descriptors. Only touched with IRQs disabled on
+ * the owning CPU, and exchanged in batches with the shared free_list.
+ */
+struct rmnet_frag_desc_mag {
+	u32 count;
+	struct rmnet_frag_descriptor *descs[RMNET_FRAG_DESC_MAG_SIZE];
+	u64 desc_alloc_fallback;
+	u64 frag_alloc_fallback;
+};
+
 struct rmnet_frag_descriptor_pool {
+	struct rmnet_frag_desc_mag __percpu *mags;
+	/* Protected by port->desc_pool_lock */
 	struct list_head free_list;
+	u32 free_cnt;
 	u32 pool_size;
 };
 
@@ -60,6 +77,25 @@ struct rmnet_frag_descriptor {
 	   flush_shs:1,
 	   tcp_flags_set:1,
 	   reserved:2;
+
+	/* Everything below is owned by the descriptor pool and must not be
+	 * copied between descriptors, see RMNET_FRAG_DESC_META_LEN.
+	 */
+	u32 frag_slot_map;
+	struct rmnet_frag_descriptor_pool *pool;
+	struct rmnet_fragment frag_slots[RMNET_FRAG_DESC_EMBEDDED_FRAGS];
+};
+
+#define RMNET_FRAG_DESC_META_LEN \
+	offsetof(struct rmnet_frag_descriptor, frag_slot_map)
+
+/* rmnet_descriptor_get_stats() indexes */
+enum {
+	RMNET_FRAG_DESC_POOL_SIZE,
+	RMNET_FRAG_DESC_POOL_FREE,
+	RMNET_FRAG_DESC_ALLOC_FALLBACK,
+	RMNET_FRAG_DESC_FRAG_ALLOC_FALLBACK,
+	RMNET_FRAG_DESC_NUM_STATS,
 };
 
 /* Descriptor management */
@@ -67,12 +103,16 @@ struct rmnet_frag_descriptor *
 rmnet_get_frag_descriptor(struct rmnet_port *port);
 void rmnet_recycle_frag_descriptor(struct rmnet_frag_descriptor *frag_desc,
 				   struct rmnet_port *port);
+void rmnet_recycle_frag_descriptors(struct list_head *list,
+				    struct rmnet_port *port);
 void *rmnet_frag_pull(struct rmnet_frag_descriptor *frag_desc,
 		      struct rmnet_port *port, unsigned int size);
 void *rmnet_frag_trim(struct rmnet_frag_descriptor *frag_desc,
 		      struct rmnet_port *port, unsigned int size);
 void *rmnet_frag_header_ptr(struct rmnet_frag_descriptor *frag_desc, u32 off,
 			    u32 len, void *buf);
+__wsum rmnet_frag_csum(struct rmnet_frag_descriptor *frag_desc, u32 off,
+		       u32 len, __wsum csum);
 int rmnet_frag_descriptor_add_frag(struct rmnet_frag_descriptor *frag_desc,
 				   struct page *p, u32 page_offset, u32 len);
 int rmnet_frag_descriptor_add_frags_from(struct rmnet_frag_descriptor *to,
@@ -102,6 +142,7 @@ void rmnet_frag_ingress_handler(struct sk_buff *skb,
 
 int rmnet_descriptor_init(struct rmnet_port *port);
 void rmnet_descriptor_deinit(struct rmnet_port *port);
+void rmnet_descriptor_get_stats(struct rmnet_port *port, u64 *s, int n);
 
 static inline void *rmnet_frag_data_ptr(struct rmnet_frag_descriptor *frag_desc)
 {
@@ -0,0 +1,159 @@
+/* Copyright (c) 2022, Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * RMNET frag descriptor checksum tests
+ *
+ * Checks rmnet_frag_csum() against csum_partial() over a linear copy of
+ * the same bytes. Only a descriptor pool is needed, no endpoint or modem.
+ */
+
+#include <kunit/test.h>
+#include <linux/module.h>
+#include <net/checksum.h>
+#include "rmnet_config.h"
+#include "rmnet_descriptor.h"
+
+#define RMNET_DESC_KUNIT_BUF_LEN (4 * 1024)
+
+struct rmnet_desc_kunit_ctx {
+	struct rmnet_port *port;
+	u8 *buf;
+};
+
+static int rmnet_desc_kunit_init(struct kunit *test)
+{
+	struct rmnet_desc_kunit_ctx *ctx;
+	int rc;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->buf = kunit_kzalloc(test, RMNET_DESC_KUNIT_BUF_LEN, GFP_KERNEL);
+	if (!ctx->buf)
+		return -ENOMEM;
+
+	ctx->port = kzalloc(sizeof(*ctx->port), GFP_KERNEL);
+	if (!ctx->port)
+		return -ENOMEM;
+
+	rc = rmnet_descriptor_init(ctx->port);
+	if (rc) {
+		rmnet_descriptor_deinit(ctx->port);
+		kfree(ctx->port);
+		return rc;
+	}
+
+	test->priv = ctx;
+	return 0;
+}
+
+static void rmnet_desc_kunit_exit(struct kunit *test)
+{
+	struct rmnet_desc_kunit_ctx *ctx = test->priv;
+
+	if (!ctx)
+		return;
+
+	rmnet_descriptor_deinit(ctx->port);
+	kfree(ctx->port);
+}
+
+/* Checks rmnet_frag_csum() against csum_partial() over a linear copy, for
+ * ranges starting and ending on either side of every frag boundary. Frags
+ * have odd sizes and sit at odd page offsets.
+ */
+static void rmnet_desc_kunit_frag_csum_partial(struct kunit *test)
+{
+	struct rmnet_desc_kunit_ctx *ctx = test->priv;
+	static const u32 frag_len[] = { 1, 7, 509, 2, 1023, 3, 64, 1501 };
+	struct rmnet_frag_descriptor *frag_desc;
+	u32 bound[ARRAY_SIZE(frag_len) + 1];
+	u32 point[3 * ARRAY_SIZE(bound)];
+	u32 total = 0, num_point = 0, i, j, off, len;
+	__wsum seed = (__force __wsum)0x1234567;
+	u16 want, got;
+
+	for (i = 0; i < RMNET_DESC_KUNIT_BUF_LEN; i++)
+		ctx->buf[i] = (u8)(i * 131 + (i >> 8));
+
+	frag_desc = rmnet_get_frag_descriptor(ctx->port);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, frag_desc);
+
+	bound[0] = 0;
+	for (i = 0; i < ARRAY_SIZE(frag_len); i++) {
+		u32 page_off = 2 * i + 1;
+		struct page *page;
+
+		page = alloc_page(GFP_KERNEL);
+		KUNIT_ASSERT_NOT_ERR_OR_NULL(test, page);
+		memcpy(page_address(page) + page_off, ctx->buf + total,
+		       frag_len[i]);
+		KUNIT_ASSERT_EQ(test,
+				rmnet_frag_descriptor_add_frag(frag_desc, page,
+							       page_off,
+							       frag_len[i]),
+				0);
+		/* The descriptor holds its own reference */
+		put_page(page);
+		total += frag_len[i];
+		bound[i + 1] = total;
+	}
+
+	KUNIT_ASSERT_EQ(test, frag_desc->len, total);
+
+	/* Every frag boundary, one byte before and one byte after it. Short
+	 * frags make neighbours overlap, keep the points unique and sorted.
+	 */
+	for (i = 0; i < ARRAY_SIZE(bound); i++) {
+		for (j = 0; j < 3; j++) {
+			off = bound[i] + j - 1;
+			if (bound[i] + j < 1 || off > total ||
+			    (num_point && off <= point[num_point - 1]))
+				continue;
+			point[num_point++] = off;
+		}
+	}
+
+	for (i = 0; i < num_point; i++) {
+		for (j = i; j < num_point; j++) {
+			off = point[i];
+			len = point[j] - off;
+			want = (__force u16)csum_fold(csum_partial(ctx->buf +
+								   off, len,
+								   seed));
+			got = (__force u16)csum_fold(rmnet_frag_csum(frag_desc,
+								     off, len,
+								     seed));
+			KUNIT_EXPECT_EQ_MSG(test, got, want, "off %u len %u",
+					    off, len);
+		}
+	}
+
+	rmnet_recycle_frag_descriptor(frag_desc, ctx->port);
+}
+
+static struct kunit_case rmnet_desc_kunit_cases[] = {
+	KUNIT_CASE(rmnet_desc_kunit_frag_csum_partial),
+	{}
+};
+
+static struct kunit_suite rmnet_desc_kunit_suite = {
+	.name = "rmnet_frag_csum",
+	.init = rmnet_desc_kunit_init,
+	.exit = rmnet_desc_kunit_exit,
+	.test_cases = rmnet_desc_kunit_cases,
+};
+
+kunit_test_suites(&rmnet_desc_kunit_suite);
+
+MODULE_DESCRIPTION("RmNet frag descriptor checksum tests");
+MODULE_LICENSE("GPL v2");
@@ -404,6 +404,7 @@ struct sk_buff *rmnet_map_deaggregate(struct sk_buff *skb,
 
 	return skbn;
 }
+EXPORT_SYMBOL(rmnet_map_deaggregate);
 
 /* Validates packet checksums. Function takes a pointer to
  * the beginning of a buffer which contains the IP payload +
@@ -1326,6 +1327,28 @@ static void rmnet_map_linearize_copy(struct sk_buff *dst, struct sk_buff *src)
 	}
 }
 
+/* Packets whose page frags can be referenced from the aggregate instead of
+ * being copied. Zerocopy and spliced pages may change under us, and frag
+ * lists would need a second level of chaining.
+ */
+static bool rmnet_map_sg_can_share(struct sk_buff *skb)
+{
+	return !skb_has_frag_list(skb) && !skb_zcopy(skb) &&
+	       !skb_has_shared_frag(skb);
+}
+
+/* The scatter-gather mode only needs a coarse age for the aggregate, the
+ * hrtimer still bounds the flush latency.
+ */
+static void rmnet_map_agg_gettime(struct rmnet_aggregation_state *state,
+				  struct timespec64 *ts)
+{
+	if (state->params.agg_features & RMNET_AGG_SG)
+		ktime_get_coarse_ts64(ts);
+	else
+		ktime_get_real_ts64(ts);
+}
+
 static void rmnet_free_agg_pages(struct rmnet_aggregation_state *state)
 {
 	struct rmnet_agg_page *agg_page, *idx;
@@ -1336,6 +1359,11 @@ static void rmnet_free_agg_pages(struct rmnet_aggregation_state *state)
 		kfree(agg_page);
 	}
 
+	if (state->agg_hdr_page) {
+		put_page(state->agg_hdr_page);
+		state->agg_hdr_page = NULL;
+	}
+
 	state->agg_head = NULL;
 }
 
@@ -1437,6 +1465,88 @@ rmnet_map_build_skb(struct rmnet_aggregation_state *state)
 	return skb;
 }
 
+/* Returns header room for count bytes in the aggregation header page,
+ * replacing the page once it is full. Headers never go into the tailroom
+ * of the aggregate itself, since anything that linearizes or pads the skb
+ * writes there.
+ */
+static struct page *rmnet_map_sg_hdr_page(struct rmnet_aggregation_state *state,
+					  unsigned int count)
+{
+	if (state->agg_hdr_page &&
+	    state->agg_hdr_off + count <= state->agg_hdr_len)
+		return state->agg_hdr_page;
+
+	if (state->agg_hdr_page)
+		put_page(state->agg_hdr_page);
+
+	state->agg_hdr_page = rmnet_get_agg_pages(state);
+	state->agg_hdr_off = 0;
+	state->agg_hdr_len = PAGE_SIZE << state->agg_size_order;
+	if (!state->agg_hdr_page || count > state->agg_hdr_len)
+		return NULL;
+
+	return state->agg_hdr_page;
+}
+
+/* Append a packet to a scatter-gather aggregate. The first packet's MAP and
+ * IP headers are copied into the linear area, the rest are copied into a
+ * separate header page and added as page frags. Payload frags are referenced
+ * from the original skb. Packets that cannot be shared are copied whole into
+ * the header page.
+ */
+static int rmnet_map_sg_append(struct rmnet_aggregation_state *state,
+			       struct sk_buff *skb)
+{
+	struct sk_buff *agg_skb = state->agg_skb;
+	struct skb_shared_info *shinfo = skb_shinfo(agg_skb);
+	unsigned int hlen = skb->len, nr_frags = 0, i;
+	struct page *page;
+
+	if (rmnet_map_sg_can_share(skb)) {
+		hlen = skb_headlen(skb);
+		nr_frags = skb_shinfo(skb)->nr_frags;
+	}
+
+	if (shinfo->nr_frags + nr_frags + (agg_skb->len && hlen) >
+	    MAX_SKB_FRAGS ||
+	    (!agg_skb->len && hlen > skb_tailroom(agg_skb)))
+		return -ENOSPC;
+
+	if (!agg_skb->len) {
+		/* Lower drivers expect the first header to be linear */
+		skb_copy_bits(skb, 0, skb_put(agg_skb, hlen), hlen);
+	} else if (hlen) {
+		page = rmnet_map_sg_hdr_page(state, hlen);
+		if (!page)
+			return -ENOMEM;
+
+		skb_copy_bits(skb, 0, page_address(page) + state->agg_hdr_off,
+			      hlen);
+		get_page(page);
+		skb_fill_page_desc(agg_skb, shinfo->nr_frags, page,
+				   state->agg_hdr_off, hlen);
+		state->agg_hdr_off += hlen;
+		agg_skb->len += hlen;
+		agg_skb->data_len += hlen;
+		agg_skb->truesize += hlen;
+	}
+
+	if (!nr_frags)
+		return 0;
+
+	for (i = 0; i < nr_frags; i++) {
+		skb_frag_ref(skb, i);
+		shinfo->frags[shinfo->nr_frags++] = skb_shinfo(skb)->frags[i];
+	}
+
+	agg_skb->len += skb->data_len;
+	agg_skb->data_len += skb->data_len;
+	agg_skb->truesize += skb->data_len;
+	state->stats->ul_agg_sg++;
+	return 0;
+}
+
 void rmnet_map_send_agg_skb(struct rmnet_aggregation_state *state)
 {
 	struct sk_buff *agg_skb;
@@ -1456,6 +1566,7 @@ void rmnet_map_send_agg_skb(struct rmnet_aggregation_state *state)
 	spin_unlock_bh(&state->agg_lock);
 	hrtimer_cancel(&state->hrtimer);
 }
+EXPORT_SYMBOL(rmnet_map_send_agg_skb);
 
 void rmnet_map_tx_aggregate(struct sk_buff *skb, struct rmnet_port *port,
 			    bool low_latency)
@@ -1470,7 +1581,7 @@ void rmnet_map_tx_aggregate(struct sk_buff *skb, struct rmnet_port *port,
 new_packet:
 	spin_lock_bh(&state->agg_lock);
 	memcpy(&last, &state->agg_last, sizeof(last));
-	ktime_get_real_ts64(&state->agg_last);
+	rmnet_map_agg_gettime(state, &state->agg_last);
 
 	if ((port->data_format & RMNET_EGRESS_FORMAT_PRIORITY) &&
 	    (RMNET_LLM(skb->priority) || RMNET_APS_LLB(skb->priority))) {
@@ -1508,16 +1619,28 @@ new_packet:
 			return;
 		}
 
-		rmnet_map_linearize_copy(state->agg_skb, skb);
+		state->agg_sg = (state->params.agg_features & RMNET_AGG_SG) &&
+				(port->dev->features & NETIF_F_SG);
+		/* A packet that cannot start an SG aggregate, e.g. one with too
+		 * many frags, starts a linear one instead.
+		 */
+		if (state->agg_sg && rmnet_map_sg_append(state, skb))
+			state->agg_sg = false;
+
+		if (!state->agg_sg)
+			rmnet_map_linearize_copy(state->agg_skb, skb);
 		state->agg_skb->dev = skb->dev;
 		state->agg_skb->protocol = htons(ETH_P_MAP);
 		state->agg_count = 1;
-		ktime_get_real_ts64(&state->agg_time);
+		rmnet_map_agg_gettime(state, &state->agg_time);
 		dev_kfree_skb_any(skb);
 		goto schedule;
 	}
 	diff = timespec64_sub(state->agg_last, state->agg_time);
-	size = skb_tailroom(state->agg_skb);
+	if (state->agg_sg)
+		size = state->params.agg_size - state->agg_skb->len;
+	else
+		size = skb_tailroom(state->agg_skb);
 
 	if (skb->len > size ||
 	    state->agg_count >= state->params.agg_count ||
@@ -1526,7 +1649,15 @@ new_packet:
 		goto new_packet;
 	}
 
-	rmnet_map_linearize_copy(state->agg_skb, skb);
+	if (state->agg_sg) {
+		if (rmnet_map_sg_append(state, skb)) {
+			/* Out of frag slots or header pages */
+			rmnet_map_send_agg_skb(state);
+			goto new_packet;
+		}
+	} else {
+		rmnet_map_linearize_copy(state->agg_skb, skb);
+	}
 	state->agg_count++;
 	dev_kfree_skb_any(skb);
 
@@ -1539,6 +1670,7 @@ schedule:
 	}
 	spin_unlock_bh(&state->agg_lock);
 }
+EXPORT_SYMBOL(rmnet_map_tx_aggregate);
 
 void rmnet_map_update_ul_agg_config(struct rmnet_aggregation_state *state,
 				    u16 size, u8 count, u8 features, u32 time)
@@ -1563,12 +1695,13 @@ void rmnet_map_update_ul_agg_config(struct rmnet_aggregation_state *state,
 	size -= SKB_DATA_ALIGN(sizeof(struct skb_shared_info));
 	state->params.agg_size = size;
 
-	if (state->params.agg_features == RMNET_PAGE_RECYCLE)
+	if (state->params.agg_features & RMNET_PAGE_RECYCLE)
 		rmnet_alloc_agg_pages(state);
 
 done:
 	spin_unlock_bh(&state->agg_lock);
 }
+EXPORT_SYMBOL(rmnet_map_update_ul_agg_config);
 
 void rmnet_map_tx_aggregate_init(struct rmnet_port *port)
 {
@@ -1599,6 +1732,7 @@ void rmnet_map_tx_aggregate_init(struct rmnet_port *port)
 	port->agg_state[RMNET_DEFAULT_AGG_STATE].send_agg_skb = dev_queue_xmit;
 	port->agg_state[RMNET_LL_AGG_STATE].send_agg_skb = rmnet_ll_send_skb;
 }
+EXPORT_SYMBOL(rmnet_map_tx_aggregate_init);
 
 void rmnet_map_tx_aggregate_exit(struct rmnet_port *port)
 {
@@ -1631,6 +1765,7 @@ void rmnet_map_tx_aggregate_exit(struct rmnet_port *port)
 		spin_unlock_bh(&state->agg_lock);
 	}
 }
+EXPORT_SYMBOL(rmnet_map_tx_aggregate_exit);
 
 void rmnet_map_tx_qmap_cmd(struct sk_buff *qmap_skb, u8 ch, bool flush)
 {
@@ -0,0 +1,922 @@
+/* Copyright (c) 2022, Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * RMNET MAP ingress replay tests
+ *
+ * Builds synthetic QMAPv5 aggregates (checksum offload and coalesced
+ * frames) and replays them through the deaggregation and next header
+ * processing used by the ingress path. No modem or physical device is
+ * needed, the endpoint is an unregistered netdev.
+ *
+ * The egress suite feeds uplink packets through UL aggregation and checks
+ * the scatter-gather aggregates against the linear ones.
+ */
+
+#include <kunit/test.h>
+#include <linux/etherdevice.h>
+#include <linux/ip.h>
+#include <linux/ipv6.h>
+#include <linux/module.h>
+#include <linux/tcp.h>
+#include <linux/udp.h>
+#include <net/ip6_checksum.h>
+#include <net/ipv6.h>
+#include "rmnet_config.h"
+#include "rmnet_descriptor.h"
+#include "rmnet_map.h"
+#include "rmnet_private.h"
+
+#define RMNET_MAP_KUNIT_BUF_LEN (64 * 1024)
+
+static unsigned int rmnet_map_kunit_iters = 2000;
+module_param(rmnet_map_kunit_iters, uint, 0444);
+MODULE_PARM_DESC(rmnet_map_kunit_iters, "Replays per throughput test");
+
+struct rmnet_map_kunit_ctx {
+	struct rmnet_port *port;
+	struct net_device *dev;
+	u8 *buf;
+	u32 len;
+};
+
+struct rmnet_map_kunit_nlo {
+	u16 gso_size;
+	u8 num_packets;
+	u8 csum_error_bitmap;
+};
+
+static void rmnet_map_kunit_setup(struct net_device *dev)
+{
+	ether_setup(dev);
+	dev->features |= NETIF_F_RXCSUM;
+}
+
+/* Writes an IP and transport header followed by payload_len bytes of data,
+ * with valid IP and transport checksums. Returns the IP packet length.
+ */
+static u32 rmnet_map_kunit_put_ip(u8 *p, int ip_ver, u8 proto,
+				  u32 payload_len)
+{
+	u32 ip_len, trans_len, l4_len, i;
+	__sum16 *check;
+	__wsum csum;
+	u8 *l4;
+
+	ip_len = (ip_ver == 4) ? sizeof(struct iphdr) : sizeof(struct ipv6hdr);
+	trans_len = (proto == IPPROTO_TCP) ? sizeof(struct tcphdr) :
+					     sizeof(struct udphdr);
+	l4_len = trans_len + payload_len;
+	l4 = p + ip_len;
+
+	for (i = 0; i < payload_len; i++)
+		l4[trans_len + i] = (u8)i;
+
+	if (proto == IPPROTO_TCP) {
+		struct tcphdr *th = (struct tcphdr *)l4;
+
+		memset(th, 0, sizeof(*th));
+		th->source = htons(5001);
+		th->dest = htons(40000);
+		th->seq = htonl(1000);
+		th->ack_seq = htonl(1);
+		th->doff = sizeof(*th) / 4;
+		th->ack = 1;
+		th->window = htons(65535);
+		check = &th->check;
+	} else {
+		struct udphdr *uh = (struct udphdr *)l4;
+
+		uh->source = htons(5001);
+		uh->dest = htons(40000);
+		uh->len = htons(l4_len);
+		uh->check = 0;
+		check = &uh->check;
+	}
+
+	csum = csum_partial(l4, l4_len, 0);
+	if (ip_ver == 4) {
+		struct iphdr *iph = (struct iphdr *)p;
+
+		memset(iph, 0, sizeof(*iph));
+		iph->version = 4;
+		iph->ihl = sizeof(*iph) / 4;
+		iph->tot_len = htons(ip_len + l4_len);
+		iph->ttl = 64;
+		iph->protocol = proto;
+		iph->saddr = htonl(0x0a000001);
+		iph->daddr = htonl(0x0a000002);
+		iph->check = ip_fast_csum(iph, iph->ihl);
+		*check = csum_tcpudp_magic(iph->saddr, iph->daddr, l4_len,
+					   proto, csum);
+	} else {
+		struct ipv6hdr *ip6h = (struct ipv6hdr *)p;
+
+		memset(ip6h, 0, sizeof(*ip6h));
+		ip6h->version = 6;
+		ip6h->payload_len = htons(l4_len);
+		ip6h->nexthdr = proto;
+		ip6h->hop_limit = 64;
+		ipv6_addr_set(&ip6h->saddr, htonl(0x20010db8), 0, 0, htonl(1));
+		ipv6_addr_set(&ip6h->daddr, htonl(0x20010db8), 0, 0, htonl(2));
+		*check = csum_ipv6_magic(&ip6h->saddr, &ip6h->daddr, l4_len,
+					 proto, csum);
+	}
+
+	if (proto == IPPROTO_UDP && !*check)
+		*check = CSUM_MANGLED_0;
+
+	return ip_len + l4_len;
+}
+
+/* Appends a QMAP packet with a checksum offload header. Returns the length
+ * the packet should have once the QMAP headers and padding are removed.
+ */
+static u32 rmnet_map_kunit_put_csum(struct kunit *test,
+				    struct rmnet_map_kunit_ctx *ctx,
+				    int ip_ver, u8 proto, u32 payload_len,
+				    bool csum_valid_required)
+{
+	struct rmnet_map_header *maph;
+	struct rmnet_map_v5_csum_header *csum_hdr;
+	u32 pkt_len, pad;
+
+	KUNIT_ASSERT_LE(test, ctx->len + sizeof(*maph) + sizeof(*csum_hdr) +
+			sizeof(struct ipv6hdr) + sizeof(struct tcphdr) +
+			payload_len + 4, (size_t)RMNET_MAP_KUNIT_BUF_LEN);
+
+	maph = (struct rmnet_map_header *)(ctx->buf + ctx->len);
+	csum_hdr = (struct rmnet_map_v5_csum_header *)(maph + 1);
+	pkt_len = rmnet_map_kunit_put_ip((u8 *)(csum_hdr + 1), ip_ver, proto,
+					 payload_len);
+	pad = ALIGN(pkt_len, 4) - pkt_len;
+	memset((u8 *)(csum_hdr + 1) + pkt_len, 0, pad);
+
+	memset(maph, 0, sizeof(*maph));
+	maph->next_hdr = 1;
+	maph->pad_len = pad;
+	maph->mux_id = 1;
+	maph->pkt_len = htons(pkt_len + pad);
+
+	memset(csum_hdr, 0, sizeof(*csum_hdr));
+	csum_hdr->header_type = RMNET_MAP_HEADER_TYPE_CSUM_OFFLOAD;
+	csum_hdr->csum_valid_required = csum_valid_required;
+
+	ctx->len += sizeof(*maph) + sizeof(*csum_hdr) + pkt_len + pad;
+	return pkt_len;
+}
+
+/* Appends a coalesced frame. As on the wire, the IP and transport headers
+ * appear once, followed by the payloads of every packet described by the
+ * NLOs. Returns the combined IP and transport header length.
+ */
+static u32 rmnet_map_kunit_put_coal(struct kunit *test,
+				    struct rmnet_map_kunit_ctx *ctx,
+				    int ip_ver, u8 proto,
+				    const struct rmnet_map_kunit_nlo *nlos,
+				    u8 num_nlos, bool csum_valid)
+{
+	struct rmnet_map_header *maph;
+	struct rmnet_map_v5_coal_header *coal_hdr;
+	u32 pkt_len, data_len = 0;
+	u8 i;
+
+	for (i = 0; i < num_nlos; i++)
+		data_len += nlos[i].gso_size * nlos[i].num_packets;
+
+	KUNIT_ASSERT_LE(test, ctx->len + sizeof(*maph) + sizeof(*coal_hdr) +
+			sizeof(struct ipv6hdr) + sizeof(struct tcphdr) +
+			data_len, (size_t)RMNET_MAP_KUNIT_BUF_LEN);
+
+	maph = (struct rmnet_map_header *)(ctx->buf + ctx->len);
+	coal_hdr = (struct rmnet_map_v5_coal_header *)(maph + 1);
+	pkt_len = rmnet_map_kunit_put_ip((u8 *)(coal_hdr + 1), ip_ver, proto,
+					 data_len);
+
+	memset(maph, 0, sizeof(*maph));
+	maph->next_hdr = 1;
+	maph->mux_id = 1;
+	maph->pkt_len = htons(pkt_len);
+
+	memset(coal_hdr, 0, sizeof(*coal_hdr));
+	coal_hdr->header_type = RMNET_MAP_HEADER_TYPE_COALESCING;
+	coal_hdr->num_nlos = num_nlos;
+	coal_hdr->csum_valid = csum_valid;
+	coal_hdr->close_type = RMNET_MAP_COAL_CLOSE_HW;
+	coal_hdr->close_value = RMNET_MAP_COAL_CLOSE_HW_NL;
+	for (i = 0; i < num_nlos && i < RMNET_MAP_V5_MAX_NLOS; i++) {
+		coal_hdr->nl_pairs[i].pkt_len =
+			htons(pkt_len - data_len + nlos[i].gso_size);
+		coal_hdr->nl_pairs[i].csum_error_bitmap =
+			nlos[i].csum_error_bitmap;
+		coal_hdr->nl_pairs[i].num_packets = nlos[i].num_packets;
+	}
+
+	ctx->len += sizeof(*maph) + sizeof(*coal_hdr) + pkt_len;
+	return pkt_len - data_len;
+}
+
+/* Copies the aggregate into page fragments of at most chunk bytes each,
+ * the way the HW hands them to rmnet. Small chunks force headers to be
+ * split across fragments.
+ */
+static struct sk_buff *rmnet_map_kunit_paged_skb(struct kunit *test,
+						 struct rmnet_map_kunit_ctx *ctx,
+						 u32 chunk)
+{
+	struct sk_buff *skb;
+	u32 off, len;
+	int i = 0;
+
+	skb = alloc_skb(0, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, skb);
+
+	for (off = 0; off < ctx->len; off += len, i++) {
+		struct page *page;
+
+		len = min_t(u32, chunk, ctx->len - off);
+		KUNIT_ASSERT_LT(test, i, (int)MAX_SKB_FRAGS);
+		page = alloc_page(GFP_KERNEL);
+		KUNIT_ASSERT_NOT_ERR_OR_NULL(test, page);
+		memcpy(page_address(page), ctx->buf + off, len);
+		skb_add_rx_frag(skb, i, page, 0, len, PAGE_SIZE);
+	}
+
+	return skb;
+}
+
+static struct sk_buff *rmnet_map_kunit_linear_skb(struct kunit *test,
+						  struct rmnet_map_kunit_ctx *ctx)
+{
+	struct sk_buff *skb;
+
+	skb = alloc_skb(ctx->len, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, skb);
+	skb_put_data(skb, ctx->buf, ctx->len);
+	return skb;
+}
+
+/* Replays one HW buffer through the descriptor path the same way
+ * rmnet_frag_ingress_handler() does, minus the endpoint lookup and
+ * delivery. The resulting packets are appended to out.
+ */
+static void rmnet_map_kunit_frag_rx(struct rmnet_map_kunit_ctx *ctx,
+				    struct sk_buff *skb,
+				    struct list_head *out)
+{
+	struct rmnet_frag_descriptor *frag_desc, *tmp;
+	struct rmnet_map_header *qmap, __qmap;
+	LIST_HEAD(desc_list);
+	LIST_HEAD(segs);
+	u16 len;
+
+	rmnet_frag_deaggregate(skb, ctx->port, &desc_list, 0);
+	list_for_each_entry_safe(frag_desc, tmp, &desc_list, list) {
+		list_del_init(&frag_desc->list);
+		frag_desc->dev = ctx->dev;
+
+		qmap = rmnet_frag_header_ptr(frag_desc, 0, sizeof(*qmap),
+					     &__qmap);
+		if (!qmap) {
+			rmnet_recycle_frag_descriptor(frag_desc, ctx->port);
+			continue;
+		}
+
+		len = ntohs(qmap->pkt_len) - qmap->pad_len;
+		if (rmnet_frag_process_next_hdr_packet(frag_desc, ctx->port,
+						       &segs, len)) {
+			rmnet_recycle_frag_descriptor(frag_desc, ctx->port);
+			continue;
+		}
+
+		list_splice_tail_init(&segs, out);
+	}
+}
+
+/* Number of packets on the wire represented by a list of descriptors */
+static u32 rmnet_map_kunit_count_pkts(struct list_head *list)
+{
+	struct rmnet_frag_descriptor *frag_desc;
+	u32 pkts = 0;
+
+	list_for_each_entry(frag_desc, list, list)
+		pkts += max_t(u32, frag_desc->gso_segs, 1);
+
+	return pkts;
+}
+
+static struct rmnet_frag_descriptor *
+rmnet_map_kunit_nth(struct list_head *list, int n)
+{
+	struct rmnet_frag_descriptor *frag_desc;
+
+	list_for_each_entry(frag_desc, list, list) {
+		if (!n--)
+			return frag_desc;
+	}
+
+	return NULL;
+}
+
+static int rmnet_map_kunit_init(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx;
+	int rc;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->buf = kunit_kzalloc(test, RMNET_MAP_KUNIT_BUF_LEN, GFP_KERNEL);
+	if (!ctx->buf)
+		return -ENOMEM;
+
+	ctx->dev = alloc_netdev(sizeof(struct rmnet_priv), "rmnet_kunit%d",
+				NET_NAME_UNKNOWN, rmnet_map_kunit_setup);
+	if (!ctx->dev)
+		return -ENOMEM;
+
+	ctx->port = kzalloc(sizeof(*ctx->port), GFP_KERNEL);
+	if (!ctx->port) {
+		rc = -ENOMEM;
+		goto free_dev;
+	}
+
+	ctx->port->dev = ctx->dev;
+	ctx->port->data_format = RMNET_FLAGS_INGRESS_COALESCE |
+				 RMNET_PRIV_FLAGS_INGRESS_MAP_CKSUMV5;
+	rc = rmnet_descriptor_init(ctx->port);
+	if (rc)
+		goto free_port;
+
+	test->priv = ctx;
+	return 0;
+
+free_port:
+	rmnet_descriptor_deinit(ctx->port);
+	kfree(ctx->port);
+free_dev:
+	free_netdev(ctx->dev);
+	return rc;
+}
+
+static void rmnet_map_kunit_exit(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+
+	if (!ctx)
+		return;
+
+	rmnet_descriptor_deinit(ctx->port);
+	kfree(ctx->port);
+	free_netdev(ctx->dev);
+}
+
+static void rmnet_map_kunit_deagg_linear(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	static const struct rmnet_map_kunit_nlo nlo = { 1000, 4, 0 };
+	struct sk_buff *skb, *skbn;
+	u32 ip_len[6];
+	int i = 0;
+
+	ip_len[0] = rmnet_map_kunit_put_csum(test, ctx, 4, IPPROTO_UDP, 1, 1);
+	ip_len[1] = rmnet_map_kunit_put_csum(test, ctx, 4, IPPROTO_TCP, 1400,
+					     1);
+	ip_len[2] = rmnet_map_kunit_put_csum(test, ctx, 6, IPPROTO_UDP, 333,
+					     0);
+	ip_len[3] = rmnet_map_kunit_put_csum(test, ctx, 6, IPPROTO_TCP, 0, 0);
+	ip_len[4] = rmnet_map_kunit_put_csum(test, ctx, 4, IPPROTO_UDP, 1450,
+					     0);
+	ip_len[5] = rmnet_map_kunit_put_csum(test, ctx, 4, IPPROTO_TCP, 7, 1);
+
+	skb = rmnet_map_kunit_linear_skb(test, ctx);
+	while ((skbn = rmnet_map_deaggregate(skb, ctx->port)) != NULL) {
+		u32 len = sizeof(struct rmnet_map_header) +
+			  sizeof(struct rmnet_map_v5_csum_header);
+
+		KUNIT_ASSERT_LT(test, i, (int)ARRAY_SIZE(ip_len));
+		len += ALIGN(ip_len[i], 4);
+		KUNIT_EXPECT_EQ(test, skbn->len, len);
+		kfree_skb(skbn);
+		i++;
+	}
+
+	KUNIT_EXPECT_EQ(test, i, (int)ARRAY_SIZE(ip_len));
+	KUNIT_EXPECT_EQ(test, skb->len, 0U);
+	kfree_skb(skb);
+
+	/* Coalesced frames are handed back whole for next header handling */
+	ctx->len = 0;
+	rmnet_map_kunit_put_coal(test, ctx, 4, IPPROTO_TCP, &nlo, 1, true);
+	skb = rmnet_map_kunit_linear_skb(test, ctx);
+	KUNIT_EXPECT_PTR_EQ(test, rmnet_map_deaggregate(skb, ctx->port), skb);
+	kfree_skb(skb);
+}
+
+static void rmnet_map_kunit_frag_csum(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	struct rmnet_priv *priv = netdev_priv(ctx->dev);
+	struct rmnet_frag_descriptor *frag_desc;
+	struct sk_buff *skb;
+	LIST_HEAD(list);
+	u32 ip_len[6];
+	int i;
+
+	ip_len[0] = rmnet_map_kunit_put_csum(test, ctx, 4, IPPROTO_UDP, 1, 1);
+	ip_len[1] = rmnet_map_kunit_put_csum(test, ctx, 4, IPPROTO_TCP, 1400,
+					     0);
+	ip_len[2] = rmnet_map_kunit_put_csum(test, ctx, 6, IPPROTO_UDP, 333,
+					     0);
+	ip_len[3] = rmnet_map_kunit_put_csum(test, ctx, 6, IPPROTO_TCP, 0, 0);
+	ip_len[4] = rmnet_map_kunit_put_csum(test, ctx, 4, IPPROTO_UDP, 1450,
+					     0);
+	ip_len[5] = rmnet_map_kunit_put_csum(test, ctx, 6, IPPROTO_TCP, 7, 1);
+
+	/* Odd sized fragments so headers and payloads straddle pages */
+	skb = rmnet_map_kunit_paged_skb(test, ctx, 509);
+	rmnet_map_kunit_frag_rx(ctx, skb, &list);
+
+	KUNIT_EXPECT_EQ(test, rmnet_map_kunit_count_pkts(&list),
+			(u32)ARRAY_SIZE(ip_len));
+	for (i = 0; i < ARRAY_SIZE(ip_len); i++) {
+		frag_desc = rmnet_map_kunit_nth(&list, i);
+		KUNIT_ASSERT_NOT_ERR_OR_NULL(test, frag_desc);
+		KUNIT_EXPECT_EQ(test, frag_desc->len, ip_len[i]);
+		KUNIT_EXPECT_TRUE(test, frag_desc->csum_valid);
+	}
+
+	KUNIT_EXPECT_EQ(test, priv->stats.csum_ok, (u64)ARRAY_SIZE(ip_len));
+	KUNIT_EXPECT_EQ(test, priv->stats.csum_validation_failed, 0ULL);
+	KUNIT_EXPECT_EQ(test, priv->stats.csum_valid_unset, 0ULL);
+	rmnet_recycle_frag_descriptors(&list, ctx->port);
+	kfree_skb(skb);
+
+	/* Corrupt the last byte of a packet that needs SW validation */
+	ctx->len = 0;
+	ip_len[0] = rmnet_map_kunit_put_csum(test, ctx, 4, IPPROTO_TCP, 1400,
+					     0);
+	ctx->buf[sizeof(struct rmnet_map_header) +
+		 sizeof(struct rmnet_map_v5_csum_header) + ip_len[0] - 1] ^= 0xff;
+	skb = rmnet_map_kunit_paged_skb(test, ctx, 509);
+	rmnet_map_kunit_frag_rx(ctx, skb, &list);
+
+	frag_desc = rmnet_map_kunit_nth(&list, 0);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, frag_desc);
+	KUNIT_EXPECT_FALSE(test, frag_desc->csum_valid);
+	KUNIT_EXPECT_EQ(test, priv->stats.csum_valid_unset, 1ULL);
+	rmnet_recycle_frag_descriptors(&list, ctx->port);
+	kfree_skb(skb);
+}
+
+/* A single packet frame closed on FIN or PUSH has an unreliable HW checksum
+ * result, so rmnet validates it in SW whatever the header claims.
+ */
+static void rmnet_map_kunit_coal_csum_buggy(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	static const struct rmnet_map_kunit_nlo nlo = { 1001, 1, 0 };
+	struct rmnet_map_v5_coal_header *coal_hdr;
+	struct rmnet_frag_descriptor *frag_desc;
+	struct sk_buff *skb;
+	LIST_HEAD(list);
+	int corrupt;
+	u32 hlen;
+
+	coal_hdr = (struct rmnet_map_v5_coal_header *)
+		   (ctx->buf + sizeof(struct rmnet_map_header));
+	for (corrupt = 0; corrupt < 2; corrupt++) {
+		ctx->len = 0;
+		hlen = rmnet_map_kunit_put_coal(test, ctx, 4, IPPROTO_TCP,
+						&nlo, 1, true);
+		coal_hdr->close_type = RMNET_MAP_COAL_CLOSE_COAL;
+		if (corrupt)
+			ctx->buf[ctx->len - 1] ^= 0x5a;
+
+		/* Odd sized fragments split the payload at odd offsets */
+		skb = rmnet_map_kunit_paged_skb(test, ctx, 333);
+		rmnet_map_kunit_frag_rx(ctx, skb, &list);
+
+		KUNIT_ASSERT_TRUE(test, list_is_singular(&list));
+		frag_desc = rmnet_map_kunit_nth(&list, 0);
+		KUNIT_EXPECT_EQ(test, frag_desc->len, hlen + 1001);
+		KUNIT_EXPECT_EQ(test, (bool)frag_desc->csum_valid, !corrupt);
+		rmnet_recycle_frag_descriptors(&list, ctx->port);
+		kfree_skb(skb);
+	}
+}
+
+static void rmnet_map_kunit_coal_gro(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	struct rmnet_priv *priv = netdev_priv(ctx->dev);
+	static const struct rmnet_map_kunit_nlo nlo = { 1000, 10, 0 };
+	struct rmnet_frag_descriptor *frag_desc;
+	struct sk_buff *skb;
+	LIST_HEAD(list);
+	u32 hlen;
+
+	ctx->dev->features |= NETIF_F_GRO_HW;
+	hlen = rmnet_map_kunit_put_coal(test, ctx, 4, IPPROTO_TCP, &nlo, 1,
+					true);
+	skb = rmnet_map_kunit_paged_skb(test, ctx, PAGE_SIZE);
+	rmnet_map_kunit_frag_rx(ctx, skb, &list);
+
+	/* A single clean NLO is passed up as one GRO descriptor */
+	KUNIT_ASSERT_TRUE(test, list_is_singular(&list));
+	frag_desc = rmnet_map_kunit_nth(&list, 0);
+	KUNIT_EXPECT_EQ(test, frag_desc->len, hlen + 10 * 1000);
+	KUNIT_EXPECT_EQ(test, frag_desc->gso_size, (u16)1000);
+	KUNIT_EXPECT_EQ(test, frag_desc->gso_segs, (u16)10);
+	KUNIT_EXPECT_TRUE(test, frag_desc->csum_valid);
+	KUNIT_EXPECT_EQ(test, priv->stats.coal.coal_rx, 1ULL);
+	KUNIT_EXPECT_EQ(test, priv->stats.coal.coal_pkts, 10ULL);
+	KUNIT_EXPECT_EQ(test, priv->stats.coal.coal_tcp, 1ULL);
+	rmnet_recycle_frag_descriptors(&list, ctx->port);
+	kfree_skb(skb);
+}
+
+static void rmnet_map_kunit_coal_segment(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	static const struct rmnet_map_kunit_nlo nlos[] = {
+		{ 1200, 3, 0 },
+		{ 400, 1, 0 },
+	};
+	struct rmnet_frag_descriptor *frag_desc;
+	struct sk_buff *skb;
+	LIST_HEAD(list);
+	u32 hlen;
+	int i;
+
+	/* Without HW GRO every packet gets its own descriptor */
+	hlen = rmnet_map_kunit_put_coal(test, ctx, 6, IPPROTO_UDP, nlos,
+					ARRAY_SIZE(nlos), true);
+	skb = rmnet_map_kunit_paged_skb(test, ctx, 1024);
+	rmnet_map_kunit_frag_rx(ctx, skb, &list);
+
+	KUNIT_EXPECT_EQ(test, rmnet_map_kunit_count_pkts(&list), 4U);
+	for (i = 0; i < 4; i++) {
+		frag_desc = rmnet_map_kunit_nth(&list, i);
+		KUNIT_ASSERT_NOT_ERR_OR_NULL(test, frag_desc);
+		KUNIT_EXPECT_EQ(test, frag_desc->len,
+				hlen + ((i < 3) ? 1200 : 400));
+		KUNIT_EXPECT_EQ(test, frag_desc->pkt_id, (u8)i);
+		KUNIT_EXPECT_TRUE(test, frag_desc->csum_valid);
+	}
+
+	rmnet_recycle_frag_descriptors(&list, ctx->port);
+	kfree_skb(skb);
+}
+
+static void rmnet_map_kunit_coal_csum_err(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	struct rmnet_priv *priv = netdev_priv(ctx->dev);
+	static const struct rmnet_map_kunit_nlo nlo = { 1000, 6, BIT(2) };
+	struct rmnet_frag_descriptor *frag_desc;
+	struct sk_buff *skb;
+	LIST_HEAD(list);
+	static const u16 segs[] = { 2, 1, 3 };
+	static const bool valid[] = { true, false, true };
+	int i;
+
+	/* The bad packet is split out between two good GRO segments */
+	ctx->dev->features |= NETIF_F_GRO_HW;
+	rmnet_map_kunit_put_coal(test, ctx, 4, IPPROTO_TCP, &nlo, 1, false);
+	skb = rmnet_map_kunit_paged_skb(test, ctx, PAGE_SIZE);
+	rmnet_map_kunit_frag_rx(ctx, skb, &list);
+
+	KUNIT_EXPECT_EQ(test, rmnet_map_kunit_count_pkts(&list), 6U);
+	for (i = 0; i < ARRAY_SIZE(segs); i++) {
+		frag_desc = rmnet_map_kunit_nth(&list, i);
+		KUNIT_ASSERT_NOT_ERR_OR_NULL(test, frag_desc);
+		KUNIT_EXPECT_EQ(test, frag_desc->gso_segs, segs[i]);
+		KUNIT_EXPECT_EQ(test, (bool)frag_desc->csum_valid, valid[i]);
+	}
+
+	KUNIT_EXPECT_EQ(test, priv->stats.coal.coal_csum_err, 1ULL);
+	rmnet_recycle_frag_descriptors(&list, ctx->port);
+	kfree_skb(skb);
+}
+
+static void rmnet_map_kunit_coal_bad_hdr(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	struct rmnet_priv *priv = netdev_priv(ctx->dev);
+	static const struct rmnet_map_kunit_nlo nlo = { 10, 49, 0 };
+	struct sk_buff *skb;
+	LIST_HEAD(list);
+
+	rmnet_map_kunit_put_coal(test, ctx, 4, IPPROTO_UDP, &nlo, 0, true);
+	rmnet_map_kunit_put_coal(test, ctx, 4, IPPROTO_UDP, &nlo, 1, true);
+	skb = rmnet_map_kunit_paged_skb(test, ctx, PAGE_SIZE);
+	rmnet_map_kunit_frag_rx(ctx, skb, &list);
+
+	/* Both frames are dropped whole */
+	KUNIT_EXPECT_TRUE(test, list_empty(&list));
+	KUNIT_EXPECT_EQ(test, priv->stats.coal.coal_hdr_nlo_err, 1ULL);
+	KUNIT_EXPECT_EQ(test, priv->stats.coal.coal_hdr_pkt_err, 1ULL);
+	kfree_skb(skb);
+}
+
+static void rmnet_map_kunit_report(struct kunit *test, const char *path,
+				   u64 pkts, u64 ns, u64 allocs)
+{
+	kunit_info(test, "%s: %llu pkts in %llu ns, %llu pkts/sec, %llu allocs (%llu.%03llu per pkt)\n",
+		   path, pkts, ns, div64_u64(pkts * NSEC_PER_SEC, ns), allocs,
+		   div64_u64(allocs, max_t(u64, pkts, 1)),
+		   div64_u64(allocs * 1000, max_t(u64, pkts, 1)) % 1000);
+}
+
+/* Replays a mixed aggregate and reports throughput along with the number
+ * of allocations made per packet once the descriptor pool is warm.
+ */
+static void rmnet_map_kunit_replay_frag(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	static const struct rmnet_map_kunit_nlo tcp_nlo = { 1400, 16, 0 };
+	static const struct rmnet_map_kunit_nlo udp_nlos[] = {
+		{ 1200, 4, 0 },
+		{ 600, 1, 0 },
+	};
+	u64 before[RMNET_FRAG_DESC_NUM_STATS] = {0};
+	u64 after[RMNET_FRAG_DESC_NUM_STATS] = {0};
+	u64 start, ns, pkts = 0, allocs;
+	struct sk_buff *skb;
+	LIST_HEAD(list);
+	unsigned int i;
+
+	rmnet_map_kunit_put_coal(test, ctx, 4, IPPROTO_TCP, &tcp_nlo, 1, true);
+	rmnet_map_kunit_put_coal(test, ctx, 6, IPPROTO_UDP, udp_nlos,
+				 ARRAY_SIZE(udp_nlos), true);
+	for (i = 0; i < 8; i++)
+		rmnet_map_kunit_put_csum(test, ctx, (i & 1) ? 6 : 4,
+					 (i & 2) ? IPPROTO_UDP : IPPROTO_TCP,
+					 100 + i * 150, i & 4);
+
+	skb = rmnet_map_kunit_paged_skb(test, ctx, PAGE_SIZE);
+
+	/* Stay on one CPU so the per-CPU magazines see a steady state */
+	migrate_disable();
+
+	/* Warm up the descriptor pool and magazines */
+	local_bh_disable();
+	rmnet_map_kunit_frag_rx(ctx, skb, &list);
+	local_bh_enable();
+	KUNIT_EXPECT_EQ(test, rmnet_map_kunit_count_pkts(&list), 29U);
+	rmnet_recycle_frag_descriptors(&list, ctx->port);
+
+	rmnet_descriptor_get_stats(ctx->port, before, ARRAY_SIZE(before));
+	start = ktime_get_ns();
+	for (i = 0; i < rmnet_map_kunit_iters; i++) {
+		local_bh_disable();
+		rmnet_map_kunit_frag_rx(ctx, skb, &list);
+		pkts += rmnet_map_kunit_count_pkts(&list);
+		rmnet_recycle_frag_descriptors(&list, ctx->port);
+		local_bh_enable();
+	}
+	ns = max_t(u64, ktime_get_ns() - start, 1);
+	migrate_enable();
+	rmnet_descriptor_get_stats(ctx->port, after, ARRAY_SIZE(after));
+
+	allocs = (after[RMNET_FRAG_DESC_ALLOC_FALLBACK] -
+		  before[RMNET_FRAG_DESC_ALLOC_FALLBACK]) +
+		 (after[RMNET_FRAG_DESC_FRAG_ALLOC_FALLBACK] -
+		  before[RMNET_FRAG_DESC_FRAG_ALLOC_FALLBACK]);
+	rmnet_map_kunit_report(test, "frag", pkts, ns, allocs);
+
+	/* Steady state must be served entirely from the pool */
+	KUNIT_EXPECT_EQ(test, allocs, 0ULL);
+	kfree_skb(skb);
+}
+
+/* Same for the legacy path, which has no allocation counter of its own.
+ * Its allocations are counted from the skbs it hands out: a new sk_buff
+ * each, plus a data buffer unless the data still sits in the aggregate.
+ */
+static void rmnet_map_kunit_replay_linear(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	struct sk_buff *skb, *skbn;
+	u64 start, ns, pkts = 0, allocs = 0;
+	unsigned int i;
+
+	for (i = 0; i < 8; i++)
+		rmnet_map_kunit_put_csum(test, ctx, (i & 1) ? 6 : 4,
+					 (i & 2) ? IPPROTO_UDP : IPPROTO_TCP,
+					 100 + i * 150, i & 4);
+
+	skb = rmnet_map_kunit_linear_skb(test, ctx);
+	start = ktime_get_ns();
+	for (i = 0; i < rmnet_map_kunit_iters; i++) {
+		local_bh_disable();
+		while ((skbn = rmnet_map_deaggregate(skb, ctx->port)) != NULL) {
+			allocs += (skbn->head == skb->head) ? 1 : 2;
+			consume_skb(skbn);
+			pkts++;
+		}
+		local_bh_enable();
+
+		/* Deaggregation only pulls, so the data is still there */
+		skb_push(skb, ctx->len);
+	}
+	ns = max_t(u64, ktime_get_ns() - start, 1);
+
+	rmnet_map_kunit_report(test, "linear", pkts, ns, allocs);
+	KUNIT_EXPECT_EQ(test, pkts, (u64)rmnet_map_kunit_iters * 8);
+	KUNIT_EXPECT_GE(test, allocs, pkts);
+	kfree_skb(skb);
+}
+
+/* Aggregates handed to the lower device by the egress tests */
+static struct sk_buff_head rmnet_map_kunit_txq;
+
+static int rmnet_map_kunit_send_agg_skb(struct sk_buff *skb)
+{
+	skb_queue_tail(&rmnet_map_kunit_txq, skb);
+	return 0;
+}
+
+/* Builds an uplink packet the way the stack hands it to rmnet: the MAP and
+ * IP headers are linear and the payload sits in a page frag. The packet is
+ * also appended to ctx->buf.
+ */
+static struct sk_buff *rmnet_map_kunit_ul_skb(struct kunit *test,
+					      struct rmnet_map_kunit_ctx *ctx,
+					      int ip_ver, u32 payload_len)
+{
+	struct rmnet_map_header *maph;
+	u32 pkt_len, hlen;
+	struct sk_buff *skb;
+	struct page *page;
+	u8 *p;
+
+	KUNIT_ASSERT_LE(test, ctx->len + sizeof(*maph) +
+			sizeof(struct ipv6hdr) + sizeof(struct udphdr) +
+			payload_len, (size_t)RMNET_MAP_KUNIT_BUF_LEN);
+	KUNIT_ASSERT_LE(test, payload_len, (u32)PAGE_SIZE);
+
+	p = ctx->buf + ctx->len;
+	maph = (struct rmnet_map_header *)p;
+	pkt_len = rmnet_map_kunit_put_ip(p + sizeof(*maph), ip_ver,
+					 IPPROTO_UDP, payload_len);
+	memset(maph, 0, sizeof(*maph));
+	maph->mux_id = 1;
+	maph->pkt_len = htons(pkt_len);
+	hlen = sizeof(*maph) + pkt_len - payload_len;
+
+	skb = alloc_skb(hlen, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, skb);
+	skb_put_data(skb, p, hlen);
+	if (payload_len) {
+		page = alloc_page(GFP_KERNEL);
+		KUNIT_ASSERT_NOT_ERR_OR_NULL(test, page);
+		memcpy(page_address(page), p + hlen, payload_len);
+		skb_add_rx_frag(skb, 0, page, 0, payload_len, PAGE_SIZE);
+	}
+
+	skb->dev = ctx->dev;
+	ctx->len += hlen + payload_len;
+	return skb;
+}
+
+/* Aggregates a burst of packets with the given UL aggregation features and
+ * linearizes every aggregate into out. Returns the length written and the
+ * number of aggregates that were nonlinear.
+ */
+static u32 rmnet_map_kunit_ul_agg(struct kunit *test,
+				  struct rmnet_map_kunit_ctx *ctx,
+				  u8 features, u8 *out, u32 *num_sg)
+{
+	struct rmnet_aggregation_state *state;
+	struct sk_buff *skb;
+	u32 len = 0;
+	int i;
+
+	state = &ctx->port->agg_state[RMNET_DEFAULT_AGG_STATE];
+	rmnet_map_update_ul_agg_config(state, 8192, 20, features,
+				       NSEC_PER_SEC);
+
+	ctx->len = 0;
+	for (i = 0; i < 24; i++) {
+		skb = rmnet_map_kunit_ul_skb(test, ctx, (i & 1) ? 6 : 4,
+					     (i * 397) % 1400);
+		rmnet_map_tx_aggregate(skb, ctx->port, false);
+	}
+
+	spin_lock_bh(&state->agg_lock);
+	rmnet_map_send_agg_skb(state);
+
+	*num_sg = 0;
+	while ((skb = skb_dequeue(&rmnet_map_kunit_txq)) != NULL) {
+		if (skb_is_nonlinear(skb))
+			(*num_sg)++;
+
+		/* Pulls every frag into the tailroom of the aggregate */
+		KUNIT_EXPECT_EQ(test, skb_linearize(skb), 0);
+		KUNIT_ASSERT_LE(test, len + skb->len, ctx->len);
+		memcpy(out + len, skb->data, skb->len);
+		len += skb->len;
+		kfree_skb(skb);
+	}
+
+	return len;
+}
+
+static void rmnet_map_kunit_ul_agg_sg(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+	u32 sg_len, linear_len, num_sg;
+	u8 *sg, *linear;
+
+	sg = kunit_kzalloc(test, RMNET_MAP_KUNIT_BUF_LEN, GFP_KERNEL);
+	linear = kunit_kzalloc(test, RMNET_MAP_KUNIT_BUF_LEN, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, sg);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, linear);
+
+	linear_len = rmnet_map_kunit_ul_agg(test, ctx, 0, linear, &num_sg);
+	KUNIT_EXPECT_EQ(test, num_sg, 0U);
+	KUNIT_EXPECT_EQ(test, linear_len, ctx->len);
+	KUNIT_EXPECT_EQ(test, memcmp(linear, ctx->buf, ctx->len), 0);
+
+	sg_len = rmnet_map_kunit_ul_agg(test, ctx, RMNET_AGG_SG, sg, &num_sg);
+	KUNIT_EXPECT_GT(test, num_sg, 0U);
+	KUNIT_EXPECT_GT(test, ctx->port->stats.agg.ul_agg_sg, 0ULL);
+	KUNIT_ASSERT_EQ(test, sg_len, linear_len);
+	KUNIT_EXPECT_EQ(test, memcmp(sg, linear, sg_len), 0);
+}
+
+static int rmnet_map_kunit_egress_init(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx;
+	int rc;
+
+	rc = rmnet_map_kunit_init(test);
+	if (rc)
+		return rc;
+
+	ctx = test->priv;
+	ctx->dev->features |= NETIF_F_SG;
+	skb_queue_head_init(&rmnet_map_kunit_txq);
+	rmnet_map_tx_aggregate_init(ctx->port);
+	ctx->port->agg_state[RMNET_DEFAULT_AGG_STATE].send_agg_skb =
+		rmnet_map_kunit_send_agg_skb;
+	return 0;
+}
+
+static void rmnet_map_kunit_egress_exit(struct kunit *test)
+{
+	struct rmnet_map_kunit_ctx *ctx = test->priv;
+
+	if (ctx)
+		rmnet_map_tx_aggregate_exit(ctx->port);
+
+	skb_queue_purge(&rmnet_map_kunit_txq);
+	rmnet_map_kunit_exit(test);
+}
+
+static struct kunit_case rmnet_map_kunit_cases[] = {
+	KUNIT_CASE(rmnet_map_kunit_deagg_linear),
+	KUNIT_CASE(rmnet_map_kunit_frag_csum),
+	KUNIT_CASE(rmnet_map_kunit_coal_csum_buggy),
+	KUNIT_CASE(rmnet_map_kunit_coal_gro),
+	KUNIT_CASE(rmnet_map_kunit_coal_segment),
+	KUNIT_CASE(rmnet_map_kunit_coal_csum_err),
+	KUNIT_CASE(rmnet_map_kunit_coal_bad_hdr),
+	KUNIT_CASE(rmnet_map_kunit_replay_frag),
+	KUNIT_CASE(rmnet_map_kunit_replay_linear),
+	{}
+};
+
+static struct kunit_suite rmnet_map_kunit_suite = {
+	.name = "rmnet_map_ingress",
+	.init = rmnet_map_kunit_init,
+	.exit = rmnet_map_kunit_exit,
+	.test_cases = rmnet_map_kunit_cases,
+};
+
+static struct kunit_case rmnet_map_kunit_egress_cases[] = {
+	KUNIT_CASE(rmnet_map_kunit_ul_agg_sg),
+	{}
+};
+
+static struct kunit_suite rmnet_map_kunit_egress_suite = {
+	.name = "rmnet_map_egress",
+	.init = rmnet_map_kunit_egress_init,
+	.exit = rmnet_map_kunit_egress_exit,
+	.test_cases = rmnet_map_kunit_egress_cases,
+};
+
+kunit_test_suites(&rmnet_map_kunit_suite, &rmnet_map_kunit_egress_suite);
+
+MODULE_DESCRIPTION("RmNet MAP ingress replay and UL aggregation tests");
+MODULE_LICENSE("GPL v2");
@@ -0,0 +1,394 @@
+/* Copyright (c) 2022, Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * RMNET QMI flow map tests
+ *
+ * Drives uplink queue selection and bearer lookups from several threads
+ * while flows are activated, rebound and deactivated through the same
+ * netlink handler rmnet uses. Lookups run under RCU only, so any reader
+ * seeing a freed or half updated map shows up as a wrong queue or bearer,
+ * or as a KASAN report. No modem is needed, the DFC client is a dummy.
+ */
+
+#include <kunit/test.h>
+#include <linux/etherdevice.h>
+#include <linux/ip.h>
+#include <linux/kthread.h>
+#include <linux/module.h>
+#include <linux/rtnetlink.h>
+#include <linux/udp.h>
+#include "qmi_rmnet.h"
+#include "qmi_rmnet_i.h"
+#include "rmnet_config.h"
+
+#define RMNET_QMI_KUNIT_FLOWS 64
+#define RMNET_QMI_KUNIT_BEARERS 8
+#define RMNET_QMI_KUNIT_MAX_READERS 4
+
+static unsigned int rmnet_qmi_kunit_iters = 200;
+module_param(rmnet_qmi_kunit_iters, uint, 0444);
+MODULE_PARM_DESC(rmnet_qmi_kunit_iters, "Flow update passes per test");
+
+struct rmnet_qmi_kunit_ctx {
+	struct net_device *dev;
+	struct rmnet_port *port;
+	struct qmi_info *qmi;
+	struct qos_info *qos;
+	int dfc_mode;
+};
+
+struct rmnet_qmi_kunit_reader {
+	struct rmnet_qmi_kunit_ctx *ctx;
+	struct task_struct *task;
+	struct sk_buff *skb;
+	u64 lookups;
+	u64 errors;
+	u64 ns;
+};
+
+/* A flow keeps its queue whatever bearer it is bound to */
+static u32 rmnet_qmi_kunit_mq(u32 flow_id)
+{
+	return flow_id % (MAX_MQ_NUM / 2 - 1) + 1;
+}
+
+static void rmnet_qmi_kunit_flow(struct rmnet_qmi_kunit_ctx *ctx,
+				 int family, u8 bearer_id, u32 flow_id)
+{
+	struct tcmsg tcm;
+
+	memset(&tcm, 0, sizeof(tcm));
+	tcm.tcm_family = family;
+	tcm.tcm__pad1 = bearer_id;
+	tcm.tcm_parent = flow_id;
+	tcm.tcm_ifindex = AF_INET;
+	tcm.tcm_handle = rmnet_qmi_kunit_mq(flow_id);
+
+	rtnl_lock();
+	qmi_rmnet_change_link(ctx->dev, ctx->port, &tcm, sizeof(tcm));
+	rtnl_unlock();
+}
+
+static struct sk_buff *rmnet_qmi_kunit_skb(struct kunit *test)
+{
+	struct sk_buff *skb;
+	struct iphdr *iph;
+
+	skb = alloc_skb(sizeof(*iph) + sizeof(struct udphdr), GFP_KERNEL);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, skb);
+
+	skb_reset_network_header(skb);
+	iph = skb_put_zero(skb, sizeof(*iph) + sizeof(struct udphdr));
+	iph->version = 4;
+	iph->ihl = sizeof(*iph) / 4;
+	iph->tot_len = htons(sizeof(*iph) + sizeof(struct udphdr));
+	iph->protocol = IPPROTO_UDP;
+	skb->protocol = htons(ETH_P_IP);
+
+	return skb;
+}
+
+/* Queue selection as done from ndo_select_queue() on transmit */
+static int rmnet_qmi_kunit_queue(struct rmnet_qmi_kunit_ctx *ctx,
+				 struct sk_buff *skb, u32 mark)
+{
+	int txq;
+
+	skb->mark = mark;
+	rcu_read_lock_bh();
+	txq = qmi_rmnet_get_queue(ctx->dev, skb);
+	rcu_read_unlock_bh();
+
+	return txq;
+}
+
+/* Checks every flow and bearer once. Absent entries are fine, entries that
+ * don't match what was looked up are not.
+ */
+static u64 rmnet_qmi_kunit_lookup_all(struct rmnet_qmi_kunit_ctx *ctx,
+				      struct sk_buff *skb, u64 *errors)
+{
+	struct rmnet_bearer_map *bearer;
+	u32 flow_id, txq;
+	u8 bearer_id;
+
+	for (flow_id = 0; flow_id < RMNET_QMI_KUNIT_FLOWS; flow_id++) {
+		txq = rmnet_qmi_kunit_queue(ctx, skb, flow_id);
+		if (txq != DEFAULT_MQ_NUM && txq != rmnet_qmi_kunit_mq(flow_id))
+			(*errors)++;
+	}
+
+	rcu_read_lock();
+	for (bearer_id = 1; bearer_id <= RMNET_QMI_KUNIT_BEARERS; bearer_id++) {
+		bearer = qmi_rmnet_get_bearer_map(ctx->qos, bearer_id);
+		if (bearer && READ_ONCE(bearer->bearer_id) != bearer_id)
+			(*errors)++;
+	}
+	rcu_read_unlock();
+
+	return RMNET_QMI_KUNIT_FLOWS + RMNET_QMI_KUNIT_BEARERS;
+}
+
+static int rmnet_qmi_kunit_reader_fn(void *arg)
+{
+	struct rmnet_qmi_kunit_reader *reader = arg;
+	u64 start = ktime_get_ns();
+
+	while (!kthread_should_stop()) {
+		reader->lookups += rmnet_qmi_kunit_lookup_all(reader->ctx,
+							      reader->skb,
+							      &reader->errors);
+		cond_resched();
+	}
+
+	reader->ns = ktime_get_ns() - start;
+	return 0;
+}
+
+/* Rebinds every flow to the next bearer, and on every fourth pass drops
+ * half of them instead, so bearers come and go as well.
+ */
+static u64 rmnet_qmi_kunit_update(struct rmnet_qmi_kunit_ctx *ctx,
+				  unsigned int pass)
+{
+	u8 bearer_id;
+	u32 flow_id;
+
+	for (flow_id = 0; flow_id < RMNET_QMI_KUNIT_FLOWS; flow_id++) {
+		if ((pass & 3) == 3 && (flow_id & 1)) {
+			rmnet_qmi_kunit_flow(ctx, NLMSG_FLOW_DEACTIVATE, 0,
+					     flow_id);
+			continue;
+		}
+
+		bearer_id = (pass + flow_id) % RMNET_QMI_KUNIT_BEARERS + 1;
+		rmnet_qmi_kunit_flow(ctx, NLMSG_FLOW_ACTIVATE, bearer_id,
+				     flow_id);
+	}
+
+	return RMNET_QMI_KUNIT_FLOWS;
+}
+
+/* Runs the readers, either alone for a while or for as long as the flows
+ * are being updated, and reports the lookup rate.
+ */
+static void rmnet_qmi_kunit_run(struct kunit *test, bool update)
+{
+	struct rmnet_qmi_kunit_reader readers[RMNET_QMI_KUNIT_MAX_READERS];
+	struct rmnet_qmi_kunit_ctx *ctx = test->priv;
+	u64 lookups = 0, errors = 0, ns = 0, updates = 0;
+	int i, num_readers, started = 0;
+	unsigned int pass;
+
+	num_readers = clamp_t(int, num_online_cpus() - 1, 1,
+			      RMNET_QMI_KUNIT_MAX_READERS);
+
+	memset(readers, 0, sizeof(readers));
+	for (i = 0; i < num_readers; i++) {
+		readers[i].ctx = ctx;
+		readers[i].skb = rmnet_qmi_kunit_skb(test);
+	}
+
+	/* The readers live on this stack, don't bail out while they run */
+	for (i = 0; i < num_readers; i++) {
+		readers[i].task = kthread_run(rmnet_qmi_kunit_reader_fn,
+					      &readers[i], "rmnet_qmi_kunit/%d",
+					      i);
+		if (IS_ERR(readers[i].task))
+			break;
+		started++;
+	}
+
+	if (!update)
+		msleep(100);
+	else
+		for (pass = 0; pass < rmnet_qmi_kunit_iters; pass++)
+			updates += rmnet_qmi_kunit_update(ctx, pass);
+
+	for (i = 0; i < started; i++) {
+		kthread_stop(readers[i].task);
+		lookups += readers[i].lookups;
+		errors += readers[i].errors;
+		ns = max_t(u64, ns, readers[i].ns);
+	}
+
+	for (i = 0; i < num_readers; i++)
+		kfree_skb(readers[i].skb);
+
+	ns = max_t(u64, ns, 1);
+	kunit_info(test, "%s: %d readers, %llu lookups in %llu ns, %llu lookups/sec, %llu updates\n",
+		   update ? "updating" : "idle", started, lookups, ns,
+		   div64_u64(lookups * NSEC_PER_SEC, ns), updates);
+
+	KUNIT_EXPECT_EQ(test, started, num_readers);
+	KUNIT_EXPECT_GT(test, lookups, 0ULL);
+	KUNIT_EXPECT_EQ(test, errors, 0ULL);
+}
+
+static int rmnet_qmi_kunit_init(struct kunit *test)
+{
+	struct rmnet_qmi_kunit_ctx *ctx;
+	struct rmnet_priv *priv;
+
+	ctx = kunit_kzalloc(test, sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	ctx->port = kunit_kzalloc(test, sizeof(*ctx->port), GFP_KERNEL);
+	ctx->qmi = kunit_kzalloc(test, sizeof(*ctx->qmi), GFP_KERNEL);
+	if (!ctx->port || !ctx->qmi)
+		return -ENOMEM;
+
+	ctx->dev = alloc_netdev_mqs(sizeof(struct rmnet_priv),
+				    "rmnet_qmi_kunit%d", NET_NAME_UNKNOWN,
+				    ether_setup, MAX_MQ_NUM, 1);
+	if (!ctx->dev)
+		return -ENOMEM;
+
+	ctx->qos = qmi_rmnet_qos_init(ctx->dev, ctx->dev, 1);
+	if (!ctx->qos) {
+		free_netdev(ctx->dev);
+		return -ENOMEM;
+	}
+
+	priv = netdev_priv(ctx->dev);
+	RCU_INIT_POINTER(priv->qos_info, ctx->qos);
+
+	/* Flow updates only need a client to be present */
+	ctx->qmi->dfc_clients[0] = ctx->qmi;
+	ctx->port->qmi_info = ctx->qmi;
+	ctx->dfc_mode = dfc_mode;
+	dfc_mode = DFC_MODE_SA;
+
+	test->priv = ctx;
+	return 0;
+}
+
+static void rmnet_qmi_kunit_exit(struct kunit *test)
+{
+	struct rmnet_qmi_kunit_ctx *ctx = test->priv;
+	struct rmnet_priv *priv;
+
+	if (!ctx)
+		return;
+
+	priv = netdev_priv(ctx->dev);
+	RCU_INIT_POINTER(priv->qos_info, NULL);
+
+	rtnl_lock();
+	qmi_rmnet_qos_exit_pre(ctx->qos);
+	qmi_rmnet_qos_exit_post();
+	rtnl_unlock();
+
+	dfc_mode = ctx->dfc_mode;
+	free_netdev(ctx->dev);
+}
+
+static void rmnet_qmi_kunit_lookup(struct kunit *test)
+{
+	struct rmnet_qmi_kunit_ctx *ctx = test->priv;
+	struct rmnet_flow_map *itm;
+	struct sk_buff *skb;
+	u32 flow_id;
+	u8 bearer_id;
+
+	skb = rmnet_qmi_kunit_skb(test);
+	for (flow_id = 0; flow_id < RMNET_QMI_KUNIT_FLOWS; flow_id++)
+		rmnet_qmi_kunit_flow(ctx, NLMSG_FLOW_ACTIVATE,
+				     flow_id % RMNET_QMI_KUNIT_BEARERS + 1,
+				     flow_id);
+
+	/* More flows than hash buckets, so some share a chain */
+	for (flow_id = 0; flow_id < RMNET_QMI_KUNIT_FLOWS; flow_id++) {
+		KUNIT_EXPECT_EQ(test, rmnet_qmi_kunit_queue(ctx, skb, flow_id),
+				(int)rmnet_qmi_kunit_mq(flow_id));
+	}
+
+	rcu_read_lock();
+	for (bearer_id = 1; bearer_id <= RMNET_QMI_KUNIT_BEARERS; bearer_id++)
+		KUNIT_EXPECT_NOT_ERR_OR_NULL(test,
+			qmi_rmnet_get_bearer_map(ctx->qos, bearer_id));
+	KUNIT_EXPECT_PTR_EQ(test,
+		qmi_rmnet_get_bearer_map(ctx->qos,
+					 RMNET_QMI_KUNIT_BEARERS + 1),
+		NULL);
+	rcu_read_unlock();
+
+	/* Rebinding moves the flow to a new bearer but keeps its queue */
+	rmnet_qmi_kunit_flow(ctx, NLMSG_FLOW_ACTIVATE,
+			     RMNET_QMI_KUNIT_BEARERS + 1, 0);
+	KUNIT_EXPECT_EQ(test, rmnet_qmi_kunit_queue(ctx, skb, 0),
+			(int)rmnet_qmi_kunit_mq(0));
+	rcu_read_lock();
+	itm = qmi_rmnet_get_flow_map(ctx->qos, 0, AF_INET);
+	KUNIT_ASSERT_NOT_ERR_OR_NULL(test, itm);
+	KUNIT_EXPECT_EQ(test, itm->bearer_id,
+			(u8)(RMNET_QMI_KUNIT_BEARERS + 1));
+	KUNIT_EXPECT_NOT_ERR_OR_NULL(test,
+		qmi_rmnet_get_bearer_map(ctx->qos,
+					 RMNET_QMI_KUNIT_BEARERS + 1));
+	rcu_read_unlock();
+
+	for (flow_id = 0; flow_id < RMNET_QMI_KUNIT_FLOWS; flow_id++)
+		rmnet_qmi_kunit_flow(ctx, NLMSG_FLOW_DEACTIVATE, 0, flow_id);
+
+	for (flow_id = 0; flow_id < RMNET_QMI_KUNIT_FLOWS; flow_id++) {
+		KUNIT_EXPECT_EQ(test, rmnet_qmi_kunit_queue(ctx, skb, flow_id),
+				DEFAULT_MQ_NUM);
+	}
+
+	rcu_read_lock();
+	for (bearer_id = 1; bearer_id <= RMNET_QMI_KUNIT_BEARERS + 1;
+	     bearer_id++)
+		KUNIT_EXPECT_PTR_EQ(test,
+			qmi_rmnet_get_bearer_map(ctx->qos, bearer_id), NULL);
+	rcu_read_unlock();
+
+	kfree_skb(skb);
+}
+
+/* Lookup rate with the maps left alone, as a reference for the next test */
+static void rmnet_qmi_kunit_lookup_idle(struct kunit *test)
+{
+	struct rmnet_qmi_kunit_ctx *ctx = test->priv;
+	u32 flow_id;
+
+	for (flow_id = 0; flow_id < RMNET_QMI_KUNIT_FLOWS; flow_id++)
+		rmnet_qmi_kunit_flow(ctx, NLMSG_FLOW_ACTIVATE,
+				     flow_id % RMNET_QMI_KUNIT_BEARERS + 1,
+				     flow_id);
+
+	rmnet_qmi_kunit_run(test, false);
+}
+
+static void rmnet_qmi_kunit_lookup_concurrent(struct kunit *test)
+{
+	rmnet_qmi_kunit_run(test, true);
+}
+
+static struct kunit_case rmnet_qmi_kunit_cases[] = {
+	KUNIT_CASE(rmnet_qmi_kunit_lookup),
+	KUNIT_CASE(rmnet_qmi_kunit_lookup_idle),
+	KUNIT_CASE(rmnet_qmi_kunit_lookup_concurrent),
+	{}
+};
+
+static struct kunit_suite rmnet_qmi_kunit_suite = {
+	.name = "rmnet_qmi_flow_map",
+	.init = rmnet_qmi_kunit_init,
+	.exit = rmnet_qmi_kunit_exit,
+	.test_cases = rmnet_qmi_kunit_cases,
+};
+
+kunit_test_suites(&rmnet_qmi_kunit_suite);
+
+MODULE_DESCRIPTION("RmNet QMI flow map tests");
+MODULE_LICENSE("GPL v2");
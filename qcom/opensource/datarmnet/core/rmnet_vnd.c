@@ -34,6 +34,7 @@
 #include "rmnet_genl.h"
 #include "rmnet_ll.h"
 #include "rmnet_ctl.h"
+#include "rmnet_descriptor.h"
 
 #include "qmi_rmnet.h"
 #include "rmnet_qmi.h"
@@ -561,6 +562,7 @@ static const char rmnet_port_gstrings_stats[][ETH_GSTRING_LEN] = {
 	"DL trailer pkts received",
 	"UL agg reuse",
 	"UL agg alloc",
+	"UL agg SG",
 	"DL chaining [0-10)",
 	"DL chaining [10-20)",
 	"DL chaining [20-30)",
@@ -603,6 +605,13 @@ static const char rmnet_qmap_gstrings_stats[][ETH_GSTRING_LEN] = {
 	"QMAP TX complete (MHI)",
 };
 
+static const char rmnet_desc_gstrings_stats[][ETH_GSTRING_LEN] = {
+	"Desc pool size",
+	"Desc pool free",
+	"Desc alloc fallback",
+	"Desc frag alloc fallback",
+};
+
 static void rmnet_get_strings(struct net_device *dev, u32 stringset, u8 *buf)
 {
 	size_t off = 0;
@@ -621,6 +630,9 @@ static void rmnet_get_strings(struct net_device *dev, u32 stringset, u8 *buf)
 		off += sizeof(rmnet_ll_gstrings_stats);
 		memcpy(buf + off, &rmnet_qmap_gstrings_stats,
 		       sizeof(rmnet_qmap_gstrings_stats));
+		off += sizeof(rmnet_qmap_gstrings_stats);
+		memcpy(buf + off, &rmnet_desc_gstrings_stats,
+		       sizeof(rmnet_desc_gstrings_stats));
 		break;
 	}
 }
@@ -632,7 +644,8 @@ static int rmnet_get_sset_count(struct net_device *dev, int sset)
 		return ARRAY_SIZE(rmnet_gstrings_stats) +
 		       ARRAY_SIZE(rmnet_port_gstrings_stats) +
 		       ARRAY_SIZE(rmnet_ll_gstrings_stats) +
-		       ARRAY_SIZE(rmnet_qmap_gstrings_stats);
+		       ARRAY_SIZE(rmnet_qmap_gstrings_stats) +
+		       ARRAY_SIZE(rmnet_desc_gstrings_stats);
 	default:
 		return -EOPNOTSUPP;
 	}
@@ -648,6 +661,7 @@ static void rmnet_get_ethtool_stats(struct net_device *dev,
 	struct rmnet_port *port;
 	size_t off = 0;
 	u64 qmap_s[ARRAY_SIZE(rmnet_qmap_gstrings_stats)];
+	u64 desc_s[ARRAY_SIZE(rmnet_desc_gstrings_stats)];
 
 	port = rmnet_get_port(priv->real_dev);
 
@@ -670,6 +684,13 @@ static void rmnet_get_ethtool_stats(struct net_device *dev,
 	rmnet_ctl_get_stats(qmap_s, ARRAY_SIZE(rmnet_qmap_gstrings_stats));
 	memcpy(data + off, qmap_s,
 	       ARRAY_SIZE(rmnet_qmap_gstrings_stats) * sizeof(u64));
+
+	off += ARRAY_SIZE(rmnet_qmap_gstrings_stats);
+	memset(desc_s, 0, sizeof(desc_s));
+	rmnet_descriptor_get_stats(port, desc_s,
+				   ARRAY_SIZE(rmnet_desc_gstrings_stats));
+	memcpy(data + off, desc_s,
+	       ARRAY_SIZE(rmnet_desc_gstrings_stats) * sizeof(u64));
 }
 
 static int rmnet_stats_reset(struct net_device *dev)